@@ -54,6 +54,8 @@ osThreadId chassis_controlTaskHandle;
 osThreadId plotTaskHandle;
 osThreadId canTaskHandle;
 osThreadId uartTaskHandle;
+osThreadId usbTaskHandle;
+osThreadId monitorTaskHandle;
 
 /* Private function prototypes -----------------------------------------------*/
 /* USER CODE BEGIN FunctionPrototypes */
@@ -67,10 +69,16 @@ extern void chassis_control_task(void const * argument);
 extern void plot_task(void const * argument);
 extern void can_task(void const * argument);
 extern void uart_task(void const * argument);
+extern void usb_task(void const * argument);
+extern void monitor_task(void const * argument);
 
 extern void MX_USB_DEVICE_Init(void);
 void MX_FREERTOS_Init(void); /* (MISRA C 2004 rule 8.1) */
 
+/* Hook prototypes */
+void configureTimerForRunTimeStats(void);
+unsigned long getRunTimeCounterValue(void);
+
 /* GetIdleTaskMemory prototype (linked to static allocation support) */
 void vApplicationGetIdleTaskMemory( StaticTask_t **ppxIdleTaskTCBBuffer, StackType_t **ppxIdleTaskStackBuffer, uint32_t *pulIdleTaskStackSize );
 
@@ -131,7 +139,7 @@ void MX_FREERTOS_Init(void) {
   chassis_controlTaskHandle = osThreadCreate(osThread(chassis_controlTask), NULL);
 
   /* definition and creation of plotTask */
-  osThreadDef(plotTask, plot_task, osPriorityHigh, 0, 128);
+  osThreadDef(plotTask, plot_task, osPriorityLow, 0, 256);
   plotTaskHandle = osThreadCreate(osThread(plotTask), NULL);
 
   /* definition and creation of canTask */
@@ -142,6 +150,14 @@ void MX_FREERTOS_Init(void) {
   osThreadDef(uartTask, uart_task, osPriorityHigh, 0, 256);
   uartTaskHandle = osThreadCreate(osThread(uartTask), NULL);
 
+  /* definition and creation of usbTask */
+  osThreadDef(usbTask, usb_task, osPriorityNormal, 0, 256);
+  usbTaskHandle = osThreadCreate(osThread(usbTask), NULL);
+
+  /* definition and creation of monitorTask */
+  osThreadDef(monitorTask, monitor_task, osPriorityLow, 0, 256);
+  monitorTaskHandle = osThreadCreate(osThread(monitorTask), NULL);
+
   /* USER CODE BEGIN RTOS_THREADS */
   /* add threads, ... */
   /* USER CODE END RTOS_THREADS */
@@ -0,0 +1,78 @@
+#include "accel_limiter.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+float achievable_wheel_accel(const PowerModel & model, float power_limit, const float speed[4], float max_torque)
+{
+    float sum_abs_speed = 0.0f;
+    float sum_speed_sq = 0.0f;
+    for (int i = 0; i < 4; i++) {
+        sum_abs_speed += std::abs(speed[i]);
+        sum_speed_sq += speed[i] * speed[i];
+    }
+
+    // 4·k1·τ² + Σ|ω|·τ + c = 0
+    float a = 4.0f * model.k1_torque_loss;
+    float b = sum_abs_speed;
+    float c = model.k2_speed_loss * sum_speed_sq + model.k3_static_power - power_limit;
+
+    float torque;
+    if (c >= 0.0f) {
+        torque = 0.0f;
+    }
+    else if (a > 0.0f) {
+        torque = (-b + std::sqrt(b * b - 4.0f * a * c)) / (2.0f * a);
+    }
+    else {
+        torque = (b > 0.0f) ? -c / b : max_torque;
+    }
+    torque = std::min(torque, max_torque);
+
+    // 扣除维持当前转速的摩擦力矩
+    float friction = model.viscous * sum_abs_speed * 0.25f + model.coulomb;
+    return std::max(torque - friction, 0.0f) / model.inertia;
+}
+
+AccelLimiter::AccelLimiter(float wheel_radius, float half_length, float half_width, float dt)
+: inverse_(wheel_radius, half_length, half_width), dt_(dt)
+{
+}
+
+void AccelLimiter::reset(float vx, float vy, float wz)
+{
+    vx_ = vx;
+    vy_ = vy;
+    wz_ = wz;
+    scale = 1.0f;
+}
+
+void AccelLimiter::limit(float & vx, float & vy, float & wz, float accel_max, float brake_max)
+{
+    // 运动学为线性映射，对设定值之差解算即得轮速设定值之差
+    float dvx = vx - vx_;
+    float dvy = vy - vy_;
+    float dwz = wz - wz_;
+    inverse_.calc(dvx, dvy, dwz);
+    const float delta[4] = {inverse_.speed_lf, inverse_.speed_lr, inverse_.speed_rf, inverse_.speed_rr};
+    inverse_.calc(vx_, vy_, wz_);
+    const float last[4] = {inverse_.speed_lf, inverse_.speed_lr, inverse_.speed_rf, inverse_.speed_rr};
+
+    float max_delta = 0.0f;
+    float power_sign = 0.0f;
+    for (int i = 0; i < 4; i++) {
+        max_delta = std::max(max_delta, std::abs(delta[i]));
+        power_sign += last[i] * delta[i];
+    }
+
+    // 增加动能时受功率限制，减速时只受力矩限制
+    float step_max = ((power_sign >= 0.0f) ? accel_max : brake_max) * dt_;
+    scale = (max_delta > step_max) ? step_max / max_delta : 1.0f;
+
+    vx_ += dvx * scale;
+    vy_ += dvy * scale;
+    wz_ += dwz * scale;
+    vx = vx_;
+    vy = vy_;
+    wz = wz_;
+}
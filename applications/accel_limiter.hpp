@@ -0,0 +1,46 @@
+#ifndef ACCEL_LIMITER_HPP
+#define ACCEL_LIMITER_HPP
+
+#include "tools/mecanum/mecanum.hpp"
+
+// 功率模型参数 (取自在线参数块)
+struct PowerModel
+{
+    float k1_torque_loss;
+    float k2_speed_loss;
+    float k3_static_power;
+    float inertia;   // 轮轴等效转动惯量
+    float viscous;
+    float coulomb;
+};
+
+// 由功率模型求功率上限下可达的轮角加速度 rad/s^2
+// 设四轮以相同的力矩幅值τ加速：P = Σ|ω|·τ + 4·k1·τ² + k2·Σω² + k3，
+// 解出τ后扣除维持当前转速所需的摩擦力矩，余量除以J即为可达角加速度
+float achievable_wheel_accel(const PowerModel & model, float power_limit, const float speed[4], float max_torque);
+
+// 功率感知的设定值加速度限制器
+// 放在运动学解算之前：把车体速度设定值相对上一周期的变化按比例缩小，
+// 使四个轮速设定值的变化率都不超过可达角加速度，PID不再追赶功率上限下达不到的目标
+class AccelLimiter
+{
+public:
+    AccelLimiter(float wheel_radius, float half_length, float half_width, float dt);
+
+    // accel_max: 增加动能方向的最大轮角加速度；brake_max: 减速方向的最大轮角加速度
+    void limit(float & vx, float & vy, float & wz, float accel_max, float brake_max);
+
+    // 停止控制后调用，下次从给定值开始
+    void reset(float vx = 0.0f, float vy = 0.0f, float wz = 0.0f);
+
+    float scale = 1.0f;  // 本周期设定值变化的缩放比例，1为未限制
+
+private:
+    sp::Mecanum inverse_;
+    const float dt_;
+    float vx_ = 0.0f;
+    float vy_ = 0.0f;
+    float wz_ = 0.0f;
+};
+
+#endif // ACCEL_LIMITER_HPP
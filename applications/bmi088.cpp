@@ -0,0 +1,252 @@
+#include "bmi088.hpp"
+
+#include "cmsis_os.h"
+#include "input_recorder.hpp"
+#include "scope_timer.hpp"
+
+// 加速度计寄存器
+constexpr uint8_t ACC_CHIP_ID = 0x00;
+constexpr uint8_t ACC_X_LSB = 0x12;
+constexpr uint8_t ACC_CONF = 0x40;
+constexpr uint8_t ACC_RANGE = 0x41;
+constexpr uint8_t ACC_INT1_IO_CTRL = 0x53;
+constexpr uint8_t ACC_INT_MAP_DATA = 0x58;
+constexpr uint8_t ACC_PWR_CONF = 0x7C;
+constexpr uint8_t ACC_PWR_CTRL = 0x7D;
+constexpr uint8_t ACC_SOFTRESET = 0x7E;
+constexpr uint8_t ACC_CHIP_ID_VALUE = 0x1E;
+
+// 陀螺仪寄存器
+constexpr uint8_t GYRO_CHIP_ID = 0x00;
+constexpr uint8_t GYRO_RATE_X_LSB = 0x02;
+constexpr uint8_t GYRO_RANGE = 0x0F;
+constexpr uint8_t GYRO_BANDWIDTH = 0x10;
+constexpr uint8_t GYRO_SOFTRESET = 0x14;
+constexpr uint8_t GYRO_INT_CTRL = 0x15;
+constexpr uint8_t GYRO_INT3_INT4_IO_CONF = 0x16;
+constexpr uint8_t GYRO_INT3_INT4_IO_MAP = 0x18;
+constexpr uint8_t GYRO_CHIP_ID_VALUE = 0x0F;
+
+constexpr uint8_t SOFTRESET_CMD = 0xB6;
+constexpr uint8_t SPI_READ = 0x80;
+constexpr uint32_t SPI_TIMEOUT_MS = 10;
+
+// 配置：加速度计±6g、1600Hz，陀螺仪±2000dps、1000Hz，数据就绪均为推挽低电平有效
+constexpr uint8_t ACC_CONF_VALUE = 0xAC;          // normal带宽，ODR 1600Hz
+constexpr uint8_t ACC_RANGE_VALUE = 0x01;         // ±6g
+constexpr uint8_t ACC_INT1_IO_VALUE = 0x08;       // INT1输出，推挽，低电平有效
+constexpr uint8_t ACC_INT1_DRDY = 0x04;
+constexpr uint8_t GYRO_RANGE_VALUE = 0x00;        // ±2000dps
+constexpr uint8_t GYRO_BANDWIDTH_VALUE = 0x02;    // ODR 1000Hz，滤波116Hz
+constexpr uint8_t GYRO_DRDY_ENABLE = 0x80;
+constexpr uint8_t GYRO_INT3_IO_VALUE = 0x00;      // INT3推挽，低电平有效
+constexpr uint8_t GYRO_INT3_DRDY = 0x01;
+
+constexpr float ACCEL_SCALE = 6.0f * 9.80665f / 32768.0f;
+constexpr float GYRO_SCALE = 2000.0f / 32768.0f * 3.14159265f / 180.0f;
+
+constexpr uint8_t PENDING_ACCEL = 1u << 0;
+constexpr uint8_t PENDING_GYRO = 1u << 1;
+
+// 加速度计读数据时地址后跟一个哑字节
+constexpr uint16_t ACCEL_XFER_LEN = 8;
+constexpr uint16_t GYRO_XFER_LEN = 7;
+
+static int16_t to_int16(const uint8_t * data)
+{
+    return static_cast<int16_t>(data[0] | (data[1] << 8));
+}
+
+Bmi088::Bmi088(SPI_HandleTypeDef * hspi) : hspi_(hspi) {}
+
+void Bmi088::select(Device device, bool active)
+{
+    GPIO_PinState state = active ? GPIO_PIN_RESET : GPIO_PIN_SET;
+    if (device == Device::ACCEL) {
+        HAL_GPIO_WritePin(CS1_ACC_GPIO_Port, CS1_ACC_Pin, state);
+    }
+    else {
+        HAL_GPIO_WritePin(CS1_GYRO_GPIO_Port, CS1_GYRO_Pin, state);
+    }
+}
+
+bool Bmi088::write_reg(Device device, uint8_t reg, uint8_t value)
+{
+    uint8_t tx[2] = {reg, value};
+    uint8_t rx[2];
+    select(device, true);
+    bool ok = HAL_SPI_TransmitReceive(hspi_, tx, rx, sizeof(tx), SPI_TIMEOUT_MS) == HAL_OK;
+    select(device, false);
+    return ok;
+}
+
+bool Bmi088::read_reg(Device device, uint8_t reg, uint8_t & value)
+{
+    uint8_t tx[3] = {static_cast<uint8_t>(reg | SPI_READ), 0, 0};
+    uint8_t rx[3];
+    uint16_t len = (device == Device::ACCEL) ? 3 : 2;
+    select(device, true);
+    bool ok = HAL_SPI_TransmitReceive(hspi_, tx, rx, len, SPI_TIMEOUT_MS) == HAL_OK;
+    select(device, false);
+    value = rx[len - 1];
+    return ok;
+}
+
+bool Bmi088::init()
+{
+    ready_ = false;
+    uint8_t id = 0;
+
+    // 加速度计上电处于I2C模式，CS的一次上升沿切换到SPI，复位后同样需要
+    read_reg(Device::ACCEL, ACC_CHIP_ID, id);
+    if (!write_reg(Device::ACCEL, ACC_SOFTRESET, SOFTRESET_CMD)) return false;
+    osDelay(2);
+    read_reg(Device::ACCEL, ACC_CHIP_ID, id);
+    if (!read_reg(Device::ACCEL, ACC_CHIP_ID, id) || id != ACC_CHIP_ID_VALUE) return false;
+
+    // 退出挂起模式并打开加速度计，之后至少等待450us
+    if (!write_reg(Device::ACCEL, ACC_PWR_CONF, 0x00)) return false;
+    osDelay(1);
+    if (!write_reg(Device::ACCEL, ACC_PWR_CTRL, 0x04)) return false;
+    osDelay(5);
+    if (!write_reg(Device::ACCEL, ACC_CONF, ACC_CONF_VALUE) ||
+        !write_reg(Device::ACCEL, ACC_RANGE, ACC_RANGE_VALUE) ||
+        !write_reg(Device::ACCEL, ACC_INT1_IO_CTRL, ACC_INT1_IO_VALUE) ||
+        !write_reg(Device::ACCEL, ACC_INT_MAP_DATA, ACC_INT1_DRDY)) {
+        return false;
+    }
+
+    if (!write_reg(Device::GYRO, GYRO_SOFTRESET, SOFTRESET_CMD)) return false;
+    osDelay(30);
+    if (!read_reg(Device::GYRO, GYRO_CHIP_ID, id) || id != GYRO_CHIP_ID_VALUE) return false;
+    if (!write_reg(Device::GYRO, GYRO_RANGE, GYRO_RANGE_VALUE) ||
+        !write_reg(Device::GYRO, GYRO_BANDWIDTH, GYRO_BANDWIDTH_VALUE) ||
+        !write_reg(Device::GYRO, GYRO_INT3_INT4_IO_CONF, GYRO_INT3_IO_VALUE) ||
+        !write_reg(Device::GYRO, GYRO_INT3_INT4_IO_MAP, GYRO_INT3_DRDY) ||
+        !write_reg(Device::GYRO, GYRO_INT_CTRL, GYRO_DRDY_ENABLE)) {
+        return false;
+    }
+
+    // 配置期间已就绪的数据不会再产生下降沿，主动读一次
+    taskENTER_CRITICAL();
+    busy_ = Device::NONE;
+    pending_ = PENDING_ACCEL | PENDING_GYRO;
+    ready_ = true;
+    start_pending();
+    taskEXIT_CRITICAL();
+    return true;
+}
+
+void Bmi088::start(Device device)
+{
+    uint8_t reg = (device == Device::ACCEL) ? ACC_X_LSB : GYRO_RATE_X_LSB;
+    uint16_t len = (device == Device::ACCEL) ? ACCEL_XFER_LEN : GYRO_XFER_LEN;
+    tx_[0] = static_cast<uint8_t>(reg | SPI_READ);
+
+    busy_ = device;
+    select(device, true);
+    if (HAL_SPI_TransmitReceive_DMA(hspi_, tx_, rx_, len) != HAL_OK) {
+        select(device, false);
+        busy_ = Device::NONE;
+        errors = errors + 1;
+    }
+}
+
+void Bmi088::start_pending()
+{
+    if (pending_ & PENDING_GYRO) {
+        pending_ &= ~PENDING_GYRO;
+        start(Device::GYRO);
+    }
+    else if (pending_ & PENDING_ACCEL) {
+        pending_ &= ~PENDING_ACCEL;
+        start(Device::ACCEL);
+    }
+}
+
+void Bmi088::on_data_ready(uint16_t pin)
+{
+    if (!ready_) return;
+
+    uint8_t bit = (pin == INT_ACC_Pin) ? PENDING_ACCEL : (pin == INT_GYRO_Pin) ? PENDING_GYRO : 0;
+    if (bit == 0) return;
+    if (pending_ & bit) overruns = overruns + 1;
+    pending_ |= bit;
+
+    if (busy_ == Device::NONE) start_pending();
+}
+
+void Bmi088::on_transfer_complete()
+{
+    SCOPE_TIMER(IMU_ISR);
+    Device device = busy_;
+    if (device == Device::NONE) return;
+    select(device, false);
+
+    if (device == Device::ACCEL) {
+        input_recorder.record(InputSource::IMU, INT_ACC_Pin, rx_, ACCEL_XFER_LEN);
+        for (int i = 0; i < 3; i++) {
+            accel_sum_[i] += to_int16(&rx_[2 + 2 * i]) * ACCEL_SCALE;
+        }
+        accel_count_++;
+    }
+    else {
+        input_recorder.record(InputSource::IMU, INT_GYRO_Pin, rx_, GYRO_XFER_LEN);
+        for (int i = 0; i < 3; i++) {
+            gyro_sum_[i] += to_int16(&rx_[1 + 2 * i]) * GYRO_SCALE;
+        }
+        gyro_count_++;
+    }
+
+    busy_ = Device::NONE;
+    start_pending();
+}
+
+void Bmi088::on_transfer_error()
+{
+    if (busy_ != Device::NONE) select(busy_, false);
+    busy_ = Device::NONE;
+    errors = errors + 1;
+    start_pending();
+}
+
+void Bmi088::take(ImuSample & sample)
+{
+    taskENTER_CRITICAL();
+    float gyro_sum[3] = {gyro_sum_[0], gyro_sum_[1], gyro_sum_[2]};
+    float accel_sum[3] = {accel_sum_[0], accel_sum_[1], accel_sum_[2]};
+    uint16_t gyro_count = gyro_count_;
+    uint16_t accel_count = accel_count_;
+    gyro_sum_[0] = gyro_sum_[1] = gyro_sum_[2] = 0.0f;
+    accel_sum_[0] = accel_sum_[1] = accel_sum_[2] = 0.0f;
+    gyro_count_ = 0;
+    accel_count_ = 0;
+    taskEXIT_CRITICAL();
+
+    float gyro_inv = (gyro_count != 0) ? 1.0f / gyro_count : 0.0f;
+    float accel_inv = (accel_count != 0) ? 1.0f / accel_count : 0.0f;
+    for (int i = 0; i < 3; i++) {
+        sample.gyro[i] = gyro_sum[i] * gyro_inv;
+        sample.accel[i] = accel_sum[i] * accel_inv;
+    }
+    sample.gyro_count = gyro_count;
+    sample.accel_count = accel_count;
+}
+
+// BMI088数据就绪中断
+extern "C" void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+{
+    if (GPIO_Pin == INT_ACC_Pin || GPIO_Pin == INT_GYRO_Pin) {
+        bmi088.on_data_ready(GPIO_Pin);
+    }
+}
+
+extern "C" void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef * hspi)
+{
+    if (hspi == bmi088.spi()) bmi088.on_transfer_complete();
+}
+
+extern "C" void HAL_SPI_ErrorCallback(SPI_HandleTypeDef * hspi)
+{
+    if (hspi == bmi088.spi()) bmi088.on_transfer_error();
+}
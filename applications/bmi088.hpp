@@ -0,0 +1,70 @@
+#ifndef BMI088_HPP
+#define BMI088_HPP
+
+#include <cstdint>
+
+#include "spi.h"
+
+// 两次take()之间IMU样本的平均值，机体坐标系与C板丝印坐标系一致
+struct ImuSample
+{
+    float gyro[3];          // rad/s
+    float accel[3];         // m/s^2
+    uint16_t gyro_count;    // 本次平均的陀螺仪样本数，0表示期间没有新数据
+    uint16_t accel_count;
+};
+
+// BMI088驱动：数据就绪中断触发SPI DMA读取
+// 加速度计和陀螺仪共用SPI1，中断中只发起传输，同时就绪时排队依次读取；
+// 中断、DMA回调均为同一优先级，互不抢占，take()在任务中加临界区读取累加值
+class Bmi088
+{
+public:
+    explicit Bmi088(SPI_HandleTypeDef * hspi);
+
+    // 阻塞配置 (复位、量程、输出频率、中断引脚)，在任务中调用，成功后开始响应数据就绪中断
+    bool init();
+
+    // HAL_GPIO_EXTI_Callback中调用 (回调在bmi088.cpp中定义)
+    void on_data_ready(uint16_t pin);
+
+    // HAL_SPI_TxRxCpltCallback / HAL_SPI_ErrorCallback中调用
+    void on_transfer_complete();
+    void on_transfer_error();
+
+    // 取出上次调用以来的样本平均值并清零累加器
+    void take(ImuSample & sample);
+
+    bool ready() const { return ready_; }
+    SPI_HandleTypeDef * spi() const { return hspi_; }
+
+    volatile uint32_t errors = 0;   // SPI传输错误次数
+    volatile uint32_t overruns = 0; // 上次数据未读完时又就绪的次数
+
+private:
+    enum class Device : uint8_t { NONE, ACCEL, GYRO };
+
+    SPI_HandleTypeDef * hspi_;
+    volatile bool ready_ = false;
+    volatile Device busy_ = Device::NONE;
+    volatile uint8_t pending_ = 0;  // 等待读取的设备位掩码
+
+    // DMA缓冲区，不能放在CCM
+    uint8_t tx_[8] = {};
+    uint8_t rx_[8] = {};
+
+    float gyro_sum_[3] = {};
+    float accel_sum_[3] = {};
+    uint16_t gyro_count_ = 0;
+    uint16_t accel_count_ = 0;
+
+    void start(Device device);
+    void start_pending();
+    void select(Device device, bool active);
+    bool write_reg(Device device, uint8_t reg, uint8_t value);
+    bool read_reg(Device device, uint8_t reg, uint8_t & value);
+};
+
+extern Bmi088 bmi088;  // chassis_control_task.cpp中实例化
+
+#endif // BMI088_HPP
@@ -5,19 +5,28 @@
 #include "motor/super_cap/super_cap.hpp"
 #include "referee/pm02/pm02.hpp"
 #include "chassis_control.hpp"
+#include "cpu_profiler.hpp"
+#include "input_recorder.hpp"
+#include "scope_timer.hpp"
 
 extern CAN_HandleTypeDef hcan2;
 
 sp::CAN can2(&hcan2);
 ChassisData chassis_data;
+volatile uint32_t wheel_feedback_cycles[4] = {};
+
+static DeadlineMonitor can_deadline("can", 1000, 500);
 
 // CAN通信任务
 extern "C" void can_task(void const * argument)
 {
     can2.config();
     can2.start();
+    cpu_profiler.add_deadline(&can_deadline);
     
     while (true) {
+        can_deadline.tick();
+        
         // 底盘电机控制
         chassis_lf.write(can2.tx_data);
         chassis_lr.write(can2.tx_data);
@@ -28,11 +37,11 @@ extern "C" void can_task(void const * argument)
         // 超级电容控制
         uint8_t super_cap_tx_data[8];
         super_cap.write(super_cap_tx_data, 
-                       chassis_data.chassis_power_limit, 
+                       chassis_data.cap_input_limit, 
                        pm02.power_heat.buffer_energy,
                        pm02.robot_status.power_management_chassis_output);
         
-        // 根据左拨杆状态覆盖电容模式
+        // 电容模式由能量管理选择
         super_cap_tx_data[0] = static_cast<uint8_t>(current_supercap_mode);
         
         for (int i = 0; i < 8; i++) {
@@ -47,17 +56,33 @@ extern "C" void can_task(void const * argument)
 // CAN接收中断处理
 extern "C" void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef * hcan)
 {
+    IsrProfile profile(IsrId::CAN_RX);
+    SCOPE_TIMER(CAN_RX_ISR);
     auto stamp_ms = osKernelSysTick();
+    uint32_t stamp_cycles = profiler_cycles();
 
     while (HAL_CAN_GetRxFifoFillLevel(hcan, CAN_RX_FIFO0) > 0) {
         if (hcan == &hcan2) {
             can2.recv();
+            input_recorder.record(InputSource::CAN2, static_cast<uint16_t>(can2.rx_id), can2.rx_data, sizeof(can2.rx_data));
 
             // 处理底盘电机反馈
-            if (can2.rx_id == chassis_lf.rx_id) chassis_lf.read(can2.rx_data, stamp_ms);
-            if (can2.rx_id == chassis_lr.rx_id) chassis_lr.read(can2.rx_data, stamp_ms);
-            if (can2.rx_id == chassis_rf.rx_id) chassis_rf.read(can2.rx_data, stamp_ms);
-            if (can2.rx_id == chassis_rr.rx_id) chassis_rr.read(can2.rx_data, stamp_ms);
+            if (can2.rx_id == chassis_lf.rx_id) {
+                chassis_lf.read(can2.rx_data, stamp_ms);
+                wheel_feedback_cycles[0] = stamp_cycles;
+            }
+            if (can2.rx_id == chassis_lr.rx_id) {
+                chassis_lr.read(can2.rx_data, stamp_ms);
+                wheel_feedback_cycles[1] = stamp_cycles;
+            }
+            if (can2.rx_id == chassis_rf.rx_id) {
+                chassis_rf.read(can2.rx_data, stamp_ms);
+                wheel_feedback_cycles[2] = stamp_cycles;
+            }
+            if (can2.rx_id == chassis_rr.rx_id) {
+                chassis_rr.read(can2.rx_data, stamp_ms);
+                wheel_feedback_cycles[3] = stamp_cycles;
+            }
             
             // 处理超级电容反馈
             if (can2.rx_id == super_cap.rx_id) super_cap.read(can2.rx_data, stamp_ms);
@@ -0,0 +1,69 @@
+#include "cap_manager.hpp"
+
+#include <algorithm>
+
+constexpr float CAP_EFFICIENCY = 0.9f;        // 电容板输入到电容的转换效率
+constexpr float CAP_READING_TAU = 2.0f;       // 电压读数校正时间常数 s
+constexpr float CAP_READING_MAX = 1.1f;       // 能量读数比例超过该值视为满量程设错，不采信
+constexpr float CAP_EMPTY_ENERGY = 20.0f;     // 电容板欠压保护前留出的能量 J
+constexpr float CAP_LAYER_HYSTERESIS = 30.0f; // 低于保留层后需充回该能量才重新允许放电 J
+constexpr float CAP_SPIN_HORIZON = 10.0f;     // 小陀螺可用能量在该时间内用完 s
+constexpr float CAP_SPIN_POWER_MAX = 60.0f;   // 小陀螺使用的电容功率上限 W
+constexpr float CAP_BUFFER_TARGET = 40.0f;    // 缓冲能量低于该值时降低输入上限 J
+constexpr float CAP_BUFFER_GAIN = 1.0f;       // 缓冲能量每低1J输入上限下调 W
+constexpr float CAP_INPUT_MIN_RATIO = 0.5f;   // 输入上限最低为功率上限的该比例
+
+CapManager::CapManager(float capacity, float boost_reserve, float spin_reserve, float dt)
+: capacity_(capacity), boost_reserve_(boost_reserve), spin_reserve_(spin_reserve), dt_(dt)
+{
+}
+
+void CapManager::update(const CapInputs & in)
+{
+    bool reading_ok = in.energy_reading >= 0.0f;
+    if (in.energy_reading > CAP_READING_MAX) {
+        reading_ok = false;
+        reading_rejects++;
+    }
+    float reading = std::min(in.energy_reading, 1.0f) * capacity_;
+
+    // 上电时没有读数则按空电容处理，宁可少放不可过放
+    if (!initialized_) {
+        energy = reading_ok ? reading : 0.0f;
+        initialized_ = true;
+    }
+    energy += (CAP_EFFICIENCY * in.power_in - in.power_out) * dt_;
+    if (reading_ok) energy += (reading - energy) * (dt_ / CAP_READING_TAU);
+    energy = std::max(0.0f, std::min(energy, capacity_));
+    soc = energy / capacity_;
+
+    // 放电下限按用途分层，回差避免在层边界上反复切换
+    float floor = boost_reserve_ + spin_reserve_;
+    if (in.boost) floor = CAP_EMPTY_ENERGY;
+    else if (in.spinning) floor = boost_reserve_;
+    if (discharge_enabled_) discharge_enabled_ = energy > floor;
+    else discharge_enabled_ = energy > floor + CAP_LAYER_HYSTERESIS;
+
+    float buffer_deficit = in.referee_valid ? std::max(CAP_BUFFER_TARGET - in.buffer_energy, 0.0f) : 0.0f;
+    input_limit = std::max(in.power_limit - CAP_BUFFER_GAIN * buffer_deficit, CAP_INPUT_MIN_RATIO * in.power_limit);
+
+    // 加速和小陀螺在需求超过输入上限时只放不充，需求回落时照常用余量充电
+    if (!discharge_enabled_) {
+        mode = sp::SuperCapMode::CHARGE;
+    }
+    else if ((in.boost || in.spinning) && in.demand >= input_limit) {
+        mode = sp::SuperCapMode::DISCHARGE;
+    }
+    else {
+        mode = sp::SuperCapMode::AUTOMODE;
+    }
+
+    bool full = energy >= capacity_;
+    charge_power = (mode == sp::SuperCapMode::DISCHARGE || full) ? 0.0f : std::max(input_limit - in.demand, 0.0f);
+
+    spin_power = 0.0f;
+    if (in.spinning && discharge_enabled_) {
+        spin_power = std::min((energy - boost_reserve_) * (1.0f / CAP_SPIN_HORIZON), CAP_SPIN_POWER_MAX);
+        spin_power = std::max(spin_power, 0.0f);
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef CAP_MANAGER_HPP
+#define CAP_MANAGER_HPP
+
+#include "motor/super_cap/super_cap.hpp"
+
+// 电容能量管理的输入，每个控制周期更新
+struct CapInputs
+{
+    float power_in;        // 电容板从裁判系统电源管理输入的功率 W
+    float power_out;       // 电容板输出给底盘的功率 W
+    float energy_reading;  // 电容板按电压换算的剩余能量比例 0-1，<0表示不可用，明显大于1说明满量程设错
+    float power_limit;     // 裁判系统底盘功率上限 W
+    float buffer_energy;   // 缓冲能量 J
+    bool referee_valid;    // 裁判系统数据在线，离线时buffer_energy是旧值
+    float demand;          // 底盘需求功率 W (功率模型预测值)
+    bool boost;            // 操作手请求放电加速
+    bool spinning;         // 小陀螺中
+};
+
+// 超级电容能量管理
+// 荷电状态：E += (η·P_in - P_out)·dt 积分，再以电压换算的能量读数做一阶互补校正，
+// 积分负责短时精度，电压读数消除效率误差和零点漂移的累积。
+// 能量分三层：加速保留 (只给操作手加速用)、小陀螺保留 (小陀螺和加速可用)、
+// 其余为日常自动充放电可用。低于保留层的能量只充不放，需求低于功率上限时的余量全部用于充电；
+// 缓冲能量偏低时下调电容板的输入功率上限，先把缓冲能量补回来 (裁判系统离线时不下调)
+class CapManager
+{
+public:
+    // capacity: 可用能量 J；boost_reserve/spin_reserve: 各层保留能量 J
+    CapManager(float capacity, float boost_reserve, float spin_reserve, float dt);
+
+    void update(const CapInputs & in);
+
+    float energy = 0.0f;        // 估计剩余可用能量 J
+    float soc = 0.0f;           // 荷电状态 0-1
+    sp::SuperCapMode mode = sp::SuperCapMode::CHARGE;
+    float input_limit = 0.0f;   // 下发给电容板的输入功率上限 W
+    float charge_power = 0.0f;  // 本周期规划的充电功率 W
+    float spin_power = 0.0f;    // 小陀螺可持续使用的电容功率 W
+    uint32_t reading_rejects = 0;  // 能量读数超出满量程被丢弃的周期数
+
+private:
+    const float capacity_;
+    const float boost_reserve_;
+    const float spin_reserve_;
+    const float dt_;
+    bool initialized_ = false;
+    bool discharge_enabled_ = false;
+};
+
+#endif // CAP_MANAGER_HPP
@@ -5,7 +5,7 @@
 #include "io/dbus/dbus.hpp"
 #include "io/can/can.hpp"
 #include "tools/mecanum/mecanum.hpp"
-#include "tools/pid/pid.hpp"
+#include "wheel_pid.hpp"
 #include "motor/rm_motor/rm_motor.hpp"
 #include "referee/pm02/pm02.hpp"
 #include "motor/super_cap/super_cap.hpp"
@@ -20,9 +20,20 @@ inline sp::RM_Motor chassis_lf(2, sp::RM_Motors::M3508, 14.9f);
 inline sp::RM_Motor chassis_lr(3, sp::RM_Motors::M3508, 14.9f);
 inline sp::RM_Motor chassis_rr(4, sp::RM_Motors::M3508, 14.9f);
 
+// 底盘几何参数：轮子半径77mm(直径154mm)，纵向间距330mm(半距165mm)，横向间距370mm(半距185mm)
+constexpr float WHEEL_RADIUS = 0.077f;
+constexpr float HALF_LENGTH = 0.165f;
+constexpr float HALF_WIDTH = 0.185f;
+
 // 定义一个麦轮底盘
-// 参数：轮子半径77mm(直径154mm)，纵向间距330mm(半距165mm)，横向间距370mm(半距185mm)
-inline sp::Mecanum mecanum_chassis(0.077f, 0.165f, 0.185f);
+inline sp::Mecanum mecanum_chassis(WHEEL_RADIUS, HALF_LENGTH, HALF_WIDTH);
+
+// C板x轴相对底盘前进方向绕z轴的安装角 rad
+constexpr float IMU_MOUNT_YAW = 0.0f;
+
+// 底盘速度上限
+constexpr float MAX_LINEAR_SPEED = 2.0f;   // 最大平移速度 m/s
+constexpr float ROTATION_SPEED = 10.0f;    // 最大旋转角速度 rad/s
 
 // 底盘控制结构体
 struct ChassisData
@@ -41,16 +52,56 @@ struct ChassisData
     float torque_rf;   // 右前轮输出力矩 N·m
     float torque_rr;   // 右后轮输出力矩 N·m
     
+    // 轮速跟踪器输出，对齐到控制周期
+    float speed_lf_est; // 左前轮速度 rad/s
+    float speed_lr_est;
+    float speed_rf_est;
+    float speed_rr_est;
+    float accel_lf;     // 左前轮角加速度 rad/s^2
+    float accel_lr;
+    float accel_rf;
+    float accel_rr;
+    
     // 功率控制相关数据
     uint16_t chassis_power_limit;  // 底盘功率限制 W
+    bool referee_online;           // 裁判系统数据在有效期内 (离线时功率上限和缓冲能量不可信)
     float power_scale_factor;      // 功率缩放因子 (0.0-1.0)
     bool power_limit_active;       // 功率限制是否激活
+    float accel_max;               // 功率允许的轮角加速度 rad/s^2
+    float accel_scale;             // 设定值变化缩放比例 (1.0为未限制)
+    
+    // 轮速里程计与IMU融合的底盘状态
+    float vx_est;                  // 车体速度估计 m/s
+    float vy_est;
+    float yaw_rate;                // 偏航角速度 rad/s (IMU不可用时为里程计值)
+    bool imu_valid;                // IMU已标定且数据正常
+    float yaw;                     // 积分航向 rad [-π, π)
+    bool field_oriented;           // 场定向驱动中，平移指令按场坐标系解释
+    bool spinning;                 // 小陀螺中
+    float spin_rate_max;           // 当前功率预算下可持续的自旋角速度 rad/s
+    
+    // 电机热模型
+    float temp_lf;                 // 左前电机绕组温度估计 °C
+    float temp_lr;
+    float temp_rf;
+    float temp_rr;
+    float thermal_derate;          // 四个电机中最低的力矩上限系数 (1.0为未降额)
+    uint8_t thermal_mismatch;      // 模型与温度反馈不一致的电机 (bit0-3: lf, lr, rf, rr)
+    
+    // 牵引力控制
+    uint8_t slip_mask;             // 判定打滑的轮子 (bit0-3: lf, lr, rf, rr)
+    float traction_gain;           // 四轮中最小的牵引系数 (1.0为未削减)
     
     // 超级电容功率数据
     float power_in;                // 电池输入功率 W (需要限制的)
     float power_out;               // 电容输出功率 W
     float chassis_actual_power;    // 底盘实际功率 W (power_out - power_in)
     float predicted_power;         // 预测输入功率 W (基于功率模型)
+    
+    // 超级电容能量管理
+    float cap_soc;                 // 电容荷电状态 0-1
+    float cap_charge_power;        // 规划的充电功率 W
+    uint16_t cap_input_limit;      // 下发给电容板的输入功率上限 W
 };
 
 // 外部声明，在对应任务中实例化
@@ -58,13 +109,27 @@ extern sp::DBus remote;     // uart_task.cpp中实例化
 extern sp::PM02 pm02;       // uart_task.cpp中实例化
 extern sp::CAN can2;        // can_task.cpp中实例化
 
+// 遥控器新帧计数与时间戳 (uart_task.cpp中实例化，串口中断中更新)
+extern volatile uint32_t remote_frame_count;
+extern volatile uint32_t remote_frame_stamp_ms;
+
+// 裁判系统新帧计数与时间戳 (uart_task.cpp中实例化，串口中断中更新)
+extern volatile uint32_t referee_frame_count;
+extern volatile uint32_t referee_frame_stamp_ms;
+
+// 底盘电机反馈帧到达时的周期计数 (lf, lr, rf, rr; can_task.cpp中实例化，CAN接收中断中更新)
+extern volatile uint32_t wheel_feedback_cycles[4];
+
 // 底盘数据实例
 extern ChassisData chassis_data;
 
+// 底盘处于释放状态 (电机无力矩输出)，此时才允许擦写flash等会暂停CPU取指的操作
+extern volatile bool chassis_released;
+
 // 超级电容实例化 (自动模式)
 inline sp::SuperCap super_cap(sp::SuperCapMode::AUTOMODE);
 
-// 当前电容工作模式 (由左拨杆控制)
+// 当前电容工作模式 (由电容能量管理按荷电状态和放电请求选择)
 extern sp::SuperCapMode current_supercap_mode;
 
 // PID参数定义 (简化版本，移除复杂滤波)
@@ -75,6 +140,7 @@ constexpr float PID_KD = 0.01f;      // 微分增益
 constexpr float PID_MO = 2.5f;     // 最大输出限制 (N·m) - 保护机械结构
 constexpr float PID_MIO = 1.0f;     // 积分输出限制 (N·m)
 constexpr float PID_ALPHA = 0.0f;   // D项滤波系数 (不使用滤波)
+constexpr float PID_KB = 20.0f;     // 反算抗饱和增益 1/s
 
 // 功率模型参数（需要根据实际测试调整）
 constexpr float K1_TORQUE_LOSS = 2.0f;        // 转矩损耗系数
@@ -83,12 +149,20 @@ constexpr float K3_STATIC_POWER = 6.2f;       // 静态待机功耗 W
 constexpr float K4_TORQUE_RATE = 0.007f;         // 转矩变化率系数
 constexpr float K5_SPEED_RATE = 0.0f;         // 速度变化率系数
 
+// 未辨识转动惯量 (ff_inertia为0) 时加速度限制使用的等效惯量 kg·m^2
+constexpr float ACCEL_LIMIT_INERTIA = 0.02f;
+
+// 轮速前馈模型参数 (折算到轮轴)，默认为0即不加前馈，辨识后经在线参数写入并保存
+constexpr float FF_INERTIA = 0.0f;            // 等效转动惯量 kg·m^2
+constexpr float FF_VISCOUS = 0.0f;            // 粘滞摩擦系数 N·m/(rad/s)
+constexpr float FF_COULOMB = 0.0f;            // 库仑摩擦力矩 N·m
+
 // PID控制器 - 每个轮子一个速度环PID
-//                                    dt     kp    ki    kd    mo   mio   alpha
-inline sp::PID chassis_lf_pid(PID_DT, PID_KP, PID_KI, PID_KD, PID_MO, PID_MIO, PID_ALPHA);
-inline sp::PID chassis_lr_pid(PID_DT, PID_KP, PID_KI, PID_KD, PID_MO, PID_MIO, PID_ALPHA);
-inline sp::PID chassis_rf_pid(PID_DT, PID_KP, PID_KI, PID_KD, PID_MO, PID_MIO, PID_ALPHA);
-inline sp::PID chassis_rr_pid(PID_DT, PID_KP, PID_KI, PID_KD, PID_MO, PID_MIO, PID_ALPHA);
+//                                    dt     kp    ki    kd    mo   mio   alpha   kb
+inline WheelPid chassis_lf_pid(PID_DT, PID_KP, PID_KI, PID_KD, PID_MO, PID_MIO, PID_ALPHA, PID_KB);
+inline WheelPid chassis_lr_pid(PID_DT, PID_KP, PID_KI, PID_KD, PID_MO, PID_MIO, PID_ALPHA, PID_KB);
+inline WheelPid chassis_rf_pid(PID_DT, PID_KP, PID_KI, PID_KD, PID_MO, PID_MIO, PID_ALPHA, PID_KB);
+inline WheelPid chassis_rr_pid(PID_DT, PID_KP, PID_KI, PID_KD, PID_MO, PID_MIO, PID_ALPHA, PID_KB);
 
 // 功率控制函数声明
 void update_power_data();
@@ -1,6 +1,27 @@
 #include "cmsis_os.h"
 #include "chassis_control.hpp"
+#include "accel_limiter.hpp"
+#include "bmi088.hpp"
+#include "cap_manager.hpp"
+#include "chassis_estimator.hpp"
 #include "buzzer_control.hpp"
+#include "input_shaping.hpp"
+#include "keyboard_control.hpp"
+#include "motor_thermal.hpp"
+#include "failsafe.hpp"
+#include "data_logger.hpp"
+#include "feedforward.hpp"
+#include "gain_schedule.hpp"
+#include "heading_control.hpp"
+#include "param_server.hpp"
+#include "param_store.hpp"
+#include "traction_control.hpp"
+#include "wheel_tracker.hpp"
+#include "cpu_profiler.hpp"
+#include "scope_timer.hpp"
+#include "spin_control.hpp"
+#include "nav_command.hpp"
+#include "spi.h"
 #include <cmath>
 #include <cstdlib>
 #include <algorithm>  
@@ -8,18 +29,212 @@
 // 参数常量
 constexpr uint16_t DEFAULT_POWER_LIMIT = 80;
 constexpr float POWER_SCALE_MIN = 0.1f;
-constexpr float MAX_LINEAR_SPEED = 2.0f;
-constexpr float ROTATION_SPEED = 10.0f;
 constexpr float MAX_SAFE_TORQUE = 8.0f;
 constexpr uint32_t CONTROL_PERIOD_MS = 1;
-constexpr uint32_t OFFLINE_DELAY_MS = 10;
+
+// 失控保护参数
+constexpr uint32_t BRAKE_TIMEOUT_MS = 1500;     // 最长制动时间，超时后直接释放力矩
+constexpr float BRAKE_STOP_SPEED = 2.0f;        // 判定停稳的轮速阈值 rad/s
+constexpr uint32_t RECOVER_HOLD_MS = 100;       // 指令恢复后需持续有效的时间
+
+// 遥控输入整形参数
+constexpr float STICK_DEADBAND = 0.05f;         // 摇杆死区
+constexpr float STICK_EXPO = 0.3f;              // expo曲线系数，越大中位附近越细腻
+constexpr float LINEAR_ACC_MAX = 4.0f;          // 平移速度设定值最大加速度 m/s^2
+constexpr float LINEAR_JERK_MAX = 40.0f;        // 平移速度设定值最大加加速度 m/s^3
+constexpr float ROTATION_ACC_MAX = 30.0f;       // 旋转速度设定值最大角加速度 rad/s^2
+constexpr float ROTATION_JERK_MAX = 300.0f;     // 旋转速度设定值最大角加加速度 rad/s^3
+constexpr uint32_t DBUS_FRAME_INTERVAL_MS = 14; // DBus标称帧间隔
+constexpr uint32_t DBUS_FRAME_INTERVAL_MIN_MS = 7;
+constexpr uint32_t DBUS_FRAME_INTERVAL_MAX_MS = 30;
+constexpr uint32_t REFEREE_TIMEOUT_MS = 200;    // 超过该时间没有裁判系统数据视为离线
+
+// 键鼠控制参数 (速度相对max_linear_speed的倍率, 加速度 m/s^2, 减速度 m/s^2)
+constexpr KeyMotionProfile KEY_PROFILE_NORMAL = {0.75f, 3.0f, 6.0f};
+constexpr KeyMotionProfile KEY_PROFILE_BOOST = {1.25f, 5.0f, 8.0f};  // Shift：超级电容放电
+constexpr KeyMotionProfile KEY_PROFILE_SLOW = {0.25f, 2.0f, 6.0f};   // Ctrl：精细对位
+constexpr float MOUSE_YAW_GAIN = 0.02f;   // 鼠标X速度到旋转角速度的增益 (rad/s)/count
+
+// 航向保持参数
+constexpr float HEADING_KP = 5.0f;              // 航向误差到角速度的增益 1/s
+constexpr float HEADING_KI = 2.0f;              // 积分增益 1/s^2
+constexpr float HEADING_MAX_CORRECTION = 2.0f;  // 修正角速度上限 rad/s
+constexpr float HEADING_CAPTURE_RATE = 0.3f;    // 车体角速度低于该值时锁定航向 rad/s
+
+// 小陀螺参数
+constexpr float SPIN_RATE_MAX = 15.0f;          // 小陀螺角速度上限 rad/s
+constexpr float SPIN_DIAL_THRESHOLD = 0.5f;     // 遥控器拨轮拨过该位置切换小陀螺
+// 场定向的执行延迟补偿 s，是在线参数field_phase_lead的默认值。延迟主要是轮速环的跟踪滞后，
+// 前馈辨识后明显变短 (主机仿真tools/sim/spin_sim中最优值从30ms以上降到10ms以内)，
+// 辨识前馈后应在小陀螺平移时重新调整，使平移方向不随自旋偏转
+constexpr float FIELD_PHASE_LEAD = 0.03f;
+
+// 超级电容能量管理参数
+constexpr float CAP_CAPACITY = 2000.0f;           // 电容可用能量 J
+constexpr float CAP_BOOST_RESERVE = 400.0f;       // 只留给操作手加速的能量 J
+constexpr float CAP_SPIN_RESERVE = 300.0f;        // 小陀螺和加速可用、日常驾驶不动用的能量 J
+// 电容板剩余能量读数 (super_cap.cap_energy) 的满量程，是在线参数cap_energy_scale的默认值。
+// 该值取决于电容板固件，无法从协议本身确认：上车后把电容充满 (电容板停止充电)，
+// 读CHASSIS_STATE中的cap_energy_raw，把cap_energy_scale设为该读数并保存。
+// 读数超过满量程10%时电容管理不再采信读数 (cap_manager.reading_rejects计数)，只按功率积分
+constexpr float CAP_ENERGY_FULL_SCALE = 255.0f;
+
+// 轮速跟踪器参数 (临界阻尼 β = α²/(2-α)；5rpm反馈噪声下加速度噪声约2.6rad/s^2，加速度阶跃63%上升约7ms)
+constexpr float TRACKER_ALPHA = 0.3f;
+constexpr float TRACKER_BETA = 0.0529f;
+constexpr float TRACKER_FRAME_DT = 0.001f;        // 电调标称反馈周期 s
+constexpr float TRACKER_MAX_EXTRAPOLATE = 0.005f; // 超过该时间未收到反馈停止外推 s
+
+// 数据记录仪默认配置
+constexpr uint16_t LOG_PRE_RECORDS = 300;        // 触发前记录条数
+constexpr uint16_t LOG_POST_RECORDS = 100;       // 触发后记录条数
+constexpr uint16_t LOG_BUFFER_ENERGY_MIN = 20;   // 缓冲能量低于20J触发
+constexpr float LOG_SCALE_MIN = POWER_SCALE_MIN; // 缩放因子触底触发
 
 // 当前电容工作模式实例化
 sp::SuperCapMode current_supercap_mode = sp::SuperCapMode::AUTOMODE;
 
+// 超级电容能量管理
+static CapManager cap_manager(CAP_CAPACITY, CAP_BOOST_RESERVE, CAP_SPIN_RESERVE, PID_DT);
+static bool cap_boost_requested = false;  // 遥控模式左拨杆拨中、键鼠模式按住Shift
+
 static sp::DBusSwitchMode last_sw_r = sp::DBusSwitchMode::MID;
 static sp::DBusSwitchMode last_sw_l = sp::DBusSwitchMode::MID;
 
+// 设定值整形器
+static SetpointShaper vx_shaper(LINEAR_ACC_MAX, LINEAR_JERK_MAX, PID_DT);
+static SetpointShaper vy_shaper(LINEAR_ACC_MAX, LINEAR_JERK_MAX, PID_DT);
+static SetpointShaper wz_shaper(ROTATION_ACC_MAX, ROTATION_JERK_MAX, PID_DT);
+
+// 键鼠运动层
+static KeyboardControl keyboard_control(
+    KEY_PROFILE_NORMAL, KEY_PROFILE_BOOST, KEY_PROFILE_SLOW, MOUSE_YAW_GAIN, PID_DT);
+
+// 失控保护状态机
+static Failsafe failsafe(BRAKE_TIMEOUT_MS, BRAKE_STOP_SPEED, RECOVER_HOLD_MS);
+
+// 航向保持与场定向驱动
+static HeadingControl heading_control(
+    HEADING_KP, HEADING_KI, HEADING_MAX_CORRECTION, HEADING_CAPTURE_RATE, PID_DT);
+static bool keyboard_field_oriented = false;  // 键鼠模式下由F键切换
+static bool last_key_f = false;
+
+// 小陀螺
+static SpinControl spin_control(WHEEL_RADIUS, HALF_LENGTH, HALF_WIDTH, SPIN_RATE_MAX);
+static bool spin_requested = false;  // 遥控模式拨轮、键鼠模式R键切换
+static bool last_key_r = false;
+static bool last_dial_high = false;
+
+static uint32_t last_frame_count = 0;
+static uint32_t last_frame_stamp_ms = 0;
+static uint32_t frame_interval_ms = DBUS_FRAME_INTERVAL_MS;
+static bool remote_override = true;  // 摇杆有输入时覆盖上位机指令
+
+// 在线参数，默认值取编译期常量
+ParamServer param_server({
+    PID_KP, PID_KI, PID_KD, PID_MO, PID_MIO,
+    K1_TORQUE_LOSS, K2_SPEED_LOSS, K3_STATIC_POWER, K4_TORQUE_RATE, K5_SPEED_RATE,
+    MAX_LINEAR_SPEED, ROTATION_SPEED,
+    FF_INERTIA, FF_VISCOUS, FF_COULOMB,
+    CAP_ENERGY_FULL_SCALE,
+    FIELD_PHASE_LEAD,
+});
+ParamStore param_store;
+
+volatile bool chassis_released = false;
+
+// 功率感知的设定值加速度限制
+static AccelLimiter accel_limiter(WHEEL_RADIUS, HALF_LENGTH, HALF_WIDTH, PID_DT);
+
+// 逐轮打滑检测与力矩再分配
+static TractionControl traction_control(WHEEL_RADIUS, HALF_LENGTH, HALF_WIDTH, MAX_SAFE_TORQUE, PID_DT);
+
+// 轮速前馈与参数辨识
+static WheelFeedforward lf_feedforward(PID_DT);
+static WheelFeedforward lr_feedforward(PID_DT);
+static WheelFeedforward rf_feedforward(PID_DT);
+static WheelFeedforward rr_feedforward(PID_DT);
+FeedforwardIdentifier ff_identifier(PID_DT);
+
+// 轮速跟踪器，为功率模型提供平滑的轮速和角加速度
+static WheelTracker lf_tracker(TRACKER_ALPHA, TRACKER_BETA, TRACKER_FRAME_DT, TRACKER_MAX_EXTRAPOLATE);
+static WheelTracker lr_tracker(TRACKER_ALPHA, TRACKER_BETA, TRACKER_FRAME_DT, TRACKER_MAX_EXTRAPOLATE);
+static WheelTracker rf_tracker(TRACKER_ALPHA, TRACKER_BETA, TRACKER_FRAME_DT, TRACKER_MAX_EXTRAPOLATE);
+static WheelTracker rr_tracker(TRACKER_ALPHA, TRACKER_BETA, TRACKER_FRAME_DT, TRACKER_MAX_EXTRAPOLATE);
+
+// 电机热模型与力矩降额
+static MotorThermal lf_thermal(PID_DT);
+static MotorThermal lr_thermal(PID_DT);
+static MotorThermal rf_thermal(PID_DT);
+static MotorThermal rr_thermal(PID_DT);
+
+// 板载IMU与底盘速度估计
+Bmi088 bmi088(&hspi1);
+static ChassisEstimator chassis_estimator(WHEEL_RADIUS, HALF_LENGTH, HALF_WIDTH, IMU_MOUNT_YAW, PID_DT);
+
+static DeadlineMonitor control_deadline("chassis", CONTROL_PERIOD_MS * 1000, 500);
+
+// 记录仪缓冲区放在CCM RAM，不占用主SRAM (CCM不能被DMA访问，只由CPU读写)
+static LogRecord log_buffer[LOG_DEPTH] __attribute__((section(".ccmbss")));
+DataLogger data_logger(log_buffer, LOG_DEPTH);
+
+// 复位整形器和键鼠输出，下次进入控制时从0开始
+static void reset_setpoint_shapers()
+{
+    vx_shaper.reset();
+    vy_shaper.reset();
+    wz_shaper.reset();
+    keyboard_control.reset();
+}
+
+// 整形器从当前设定值继续，切换输入源时避免设定值阶跃
+static void sync_setpoint_shapers()
+{
+    vx_shaper.reset(chassis_data.vx_set);
+    vy_shaper.reset(chassis_data.vy_set);
+    wz_shaper.reset(chassis_data.wz_set);
+    keyboard_control.reset(chassis_data.vx_set, chassis_data.vy_set, chassis_data.wz_set);
+}
+
+// 有新的遥控帧时更新整形器目标，并估计帧间隔
+static void update_setpoint_targets(bool nav_active)
+{
+    uint32_t frame_count = remote_frame_count;
+    if (frame_count == last_frame_count) return;
+
+    uint32_t stamp_ms = remote_frame_stamp_ms;
+    uint32_t interval = stamp_ms - last_frame_stamp_ms;
+    if (frame_count == last_frame_count + 1 &&
+        interval >= DBUS_FRAME_INTERVAL_MIN_MS && interval <= DBUS_FRAME_INTERVAL_MAX_MS) {
+        // 一阶低通平滑帧间隔估计
+        frame_interval_ms = (frame_interval_ms * 7 + interval + 4) / 8;
+    }
+    last_frame_count = frame_count;
+    last_frame_stamp_ms = stamp_ms;
+
+    float stick_lv = shape_stick(remote.ch_lv, STICK_DEADBAND, STICK_EXPO);
+    float stick_lh = shape_stick(remote.ch_lh, STICK_DEADBAND, STICK_EXPO);
+    float stick_rv = shape_stick(remote.ch_rv, STICK_DEADBAND, STICK_EXPO);
+    float stick_rh = shape_stick(remote.ch_rh, STICK_DEADBAND, STICK_EXPO);
+
+    const ChassisParams & params = param_server.active();
+    float wz = 0.0f;
+    if (stick_rv != 0.0f) {
+        wz = stick_rv * params.rotation_speed;
+    }
+    else if (stick_rh != 0.0f) {
+        wz = -stick_rh * params.rotation_speed;
+    }
+
+    // 摇杆回中且上位机指令有效时由上位机控制
+    remote_override = (stick_lv != 0.0f || stick_lh != 0.0f || wz != 0.0f);
+    if (!remote_override && nav_active) return;
+
+    vx_shaper.set_target(stick_lv * params.max_linear_speed, frame_interval_ms);
+    vy_shaper.set_target(-stick_lh * params.max_linear_speed, frame_interval_ms);
+    wz_shaper.set_target(wz, frame_interval_ms);
+}
+
 // 更新功率数据，从裁判系统和超级电容获取最新数据
 void update_power_data()
 {
@@ -45,47 +260,48 @@ float predict_power_consumption()
     // 历史数据用于计算变化率
     static float last_torque_lf = 0.0f, last_torque_lr = 0.0f;
     static float last_torque_rf = 0.0f, last_torque_rr = 0.0f;
-    static float last_speed_lf = 0.0f, last_speed_lr = 0.0f;
-    static float last_speed_rf = 0.0f, last_speed_rr = 0.0f;
     
     float torque_lf = chassis_data.torque_lf;
     float torque_lr = chassis_data.torque_lr; 
     float torque_rf = chassis_data.torque_rf;
     float torque_rr = chassis_data.torque_rr;
     
-    float speed_lf = chassis_lf.speed;
-    float speed_lr = chassis_lr.speed;
-    float speed_rf = chassis_rf.speed;
-    float speed_rr = chassis_rr.speed;
+    // 轮速和角加速度取跟踪器输出，反馈帧的量化和不同步使直接差分基本是噪声
+    float speed_lf = chassis_data.speed_lf_est;
+    float speed_lr = chassis_data.speed_lr_est;
+    float speed_rf = chassis_data.speed_rf_est;
+    float speed_rr = chassis_data.speed_rr_est;
     
-    // 计算转矩和速度变化率
+    // 计算转矩变化率
     constexpr float CONTROL_FREQ = 1000.0f;
     float torque_rate_lf = std::abs(torque_lf - last_torque_lf) * CONTROL_FREQ;
     float torque_rate_lr = std::abs(torque_lr - last_torque_lr) * CONTROL_FREQ;
     float torque_rate_rf = std::abs(torque_rf - last_torque_rf) * CONTROL_FREQ;
     float torque_rate_rr = std::abs(torque_rr - last_torque_rr) * CONTROL_FREQ;
     
-    float speed_rate_lf = std::abs(speed_lf - last_speed_lf) * CONTROL_FREQ;
-    float speed_rate_lr = std::abs(speed_lr - last_speed_lr) * CONTROL_FREQ;
-    float speed_rate_rf = std::abs(speed_rf - last_speed_rf) * CONTROL_FREQ;
-    float speed_rate_rr = std::abs(speed_rr - last_speed_rr) * CONTROL_FREQ;
+    float speed_rate_lf = std::abs(chassis_data.accel_lf);
+    float speed_rate_lr = std::abs(chassis_data.accel_lr);
+    float speed_rate_rf = std::abs(chassis_data.accel_rf);
+    float speed_rate_rr = std::abs(chassis_data.accel_rr);
+    
+    const ChassisParams & params = param_server.active();
     
     // 静态功率项计算
     float shaft_power = torque_lf * speed_lf + torque_lr * speed_lr + 
                        torque_rf * speed_rf + torque_rr * speed_rr;
     
-    float torque_loss = K1_TORQUE_LOSS * (torque_lf * torque_lf + torque_lr * torque_lr +
+    float torque_loss = params.k1_torque_loss * (torque_lf * torque_lf + torque_lr * torque_lr +
                                          torque_rf * torque_rf + torque_rr * torque_rr);
     
-    float speed_loss = K2_SPEED_LOSS * (speed_lf * speed_lf + speed_lr * speed_lr +
+    float speed_loss = params.k2_speed_loss * (speed_lf * speed_lf + speed_lr * speed_lr +
                                        speed_rf * speed_rf + speed_rr * speed_rr);
     
-    float static_power = K3_STATIC_POWER;
+    float static_power = params.k3_static_power;
     
     // 动态功率项
-    float dynamic_torque_power = K4_TORQUE_RATE * (torque_rate_lf + torque_rate_lr + 
+    float dynamic_torque_power = params.k4_torque_rate * (torque_rate_lf + torque_rate_lr + 
                                                   torque_rate_rf + torque_rate_rr);
-    float dynamic_speed_power = K5_SPEED_RATE * (speed_rate_lf + speed_rate_lr + 
+    float dynamic_speed_power = params.k5_speed_rate * (speed_rate_lf + speed_rate_lr + 
                                                 speed_rate_rf + speed_rate_rr);
     
     // 总功率预测
@@ -100,10 +316,6 @@ float predict_power_consumption()
     last_torque_lr = torque_lr;
     last_torque_rf = torque_rf;
     last_torque_rr = torque_rr;
-    last_speed_lf = speed_lf;
-    last_speed_lr = speed_lr;
-    last_speed_rf = speed_rf;
-    last_speed_rr = speed_rr;
     
     return filtered_power;
 }
@@ -123,10 +335,10 @@ float calculate_torque_scale_factor()
     float torque_rf = chassis_data.torque_rf;
     float torque_rr = chassis_data.torque_rr;
     
-    float speed_lf = chassis_lf.speed;
-    float speed_lr = chassis_lr.speed;
-    float speed_rf = chassis_rf.speed;
-    float speed_rr = chassis_rr.speed;
+    float speed_lf = chassis_data.speed_lf_est;
+    float speed_lr = chassis_data.speed_lr_est;
+    float speed_rf = chassis_data.speed_rf_est;
+    float speed_rr = chassis_data.speed_rr_est;
     
     float sum_tau_omega = torque_lf * speed_lf + torque_lr * speed_lr + 
                          torque_rf * speed_rf + torque_rr * speed_rr;
@@ -137,9 +349,10 @@ float calculate_torque_scale_factor()
     float sum_omega_squared = speed_lf * speed_lf + speed_lr * speed_lr +
                              speed_rf * speed_rf + speed_rr * speed_rr;
     
-    float a = K1_TORQUE_LOSS * sum_tau_squared;
+    const ChassisParams & params = param_server.active();
+    float a = params.k1_torque_loss * sum_tau_squared;
     float b = sum_tau_omega;
-    float c = K2_SPEED_LOSS * sum_omega_squared + K3_STATIC_POWER - power_limit;
+    float c = params.k2_speed_loss * sum_omega_squared + params.k3_static_power - power_limit;
     
     float discriminant = b * b - 4 * a * c;
     
@@ -157,6 +370,13 @@ float calculate_torque_scale_factor()
     return k;
 }
 
+// 实际输出力矩上限：轮速环限幅 (不超过安全力矩) 按电机温度降额，PID与前馈之和在此限幅。
+// 降额必须作用在实际起作用的限幅上，乘在更大的MAX_SAFE_TORQUE上时降到PID限幅以下才生效，平滑降额变成过温前的突降
+static float output_torque_limit(float derate)
+{
+    return std::min(param_server.active().pid_mo, MAX_SAFE_TORQUE) * derate;
+}
+
 // 应用功率限制和安全转矩限制
 void apply_power_limit()
 {
@@ -169,11 +389,15 @@ void apply_power_limit()
     chassis_data.torque_rf *= chassis_data.power_scale_factor;
     chassis_data.torque_rr *= chassis_data.power_scale_factor;
     
-    // 安全转矩限幅
-    chassis_data.torque_lf = std::max(std::min(chassis_data.torque_lf, MAX_SAFE_TORQUE), -MAX_SAFE_TORQUE);
-    chassis_data.torque_lr = std::max(std::min(chassis_data.torque_lr, MAX_SAFE_TORQUE), -MAX_SAFE_TORQUE);
-    chassis_data.torque_rf = std::max(std::min(chassis_data.torque_rf, MAX_SAFE_TORQUE), -MAX_SAFE_TORQUE);
-    chassis_data.torque_rr = std::max(std::min(chassis_data.torque_rr, MAX_SAFE_TORQUE), -MAX_SAFE_TORQUE);
+    // 输出力矩限幅，按各电机温度降额
+    const float limit_lf = output_torque_limit(lf_thermal.derate);
+    const float limit_lr = output_torque_limit(lr_thermal.derate);
+    const float limit_rf = output_torque_limit(rf_thermal.derate);
+    const float limit_rr = output_torque_limit(rr_thermal.derate);
+    chassis_data.torque_lf = std::max(std::min(chassis_data.torque_lf, limit_lf), -limit_lf);
+    chassis_data.torque_lr = std::max(std::min(chassis_data.torque_lr, limit_lr), -limit_lr);
+    chassis_data.torque_rf = std::max(std::min(chassis_data.torque_rf, limit_rf), -limit_rf);
+    chassis_data.torque_rr = std::max(std::min(chassis_data.torque_rr, limit_rr), -limit_rr);
 }
 
 // 停止所有电机
@@ -190,110 +414,482 @@ void disable_all_motors()
     chassis_rr.cmd(0.0f);
 }
 
+// 更新轮速跟踪器，每个周期调用
+static void update_wheel_trackers()
+{
+    // 轮速与帧时刻在CAN中断中成对更新，一起取快照
+    taskENTER_CRITICAL();
+    const float speeds[4] = {chassis_lf.speed, chassis_lr.speed, chassis_rf.speed, chassis_rr.speed};
+    const uint32_t stamps[4] = {wheel_feedback_cycles[0], wheel_feedback_cycles[1],
+                                wheel_feedback_cycles[2], wheel_feedback_cycles[3]};
+    uint32_t now_cycles = profiler_cycles();
+    taskEXIT_CRITICAL();
+
+    lf_tracker.update(speeds[0], stamps[0], now_cycles);
+    lr_tracker.update(speeds[1], stamps[1], now_cycles);
+    rf_tracker.update(speeds[2], stamps[2], now_cycles);
+    rr_tracker.update(speeds[3], stamps[3], now_cycles);
+
+    chassis_data.speed_lf_est = lf_tracker.speed;
+    chassis_data.speed_lr_est = lr_tracker.speed;
+    chassis_data.speed_rf_est = rf_tracker.speed;
+    chassis_data.speed_rr_est = rr_tracker.speed;
+    chassis_data.accel_lf = lf_tracker.accel;
+    chassis_data.accel_lr = lr_tracker.accel;
+    chassis_data.accel_rf = rf_tracker.accel;
+    chassis_data.accel_rr = rr_tracker.accel;
+}
+
+// 更新电机热模型，每个周期调用 (释放状态下继续计算散热)
+static void update_motor_thermal()
+{
+    lf_thermal.update(chassis_lf.torque, chassis_lf.temperature);
+    lr_thermal.update(chassis_lr.torque, chassis_lr.temperature);
+    rf_thermal.update(chassis_rf.torque, chassis_rf.temperature);
+    rr_thermal.update(chassis_rr.torque, chassis_rr.temperature);
+
+    chassis_data.temp_lf = lf_thermal.estimate;
+    chassis_data.temp_lr = lr_thermal.estimate;
+    chassis_data.temp_rf = rf_thermal.estimate;
+    chassis_data.temp_rr = rr_thermal.estimate;
+    chassis_data.thermal_derate = std::min(std::min(lf_thermal.derate, lr_thermal.derate),
+                                           std::min(rf_thermal.derate, rr_thermal.derate));
+    chassis_data.thermal_mismatch = (lf_thermal.mismatch ? 0x01 : 0) | (lr_thermal.mismatch ? 0x02 : 0) |
+                                    (rf_thermal.mismatch ? 0x04 : 0) | (rr_thermal.mismatch ? 0x08 : 0);
+}
+
+// 电容能量管理，每个周期调用 (释放状态下照常充电)
+static void update_cap_manager(FailsafeState state)
+{
+    CapInputs in;
+    in.power_in = super_cap.power_in;
+    in.power_out = super_cap.power_out;
+    in.energy_reading = static_cast<float>(super_cap.cap_energy) / param_server.active().cap_energy_scale;
+    in.power_limit = static_cast<float>(chassis_data.chassis_power_limit);
+    in.buffer_energy = static_cast<float>(pm02.power_heat.buffer_energy);
+    in.referee_valid = chassis_data.referee_online;
+    in.demand = chassis_data.predicted_power;
+    in.boost = cap_boost_requested && state == FailsafeState::ACTIVE;
+    in.spinning = chassis_data.spinning;
+    cap_manager.update(in);
+
+    current_supercap_mode = cap_manager.mode;
+    chassis_data.cap_input_limit = static_cast<uint16_t>(std::max(cap_manager.input_limit, 0.0f));
+    chassis_data.cap_soc = cap_manager.soc;
+    chassis_data.cap_charge_power = cap_manager.charge_power;
+}
+
+// 融合轮速和IMU更新底盘速度估计，每个周期调用 (释放状态下用于静止标定零偏)
+static void update_chassis_estimate()
+{
+    ImuSample imu = {};
+    if (bmi088.ready()) bmi088.take(imu);
+
+    SCOPE_TIMER(IMU_FILTER);
+    const float speeds[4] = {chassis_lf.speed, chassis_lr.speed, chassis_rf.speed, chassis_rr.speed};
+    chassis_estimator.update(speeds, imu);
+    chassis_data.vx_est = chassis_estimator.vx;
+    chassis_data.vy_est = chassis_estimator.vy;
+    chassis_data.yaw_rate = chassis_estimator.wz;
+    chassis_data.imu_valid = chassis_estimator.imu_valid;
+    chassis_data.yaw = chassis_estimator.yaw;
+}
+
 // 底盘运动控制主函数
 void chassis_move_control(float vx, float vy, float wz)
 {
+    const ChassisParams & params = param_server.active();
+    float inertia = (params.ff_inertia > 0.0f) ? params.ff_inertia : ACCEL_LIMIT_INERTIA;
+    const PowerModel power_model = {
+        params.k1_torque_loss, params.k2_speed_loss, params.k3_static_power,
+        inertia, params.ff_viscous, params.ff_coulomb,
+    };
+    float power_limit = static_cast<float>(chassis_data.chassis_power_limit) - 5.0f;
+
+    // 小陀螺：按功率预算给出可持续的自旋角速度，平移越快自旋越慢
+    if (chassis_data.spinning) {
+        const SpinBudget budget = {power_limit, static_cast<float>(pm02.power_heat.buffer_energy), cap_manager.spin_power};
+        wz = spin_control.update(power_model, budget, vx, vy);
+        chassis_data.spin_rate_max = spin_control.rate_max;
+    }
+
+    // 旋转指令为零时闭环保持航向；场定向时把平移指令转到车体坐标系，
+    // 按实测角速度超前一个执行延迟的角度，补偿旋转时平移方向的滞后
+    wz = heading_control.hold(wz, chassis_data.yaw, chassis_data.yaw_rate, chassis_data.imu_valid);
+    if (chassis_data.field_oriented) {
+        heading_control.field_to_body(vx, vy, chassis_data.yaw + chassis_data.yaw_rate * params.field_phase_lead);
+    }
+
+    // 功率上限折算为可达加速度，在运动学解算前限制设定值变化
+    {
+        const float speeds[4] = {chassis_lf.speed, chassis_lr.speed, chassis_rf.speed, chassis_rr.speed};
+        const float max_torque = output_torque_limit(chassis_data.thermal_derate);
+        chassis_data.accel_max = achievable_wheel_accel(power_model, power_limit, speeds, max_torque);
+        accel_limiter.limit(vx, vy, wz, chassis_data.accel_max, max_torque / inertia);
+        chassis_data.accel_scale = accel_limiter.scale;
+    }
+
     chassis_data.vx_set = vx;
     chassis_data.vy_set = vy;
     chassis_data.wz_set = wz;
     
     // 麦轮运动学解算
-    mecanum_chassis.calc(vx, vy, wz);
+    {
+        SCOPE_TIMER(KINEMATICS);
+        mecanum_chassis.calc(vx, vy, wz);
+    }
     chassis_data.speed_lf_set = mecanum_chassis.speed_lf;
     chassis_data.speed_lr_set = mecanum_chassis.speed_lr;
     chassis_data.speed_rf_set = mecanum_chassis.speed_rf;
     chassis_data.speed_rr_set = mecanum_chassis.speed_rr;
     
     // PID速度闭环控制
-    chassis_lf_pid.calc(chassis_data.speed_lf_set, chassis_lf.speed);
-    chassis_lr_pid.calc(chassis_data.speed_lr_set, chassis_lr.speed);
-    chassis_rf_pid.calc(chassis_data.speed_rf_set, chassis_rf.speed);
-    chassis_rr_pid.calc(chassis_data.speed_rr_set, chassis_rr.speed);
+    {
+        SCOPE_TIMER(WHEEL_PID);
+        // 按平均轮速和上一周期的功率限制状态调度增益，四轮共用
+        float mean_speed = 0.25f * (std::abs(chassis_lf.speed) + std::abs(chassis_lr.speed) +
+                                    std::abs(chassis_rf.speed) + std::abs(chassis_rr.speed));
+        const GainScale scale = gain_schedule(mean_speed, chassis_data.power_limit_active);
+        float kp = params.pid_kp * scale.kp;
+        float ki = params.pid_ki * scale.ki;
+        float kd = params.pid_kd * scale.kd;
+        chassis_lf_pid.set_gains(kp, ki, kd);
+        chassis_lr_pid.set_gains(kp, ki, kd);
+        chassis_rf_pid.set_gains(kp, ki, kd);
+        chassis_rr_pid.set_gains(kp, ki, kd);
+
+        chassis_lf_pid.calc(chassis_data.speed_lf_set, chassis_lf.speed);
+        chassis_lr_pid.calc(chassis_data.speed_lr_set, chassis_lr.speed);
+        chassis_rf_pid.calc(chassis_data.speed_rf_set, chassis_rf.speed);
+        chassis_rr_pid.calc(chassis_data.speed_rr_set, chassis_rr.speed);
+    }
     
-    chassis_data.torque_lf = chassis_lf_pid.out;
-    chassis_data.torque_lr = chassis_lr_pid.out;
-    chassis_data.torque_rf = chassis_rf_pid.out;
-    chassis_data.torque_rr = chassis_rr_pid.out;
+    // 前馈力矩叠加在PID输出上，PID只修正模型残差
+    const FeedforwardModel model = {params.ff_inertia, params.ff_viscous, params.ff_coulomb};
+    float ff_lf = lf_feedforward.calc(chassis_data.speed_lf_set, model);
+    float ff_lr = lr_feedforward.calc(chassis_data.speed_lr_set, model);
+    float ff_rf = rf_feedforward.calc(chassis_data.speed_rf_set, model);
+    float ff_rr = rr_feedforward.calc(chassis_data.speed_rr_set, model);
+    chassis_data.torque_lf = chassis_lf_pid.out + ff_lf;
+    chassis_data.torque_lr = chassis_lr_pid.out + ff_lr;
+    chassis_data.torque_rf = chassis_rf_pid.out + ff_rf;
+    chassis_data.torque_rr = chassis_rr_pid.out + ff_rr;
+
+    // 打滑轮降力矩，其余车轮补偿车体合力，在统一的功率缩放之前进行
+    {
+        const float speeds[4] = {chassis_lf.speed, chassis_lr.speed, chassis_rf.speed, chassis_rr.speed};
+        float torques[4] = {chassis_data.torque_lf, chassis_data.torque_lr, chassis_data.torque_rf, chassis_data.torque_rr};
+        // 小陀螺时IMU不在旋转中心，向心加速度混入速度估计，只用轮速间的一致性判断打滑
+        const bool body_valid = chassis_data.imu_valid && !chassis_data.spinning;
+        const BodyMotion body = {chassis_data.vx_est, chassis_data.vy_est, chassis_data.yaw_rate, body_valid};
+        traction_control.apply(speeds, torques, body);
+        chassis_data.torque_lf = torques[0];
+        chassis_data.torque_lr = torques[1];
+        chassis_data.torque_rf = torques[2];
+        chassis_data.torque_rr = torques[3];
+        chassis_data.slip_mask = traction_control.slip_mask;
+        chassis_data.traction_gain = traction_control.gain_min;
+    }
 
     // 功率管理
-    update_power_data();
-    apply_power_limit();
+    {
+        SCOPE_TIMER(POWER_DATA);
+        update_power_data();
+    }
+    {
+        SCOPE_TIMER(POWER_LIMIT);
+        apply_power_limit();
+    }
+
+    // 功率缩放和限幅后实际执行的PID部分反馈给积分项；
+    // 再分配补偿的轮子力矩里含有替打滑轮出的力，不是PID的输出，只按PID自身的限幅反算
+    const uint8_t compensating = traction_control.compensating_mask;
+    chassis_lf_pid.back_calculate((compensating & (1u << 0)) ? chassis_lf_pid.out : chassis_data.torque_lf - ff_lf);
+    chassis_lr_pid.back_calculate((compensating & (1u << 1)) ? chassis_lr_pid.out : chassis_data.torque_lr - ff_lr);
+    chassis_rf_pid.back_calculate((compensating & (1u << 2)) ? chassis_rf_pid.out : chassis_data.torque_rf - ff_rf);
+    chassis_rr_pid.back_calculate((compensating & (1u << 3)) ? chassis_rr_pid.out : chassis_data.torque_rr - ff_rr);
+    
+    // 前馈参数辨识样本 (电调反馈的实际力矩)
+    const float speeds[4] = {chassis_lf.speed, chassis_lr.speed, chassis_rf.speed, chassis_rr.speed};
+    const float torques[4] = {chassis_lf.torque, chassis_lr.torque, chassis_rf.torque, chassis_rr.torque};
+    ff_identifier.update(speeds, torques);
     
     // 发送电机指令
+    SCOPE_TIMER(MOTOR_CMD);
     chassis_lf.cmd(chassis_data.torque_lf);
     chassis_lr.cmd(chassis_data.torque_lr);
     chassis_rf.cmd(chassis_data.torque_rf);
     chassis_rr.cmd(chassis_data.torque_rr);
 }
 
+// 遥控器拨杆处理：音效提示和电容模式选择
+static void handle_remote_switches()
+{
+    if (remote.sw_r != last_sw_r) {
+        if (remote.sw_r == sp::DBusSwitchMode::MID && last_sw_r == sp::DBusSwitchMode::DOWN) {
+            request_sound_effect(SoundEffect::SWITCH_UP);
+        }
+        else if (remote.sw_r == sp::DBusSwitchMode::DOWN && last_sw_r == sp::DBusSwitchMode::MID) {
+            request_sound_effect(SoundEffect::SWITCH_DOWN);
+        }
+        else if (remote.sw_r == sp::DBusSwitchMode::UP && last_sw_r == sp::DBusSwitchMode::MID) {
+            request_sound_effect(SoundEffect::SWITCH_UP);
+        }
+        else if (remote.sw_r == sp::DBusSwitchMode::MID && last_sw_r == sp::DBusSwitchMode::UP) {
+            request_sound_effect(SoundEffect::SWITCH_DOWN);
+        }
+        // 遥控/键鼠模式切换时从当前设定值接续 (制动过程中保持制动轨迹)
+        if (failsafe.state() == FailsafeState::ACTIVE) sync_setpoint_shapers();
+        last_sw_r = remote.sw_r;
+    }
+    
+    // 左拨杆音效和电容模式控制
+    if (remote.sw_l != last_sw_l) {
+        if (remote.sw_l == sp::DBusSwitchMode::UP && last_sw_l != sp::DBusSwitchMode::UP) {
+            request_sound_effect(SoundEffect::LEFT_SWITCH_UP);
+        }
+        else if (remote.sw_l == sp::DBusSwitchMode::DOWN && last_sw_l != sp::DBusSwitchMode::DOWN) {
+            request_sound_effect(SoundEffect::LEFT_SWITCH_DOWN);
+        }
+        else if (remote.sw_l == sp::DBusSwitchMode::MID && last_sw_l != sp::DBusSwitchMode::MID) {
+            request_sound_effect(SoundEffect::LEFT_SWITCH_UP);
+        }
+        last_sw_l = remote.sw_l;
+    }
+    
+    // 电容放电请求 (键鼠模式下由键鼠运动层的Shift加速状态请求)，实际模式由能量管理选择
+    bool keyboard_boost = (remote.sw_r == sp::DBusSwitchMode::UP) && keyboard_control.boost;
+    cap_boost_requested = (remote.sw_l == sp::DBusSwitchMode::MID) || keyboard_boost;
+}
+
+// 驱动模式选择：遥控模式下左拨杆拨下、键鼠模式下F键切换为场定向驱动；
+// 小陀螺由遥控器拨轮拨动或R键切换，小陀螺时平移总是场定向
+static void update_drive_mode()
+{
+    bool keyboard = (remote.sw_r == sp::DBusSwitchMode::UP);
+    bool key_f = remote.keys.f;
+    if (key_f && !last_key_f && keyboard) {
+        keyboard_field_oriented = !keyboard_field_oriented;
+    }
+    last_key_f = key_f;
+
+    bool key_r = remote.keys.r;
+    bool dial_high = std::abs(remote.ch_lu) > SPIN_DIAL_THRESHOLD;
+    if ((key_r && !last_key_r && keyboard) || (dial_high && !last_dial_high && !keyboard)) {
+        spin_requested = !spin_requested;
+        request_sound_effect(spin_requested ? SoundEffect::SWITCH_UP : SoundEffect::SWITCH_DOWN);
+    }
+    last_key_r = key_r;
+    last_dial_high = dial_high;
+
+    bool field_oriented = spin_requested ||
+                          (keyboard ? keyboard_field_oriented : remote.sw_l == sp::DBusSwitchMode::DOWN);
+    // 进入场定向时以当前车头方向为场坐标系前方
+    if (field_oriented && !chassis_data.field_oriented) {
+        heading_control.set_field_reference(chassis_data.yaw);
+    }
+    chassis_data.field_oriented = field_oriented;
+}
+
+// 裁判系统在线检测，帧时间戳与串口中断中一样取osKernelSysTick
+static bool referee_online()
+{
+    if (referee_frame_count == 0) return false;
+    return osKernelSysTick() - referee_frame_stamp_ms < REFEREE_TIMEOUT_MS;
+}
+
+// 四个轮子中最大的转速绝对值
+static float max_wheel_speed()
+{
+    return std::max(
+        std::max(std::abs(chassis_lf.speed), std::abs(chassis_lr.speed)),
+        std::max(std::abs(chassis_rf.speed), std::abs(chassis_rr.speed)));
+}
+
+// 停止控制后复位前馈，恢复时不把设定值跳变当作加速度
+static void reset_feedforward()
+{
+    lf_feedforward.reset();
+    lr_feedforward.reset();
+    rf_feedforward.reset();
+    rr_feedforward.reset();
+}
+
+// 进入制动：整形器从当前设定值出发，按加加速度受限轨迹减速到零
+static void start_braking()
+{
+    sync_setpoint_shapers();
+    vx_shaper.set_target(0.0f, CONTROL_PERIOD_MS);
+    vy_shaper.set_target(0.0f, CONTROL_PERIOD_MS);
+    wz_shaper.set_target(0.0f, CONTROL_PERIOD_MS);
+}
+
+// 切换到新参数块后重建轮速环PID (积分项随之清零)
+static void apply_chassis_params()
+{
+    const ChassisParams & params = param_server.active();
+    chassis_lf_pid = WheelPid(PID_DT, params.pid_kp, params.pid_ki, params.pid_kd, params.pid_mo, params.pid_mio, PID_ALPHA, PID_KB);
+    chassis_lr_pid = WheelPid(PID_DT, params.pid_kp, params.pid_ki, params.pid_kd, params.pid_mo, params.pid_mio, PID_ALPHA, PID_KB);
+    chassis_rf_pid = WheelPid(PID_DT, params.pid_kp, params.pid_ki, params.pid_kd, params.pid_mo, params.pid_mio, PID_ALPHA, PID_KB);
+    chassis_rr_pid = WheelPid(PID_DT, params.pid_kp, params.pid_ki, params.pid_kd, params.pid_mo, params.pid_mio, PID_ALPHA, PID_KB);
+}
+
+// 上电从flash载入已保存的参数，超出当前范围的值忽略
+static void load_stored_params()
+{
+    param_store.init();
+
+    uint32_t values[PARAM_STORE_MAX_KEYS];
+    size_t count = param_server.count();
+    uint32_t found = param_store.load(values, count);
+
+    ParamEntry entries[PARAM_STORE_MAX_KEYS];
+    size_t n = 0;
+    for (size_t id = 0; id < count; id++) {
+        if (!(found & (1u << id)) || !param_server.valid(id, values[id])) continue;
+        entries[n].id = static_cast<uint8_t>(id);
+        entries[n].value = values[id];
+        n++;
+    }
+    if (n != 0 && param_server.set(entries, n) == ParamStatus::OK && param_server.update()) {
+        apply_chassis_params();
+    }
+}
+
+// 记录本周期的完整底盘状态
+static void log_chassis_state(uint32_t now_ms, FailsafeState state)
+{
+    LogRecord rec;
+    rec.stamp_ms = now_ms;
+    rec.vx_set = chassis_data.vx_set;
+    rec.vy_set = chassis_data.vy_set;
+    rec.wz_set = chassis_data.wz_set;
+    rec.speed_set[0] = chassis_data.speed_lf_set;
+    rec.speed_set[1] = chassis_data.speed_lr_set;
+    rec.speed_set[2] = chassis_data.speed_rf_set;
+    rec.speed_set[3] = chassis_data.speed_rr_set;
+    rec.speed[0] = chassis_lf.speed;
+    rec.speed[1] = chassis_lr.speed;
+    rec.speed[2] = chassis_rf.speed;
+    rec.speed[3] = chassis_rr.speed;
+    rec.torque_set[0] = chassis_data.torque_lf;
+    rec.torque_set[1] = chassis_data.torque_lr;
+    rec.torque_set[2] = chassis_data.torque_rf;
+    rec.torque_set[3] = chassis_data.torque_rr;
+    rec.torque[0] = chassis_lf.torque;
+    rec.torque[1] = chassis_lr.torque;
+    rec.torque[2] = chassis_rf.torque;
+    rec.torque[3] = chassis_rr.torque;
+    rec.power_in = chassis_data.power_in;
+    rec.power_out = chassis_data.power_out;
+    rec.actual_power = chassis_data.chassis_actual_power;
+    rec.predicted_power = chassis_data.predicted_power;
+    rec.scale_factor = chassis_data.power_scale_factor;
+    rec.buffer_energy = pm02.power_heat.buffer_energy;
+    rec.power_limit = chassis_data.chassis_power_limit;
+    rec.state = static_cast<uint8_t>(state);
+    rec.limit_active = chassis_data.power_limit_active;
+    rec.referee_online = chassis_data.referee_online;
+    rec.reserved = 0;
+    data_logger.record(rec);
+}
+
 // 主控制任务，处理遥控器输入和底盘控制
 extern "C" void chassis_control_task()
 {
     chassis_data.chassis_power_limit = DEFAULT_POWER_LIMIT;
+    chassis_data.cap_input_limit = DEFAULT_POWER_LIMIT;
+    FailsafeState last_state = failsafe.state();
+    load_stored_params();
+    cpu_profiler.add_deadline(&control_deadline);
+    data_logger.arm(LOG_PRE_RECORDS, LOG_POST_RECORDS, LOG_BUFFER_ENERGY_MIN, LOG_SCALE_MIN, true);
+    // 初始化失败时估计器退化为纯轮速里程计
+    bmi088.init();
 
     while (true) {
-        // 遥控器离线检测
-        if (!remote.is_alive(HAL_GetTick())) {
-            disable_all_motors();
-            osDelay(OFFLINE_DELAY_MS);
-            continue;
-        }
+        control_deadline.tick();
+        uint32_t now_ms = HAL_GetTick();
         
-        if (remote.sw_r != last_sw_r) {
-            if (remote.sw_r == sp::DBusSwitchMode::MID && last_sw_r == sp::DBusSwitchMode::DOWN) {
-                request_sound_effect(SoundEffect::SWITCH_UP);
-            }
-            else if (remote.sw_r == sp::DBusSwitchMode::DOWN && last_sw_r == sp::DBusSwitchMode::MID) {
-                request_sound_effect(SoundEffect::SWITCH_DOWN);
-            }
-            last_sw_r = remote.sw_r;
-        }
+        // 在线参数只在周期开始时切换，保证一个周期内参数一致
+        if (param_server.update()) apply_chassis_params();
         
-        // 左拨杆音效和电容模式控制
-        if (remote.sw_l != last_sw_l) {
-            if (remote.sw_l == sp::DBusSwitchMode::UP && last_sw_l != sp::DBusSwitchMode::UP) {
-                request_sound_effect(SoundEffect::LEFT_SWITCH_UP);
-            }
-            else if (remote.sw_l == sp::DBusSwitchMode::DOWN && last_sw_l != sp::DBusSwitchMode::DOWN) {
-                request_sound_effect(SoundEffect::LEFT_SWITCH_DOWN);
-            }
-            else if (remote.sw_l == sp::DBusSwitchMode::MID && last_sw_l != sp::DBusSwitchMode::MID) {
-                request_sound_effect(SoundEffect::LEFT_SWITCH_UP);
-            }
-            last_sw_l = remote.sw_l;
+        update_wheel_trackers();
+        update_motor_thermal();
+        update_chassis_estimate();
+        
+        // 遥控器离线检测，离线时拨杆数据不可信
+        bool remote_alive = remote.is_alive(now_ms);
+        chassis_data.referee_online = referee_online();
+        if (remote_alive) {
+            handle_remote_switches();
+            update_drive_mode();
         }
         
-        // 电容模式设置
-        if (remote.sw_l == sp::DBusSwitchMode::MID) {
-            current_supercap_mode = sp::SuperCapMode::DISCHARGE;  // 只放不充模式
-        } else {
-            current_supercap_mode = sp::SuperCapMode::AUTOMODE;   // 自动模式
+        bool command_ok = remote_alive && remote.sw_r != sp::DBusSwitchMode::DOWN;
+        FailsafeState state = failsafe.update(command_ok, max_wheel_speed(), now_ms);
+        if (state == FailsafeState::BRAKING && last_state == FailsafeState::ACTIVE) {
+            start_braking();
         }
+        else if (state == FailsafeState::ACTIVE && last_state != FailsafeState::ACTIVE) {
+            sync_setpoint_shapers();
+        }
+        last_state = state;
+        chassis_released = (state == FailsafeState::RELEASED);
+        // 制动和恢复过程中不自旋
+        chassis_data.spinning = spin_requested && state == FailsafeState::ACTIVE;
+        update_cap_manager(state);
         
         // 底盘控制逻辑
-        if (remote.sw_r == sp::DBusSwitchMode::MID) {
-            float raw_vx = remote.ch_lv;
-            float raw_vy = remote.ch_lh;
-            float raw_right_v = remote.ch_rv;
-            float raw_right_h = remote.ch_rh;
-            
-            float vx = raw_vx * MAX_LINEAR_SPEED;
-            float vy = (-raw_vy) * MAX_LINEAR_SPEED;
-            
-            float wz = 0.0f;
-            if (std::abs(raw_right_v) > 0.0f) {
-                wz = raw_right_v * ROTATION_SPEED;
+        if (state == FailsafeState::RELEASED) {
+            disable_all_motors();
+            reset_setpoint_shapers();
+            reset_feedforward();
+            accel_limiter.reset();
+            traction_control.reset();
+            heading_control.reset();
+            log_chassis_state(now_ms, state);
+            // 遥控器离线时也按控制周期运行：热模型、电容管理和速度估计按PID_DT积分
+            osDelay(CONTROL_PERIOD_MS);
+            continue;
+        }
+        
+        if (state != FailsafeState::ACTIVE) {
+            // 制动/恢复过程中在功率限制下主动减速到零
+            chassis_move_control(vx_shaper.update(), vy_shaper.update(), wz_shaper.update());
+        }
+        else if (remote.sw_r == sp::DBusSwitchMode::MID) {
+            // 死区/expo整形 + 帧间插值 + 加加速度受限轨迹
+            // 摇杆回中时由上位机指令接管，每个周期按时间对齐后的指令更新目标
+            float nav_vx, nav_vy, nav_wz;
+            const ChassisParams & params = param_server.active();
+            bool nav_active = nav_command.setpoint(
+                now_ms, params.max_linear_speed, params.rotation_speed, nav_vx, nav_vy, nav_wz);
+            update_setpoint_targets(nav_active);
+            if (nav_active && !remote_override) {
+                vx_shaper.set_target(nav_vx, CONTROL_PERIOD_MS);
+                vy_shaper.set_target(nav_vy, CONTROL_PERIOD_MS);
+                wz_shaper.set_target(nav_wz, CONTROL_PERIOD_MS);
             }
-            else if (std::abs(raw_right_h) > 0.0f) {
-                wz = -raw_right_h * ROTATION_SPEED;
+            else if (!nav_active && !remote_override) {
+                // 上位机指令超时且摇杆回中，目标回零
+                vx_shaper.set_target(0.0f, CONTROL_PERIOD_MS);
+                vy_shaper.set_target(0.0f, CONTROL_PERIOD_MS);
+                wz_shaper.set_target(0.0f, CONTROL_PERIOD_MS);
             }
+            float vx = vx_shaper.update();
+            float vy = vy_shaper.update();
+            float wz = wz_shaper.update();
             
             chassis_move_control(vx, vy, wz);
         }
         else {
-            disable_all_motors();
+            // 键鼠控制模式
+            const ChassisParams & params = param_server.active();
+            keyboard_control.update(remote, params.max_linear_speed, params.rotation_speed);
+            chassis_move_control(keyboard_control.vx, keyboard_control.vy, keyboard_control.wz);
         }
         
+        log_chassis_state(now_ms, state);
         osDelay(CONTROL_PERIOD_MS);
     }
 }
@@ -0,0 +1,112 @@
+#include "chassis_estimator.hpp"
+
+#include <cmath>
+
+constexpr float STILL_WHEEL_SPEED = 0.2f;     // 判定静止的轮速阈值 rad/s
+constexpr float STILL_GYRO_RATE = 0.05f;      // 已标定后判定静止的角速度阈值 rad/s
+constexpr uint32_t CALIB_SAMPLES = 500;       // 首次零偏标定需要的连续静止周期数
+constexpr float BIAS_ALPHA = 0.001f;          // 标定后静止时零偏跟踪系数
+constexpr uint32_t STALE_LIMIT = 10;          // 连续无IMU数据的周期数上限
+constexpr float ODOM_TAU = 0.2f;              // 里程计校正时间常数 s
+constexpr float ACC_FILTER_ALPHA = 0.05f;     // 加速度比较用低通系数，1kHz下约8Hz截止
+constexpr float SLIP_MISMATCH = 1.0f;         // 判定打滑的加速度差 m/s^2
+constexpr float SLIP_RESIDUAL = 2.0f;         // 判定打滑的四轮运动学残差 rad/s
+constexpr uint32_t SLIP_HOLD = 100;           // 打滑结束后继续暂停校正的周期数
+
+ChassisEstimator::ChassisEstimator(
+    float wheel_radius, float half_length, float half_width, float mount_yaw, float dt)
+: forward_(wheel_radius, half_length, half_width),
+  dt_(dt),
+  mount_cos_(std::cos(mount_yaw)),
+  mount_sin_(std::sin(mount_yaw))
+{
+}
+
+void ChassisEstimator::update(const float speed[4], const ImuSample & imu)
+{
+    forward_.calc(speed[0], speed[1], speed[2], speed[3]);
+    odom_vx = forward_.vx;
+    odom_vy = forward_.vy;
+    odom_wz = forward_.wz;
+    float odom_ax = (odom_vx - last_odom_[0]) / dt_;
+    float odom_ay = (odom_vy - last_odom_[1]) / dt_;
+    last_odom_[0] = odom_vx;
+    last_odom_[1] = odom_vy;
+
+    bool fresh = (imu.gyro_count != 0 && imu.accel_count != 0);
+    stale_count_ = fresh ? 0 : stale_count_ + 1;
+
+    // 板载坐标系转到底盘坐标系
+    float ax = mount_cos_ * imu.accel[0] - mount_sin_ * imu.accel[1];
+    float ay = mount_sin_ * imu.accel[0] + mount_cos_ * imu.accel[1];
+    float gz = imu.gyro[2];
+
+    bool wheels_still = std::abs(speed[0]) < STILL_WHEEL_SPEED && std::abs(speed[1]) < STILL_WHEEL_SPEED &&
+                        std::abs(speed[2]) < STILL_WHEEL_SPEED && std::abs(speed[3]) < STILL_WHEEL_SPEED;
+    bool still = fresh && wheels_still && (!calibrated_ || std::abs(gz - gyro_bias_) < STILL_GYRO_RATE);
+    still_count_ = still ? still_count_ + 1 : 0;
+
+    // 静止时估计零偏 (加速度计零偏同时吸收了安装倾斜带来的重力分量)
+    if (still) {
+        float alpha = calibrated_ ? BIAS_ALPHA : 1.0f / static_cast<float>(still_count_);
+        gyro_bias_ += alpha * (gz - gyro_bias_);
+        accel_bias_[0] += alpha * (ax - accel_bias_[0]);
+        accel_bias_[1] += alpha * (ay - accel_bias_[1]);
+        if (still_count_ >= CALIB_SAMPLES) calibrated_ = true;
+    }
+
+    imu_valid = calibrated_ && stale_count_ < STALE_LIMIT;
+    if (!imu_valid) {
+        vx = odom_vx;
+        vy = odom_vy;
+        wz = odom_wz;
+        odom_acc_[0] = odom_acc_[1] = 0.0f;
+        imu_acc_[0] = imu_acc_[1] = 0.0f;
+        mismatch = 0.0f;
+        slipping = false;
+        yaw = wrap_angle(yaw + wz * dt_);
+        return;
+    }
+
+    // 本周期没有新样本时沿用上一周期的角速度，不做加速度积分
+    if (fresh) {
+        wz = gz - gyro_bias_;
+        ax -= accel_bias_[0];
+        ay -= accel_bias_[1];
+        float dvx = ax + wz * vy;
+        float dvy = ay - wz * vx;
+        vx += dvx * dt_;
+        vy += dvy * dt_;
+        imu_acc_[0] += ACC_FILTER_ALPHA * (dvx - imu_acc_[0]);
+        imu_acc_[1] += ACC_FILTER_ALPHA * (dvy - imu_acc_[1]);
+    }
+    yaw = wrap_angle(yaw + wz * dt_);
+    odom_acc_[0] += ACC_FILTER_ALPHA * (odom_ax - odom_acc_[0]);
+    odom_acc_[1] += ACC_FILTER_ALPHA * (odom_ay - odom_acc_[1]);
+
+    // 轮子打滑时轮速的变化快于车体，里程计加速度与IMU不一致；
+    // 单个轮子以稳定转速空转时加速度又一致了，但四轮转速不再满足运动学约束
+    float dax = odom_acc_[0] - imu_acc_[0];
+    float day = odom_acc_[1] - imu_acc_[1];
+    mismatch = std::sqrt(dax * dax + day * day);
+    if (mismatch > SLIP_MISMATCH || forward_.residual > SLIP_RESIDUAL) {
+        slip_hold_ = SLIP_HOLD;
+    }
+    else if (slip_hold_ != 0) {
+        slip_hold_--;
+    }
+    slipping = (slip_hold_ != 0);
+
+    // 里程计低频校正加速度计积分漂移
+    if (!slipping) {
+        float k = dt_ / ODOM_TAU;
+        vx += k * (odom_vx - vx);
+        vy += k * (odom_vy - vy);
+    }
+
+    // 静止时速度直接归零，消除积分漂移
+    if (still) {
+        vx = 0.0f;
+        vy = 0.0f;
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef CHASSIS_ESTIMATOR_HPP
+#define CHASSIS_ESTIMATOR_HPP
+
+#include <cmath>
+
+#include "bmi088.hpp"
+#include "chassis_kinematics.hpp"
+
+// 角度归一化到 [-π, π)
+inline float wrap_angle(float angle)
+{
+    constexpr float PI = 3.14159265f;
+    return angle - 2.0f * PI * std::floor((angle + PI) * (0.5f / PI));
+}
+
+// 底盘速度估计：轮速里程计与IMU互补滤波
+// 偏航角速度直接取陀螺仪 (减去静止时估计的零偏)，轮子打滑不影响；
+// 车体速度由加速度计积分预测 (含旋转坐标系项 ω×v)，再以轮速里程计低频校正，
+// 里程计求导的加速度与加速度计不一致 (打滑、腾空) 或四轮转速不满足运动学约束 (单轮空转) 时暂停校正。
+// IMU不可用时退化为纯里程计
+class ChassisEstimator
+{
+public:
+    // mount_yaw: C板x轴相对底盘前进方向绕z轴的安装角 rad
+    ChassisEstimator(float wheel_radius, float half_length, float half_width, float mount_yaw, float dt);
+
+    // 控制周期调用，speed为四轮转速 (lf, lr, rf, rr) rad/s
+    void update(const float speed[4], const ImuSample & imu);
+
+    float vx = 0.0f;          // 融合后的车体速度 m/s
+    float vy = 0.0f;
+    float wz = 0.0f;          // 偏航角速度 rad/s
+    float yaw = 0.0f;         // 偏航角速度积分 rad，上电时为0，[-π, π)
+    float odom_vx = 0.0f;     // 轮速里程计
+    float odom_vy = 0.0f;
+    float odom_wz = 0.0f;
+    float mismatch = 0.0f;    // 里程计与IMU加速度之差的模 (低通后) m/s^2
+    bool slipping = false;    // 里程计不可信，只用IMU积分
+    bool imu_valid = false;   // 已完成零偏标定且IMU数据正常
+
+private:
+    MecanumForward forward_;
+    const float dt_;
+    const float mount_cos_;
+    const float mount_sin_;
+
+    float gyro_bias_ = 0.0f;
+    float accel_bias_[2] = {};
+    uint32_t still_count_ = 0;
+    uint32_t stale_count_ = 0;
+    uint32_t slip_hold_ = 0;
+    float last_odom_[2] = {};
+    float odom_acc_[2] = {};  // 低通后的里程计加速度
+    float imu_acc_[2] = {};   // 低通后的IMU速度变化率
+    bool calibrated_ = false;
+};
+
+#endif // CHASSIS_ESTIMATOR_HPP
@@ -0,0 +1,78 @@
+#include "chassis_kinematics.hpp"
+
+#include <cmath>
+
+MecanumForward::MecanumForward(float wheel_radius, float half_length, float half_width)
+: inverse_(wheel_radius, half_length, half_width)
+{
+}
+
+// 首次使用时构建伪逆，避免在静态初始化阶段调用其他对象
+void MecanumForward::build()
+{
+    // 雅可比矩阵的三列分别为单位vx、vy、wz对应的四轮转速
+    float (&jac)[4][3] = jac_;
+    const float unit[3][3] = {{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}};
+    for (int col = 0; col < 3; col++) {
+        inverse_.calc(unit[col][0], unit[col][1], unit[col][2]);
+        jac[0][col] = inverse_.speed_lf;
+        jac[1][col] = inverse_.speed_lr;
+        jac[2][col] = inverse_.speed_rf;
+        jac[3][col] = inverse_.speed_rr;
+    }
+
+    // A = J^T J
+    float a[3][3] = {};
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            for (int k = 0; k < 4; k++) a[i][j] += jac[k][i] * jac[k][j];
+        }
+    }
+
+    // 3x3 伴随矩阵求逆
+    float inv[3][3];
+    inv[0][0] = a[1][1] * a[2][2] - a[1][2] * a[2][1];
+    inv[0][1] = a[0][2] * a[2][1] - a[0][1] * a[2][2];
+    inv[0][2] = a[0][1] * a[1][2] - a[0][2] * a[1][1];
+    inv[1][0] = a[1][2] * a[2][0] - a[1][0] * a[2][2];
+    inv[1][1] = a[0][0] * a[2][2] - a[0][2] * a[2][0];
+    inv[1][2] = a[0][2] * a[1][0] - a[0][0] * a[1][2];
+    inv[2][0] = a[1][0] * a[2][1] - a[1][1] * a[2][0];
+    inv[2][1] = a[0][1] * a[2][0] - a[0][0] * a[2][1];
+    inv[2][2] = a[0][0] * a[1][1] - a[0][1] * a[1][0];
+    float det = a[0][0] * inv[0][0] + a[0][1] * inv[1][0] + a[0][2] * inv[2][0];
+
+    // pinv = A^-1 J^T
+    for (int i = 0; i < 3; i++) {
+        for (int k = 0; k < 4; k++) {
+            float sum = 0.0f;
+            for (int j = 0; j < 3; j++) sum += inv[i][j] * jac[k][j];
+            pinv_[i][k] = sum / det;
+        }
+    }
+
+    ready_ = true;
+}
+
+void MecanumForward::calc(float speed_lf, float speed_lr, float speed_rf, float speed_rr)
+{
+    if (!ready_) build();
+
+    const float speed[4] = {speed_lf, speed_lr, speed_rf, speed_rr};
+    float out[3];
+    for (int i = 0; i < 3; i++) {
+        out[i] = pinv_[i][0] * speed[0] + pinv_[i][1] * speed[1] + pinv_[i][2] * speed[2] +
+                 pinv_[i][3] * speed[3];
+    }
+
+    vx = out[0];
+    vy = out[1];
+    wz = out[2];
+
+    float square = 0.0f;
+    for (int k = 0; k < 4; k++) {
+        float e = speed[k] - (jac_[k][0] * out[0] + jac_[k][1] * out[1] + jac_[k][2] * out[2]);
+        square += e * e;
+    }
+    residual = std::sqrt(square);
+}
@@ -0,0 +1,31 @@
+#ifndef CHASSIS_KINEMATICS_HPP
+#define CHASSIS_KINEMATICS_HPP
+
+#include "tools/mecanum/mecanum.hpp"
+
+// 麦轮正运动学：由四轮转速求底盘速度
+// 用独立的sp::Mecanum实例采样逆运动学雅可比矩阵，再求最小二乘伪逆，
+// 因此与mecanum_chassis的轮序和正负号约定保持一致，且不会与控制任务争用同一实例
+class MecanumForward
+{
+public:
+    MecanumForward(float wheel_radius, float half_length, float half_width);
+
+    // 由四轮转速(rad/s)求底盘速度 vx, vy (m/s), wz (rad/s)
+    void calc(float speed_lf, float speed_lr, float speed_rf, float speed_rr);
+
+    float vx = 0.0f;
+    float vy = 0.0f;
+    float wz = 0.0f;
+    float residual = 0.0f;  // 四轮转速中不能由车体运动解释的部分 (最小二乘残差的模) rad/s
+
+private:
+    sp::Mecanum inverse_;
+    bool ready_ = false;
+    float jac_[4][3];   // 逆运动学雅可比矩阵，列为单位vx、vy、wz
+    float pinv_[3][4];  // (J^T J)^-1 J^T
+
+    void build();
+};
+
+#endif // CHASSIS_KINEMATICS_HPP
@@ -0,0 +1,185 @@
+#include "cpu_profiler.hpp"
+#include "memory_monitor.hpp"
+#include "scope_timer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#if defined(__arm__)
+#include "main.h"
+#else
+#include <time.h>
+#endif
+
+// 各中断本统计周期内的累计耗时和最长单次耗时 (中断中更新，采样时关中断读取并清零)
+static uint32_t isr_cycles[static_cast<size_t>(IsrId::COUNT)];
+static uint32_t isr_max_cycles[static_cast<size_t>(IsrId::COUNT)];
+static const char * const ISR_NAMES[] = {"can_rx", "uart_rx", "usb_rx"};
+static_assert(sizeof(ISR_NAMES) / sizeof(ISR_NAMES[0]) == static_cast<size_t>(IsrId::COUNT), "isr name table");
+
+#if defined(__arm__)
+
+void profiler_init()
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+uint32_t profiler_cycles() { return DWT->CYCCNT; }
+
+uint32_t profiler_cycles_per_us() { return SystemCoreClock / 1000000; }
+
+#else
+
+void profiler_init() {}
+
+uint32_t profiler_cycles()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint32_t>(static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec);
+}
+
+uint32_t profiler_cycles_per_us() { return 1000; }
+
+#endif
+
+extern "C" void configureTimerForRunTimeStats(void)
+{
+    profiler_init();
+    scope_timers_init();
+    msp_paint();
+}
+
+extern "C" unsigned long getRunTimeCounterValue(void) { return profiler_cycles(); }
+
+IsrProfile::~IsrProfile()
+{
+    uint32_t cycles = profiler_cycles() - start_;
+    size_t id = static_cast<size_t>(id_);
+    isr_cycles[id] += cycles;
+    isr_max_cycles[id] = std::max(isr_max_cycles[id], cycles);
+}
+
+DeadlineMonitor::DeadlineMonitor(const char * name, uint32_t period_us, uint32_t tolerance_us)
+: name_(name), limit_us_(period_us + tolerance_us)
+{
+}
+
+void DeadlineMonitor::tick()
+{
+    uint32_t now = profiler_cycles();
+    if (started_) {
+        uint32_t interval = now - last_;
+        if (interval > limit_us_ * profiler_cycles_per_us()) misses++;
+        max_interval = std::max(max_interval, interval);
+    }
+    last_ = now;
+    started_ = true;
+}
+
+bool CpuProfiler::add_deadline(DeadlineMonitor * monitor)
+{
+    taskENTER_CRITICAL();
+    bool ok = deadline_count_ < MAX_DEADLINES;
+    if (ok) deadlines_[deadline_count_++] = monitor;
+    taskEXIT_CRITICAL();
+    return ok;
+}
+
+uint32_t CpuProfiler::task_delta(uint32_t task_number, uint32_t runtime) const
+{
+    for (size_t i = 0; i < last_task_count_; i++) {
+        if (last_task_number_[i] == task_number) return runtime - last_task_runtime_[i];
+    }
+    return 0;  // 新建的任务从下个周期开始统计
+}
+
+// 按 0.01% 计的占用率
+static uint16_t load_of(uint32_t cycles, uint32_t total)
+{
+    if (total == 0) return 0;
+    return static_cast<uint16_t>(std::min<uint64_t>(static_cast<uint64_t>(cycles) * 10000 / total, 10000));
+}
+
+static void fill_entry(CpuStatEntry & entry, uint8_t kind, uint8_t id, const char * name)
+{
+    entry.kind = kind;
+    entry.id = id;
+    entry.load = 0;
+    entry.misses = 0;
+    entry.max_us = 0;
+    std::strncpy(entry.name, name, sizeof(entry.name));
+}
+
+size_t CpuProfiler::sample(CpuStatEntry * entries, size_t max_entries)
+{
+    static TaskStatus_t status[MAX_TASKS];
+    uint32_t total = 0;
+    size_t task_count = uxTaskGetSystemState(status, MAX_TASKS, &total);
+    uint32_t total_delta = total - last_total_;
+    uint32_t cycles_per_us = profiler_cycles_per_us();
+    size_t n = 0;
+
+    // 任务占用率
+    TaskHandle_t idle = xTaskGetIdleTaskHandle();
+    uint32_t idle_delta = 0;
+    for (size_t i = 0; i < task_count; i++) {
+        uint32_t delta = task_delta(status[i].xTaskNumber, status[i].ulRunTimeCounter);
+        if (status[i].xHandle == idle) idle_delta = delta;
+        if (n < max_entries) {
+            fill_entry(entries[n], 0, static_cast<uint8_t>(status[i].xTaskNumber), status[i].pcTaskName);
+            entries[n].load = load_of(delta, total_delta);
+            n++;
+        }
+    }
+    if (total_delta != 0) {
+        cpu_load = 100.0f - 100.0f * static_cast<float>(idle_delta) / static_cast<float>(total_delta);
+    }
+
+    last_task_count_ = task_count;
+    for (size_t i = 0; i < task_count; i++) {
+        last_task_number_[i] = status[i].xTaskNumber;
+        last_task_runtime_[i] = status[i].ulRunTimeCounter;
+    }
+    last_total_ = total;
+
+    // 中断耗时
+    uint32_t cycles[static_cast<size_t>(IsrId::COUNT)];
+    uint32_t max_cycles[static_cast<size_t>(IsrId::COUNT)];
+    taskENTER_CRITICAL();
+    std::memcpy(cycles, isr_cycles, sizeof(cycles));
+    std::memcpy(max_cycles, isr_max_cycles, sizeof(max_cycles));
+    std::memset(isr_cycles, 0, sizeof(isr_cycles));
+    std::memset(isr_max_cycles, 0, sizeof(isr_max_cycles));
+    taskEXIT_CRITICAL();
+
+    for (size_t id = 0; id < static_cast<size_t>(IsrId::COUNT) && n < max_entries; id++) {
+        fill_entry(entries[n], 1, static_cast<uint8_t>(id), ISR_NAMES[id]);
+        entries[n].load = load_of(cycles[id], total_delta);
+        entries[n].max_us = static_cast<uint16_t>(std::min<uint32_t>(max_cycles[id] / cycles_per_us, UINT16_MAX));
+        n++;
+    }
+
+    // 截止时间
+    for (size_t id = 0; id < deadline_count_ && n < max_entries; id++) {
+        DeadlineMonitor * monitor = deadlines_[id];
+        taskENTER_CRITICAL();
+        uint32_t misses = monitor->misses;
+        uint32_t max_interval = monitor->max_interval;
+        monitor->misses = 0;
+        monitor->max_interval = 0;
+        taskEXIT_CRITICAL();
+
+        fill_entry(entries[n], 2, static_cast<uint8_t>(id), monitor->name());
+        entries[n].misses = static_cast<uint16_t>(std::min<uint32_t>(misses, UINT16_MAX));
+        entries[n].max_us = static_cast<uint16_t>(std::min<uint32_t>(max_interval / cycles_per_us, UINT16_MAX));
+        n++;
+    }
+
+    return n;
+}
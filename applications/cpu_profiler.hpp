@@ -0,0 +1,104 @@
+#ifndef CPU_PROFILER_HPP
+#define CPU_PROFILER_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// 周期计数源：ARM上为DWT->CYCCNT (168MHz，约25.6s回绕)，主机POSIX构建为clock_gettime纳秒
+void profiler_init();
+uint32_t profiler_cycles();
+uint32_t profiler_cycles_per_us();
+
+// FreeRTOS运行时间统计钩子 (configGENERATE_RUN_TIME_STATS)
+extern "C" void configureTimerForRunTimeStats(void);
+extern "C" unsigned long getRunTimeCounterValue(void);
+
+// 被统计的中断
+enum class IsrId : uint8_t
+{
+    CAN_RX,   // CAN2 FIFO0接收
+    UART_RX,  // DBus/裁判系统串口接收
+    USB_RX,   // USB CDC接收
+    COUNT,
+};
+
+// 中断耗时统计，在回调入口构造
+// 中断时间同时计入被打断任务的运行时间，嵌套中断的时间计入外层中断
+class IsrProfile
+{
+public:
+    explicit IsrProfile(IsrId id) : id_(id), start_(profiler_cycles()) {}
+    ~IsrProfile();
+
+private:
+    IsrId id_;
+    uint32_t start_;
+};
+
+// 周期任务截止时间监测：任务每次循环开始时调用tick()，
+// 两次调用间隔超过周期+容差记为一次错过
+class DeadlineMonitor
+{
+public:
+    DeadlineMonitor(const char * name, uint32_t period_us, uint32_t tolerance_us);
+
+    void tick();
+
+    // 任务主动长时间休眠前调用，下一个间隔不计入统计
+    void skip() { started_ = false; }
+
+    const char * name() const { return name_; }
+
+    // 以下由监测任务读取并清零
+    uint32_t misses = 0;
+    uint32_t max_interval = 0;  // 最大循环间隔 (周期计数)
+
+private:
+    const char * name_;
+    uint32_t limit_us_;
+    uint32_t last_ = 0;
+    bool started_ = false;
+};
+
+// 统计表条目，kind: 0任务 1中断 2截止时间
+struct __attribute__((packed)) CpuStatEntry
+{
+    uint8_t kind;
+    uint8_t id;
+    uint16_t load;       // 占用率 0.01%
+    uint16_t misses;     // 本统计周期错过截止时间次数
+    uint16_t max_us;     // 中断最长单次耗时 / 最大循环间隔 us
+    char name[10];
+};
+
+// CPU占用统计：周期性读取FreeRTOS各任务运行时间和中断耗时，计算本周期占用率
+class CpuProfiler
+{
+public:
+    // 注册截止时间监测，返回是否成功
+    bool add_deadline(DeadlineMonitor * monitor);
+
+    // 监测任务中周期调用，生成统计表，返回条目数
+    size_t sample(CpuStatEntry * entries, size_t max_entries);
+
+    float cpu_load = 0.0f;  // 除空闲任务外的总占用率 %
+
+private:
+    static constexpr size_t MAX_TASKS = 16;
+    static constexpr size_t MAX_DEADLINES = 8;
+
+    DeadlineMonitor * deadlines_[MAX_DEADLINES] = {};
+    size_t deadline_count_ = 0;
+
+    // 上一次采样时各任务的累计运行时间，按任务号索引
+    uint32_t last_task_number_[MAX_TASKS] = {};
+    uint32_t last_task_runtime_[MAX_TASKS] = {};
+    size_t last_task_count_ = 0;
+    uint32_t last_total_ = 0;
+
+    uint32_t task_delta(uint32_t task_number, uint32_t runtime) const;
+};
+
+extern CpuProfiler cpu_profiler;  // monitor_task.cpp中实例化
+
+#endif // CPU_PROFILER_HPP
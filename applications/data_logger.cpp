@@ -0,0 +1,136 @@
+#include "data_logger.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "cpu_profiler.hpp"
+#include "failsafe.hpp"
+#include "usb_link.hpp"
+
+static_assert(sizeof(uint16_t) + sizeof(LogRecord) <= USB_FRAME_MAX_PAYLOAD, "log record too large");
+static_assert(sizeof(LogInfoFrame) <= USB_FRAME_MAX_PAYLOAD, "log info frame too large");
+
+DataLogger::DataLogger(LogRecord * buffer, uint16_t depth) : buffer_(buffer), depth_(depth) {}
+
+bool DataLogger::arm(uint16_t pre, uint16_t post, uint16_t buffer_energy_min, float scale_min, bool rearm)
+{
+    LoggerState state = state_.load(std::memory_order_acquire);
+    if (state == LoggerState::ARMED || state == LoggerState::TRIGGERED) return false;
+    if (post == 0 || pre + post > depth_) return false;
+
+    pre_ = pre;
+    post_ = post;
+    buffer_energy_min_ = buffer_energy_min;
+    scale_min_ = scale_min;
+    rearm_ = rearm;
+    manual_trigger_.store(false, std::memory_order_relaxed);
+
+    state_.store(LoggerState::ARMED, std::memory_order_release);
+    return true;
+}
+
+void DataLogger::disarm()
+{
+    state_.store(LoggerState::IDLE, std::memory_order_release);
+}
+
+LogTrigger DataLogger::check_trigger(const LogRecord & rec)
+{
+    if (manual_trigger_.exchange(false, std::memory_order_relaxed)) return LogTrigger::MANUAL;
+
+    // 上电后、释放状态和裁判系统离线时缓冲能量为0、缩放因子未计算，不能作为触发依据；
+    // 缩放因子只在功率限制生效时才由功率控制写入
+    if (rec.state != static_cast<uint8_t>(FailsafeState::ACTIVE) || !rec.referee_online) return LogTrigger::NONE;
+    if (buffer_energy_min_ != 0 && rec.buffer_energy < buffer_energy_min_) return LogTrigger::BUFFER_ENERGY;
+    if (scale_min_ >= 0.0f && rec.limit_active && rec.scale_factor <= scale_min_) return LogTrigger::SCALE_FACTOR;
+    return LogTrigger::NONE;
+}
+
+void DataLogger::record(const LogRecord & rec)
+{
+    uint32_t start = profiler_cycles();
+
+    LoggerState state = state_.load(std::memory_order_acquire);
+    if (state != LoggerState::ARMED && state != LoggerState::TRIGGERED) {
+        filled_ = 0;
+        return;
+    }
+
+    buffer_[head_] = rec;
+    head_ = (head_ + 1 == depth_) ? 0 : head_ + 1;
+    if (filled_ < depth_) filled_++;
+
+    if (state == LoggerState::ARMED) {
+        LogTrigger cause = check_trigger(rec);
+        if (cause != LogTrigger::NONE) {
+            // 触发点本身计入触发后记录
+            trigger_cause_ = cause;
+            trigger_stamp_ms_ = rec.stamp_ms;
+            window_pre_ = std::min<uint16_t>(filled_ - 1, pre_);
+            post_left_ = post_;
+            // 上位机可能同时disarm，状态切换用CAS
+            LoggerState expected = LoggerState::ARMED;
+            if (state_.compare_exchange_strong(expected, LoggerState::TRIGGERED, std::memory_order_acq_rel)) {
+                state = LoggerState::TRIGGERED;
+            }
+        }
+    }
+
+    if (state == LoggerState::TRIGGERED && --post_left_ == 0) {
+        // 冻结窗口，之后只由USB任务读取
+        window_count_ = window_pre_ + post_;
+        window_start_ = static_cast<uint16_t>((head_ + depth_ - window_count_) % depth_);
+        flush_index_ = 0;
+        info_sent_ = false;
+        filled_ = 0;
+        LoggerState expected = LoggerState::TRIGGERED;
+        state_.compare_exchange_strong(expected, LoggerState::CAPTURED, std::memory_order_acq_rel);
+    }
+
+    cycles_last_ = profiler_cycles() - start;
+    cycles_max_ = std::max(cycles_max_, cycles_last_);
+}
+
+bool DataLogger::flush(size_t max_records)
+{
+    if (state_.load(std::memory_order_acquire) != LoggerState::CAPTURED) return false;
+
+    if (!info_sent_) {
+        LogInfoFrame info;
+        fill_info(info);
+        if (!usb_link.send(UsbCmd::LOG_INFO, &info, sizeof(info))) return true;
+        info_sent_ = true;
+    }
+
+    // 发送队列满时停在当前记录，下次继续
+    uint8_t payload[sizeof(uint16_t) + sizeof(LogRecord)];
+    for (size_t n = 0; n < max_records && flush_index_ < window_count_; n++) {
+        uint16_t index = (window_start_ + flush_index_) % depth_;
+        std::memcpy(payload, &flush_index_, sizeof(flush_index_));
+        std::memcpy(payload + sizeof(uint16_t), &buffer_[index], sizeof(LogRecord));
+        if (!usb_link.send(UsbCmd::LOG_RECORD, payload, sizeof(payload))) return true;
+        flush_index_++;
+    }
+    if (flush_index_ < window_count_) return true;
+
+    // 上发期间上位机可能disarm或重新arm，状态切换用CAS
+    if (rearm_) manual_trigger_.store(false, std::memory_order_relaxed);
+    LoggerState expected = LoggerState::CAPTURED;
+    state_.compare_exchange_strong(
+        expected, rearm_ ? LoggerState::ARMED : LoggerState::IDLE, std::memory_order_acq_rel);
+    return false;
+}
+
+void DataLogger::fill_info(LogInfoFrame & info) const
+{
+    info.trigger_stamp_ms = trigger_stamp_ms_;
+    info.trigger = static_cast<uint8_t>(trigger_cause_);
+    info.state = static_cast<uint8_t>(state_.load(std::memory_order_relaxed));
+    info.record_size = sizeof(LogRecord);
+    info.depth = depth_;
+    info.pre = window_pre_;
+    info.post = post_;
+    info.count = window_count_;
+    info.cycles_last = cycles_last_;
+    info.cycles_max = cycles_max_;
+}
@@ -0,0 +1,148 @@
+#ifndef DATA_LOGGER_HPP
+#define DATA_LOGGER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// 单个控制周期的底盘状态记录
+struct LogRecord
+{
+    uint32_t stamp_ms;
+    float vx_set, vy_set, wz_set;
+    float speed_set[4];   // lf, lr, rf, rr  rad/s
+    float speed[4];       // lf, lr, rf, rr  rad/s
+    float torque_set[4];  // 功率限制后下发的力矩 N·m
+    float torque[4];      // 电调反馈电流换算的力矩 N·m
+    float power_in;
+    float power_out;
+    float actual_power;
+    float predicted_power;
+    float scale_factor;
+    uint16_t buffer_energy;
+    uint16_t power_limit;
+    uint8_t state;        // FailsafeState
+    uint8_t limit_active;
+    uint8_t referee_online;
+    uint8_t reserved;
+};
+
+// 触发原因
+enum class LogTrigger : uint8_t
+{
+    NONE,
+    BUFFER_ENERGY,  // 缓冲能量低于阈值
+    SCALE_FACTOR,   // 功率缩放因子饱和
+    MANUAL,         // 上位机手动触发
+};
+
+enum class LoggerState : uint8_t
+{
+    IDLE,       // 未启动
+    ARMED,      // 循环记录，等待触发
+    TRIGGERED,  // 已触发，记录触发后数据
+    CAPTURED,   // 窗口已冻结，等待上发
+};
+
+// 捕获窗口描述，随数据一起上发
+struct __attribute__((packed)) LogInfoFrame
+{
+    uint32_t trigger_stamp_ms;
+    uint8_t trigger;        // LogTrigger
+    uint8_t state;          // LoggerState
+    uint16_t record_size;   // sizeof(LogRecord)
+    uint16_t depth;         // 环形缓冲区容量 (条)
+    uint16_t pre;           // 窗口内触发前记录数
+    uint16_t post;          // 窗口内触发后记录数 (含触发点)
+    uint16_t count;         // 窗口总记录数
+    uint32_t cycles_last;   // 最近一次record()耗时 (CPU周期)
+    uint32_t cycles_max;    // record()最大耗时 (CPU周期)
+};
+
+// 上位机控制指令
+enum class LogCtrlOp : uint8_t
+{
+    ARM,      // 按帧内参数启动记录，捕获一次后停止
+    TRIGGER,  // 手动触发
+    DISARM,   // 停止记录
+    STATUS,   // 回传LogInfoFrame
+};
+
+struct __attribute__((packed)) LogCtrlFrame
+{
+    uint8_t op;  // LogCtrlOp
+    uint16_t pre;
+    uint16_t post;
+    uint16_t buffer_energy_min;
+    float scale_min;
+};
+
+// 高速数据记录仪
+// 控制任务每个周期调用record()把完整状态写入环形缓冲区，满足触发条件后再记录post条，
+// 随后冻结窗口，由USB任务调用flush()分批上发，发完后按arm时的设置重新开始记录或回到IDLE。
+// 缓冲能量和缩放因子触发只在底盘受控且裁判系统在线时判断，手动触发不受限制
+class DataLogger
+{
+public:
+    DataLogger(LogRecord * buffer, uint16_t depth);
+
+    // 启动记录，pre + post 不超过缓冲区容量
+    // buffer_energy_min: 缓冲能量低于该值触发，0为不触发
+    // scale_min: 缩放因子不大于该值触发，负数为不触发
+    // rearm: 窗口上发完后自动重新开始记录
+    bool arm(uint16_t pre, uint16_t post, uint16_t buffer_energy_min, float scale_min, bool rearm = false);
+    void disarm();
+
+    // 上位机手动触发
+    void trigger() { manual_trigger_.store(true, std::memory_order_relaxed); }
+
+    // 控制任务中每周期调用
+    void record(const LogRecord & rec);
+
+    // USB任务中调用，每次最多上发max_records条，返回是否仍有待发送数据
+    bool flush(size_t max_records);
+
+    LoggerState state() const { return state_.load(std::memory_order_acquire); }
+    void fill_info(LogInfoFrame & info) const;
+
+private:
+    LogRecord * buffer_;
+    uint16_t depth_;
+
+    std::atomic<LoggerState> state_{LoggerState::IDLE};
+    std::atomic<bool> manual_trigger_{false};
+
+    // 触发配置，仅在IDLE状态下修改
+    uint16_t pre_ = 0;
+    uint16_t post_ = 0;
+    uint16_t buffer_energy_min_ = 0;
+    float scale_min_ = -1.0f;
+    bool rearm_ = false;
+
+    // 写入状态，仅控制任务访问
+    uint16_t head_ = 0;       // 下一条写入位置
+    uint16_t filled_ = 0;     // 已写入的有效记录数
+    uint16_t post_left_ = 0;  // 触发后还需记录的条数
+
+    // 冻结后的窗口
+    uint16_t window_start_ = 0;
+    uint16_t window_pre_ = 0;
+    uint16_t window_count_ = 0;
+    uint32_t trigger_stamp_ms_ = 0;
+    LogTrigger trigger_cause_ = LogTrigger::NONE;
+
+    // 上发进度，仅USB任务访问
+    uint16_t flush_index_ = 0;
+    bool info_sent_ = false;
+
+    uint32_t cycles_last_ = 0;
+    uint32_t cycles_max_ = 0;
+
+    LogTrigger check_trigger(const LogRecord & rec);
+};
+
+// 记录仪实例及其缓冲区 (chassis_control_task.cpp中实例化，缓冲区位于CCM RAM)
+constexpr uint16_t LOG_DEPTH = 400;  // 1kHz下400ms窗口，约42KB
+extern DataLogger data_logger;
+
+#endif // DATA_LOGGER_HPP
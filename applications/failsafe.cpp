@@ -0,0 +1,55 @@
+#include "failsafe.hpp"
+
+Failsafe::Failsafe(uint32_t brake_timeout_ms, float stop_speed, uint32_t recover_hold_ms)
+: brake_timeout_ms_(brake_timeout_ms), stop_speed_(stop_speed), recover_hold_ms_(recover_hold_ms)
+{
+}
+
+void Failsafe::enter(FailsafeState state, uint32_t now_ms)
+{
+    state_ = state;
+    state_start_ms_ = now_ms;
+
+    if (state == FailsafeState::BRAKING && !brake_pending_) {
+        brake_start_ms_ = now_ms;
+        brake_pending_ = true;
+    }
+    else if (state == FailsafeState::ACTIVE) {
+        brake_pending_ = false;
+    }
+}
+
+FailsafeState Failsafe::update(bool command_ok, float max_wheel_speed, uint32_t now_ms)
+{
+    uint32_t elapsed_ms = now_ms - state_start_ms_;
+
+    switch (state_) {
+        case FailsafeState::ACTIVE:
+            if (!command_ok) enter(FailsafeState::BRAKING, now_ms);
+            break;
+
+        case FailsafeState::BRAKING:
+            if (max_wheel_speed < stop_speed_ || now_ms - brake_start_ms_ >= brake_timeout_ms_) {
+                enter(FailsafeState::RELEASED, now_ms);
+            }
+            else if (command_ok) {
+                enter(FailsafeState::RECOVERING, now_ms);
+            }
+            break;
+
+        case FailsafeState::RELEASED:
+            if (command_ok) enter(FailsafeState::RECOVERING, now_ms);
+            break;
+
+        case FailsafeState::RECOVERING:
+            if (!command_ok) {
+                enter(FailsafeState::BRAKING, now_ms);
+            }
+            else if (elapsed_ms >= recover_hold_ms_) {
+                enter(FailsafeState::ACTIVE, now_ms);
+            }
+            break;
+    }
+
+    return state_;
+}
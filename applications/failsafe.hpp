@@ -0,0 +1,48 @@
+#ifndef FAILSAFE_HPP
+#define FAILSAFE_HPP
+
+#include <cstdint>
+
+// 失控保护状态
+enum class FailsafeState
+{
+    ACTIVE,      // 正常控制
+    BRAKING,     // 指令失效，主动减速到零速
+    RELEASED,    // 已停止(或制动超时)，释放力矩
+    RECOVERING   // 指令恢复，保持制动直到持续有效一段时间
+};
+
+// 失控保护状态机
+// 遥控器离线或右拨杆拨下时不再立即清零力矩，而是先在功率限制下主动刹停，
+// 轮速低于阈值或超过制动时限后再释放力矩；指令恢复后需持续有效一段时间才重新接管。
+// 制动时限从指令失效算起，恢复过程中再次失效不重新计时，直到重新接管为止，
+// 否则时断时续的指令会让底盘一直处于制动而不释放
+class Failsafe
+{
+public:
+    // brake_timeout_ms: 最长制动时间
+    // stop_speed: 判定停稳的轮速阈值 rad/s
+    // recover_hold_ms: 恢复所需的指令持续有效时间
+    Failsafe(uint32_t brake_timeout_ms, float stop_speed, uint32_t recover_hold_ms);
+
+    // 每个控制周期调用一次
+    // command_ok: 遥控指令是否有效
+    // max_wheel_speed: 四个轮子中最大的转速绝对值 rad/s
+    FailsafeState update(bool command_ok, float max_wheel_speed, uint32_t now_ms);
+
+    FailsafeState state() const { return state_; }
+
+private:
+    const uint32_t brake_timeout_ms_;
+    const float stop_speed_;
+    const uint32_t recover_hold_ms_;
+
+    FailsafeState state_ = FailsafeState::RELEASED;
+    uint32_t state_start_ms_ = 0;
+    uint32_t brake_start_ms_ = 0;   // 本次制动的开始时刻
+    bool brake_pending_ = false;    // 制动开始后尚未重新接管
+
+    void enter(FailsafeState state, uint32_t now_ms);
+};
+
+#endif // FAILSAFE_HPP
@@ -0,0 +1,155 @@
+#include "feedforward.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+constexpr float FEEDFORWARD_SIGN_BAND = 0.5f;  // rad/s
+constexpr float IDENT_FILTER_ALPHA = 0.1f;     // 辨识低通系数，1kHz下约17Hz截止
+constexpr uint32_t IDENT_WARMUP = 50;          // 滤波器稳定前的周期数
+constexpr float IDENT_MIN_SPEED = 1.0f;        // 低于该轮速的样本不计入 rad/s
+constexpr uint32_t IDENT_MIN_SAMPLES = 2000;
+
+// 平滑符号函数
+static float soft_sign(float value)
+{
+    return std::max(-1.0f, std::min(1.0f, value * (1.0f / FEEDFORWARD_SIGN_BAND)));
+}
+
+WheelFeedforward::WheelFeedforward(float dt) : inv_dt_(1.0f / dt) {}
+
+float WheelFeedforward::calc(float speed_set, const FeedforwardModel & model)
+{
+    accel_set = started_ ? (speed_set - last_set_) * inv_dt_ : 0.0f;
+    last_set_ = speed_set;
+    started_ = true;
+
+    return model.inertia * accel_set + model.viscous * speed_set + model.coulomb * soft_sign(speed_set);
+}
+
+FeedforwardIdentifier::FeedforwardIdentifier(float dt) : inv_dt_(1.0f / dt) {}
+
+void FeedforwardIdentifier::request(IdentOp op)
+{
+    switch (op) {
+        case IdentOp::START:
+            state_.store(State::STARTING, std::memory_order_release);
+            break;
+        case IdentOp::STOP:
+            state_.store(State::IDLE, std::memory_order_release);
+            break;
+        case IdentOp::SOLVE: {
+            State expected = State::RUNNING;
+            state_.compare_exchange_strong(expected, State::SOLVING, std::memory_order_acq_rel);
+            break;
+        }
+    }
+}
+
+bool FeedforwardIdentifier::take_result(IdentResultFrame & result)
+{
+    if (state_.load(std::memory_order_acquire) != State::SOLVED) return false;
+    result = result_;
+    State expected = State::SOLVED;
+    state_.compare_exchange_strong(expected, State::IDLE, std::memory_order_acq_rel);
+    return true;
+}
+
+void FeedforwardIdentifier::clear()
+{
+    std::fill(std::begin(ata_), std::end(ata_), 0.0);
+    std::fill(std::begin(aty_), std::end(aty_), 0.0);
+    yty_ = 0.0;
+    samples_ = 0;
+    warmup_ = 0;
+}
+
+void FeedforwardIdentifier::update(const float speed[4], const float torque[4])
+{
+    State state = state_.load(std::memory_order_acquire);
+    if (state == State::STARTING) {
+        clear();
+        State expected = State::STARTING;
+        if (!state_.compare_exchange_strong(expected, State::RUNNING, std::memory_order_acq_rel)) return;
+        state = State::RUNNING;
+    }
+    if (state == State::SOLVING) {
+        solve();
+        state_.store(State::SOLVED, std::memory_order_release);
+        return;
+    }
+    if (state != State::RUNNING) return;
+
+    for (size_t i = 0; i < 4; i++) {
+        last_speed_filt_[i] = speed_filt_[i];
+        speed_filt_[i] += IDENT_FILTER_ALPHA * (speed[i] - speed_filt_[i]);
+        torque_filt_[i] += IDENT_FILTER_ALPHA * (torque[i] - torque_filt_[i]);
+    }
+    if (warmup_ < IDENT_WARMUP) {
+        warmup_++;
+        return;
+    }
+
+    for (size_t i = 0; i < 4; i++) {
+        float omega = speed_filt_[i];
+        if (std::abs(omega) < IDENT_MIN_SPEED) continue;
+
+        double a[3] = {
+            (speed_filt_[i] - last_speed_filt_[i]) * inv_dt_,
+            omega,
+            omega > 0.0f ? 1.0 : -1.0,
+        };
+        double y = torque_filt_[i];
+        ata_[0] += a[0] * a[0];
+        ata_[1] += a[0] * a[1];
+        ata_[2] += a[0] * a[2];
+        ata_[3] += a[1] * a[1];
+        ata_[4] += a[1] * a[2];
+        ata_[5] += a[2] * a[2];
+        aty_[0] += a[0] * y;
+        aty_[1] += a[1] * y;
+        aty_[2] += a[2] * y;
+        yty_ += y * y;
+        samples_++;
+    }
+}
+
+// 3x3对称正定方程组，Cholesky分解求解
+void FeedforwardIdentifier::solve()
+{
+    result_ = {};
+    result_.samples = samples_;
+    if (samples_ < IDENT_MIN_SAMPLES) return;
+
+    const double a00 = ata_[0], a01 = ata_[1], a02 = ata_[2];
+    const double a11 = ata_[3], a12 = ata_[4], a22 = ata_[5];
+
+    // 激励不足 (例如只匀速运行，α恒为零) 时矩阵接近奇异
+    if (a00 <= 0.0) return;
+    double l00 = std::sqrt(a00);
+    double l10 = a01 / l00;
+    double l20 = a02 / l00;
+    double d11 = a11 - l10 * l10;
+    if (d11 <= 1e-9 * a11) return;
+    double l11 = std::sqrt(d11);
+    double l21 = (a12 - l20 * l10) / l11;
+    double d22 = a22 - l20 * l20 - l21 * l21;
+    if (d22 <= 1e-9 * a22) return;
+    double l22 = std::sqrt(d22);
+
+    double z0 = aty_[0] / l00;
+    double z1 = (aty_[1] - l10 * z0) / l11;
+    double z2 = (aty_[2] - l20 * z0 - l21 * z1) / l22;
+    double x2 = z2 / l22;
+    double x1 = (z1 - l21 * x2) / l11;
+    double x0 = (z0 - l10 * x1 - l20 * x2) / l00;
+
+    // 残差平方和 = yᵀy - xᵀAᵀy
+    double sse = yty_ - (x0 * aty_[0] + x1 * aty_[1] + x2 * aty_[2]);
+
+    result_.ok = 1;
+    result_.inertia = static_cast<float>(x0);
+    result_.viscous = static_cast<float>(x1);
+    result_.coulomb = static_cast<float>(x2);
+    result_.rms_error = static_cast<float>(std::sqrt(std::max(sse, 0.0) / samples_));
+}
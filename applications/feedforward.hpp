@@ -0,0 +1,106 @@
+#ifndef FEEDFORWARD_HPP
+#define FEEDFORWARD_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// 单轮前馈模型参数 (均折算到轮轴)
+struct FeedforwardModel
+{
+    float inertia;  // 等效转动惯量 J  kg·m^2
+    float viscous;  // 粘滞摩擦系数 B  N·m/(rad/s)
+    float coulomb;  // 库仑摩擦力矩 Fc N·m
+};
+
+// 前馈力矩 τ = J·α + B·ω + Fc·sign(ω)
+// ω、α取自轮速设定值及其差分，PID只需修正模型残差。
+// sign(ω)在 ±FEEDFORWARD_SIGN_BAND 内线性过渡，避免设定值过零时力矩跳变
+class WheelFeedforward
+{
+public:
+    explicit WheelFeedforward(float dt);
+
+    // 每个控制周期调用，speed_set为本周期轮速设定值 rad/s
+    float calc(float speed_set, const FeedforwardModel & model);
+
+    // 停止控制后调用，下次calc()不产生加速度项
+    void reset() { started_ = false; }
+
+    float accel_set = 0.0f;  // 设定值角加速度 rad/s^2
+
+private:
+    const float inv_dt_;
+    float last_set_ = 0.0f;
+    bool started_ = false;
+};
+
+enum class IdentOp : uint8_t
+{
+    STOP,   // 放弃本次辨识
+    START,  // 清空并开始累积样本
+    SOLVE,  // 停止累积并求解
+};
+
+// 辨识结果
+struct __attribute__((packed)) IdentResultFrame
+{
+    uint8_t ok;        // 法方程可解且样本足够
+    uint32_t samples;
+    float inertia;
+    float viscous;
+    float coulomb;
+    float rms_error;   // 拟合残差均方根 N·m
+};
+
+// 前馈参数在线辨识
+// 控制任务每周期把四个轮子的实测(轮速, 角加速度, 力矩)作为样本，
+// 以 τ = J·α + B·ω + Fc·sign(ω) 累积3x3最小二乘法方程，求解时只需解一次方程组。
+// 轮速和力矩先经同一低通滤波再差分，低速样本 sign(ω) 不可靠，不计入
+class FeedforwardIdentifier
+{
+public:
+    explicit FeedforwardIdentifier(float dt);
+
+    // USB任务调用
+    void request(IdentOp op);
+
+    // USB任务轮询，有新结果时返回true
+    bool take_result(IdentResultFrame & result);
+
+    // 控制任务每周期调用，speed/torque为四个轮子的实测值
+    void update(const float speed[4], const float torque[4]);
+
+private:
+    enum class State : uint8_t
+    {
+        IDLE,
+        STARTING,  // 等待控制任务清空累积量
+        RUNNING,
+        SOLVING,   // 等待控制任务求解
+        SOLVED,
+    };
+
+    const float inv_dt_;
+    std::atomic<State> state_{State::IDLE};
+
+    float speed_filt_[4] = {};
+    float torque_filt_[4] = {};
+    float last_speed_filt_[4] = {};
+    uint32_t warmup_ = 0;
+
+    // 法方程 AᵀA (对称，存上三角) 和 Aᵀy，以及 yᵀy 用于残差
+    double ata_[6] = {};
+    double aty_[3] = {};
+    double yty_ = 0.0;
+    uint32_t samples_ = 0;
+
+    IdentResultFrame result_ = {};
+
+    void clear();
+    void solve();
+};
+
+extern FeedforwardIdentifier ff_identifier;  // chassis_control_task.cpp中实例化
+
+#endif // FEEDFORWARD_HPP
@@ -0,0 +1,42 @@
+#include "gain_schedule.hpp"
+
+#include <cstddef>
+
+// 断点 0, 8, 16, ..., 40 rad/s (2m/s平移约26rad/s)
+constexpr size_t GAIN_POINTS = 6;
+constexpr float GAIN_SPEED_STEP = 8.0f;
+constexpr float GAIN_INV_STEP = 1.0f / GAIN_SPEED_STEP;
+
+// 低速：提高kp/ki，对位和抗扰更硬；高速：适当降低ki，减小加速过程中的积分超调
+static constexpr GainScale GAIN_TABLE_NORMAL[GAIN_POINTS] = {
+    {1.6f, 1.5f, 1.0f},
+    {1.3f, 1.2f, 1.0f},
+    {1.1f, 1.0f, 1.0f},
+    {1.0f, 0.9f, 1.0f},
+    {1.0f, 0.8f, 1.0f},
+    {1.0f, 0.8f, 1.0f},
+};
+
+// 功率受限：输出会被统一缩放，高增益只会放大力矩需求和积分累积
+static constexpr GainScale GAIN_TABLE_LIMITED[GAIN_POINTS] = {
+    {1.2f, 1.0f, 1.0f},
+    {1.0f, 0.8f, 1.0f},
+    {0.8f, 0.6f, 1.0f},
+    {0.7f, 0.5f, 0.8f},
+    {0.6f, 0.4f, 0.8f},
+    {0.6f, 0.3f, 0.8f},
+};
+
+GainScale gain_schedule(float speed, bool power_limited)
+{
+    const GainScale * table = power_limited ? GAIN_TABLE_LIMITED : GAIN_TABLE_NORMAL;
+
+    float pos = (speed < 0.0f ? -speed : speed) * GAIN_INV_STEP;
+    if (pos >= static_cast<float>(GAIN_POINTS - 1)) return table[GAIN_POINTS - 1];
+
+    size_t i = static_cast<size_t>(pos);
+    float t = pos - static_cast<float>(i);
+    const GainScale & a = table[i];
+    const GainScale & b = table[i + 1];
+    return {a.kp + t * (b.kp - a.kp), a.ki + t * (b.ki - a.ki), a.kd + t * (b.kd - a.kd)};
+}
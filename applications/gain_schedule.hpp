@@ -0,0 +1,17 @@
+#ifndef GAIN_SCHEDULE_HPP
+#define GAIN_SCHEDULE_HPP
+
+// 轮速环增益调度
+// 以轮速为自变量在分段线性表中插值，得到相对于在线参数kp/ki/kd的倍率；
+// 功率限制生效时换用另一张表。断点等间距，查表只用乘法，表为常量放在flash中
+struct GainScale
+{
+    float kp;
+    float ki;
+    float kd;
+};
+
+// speed: 轮速绝对值 rad/s；power_limited: 功率限制是否生效
+GainScale gain_schedule(float speed, bool power_limited);
+
+#endif // GAIN_SCHEDULE_HPP
@@ -0,0 +1,57 @@
+#include "heading_control.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "chassis_estimator.hpp"
+
+constexpr float HEADING_CMD_DEADBAND = 0.05f;  // 视为无旋转指令的角速度 rad/s
+
+HeadingControl::HeadingControl(float kp, float ki, float max_correction, float capture_rate, float dt)
+: kp_(kp), ki_(ki), max_correction_(max_correction), capture_rate_(capture_rate), dt_(dt)
+{
+}
+
+float HeadingControl::hold(float wz_cmd, float yaw, float yaw_rate, bool enabled)
+{
+    if (!enabled || std::abs(wz_cmd) > HEADING_CMD_DEADBAND) {
+        holding = false;
+        error = 0.0f;
+        integral_ = 0.0f;
+        return wz_cmd;
+    }
+
+    // 旋转指令刚回零时车体仍在转动，等转速降下来再锁定，避免回拉
+    if (!holding) {
+        if (std::abs(yaw_rate) >= capture_rate_) return wz_cmd;
+        holding = true;
+        target = yaw;
+    }
+
+    error = wrap_angle(target - yaw);
+    integral_ = std::max(-max_correction_, std::min(integral_ + ki_ * error * dt_, max_correction_));
+    return std::max(-max_correction_, std::min(kp_ * error + integral_, max_correction_));
+}
+
+void HeadingControl::set_field_reference(float yaw)
+{
+    field_reference_ = yaw;
+}
+
+void HeadingControl::field_to_body(float & vx, float & vy, float yaw) const
+{
+    float angle = yaw - field_reference_;
+    float c = std::cos(angle);
+    float s = std::sin(angle);
+    float body_vx = c * vx + s * vy;
+    float body_vy = -s * vx + c * vy;
+    vx = body_vx;
+    vy = body_vy;
+}
+
+void HeadingControl::reset()
+{
+    holding = false;
+    error = 0.0f;
+    integral_ = 0.0f;
+}
@@ -0,0 +1,41 @@
+#ifndef HEADING_CONTROL_HPP
+#define HEADING_CONTROL_HPP
+
+// 航向保持与场定向 (field-oriented) 驱动
+// 航向保持：旋转指令为零且车体基本停止转动后锁定当前航向，
+// 之后以航向误差的PI控制给出旋转角速度设定值，抵消功率缩放不均带来的持续偏航力矩；
+// 场定向：平移指令按场坐标系解释，运动学解算前按估计航向旋转到车体坐标系
+class HeadingControl
+{
+public:
+    // kp: 航向误差到角速度的增益 1/s；ki: 积分增益 1/s^2；max_correction: 修正角速度上限 rad/s；
+    // capture_rate: 车体角速度低于该值时锁定航向 rad/s
+    HeadingControl(float kp, float ki, float max_correction, float capture_rate, float dt);
+
+    // 返回实际使用的旋转角速度设定值，enabled为false (无IMU) 时直接返回wz_cmd
+    float hold(float wz_cmd, float yaw, float yaw_rate, bool enabled);
+
+    // 以当前航向为场坐标系的前方
+    void set_field_reference(float yaw);
+
+    // 场坐标系平移速度转换到车体坐标系
+    void field_to_body(float & vx, float & vy, float yaw) const;
+
+    // 停止控制后调用，下次重新锁定航向
+    void reset();
+
+    bool holding = false;  // 正在保持航向
+    float target = 0.0f;   // 锁定的航向 rad
+    float error = 0.0f;    // 航向误差 rad
+
+private:
+    const float kp_;
+    const float ki_;
+    const float max_correction_;
+    const float capture_rate_;
+    const float dt_;
+    float integral_ = 0.0f;
+    float field_reference_ = 0.0f;
+};
+
+#endif // HEADING_CONTROL_HPP
@@ -0,0 +1,98 @@
+#include "input_recorder.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "cpu_profiler.hpp"
+#include "usb_link.hpp"
+
+constexpr size_t INPUT_FRAME_HEADER_SIZE = sizeof(uint16_t);  // seq u16
+
+static_assert(
+    INPUT_FRAME_HEADER_SIZE + sizeof(InputEventHeader) + INPUT_EVENT_MAX_DATA <= USB_FRAME_MAX_PAYLOAD,
+    "input event too large");
+
+InputRecorder::InputRecorder(uint8_t * buffer, uint32_t size) : buffer_(buffer), mask_(size - 1) {}
+
+void InputRecorder::start()
+{
+    // 清空未发完的旧数据，由读取方移动tail
+    tail_.store(head_.load(std::memory_order_acquire), std::memory_order_release);
+    dropped_events = 0;
+    seq_ = 0;
+    recording_.store(true, std::memory_order_release);
+}
+
+void InputRecorder::push(uint32_t cycles, uint8_t source, uint16_t id, const uint8_t * data, size_t len)
+{
+    uint32_t head = head_.load(std::memory_order_relaxed);
+    InputEventHeader header = {cycles, source, static_cast<uint8_t>(len), id};
+    const uint8_t * parts[2] = {reinterpret_cast<const uint8_t *>(&header), data};
+    size_t sizes[2] = {sizeof(header), len};
+    uint32_t pos = head;
+    for (size_t part = 0; part < 2; part++) {
+        for (size_t i = 0; i < sizes[part]; i++) buffer_[(pos++) & mask_] = parts[part][i];
+    }
+
+    head_.store(pos, std::memory_order_release);
+}
+
+void InputRecorder::record(InputSource source, uint16_t id, const uint8_t * data, size_t len)
+{
+    if (!recording_.load(std::memory_order_relaxed)) return;
+
+    uint32_t cycles = profiler_cycles();
+
+    // 拆分后丢失任何一段都无法还原，空间不足时整包放弃
+    size_t events = (len == 0) ? 1 : (len + INPUT_EVENT_MAX_DATA - 1) / INPUT_EVENT_MAX_DATA;
+    uint32_t used = head_.load(std::memory_order_relaxed) - tail_.load(std::memory_order_acquire);
+    if (used + events * sizeof(InputEventHeader) + len > mask_ + 1) {
+        dropped_events++;
+        return;
+    }
+
+    do {
+        size_t n = std::min(len, INPUT_EVENT_MAX_DATA);
+        uint8_t flags = static_cast<uint8_t>(source) | (len > n ? INPUT_SOURCE_MORE : 0);
+        push(cycles, flags, id, data, n);
+        data += n;
+        len -= n;
+    } while (len != 0);
+}
+
+void InputRecorder::copy_out(uint32_t pos, void * out, size_t len) const
+{
+    uint8_t * dst = static_cast<uint8_t *>(out);
+    for (size_t i = 0; i < len; i++) dst[i] = buffer_[(pos + i) & mask_];
+}
+
+bool InputRecorder::flush(size_t max_frames)
+{
+    uint8_t payload[USB_FRAME_MAX_PAYLOAD];
+
+    for (size_t frame = 0; frame < max_frames; frame++) {
+        uint32_t head = head_.load(std::memory_order_acquire);
+        uint32_t tail = tail_.load(std::memory_order_relaxed);
+        if (head == tail) return false;
+
+        // 整个事件打包进帧，帧满或数据取完为止
+        std::memcpy(payload, &seq_, sizeof(seq_));
+        size_t size = INPUT_FRAME_HEADER_SIZE;
+        uint32_t pos = tail;
+        while (pos != head) {
+            InputEventHeader header;
+            copy_out(pos, &header, sizeof(header));
+            size_t event_size = sizeof(header) + header.len;
+            if (size + event_size > sizeof(payload)) break;
+            copy_out(pos, payload + size, event_size);
+            size += event_size;
+            pos += event_size;
+        }
+
+        // 发送队列满时保留数据，下次继续
+        if (!usb_link.send(UsbCmd::INPUT_RECORD, payload, static_cast<uint8_t>(size))) return true;
+        seq_++;
+        tail_.store(pos, std::memory_order_release);
+    }
+    return head_.load(std::memory_order_acquire) != tail_.load(std::memory_order_relaxed);
+}
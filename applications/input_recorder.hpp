@@ -0,0 +1,75 @@
+#ifndef INPUT_RECORDER_HPP
+#define INPUT_RECORDER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// 输入来源
+enum class InputSource : uint8_t
+{
+    DBUS,     // 遥控器串口 (huart3) 一次空闲中断收到的字节
+    REFEREE,  // 裁判系统串口 (huart6) 一次空闲中断收到的字节
+    CAN2,     // CAN2 一帧 (电机/超级电容反馈)
+    USB,      // USB CDC一次接收回调的字节 (上位机速度指令、参数写入、前馈辨识等命令帧)
+    IMU,      // BMI088一次SPI DMA读取的原始字节
+};
+
+// source最高位：本事件数据未完，下一事件为其后续 (长串口包拆分)
+constexpr uint8_t INPUT_SOURCE_MORE = 0x80;
+
+// 事件头，后跟len字节数据
+struct __attribute__((packed)) InputEventHeader
+{
+    uint32_t cycles;  // profiler_cycles()，约25.6s回绕，回放端按事件顺序展开
+    uint8_t source;   // InputSource | INPUT_SOURCE_MORE
+    uint8_t len;
+    uint16_t id;      // CAN标准帧ID，IMU为数据就绪引脚 (INT_ACC_Pin/INT_GYRO_Pin)，串口和USB为0
+};
+
+// 单个事件最大数据长度，保证一个事件能装进一帧USB
+constexpr size_t INPUT_EVENT_MAX_DATA = 96;
+
+enum class InputRecordOp : uint8_t
+{
+    STOP,
+    START,
+};
+
+// 输入记录仪
+// 在串口、CAN、USB接收回调和IMU传输完成回调中把控制回路看到的原始输入连同时间戳写入字节环，
+// 由USB任务打包上发，上位机保存后可在主机构建中通过InputReplay逐字节回放。
+// 写入方为同一优先级的中断 (不会相互抢占)，视为单生产者；读取方为USB任务
+class InputRecorder
+{
+public:
+    // size必须为2的幂
+    InputRecorder(uint8_t * buffer, uint32_t size);
+
+    void start();
+    void stop() { recording_.store(false, std::memory_order_release); }
+    bool recording() const { return recording_.load(std::memory_order_acquire); }
+
+    // 接收中断中调用，超过INPUT_EVENT_MAX_DATA的数据拆成多个事件
+    void record(InputSource source, uint16_t id, const uint8_t * data, size_t len);
+
+    // USB任务中调用，最多发出max_frames帧，返回是否还有未发数据
+    bool flush(size_t max_frames);
+
+    uint32_t dropped_events = 0;  // 缓冲区满丢弃的事件数
+
+private:
+    uint8_t * buffer_;
+    uint32_t mask_;
+    std::atomic<bool> recording_{false};
+    std::atomic<uint32_t> head_{0};
+    std::atomic<uint32_t> tail_{0};
+    uint16_t seq_ = 0;
+
+    void push(uint32_t cycles, uint8_t source, uint16_t id, const uint8_t * data, size_t len);
+    void copy_out(uint32_t pos, void * out, size_t len) const;
+};
+
+extern InputRecorder input_recorder;  // usb_task.cpp中实例化
+
+#endif // INPUT_RECORDER_HPP
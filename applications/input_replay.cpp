@@ -0,0 +1,135 @@
+#include "input_replay.hpp"
+
+#if !defined(__arm__)
+
+#include <cstring>
+
+#include "can.h"
+#include "spi.h"
+#include "usart.h"
+
+extern "C" void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef * huart, uint16_t Size);
+extern "C" void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef * hcan);
+extern "C" void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin);
+extern "C" void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef * hspi);
+extern "C" void usb_link_on_receive(const uint8_t * data, uint32_t len);
+
+constexpr size_t INPUT_REPLAY_UART_MAX = 512;
+
+// 待交给CAN驱动的一帧
+static bool can_pending = false;
+static uint16_t can_pending_id = 0;
+static uint8_t can_pending_data[8];
+
+// 主机版HAL：记录接收缓冲区，回放时把数据拷贝到这里
+extern "C" HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef * huart, uint8_t * pData, uint16_t Size)
+{
+    huart->pRxBuffPtr = pData;
+    huart->RxXferSize = Size;
+    return HAL_OK;
+}
+
+// 主机版HAL：记录IMU读取的接收缓冲区，回放时把数据拷贝到这里后完成传输
+extern "C" HAL_StatusTypeDef HAL_SPI_TransmitReceive_DMA(
+    SPI_HandleTypeDef * hspi, const uint8_t * pTxData, uint8_t * pRxData, uint16_t Size)
+{
+    hspi->pTxBuffPtr = pTxData;
+    hspi->pRxBuffPtr = pRxData;
+    hspi->RxXferSize = Size;
+    return HAL_OK;
+}
+
+// 主机版HAL：回放时CAN FIFO中只有当前注入的一帧
+extern "C" uint32_t HAL_CAN_GetRxFifoFillLevel(CAN_HandleTypeDef *, uint32_t)
+{
+    return can_pending ? 1 : 0;
+}
+
+extern "C" HAL_StatusTypeDef HAL_CAN_GetRxMessage(
+    CAN_HandleTypeDef *, uint32_t, CAN_RxHeaderTypeDef * header, uint8_t data[])
+{
+    if (!can_pending) return HAL_ERROR;
+    std::memset(header, 0, sizeof(*header));
+    header->StdId = can_pending_id;
+    header->DLC = sizeof(can_pending_data);
+    std::memcpy(data, can_pending_data, sizeof(can_pending_data));
+    can_pending = false;
+    return HAL_OK;
+}
+
+InputReplay::InputReplay(const uint8_t * stream, size_t size) : stream_(stream), size_(size) {}
+
+uint64_t InputReplay::unwrap(uint32_t cycles) const
+{
+    // 相邻输入间隔远小于回绕周期，计数变小即发生了一次回绕
+    uint64_t epoch = epoch_;
+    if (injected != 0 && cycles < last_cycles_) epoch += 1ull << 32;
+    return epoch | cycles;
+}
+
+uint64_t InputReplay::next_cycles() const
+{
+    if (done() || size_ - pos_ < sizeof(InputEventHeader)) return UINT64_MAX;
+    InputEventHeader header;
+    std::memcpy(&header, stream_ + pos_, sizeof(header));
+    return unwrap(header.cycles);
+}
+
+bool InputReplay::step()
+{
+    uint8_t data[INPUT_REPLAY_UART_MAX];
+    size_t len = 0;
+    InputEventHeader header;
+    uint8_t source;
+
+    // 合并被拆分的事件
+    do {
+        if (size_ - pos_ < sizeof(header)) return false;
+        std::memcpy(&header, stream_ + pos_, sizeof(header));
+        if (size_ - pos_ - sizeof(header) < header.len || len + header.len > sizeof(data)) return false;
+        std::memcpy(data + len, stream_ + pos_ + sizeof(header), header.len);
+        len += header.len;
+        pos_ += sizeof(header) + header.len;
+        source = header.source & ~INPUT_SOURCE_MORE;
+    } while (header.source & INPUT_SOURCE_MORE);
+
+    uint64_t stamp = unwrap(header.cycles);
+    epoch_ = stamp & ~0xFFFFFFFFull;
+    last_cycles_ = header.cycles;
+
+    switch (static_cast<InputSource>(source)) {
+        case InputSource::DBUS:
+        case InputSource::REFEREE: {
+            UART_HandleTypeDef * huart = (static_cast<InputSource>(source) == InputSource::DBUS) ? &huart3 : &huart6;
+            if (huart->pRxBuffPtr == nullptr || len > huart->RxXferSize) return false;
+            std::memcpy(huart->pRxBuffPtr, data, len);
+            HAL_UARTEx_RxEventCallback(huart, static_cast<uint16_t>(len));
+            break;
+        }
+        case InputSource::CAN2:
+            if (len != sizeof(can_pending_data)) return false;
+            can_pending_id = header.id;
+            std::memcpy(can_pending_data, data, len);
+            can_pending = true;
+            HAL_CAN_RxFifo0MsgPendingCallback(&hcan2);
+            break;
+        case InputSource::USB:
+            usb_link_on_receive(data, static_cast<uint32_t>(len));
+            break;
+        case InputSource::IMU:
+            // 数据就绪中断应当发起一次长度相同的读取
+            hspi1.pRxBuffPtr = nullptr;
+            HAL_GPIO_EXTI_Callback(header.id);
+            if (hspi1.pRxBuffPtr == nullptr || len != hspi1.RxXferSize) return false;
+            std::memcpy(hspi1.pRxBuffPtr, data, len);
+            HAL_SPI_TxRxCpltCallback(&hspi1);
+            break;
+        default:
+            return false;
+    }
+
+    injected++;
+    return true;
+}
+
+#endif
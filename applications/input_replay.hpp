@@ -0,0 +1,45 @@
+#ifndef INPUT_REPLAY_HPP
+#define INPUT_REPLAY_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include "input_recorder.hpp"
+
+// 输入回放 (仅主机构建)
+// 把InputRecorder记录的事件流按原顺序注入未修改的接收回调：
+//   串口事件拷贝到HAL接收缓冲区 (huart->pRxBuffPtr) 后调用HAL_UARTEx_RxEventCallback
+//   CAN事件经本模块提供的主机版HAL_CAN_GetRxMessage交给HAL_CAN_RxFifo0MsgPendingCallback
+//   USB事件交给usb_link_on_receive，由USB任务的poll()解帧分发
+//   IMU事件先调用HAL_GPIO_EXTI_Callback发起读取，数据拷贝到主机版HAL_SPI_TransmitReceive_DMA
+//   记下的接收缓冲区后调用HAL_SPI_TxRxCpltCallback
+//   串口接收缓冲区由主机版HAL_UARTEx_ReceiveToIdle_DMA记录，回放前应用需已调用request()
+// 回放本身不等待，时间推进由调用方按next_cycles()驱动虚拟时钟和控制循环，
+// 因此回放速度只受主机算力限制
+class InputReplay
+{
+public:
+    // stream为各INPUT_RECORD帧去掉seq后按seq顺序拼接的事件流
+    InputReplay(const uint8_t * stream, size_t size);
+
+    bool done() const { return pos_ >= size_; }
+
+    // 下一个输入的时间戳，按记录顺序把32位周期计数展开为64位
+    uint64_t next_cycles() const;
+
+    // 注入下一个输入 (被拆分的串口包合并后一次注入)，流损坏或结束时返回false
+    bool step();
+
+    uint32_t injected = 0;
+
+private:
+    const uint8_t * stream_;
+    size_t size_;
+    size_t pos_ = 0;
+    uint64_t epoch_ = 0;      // 已展开的高位
+    uint32_t last_cycles_ = 0;
+
+    uint64_t unwrap(uint32_t cycles) const;
+};
+
+#endif // INPUT_REPLAY_HPP
@@ -0,0 +1,69 @@
+#include "input_shaping.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// 死区外重新映射到[0, 1]，再做 expo 混合: y = (1-e)*x + e*x^3
+float shape_stick(float raw, float deadband, float expo)
+{
+    float magnitude = std::abs(raw);
+    if (magnitude <= deadband) return 0.0f;
+
+    float x = std::min((magnitude - deadband) / (1.0f - deadband), 1.0f);
+    float y = (1.0f - expo) * x + expo * x * x * x;
+
+    return (raw > 0.0f) ? y : -y;
+}
+
+SetpointShaper::SetpointShaper(float max_rate, float max_jerk, float dt)
+: max_rate_(max_rate), max_jerk_(max_jerk), dt_(dt)
+{
+}
+
+void SetpointShaper::set_target(float target, uint32_t frame_interval_ms)
+{
+    // 从当前插值位置出发，在一个帧间隔内走到新目标
+    uint32_t ticks = static_cast<uint32_t>(frame_interval_ms / (dt_ * 1000.0f) + 0.5f);
+    interp_from_ = interp_from_ + (interp_to_ - interp_from_) *
+                   (static_cast<float>(interp_step_) / static_cast<float>(interp_ticks_));
+    interp_to_ = target;
+    interp_ticks_ = std::max<uint32_t>(ticks, 1);
+    interp_step_ = 0;
+}
+
+float SetpointShaper::update()
+{
+    // 帧间线性插值
+    if (interp_step_ < interp_ticks_) interp_step_++;
+    float ref = interp_from_ + (interp_to_ - interp_from_) *
+                (static_cast<float>(interp_step_) / static_cast<float>(interp_ticks_));
+
+    // 加加速度受限跟踪：期望变化率保证能在到达目标前以max_jerk把变化率降到0
+    float err = ref - value_;
+    float rate_des = std::min(max_rate_, std::sqrt(2.0f * max_jerk_ * std::abs(err)));
+    if (err < 0.0f) rate_des = -rate_des;
+
+    float max_delta = max_jerk_ * dt_;
+    rate_ += std::max(std::min(rate_des - rate_, max_delta), -max_delta);
+    value_ += rate_ * dt_;
+
+    // 越过参考时钳位到参考值。插值还在进行时参考仍在移动，保留变化率继续跟随，
+    // 否则变化率一步清零相当于无界的加加速度；只有插值已到终点且变化率在一步
+    // 加加速度之内时才直接收敛，避免在目标附近振荡
+    if ((err > 0.0f && value_ > ref) || (err < 0.0f && value_ < ref)) {
+        value_ = ref;
+        if (interp_step_ >= interp_ticks_ && std::abs(rate_) <= max_delta) rate_ = 0.0f;
+    }
+
+    return value_;
+}
+
+void SetpointShaper::reset(float value)
+{
+    interp_from_ = value;
+    interp_to_ = value;
+    interp_ticks_ = 1;
+    interp_step_ = 1;
+    value_ = value;
+    rate_ = 0.0f;
+}
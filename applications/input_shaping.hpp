@@ -0,0 +1,48 @@
+#ifndef INPUT_SHAPING_HPP
+#define INPUT_SHAPING_HPP
+
+#include <cstdint>
+
+// 摇杆整形：死区 + expo曲线，输入输出范围均为[-1, 1]
+float shape_stick(float raw, float deadband, float expo);
+
+// 单轴设定值整形器
+// DBus约14ms一帧而控制周期1ms，直接使用摇杆值会让PID每14ms看到一次阶跃。
+// 这里先在相邻两帧之间做线性插值，再用加速度/加加速度受限的轨迹去跟踪插值结果。
+class SetpointShaper
+{
+public:
+    // max_rate: 设定值最大变化率 (如 m/s^2)
+    // max_jerk: 变化率的最大变化率 (如 m/s^3)
+    // dt: 控制周期 s
+    SetpointShaper(float max_rate, float max_jerk, float dt);
+
+    // 收到新的一帧遥控数据时调用，frame_interval_ms为估计的帧间隔
+    void set_target(float target, uint32_t frame_interval_ms);
+
+    // 每个控制周期调用一次，返回整形后的设定值
+    float update();
+
+    // 立即复位到指定值 (离线、切换模式时使用)
+    void reset(float value = 0.0f);
+
+    float value() const { return value_; }
+    float rate() const { return rate_; }
+
+private:
+    const float max_rate_;
+    const float max_jerk_;
+    const float dt_;
+
+    // 帧间插值状态
+    float interp_from_ = 0.0f;
+    float interp_to_ = 0.0f;
+    uint32_t interp_ticks_ = 1;
+    uint32_t interp_step_ = 1;
+
+    // 轨迹状态
+    float value_ = 0.0f;
+    float rate_ = 0.0f;
+};
+
+#endif // INPUT_SHAPING_HPP
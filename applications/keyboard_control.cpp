@@ -0,0 +1,58 @@
+#include "keyboard_control.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// 鼠标旋转一阶低通系数，抑制鼠标帧间的抖动
+constexpr float MOUSE_FILTER_ALPHA = 0.1f;
+
+KeyboardControl::KeyboardControl(
+    const KeyMotionProfile & normal, const KeyMotionProfile & boost,
+    const KeyMotionProfile & slow, float mouse_yaw_gain, float dt)
+: normal_(normal),
+  boost_(boost),
+  slow_(slow),
+  mouse_yaw_gain_(mouse_yaw_gain),
+  dt_(dt)
+{
+}
+
+// 朝目标速度按加速度/减速度斜坡逼近
+float KeyboardControl::ramp(float current, float target, const KeyMotionProfile & profile) const
+{
+    // 目标与当前同向且幅值更大时为加速，其余情况(松键、反向)为减速
+    bool accelerating = (target * current >= 0.0f) && (std::abs(target) > std::abs(current));
+    float step = (accelerating ? profile.acc : profile.dec) * dt_;
+
+    if (target > current) return std::min(current + step, target);
+    return std::max(current - step, target);
+}
+
+void KeyboardControl::update(const sp::DBus & dbus, float max_linear_speed, float max_wz)
+{
+    const auto & keys = dbus.keys;
+
+    // Ctrl优先于Shift，防止慢速模式下误触加速
+    const KeyMotionProfile & profile = keys.ctrl ? slow_ : (keys.shift ? boost_ : normal_);
+    boost = keys.shift && !keys.ctrl;
+
+    float dir_x = static_cast<float>(keys.w) - static_cast<float>(keys.s);
+    float dir_y = static_cast<float>(keys.a) - static_cast<float>(keys.d);
+
+    float speed = profile.speed_scale * max_linear_speed;
+    vx = ramp(vx, dir_x * speed, profile);
+    vy = ramp(vy, dir_y * speed, profile);
+
+    // 鼠标右移对应顺时针旋转(wz为负)，与右摇杆方向一致
+    float wz_target = -static_cast<float>(dbus.mouse.vx) * mouse_yaw_gain_;
+    wz_target = std::max(std::min(wz_target, max_wz), -max_wz);
+    wz += MOUSE_FILTER_ALPHA * (wz_target - wz);
+}
+
+void KeyboardControl::reset(float vx0, float vy0, float wz0)
+{
+    vx = vx0;
+    vy = vy0;
+    wz = wz0;
+    boost = false;
+}
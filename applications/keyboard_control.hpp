@@ -0,0 +1,44 @@
+#ifndef KEYBOARD_CONTROL_HPP
+#define KEYBOARD_CONTROL_HPP
+
+#include "io/dbus/dbus.hpp"
+
+// 键盘平移加减速曲线
+struct KeyMotionProfile
+{
+    float speed_scale;  // 按键对应的平移速度，相对在线参数max_linear_speed的倍率
+    float acc;          // 加速时速度变化率 m/s^2
+    float dec;          // 松键/反向时速度变化率 m/s^2
+};
+
+// 键鼠运动层：WASD平移，Shift加速(电容放电)，Ctrl慢速，鼠标X轴控制旋转
+// 直接读取DBus对象中由串口中断解析好的键鼠字段，不做额外拷贝
+class KeyboardControl
+{
+public:
+    KeyboardControl(
+        const KeyMotionProfile & normal, const KeyMotionProfile & boost,
+        const KeyMotionProfile & slow, float mouse_yaw_gain, float dt);
+
+    // 每个控制周期调用一次，速度上限取自在线参数
+    void update(const sp::DBus & dbus, float max_linear_speed, float max_wz);
+
+    // 复位输出到指定速度 (离线、切换模式时使用)
+    void reset(float vx0 = 0.0f, float vy0 = 0.0f, float wz0 = 0.0f);
+
+    float vx = 0.0f;     // 前后速度设定 m/s
+    float vy = 0.0f;     // 左右速度设定 m/s
+    float wz = 0.0f;     // 旋转角速度设定 rad/s
+    bool boost = false;  // Shift加速中，需要电容放电
+
+private:
+    const KeyMotionProfile normal_;
+    const KeyMotionProfile boost_;
+    const KeyMotionProfile slow_;
+    const float mouse_yaw_gain_;
+    const float dt_;
+
+    float ramp(float current, float target, const KeyMotionProfile & profile) const;
+};
+
+#endif // KEYBOARD_CONTROL_HPP
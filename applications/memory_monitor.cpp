@@ -0,0 +1,135 @@
+#include "memory_monitor.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#if defined(__arm__)
+#include "main.h"
+
+// 链接脚本符号，_Min_Stack_Size 的地址即其数值
+extern "C" uint32_t _estack;
+extern "C" uint32_t _Min_Stack_Size;
+#endif
+
+constexpr uint32_t MSP_PAINT_PATTERN = 0xA5A5A5A5;
+constexpr uint32_t MSP_PAINT_GUARD = 64;  // 当前SP以下保留的字节，不填充
+
+// 各任务栈深度 (字)，与Src/freertos.c中的osThreadDef保持一致
+struct TaskStackSize
+{
+    const char * name;
+    uint32_t words;
+};
+
+static const TaskStackSize TASK_STACK_SIZES[] = {
+    {"defaultTask", 128},
+    {"ledTask", 128},
+    {"buzzerTask", 128},
+    {"chassis_controlTask", 512},
+    {"plotTask", 256},
+    {"canTask", 256},
+    {"uartTask", 256},
+    {"usbTask", 256},
+    {"monitorTask", 256},
+    {"IDLE", configMINIMAL_STACK_SIZE},
+};
+
+static uint32_t task_stack_words(const char * name)
+{
+    for (const auto & task : TASK_STACK_SIZES) {
+        if (std::strcmp(task.name, name) == 0) return task.words;
+    }
+    return 0;
+}
+
+#if defined(__arm__)
+
+static uint32_t * msp_bottom()
+{
+    return reinterpret_cast<uint32_t *>(
+        reinterpret_cast<uintptr_t>(&_estack) - reinterpret_cast<uintptr_t>(&_Min_Stack_Size));
+}
+
+static uint32_t msp_size()
+{
+    return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&_Min_Stack_Size));
+}
+
+void msp_paint()
+{
+    // 调度器启动后主栈会被复位到_estack，只有中断使用，SP以上未填充的部分按已用计
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint32_t * limit = reinterpret_cast<uint32_t *>(__get_MSP() - MSP_PAINT_GUARD);
+    for (uint32_t * p = msp_bottom(); p < limit; p++) *p = MSP_PAINT_PATTERN;
+    __set_PRIMASK(primask);
+}
+
+uint32_t msp_free_min()
+{
+    const uint32_t * bottom = msp_bottom();
+    const uint32_t * top = reinterpret_cast<const uint32_t *>(&_estack);
+    const uint32_t * p = bottom;
+    while (p < top && *p == MSP_PAINT_PATTERN) p++;
+    return static_cast<uint32_t>(p - bottom) * sizeof(uint32_t);
+}
+
+#else
+
+void msp_paint() {}
+
+uint32_t msp_free_min() { return 0; }
+
+static uint32_t msp_size() { return 0; }
+
+#endif
+
+static void fill_entry(StackStatEntry & entry, uint8_t kind, uint8_t id, const char * name, uint32_t size, uint32_t free_min)
+{
+    entry.kind = kind;
+    entry.id = id;
+    entry.low = size != 0 && free_min * 100 < size * MEMORY_LOW_MARGIN_PERCENT;
+    entry.size = size;
+    entry.free_min = free_min;
+    std::strncpy(entry.name, name, sizeof(entry.name));
+}
+
+size_t MemoryMonitor::sample(StackStatEntry * entries, size_t max_entries, HeapStat & heap)
+{
+    static TaskStatus_t status[MAX_TASKS];
+    size_t task_count = uxTaskGetSystemState(status, MAX_TASKS, nullptr);
+    float margin = 100.0f;
+    uint8_t low = 0;
+    size_t n = 0;
+
+    // 任务栈：usStackHighWaterMark 即 uxTaskGetStackHighWaterMark()，单位为字
+    for (size_t i = 0; i < task_count && n < max_entries; i++) {
+        uint32_t size = task_stack_words(status[i].pcTaskName) * sizeof(StackType_t);
+        uint32_t free_min = status[i].usStackHighWaterMark * sizeof(StackType_t);
+        StackStatEntry & entry = entries[n++];
+        fill_entry(entry, 0, static_cast<uint8_t>(status[i].xTaskNumber), status[i].pcTaskName, size, free_min);
+        if (size != 0) margin = std::min(margin, 100.0f * free_min / size);
+        low += entry.low;
+    }
+
+    // 主栈
+    if (n < max_entries && msp_size() != 0) {
+        StackStatEntry & entry = entries[n++];
+        fill_entry(entry, 1, 0, "msp", msp_size(), msp_free_min());
+        margin = std::min(margin, 100.0f * entry.free_min / entry.size);
+        low += entry.low;
+    }
+
+    heap.total = configTOTAL_HEAP_SIZE;
+    heap.free = xPortGetFreeHeapSize();
+    heap.free_min = xPortGetMinimumEverFreeHeapSize();
+    heap.low = heap.free_min * 100 < heap.total * MEMORY_LOW_MARGIN_PERCENT;
+
+    stack_margin = margin;
+    heap_free_min = heap.free_min;
+    low_count = low;
+    return n;
+}
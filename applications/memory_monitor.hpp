@@ -0,0 +1,54 @@
+#ifndef MEMORY_MONITOR_HPP
+#define MEMORY_MONITOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// 余量低于该比例的栈/堆置low标志
+constexpr uint32_t MEMORY_LOW_MARGIN_PERCENT = 20;
+
+// 主栈(MSP)填充：调度器启动前在关中断状态下调用，把当前SP以下的主栈区写为填充值
+void msp_paint();
+
+// 主栈历史最小余量 (字节)，从栈底向上找第一个被改写的字
+uint32_t msp_free_min();
+
+// 栈统计条目，kind: 0任务栈 1主栈
+struct __attribute__((packed)) StackStatEntry
+{
+    uint8_t kind;
+    uint8_t id;
+    uint8_t low;         // 余量低于 MEMORY_LOW_MARGIN_PERCENT
+    uint32_t size;       // 栈大小 (字节)，未知为0
+    uint32_t free_min;   // 历史最小余量 (字节)
+    char name[10];
+};
+
+// 堆统计，heap_4
+struct __attribute__((packed)) HeapStat
+{
+    uint32_t total;
+    uint32_t free;
+    uint32_t free_min;   // 历史最小空闲
+    uint8_t low;
+};
+
+// 内存监测：周期性读取各任务栈高水位、主栈高水位和堆空闲量
+class MemoryMonitor
+{
+public:
+    // 监测任务中周期调用，生成栈统计表，返回条目数
+    size_t sample(StackStatEntry * entries, size_t max_entries, HeapStat & heap);
+
+    // 以下供遥测通道读取
+    float stack_margin = 100.0f;   // 所有已知大小的栈中最小余量 %
+    uint32_t heap_free_min = 0;    // 堆历史最小空闲 (字节)
+    uint8_t low_count = 0;         // 余量不足的栈个数
+
+private:
+    static constexpr size_t MAX_TASKS = 16;
+};
+
+extern MemoryMonitor memory_monitor;  // monitor_task.cpp中实例化
+
+#endif // MEMORY_MONITOR_HPP
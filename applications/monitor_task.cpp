@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <cstring>
+
+#include "cmsis_os.h"
+#include "cpu_profiler.hpp"
+#include "memory_monitor.hpp"
+#include "scope_timer.hpp"
+#include "usb_link.hpp"
+
+constexpr uint32_t MONITOR_PERIOD_MS = 1000;
+constexpr size_t CPU_STAT_MAX_ENTRIES = 32;
+constexpr size_t CPU_STAT_HEADER_SIZE = 6;  // stamp u32, first u8, total u8
+constexpr size_t CPU_STATS_PER_FRAME = (USB_FRAME_MAX_PAYLOAD - CPU_STAT_HEADER_SIZE) / sizeof(CpuStatEntry);
+constexpr size_t STACK_STAT_MAX_ENTRIES = 17;  // 任务 + 主栈
+constexpr size_t MEM_STAT_HEADER_SIZE = 6 + sizeof(HeapStat);  // stamp u32, HeapStat, first u8, total u8
+constexpr size_t STACK_STATS_PER_FRAME = (USB_FRAME_MAX_PAYLOAD - MEM_STAT_HEADER_SIZE) / sizeof(StackStatEntry);
+constexpr size_t SCOPE_STAT_MAX_ENTRIES = static_cast<size_t>(ScopeId::COUNT);
+constexpr size_t SCOPE_STAT_HEADER_SIZE = 8;  // stamp u32, cycles_per_us u16, first u8, total u8
+constexpr size_t SCOPE_STATS_PER_FRAME = (USB_FRAME_MAX_PAYLOAD - SCOPE_STAT_HEADER_SIZE) / sizeof(ScopeStatEntry);
+
+CpuProfiler cpu_profiler;
+MemoryMonitor memory_monitor;
+
+// 统计表分多帧上发，first为本帧第一条的序号，total为总条数
+static void send_cpu_stats(uint32_t now_ms, const CpuStatEntry * entries, size_t total)
+{
+    for (size_t first = 0; first < total; first += CPU_STATS_PER_FRAME) {
+        size_t n = std::min(total - first, CPU_STATS_PER_FRAME);
+        uint8_t payload[CPU_STAT_HEADER_SIZE + CPU_STATS_PER_FRAME * sizeof(CpuStatEntry)];
+        std::memcpy(payload, &now_ms, sizeof(now_ms));
+        payload[4] = static_cast<uint8_t>(first);
+        payload[5] = static_cast<uint8_t>(total);
+        std::memcpy(payload + CPU_STAT_HEADER_SIZE, entries + first, n * sizeof(CpuStatEntry));
+        usb_link.send(UsbCmd::CPU_STATS, payload, static_cast<uint8_t>(CPU_STAT_HEADER_SIZE + n * sizeof(CpuStatEntry)));
+    }
+}
+
+// 栈统计表分多帧上发，每帧都带堆统计
+static void send_mem_stats(uint32_t now_ms, const HeapStat & heap, const StackStatEntry * entries, size_t total)
+{
+    for (size_t first = 0; first < total; first += STACK_STATS_PER_FRAME) {
+        size_t n = std::min(total - first, STACK_STATS_PER_FRAME);
+        uint8_t payload[MEM_STAT_HEADER_SIZE + STACK_STATS_PER_FRAME * sizeof(StackStatEntry)];
+        std::memcpy(payload, &now_ms, sizeof(now_ms));
+        std::memcpy(payload + 4, &heap, sizeof(heap));
+        payload[4 + sizeof(heap)] = static_cast<uint8_t>(first);
+        payload[5 + sizeof(heap)] = static_cast<uint8_t>(total);
+        std::memcpy(payload + MEM_STAT_HEADER_SIZE, entries + first, n * sizeof(StackStatEntry));
+        usb_link.send(UsbCmd::MEM_STATS, payload, static_cast<uint8_t>(MEM_STAT_HEADER_SIZE + n * sizeof(StackStatEntry)));
+    }
+}
+
+#if SCOPE_TIMER_ENABLED
+// 分段耗时统计，header中的cycles_per_us供上位机换算为微秒
+static void send_scope_stats(uint32_t now_ms, const ScopeStatEntry * entries, size_t total)
+{
+    uint16_t cycles_per_us = static_cast<uint16_t>(profiler_cycles_per_us());
+    for (size_t first = 0; first < total; first += SCOPE_STATS_PER_FRAME) {
+        size_t n = std::min(total - first, SCOPE_STATS_PER_FRAME);
+        uint8_t payload[SCOPE_STAT_HEADER_SIZE + SCOPE_STATS_PER_FRAME * sizeof(ScopeStatEntry)];
+        std::memcpy(payload, &now_ms, sizeof(now_ms));
+        std::memcpy(payload + 4, &cycles_per_us, sizeof(cycles_per_us));
+        payload[6] = static_cast<uint8_t>(first);
+        payload[7] = static_cast<uint8_t>(total);
+        std::memcpy(payload + SCOPE_STAT_HEADER_SIZE, entries + first, n * sizeof(ScopeStatEntry));
+        usb_link.send(UsbCmd::SCOPE_STATS, payload, static_cast<uint8_t>(SCOPE_STAT_HEADER_SIZE + n * sizeof(ScopeStatEntry)));
+    }
+}
+#endif
+
+// 系统监测任务：低优先级周期统计各任务和中断的CPU占用、截止时间及栈/堆余量
+extern "C" void monitor_task()
+{
+    static CpuStatEntry entries[CPU_STAT_MAX_ENTRIES];
+    static StackStatEntry stack_entries[STACK_STAT_MAX_ENTRIES];
+
+    TickType_t last_wake = xTaskGetTickCount();
+    while (true) {
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(MONITOR_PERIOD_MS));
+
+        size_t n = cpu_profiler.sample(entries, CPU_STAT_MAX_ENTRIES);
+        send_cpu_stats(osKernelSysTick(), entries, n);
+
+        HeapStat heap;
+        size_t stack_n = memory_monitor.sample(stack_entries, STACK_STAT_MAX_ENTRIES, heap);
+        send_mem_stats(osKernelSysTick(), heap, stack_entries, stack_n);
+
+#if SCOPE_TIMER_ENABLED
+        static ScopeStatEntry scope_entries[SCOPE_STAT_MAX_ENTRIES];
+        size_t scope_n = scope_timers_sample(scope_entries, SCOPE_STAT_MAX_ENTRIES);
+        send_scope_stats(osKernelSysTick(), scope_entries, scope_n);
+#endif
+    }
+}
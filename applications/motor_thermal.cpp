@@ -0,0 +1,68 @@
+#include "motor_thermal.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+constexpr float THERMAL_KT = 0.3f;              // M3508输出轴转矩常数 N·m/A
+constexpr float THERMAL_R20 = 0.29f;            // 20°C时的等效绕组电阻 (1.5倍相电阻) Ω
+constexpr float THERMAL_ALPHA_CU = 0.00393f;    // 铜电阻温度系数 1/K
+constexpr float THERMAL_RTH = 2.0f;             // 绕组到环境热阻 K/W
+constexpr float THERMAL_TAU = 300.0f;           // 绕组热时间常数 s
+constexpr float THERMAL_CAPACITY = THERMAL_TAU / THERMAL_RTH;  // 热容 J/K
+constexpr float THERMAL_AMBIENT = 30.0f;        // 假定环境温度，偏差由实测修正吸收 °C
+constexpr float THERMAL_SENSOR_TAU = 20.0f;     // 温度传感器相对绕组的滞后 s
+constexpr float THERMAL_CORRECTION_TAU = 60.0f; // 实测修正模型的时间常数 s
+constexpr float THERMAL_OFFSET_MAX = 15.0f;     // 实测修正量上限 °C
+constexpr float THERMAL_MISMATCH = 15.0f;       // 模型与实测偏差阈值 °C
+constexpr float THERMAL_MISMATCH_TIME = 5.0f;   // 偏差持续该时间判定不一致 s
+constexpr float THERMAL_DERATE_START = 85.0f;   // 开始降额的温度 °C
+constexpr float THERMAL_DERATE_END = 115.0f;    // 降到最低系数的温度 (电调约125°C过温保护) °C
+constexpr float THERMAL_DERATE_MIN = 0.3f;      // 最低力矩上限系数
+
+MotorThermal::MotorThermal(float dt)
+: winding(THERMAL_AMBIENT), sensor(THERMAL_AMBIENT), estimate(THERMAL_AMBIENT), dt_(dt),
+  winding_ol_(THERMAL_AMBIENT), sensor_ol_(THERMAL_AMBIENT)
+{
+}
+
+void MotorThermal::update(float torque, uint8_t reported)
+{
+    bool reported_ok = reported != 0;
+    float measured = static_cast<float>(reported);
+
+    // 上电后以第一帧温度反馈为初值，比环境温度假设更接近重启前的状态
+    if (!initialized_ && reported_ok) {
+        winding_ol_ = measured;
+        sensor_ol_ = measured;
+        initialized_ = true;
+    }
+
+    float current = torque * (1.0f / THERMAL_KT);
+    float resistance = THERMAL_R20 * (1.0f + THERMAL_ALPHA_CU * (winding_ol_ - 20.0f));
+    float heat = current * current * resistance;
+    winding_ol_ += (heat - (winding_ol_ - THERMAL_AMBIENT) * (1.0f / THERMAL_RTH)) * (dt_ / THERMAL_CAPACITY);
+    sensor_ol_ += (winding_ol_ - sensor_ol_) * (dt_ / THERMAL_SENSOR_TAU);
+
+    // 实测与预测的传感器温度之差积累为有界偏置，同时加到绕组和传感器上；
+    // 偏置有界使卡死或掉线的传感器无法把模型拉偏，偏差持续超限时冻结偏置
+    if (reported_ok) {
+        float residual = measured - (sensor_ol_ + offset_);
+        if (std::abs(residual) > THERMAL_MISMATCH) mismatch_time_ += dt_;
+        else mismatch_time_ = 0.0f;
+        mismatch = mismatch_time_ > THERMAL_MISMATCH_TIME;
+        if (!mismatch) {
+            offset_ += residual * (dt_ / THERMAL_CORRECTION_TAU);
+            offset_ = std::max(-THERMAL_OFFSET_MAX, std::min(offset_, THERMAL_OFFSET_MAX));
+        }
+    }
+    winding = winding_ol_ + offset_;
+    sensor = sensor_ol_ + offset_;
+
+    // 按模型与实测中较高者降额 (不一致时开环模型加上偏置上限作为保守值参与取大)，smoothstep曲线使力矩上限连续变化
+    estimate = winding;
+    if (reported_ok) estimate = std::max(estimate, measured);
+    if (mismatch) estimate = std::max(estimate, winding_ol_ + THERMAL_OFFSET_MAX);
+    float x = (estimate - THERMAL_DERATE_START) * (1.0f / (THERMAL_DERATE_END - THERMAL_DERATE_START));
+    x = std::max(0.0f, std::min(x, 1.0f));
+    derate = 1.0f - (1.0f - THERMAL_DERATE_MIN) * x * x * (3.0f - 2.0f * x);
+}
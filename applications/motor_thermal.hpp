@@ -0,0 +1,35 @@
+#ifndef MOTOR_THERMAL_HPP
+#define MOTOR_THERMAL_HPP
+
+#include <cstdint>
+
+// M3508电机热模型与力矩降额
+// 绕组按一阶热路建模：C·dT/dt = I²·R(T) - (T - T_amb)/R_th，电流由反馈力矩折算，
+// 铜阻随温度上升。电调上报的温度传感器相对绕组有明显滞后，
+// 模型同时预测传感器读数，两者之差积累为有界偏置叠加到模型上，吸收环境温度和参数误差；
+// 偏差长时间超出偏置范围说明模型或传感器不可信，冻结偏置并置位mismatch。
+// 按模型与实测中较高者，在降额区间内平滑降低力矩上限，赶在电调过温保护之前
+class MotorThermal
+{
+public:
+    explicit MotorThermal(float dt);
+
+    // torque: 反馈输出轴力矩 N·m；reported: 电调上报温度 °C，0为无效
+    void update(float torque, uint8_t reported);
+
+    float winding = 0.0f;     // 模型绕组温度 °C
+    float sensor = 0.0f;      // 模型预测的传感器温度 °C
+    float estimate = 0.0f;    // 用于降额的温度 °C
+    float derate = 1.0f;      // 力矩上限系数
+    bool mismatch = false;    // 模型与实测偏差持续超限
+
+private:
+    const float dt_;
+    bool initialized_ = false;
+    float winding_ol_;             // 开环模型绕组温度 °C
+    float sensor_ol_;              // 开环模型传感器温度 °C
+    float offset_ = 0.0f;          // 实测修正偏置 °C
+    float mismatch_time_ = 0.0f;
+};
+
+#endif // MOTOR_THERMAL_HPP
@@ -0,0 +1,134 @@
+#include "nav_command.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "cmsis_os.h"
+
+constexpr uint32_t OFFSET_RELAX_PERIOD_MS = 1000; // 每经过该时间时钟偏移最多放松1ms (远大于晶振漂移)
+constexpr float LATENCY_FILTER_ALPHA = 0.05f;     // 延迟估计低通系数
+constexpr uint32_t MIN_SAMPLE_INTERVAL_MS = 1;
+
+NavCommand::NavCommand(uint32_t timeout_ms, float wheel_radius, float half_length, float half_width)
+: timeout_ms_(timeout_ms),
+  forward_(wheel_radius, half_length, half_width)
+{
+}
+
+void NavCommand::on_command(const NavCmdFrame & cmd, uint32_t now_ms, float max_linear_speed, float max_rotation_speed)
+{
+    // 合法性检查
+    bool finite = std::isfinite(cmd.vx) && std::isfinite(cmd.vy) && std::isfinite(cmd.wz);
+    if (!finite || std::abs(cmd.vx) > max_linear_speed || std::abs(cmd.vy) > max_linear_speed ||
+        std::abs(cmd.wz) > max_rotation_speed) {
+        rejected++;
+        return;
+    }
+
+    // 长时间无指令后视为上位机重新连接，重新估计时钟偏移
+    bool session_alive = has_last_ && (now_ms - last_rx_ms_ <= timeout_ms_);
+    if (!session_alive) offset_valid_ = false;
+
+    // 序号检查：重复或乱序的指令丢弃，跳变计入丢失
+    if (session_alive) {
+        int16_t seq_diff = static_cast<int16_t>(cmd.seq - last_seq_);
+        if (seq_diff <= 0) {
+            rejected++;
+            return;
+        }
+        dropped += static_cast<uint32_t>(seq_diff - 1);
+    }
+
+    // 时钟偏移估计：最小的(接收时间-发送时间)对应最快的一次传输
+    int32_t sample = static_cast<int32_t>(now_ms - cmd.stamp_ms);
+    if (!offset_valid_) {
+        offset_ms_ = sample;
+        relax_stamp_ms_ = now_ms;
+        offset_valid_ = true;
+    }
+    else {
+        // 放松量只随本地时间增长，与指令频率无关，否则偏移会紧跟最新一次的传输延迟
+        int32_t relax = static_cast<int32_t>((now_ms - relax_stamp_ms_) / OFFSET_RELAX_PERIOD_MS);
+        relax_stamp_ms_ += static_cast<uint32_t>(relax) * OFFSET_RELAX_PERIOD_MS;
+        offset_ms_ = std::min(offset_ms_ + relax, sample);
+    }
+    latency_ms_ += LATENCY_FILTER_ALPHA * (static_cast<float>(sample - offset_ms_) - latency_ms_);
+
+    Sample next;
+    next.local_ms = cmd.stamp_ms + static_cast<uint32_t>(offset_ms_);
+    next.vx = cmd.vx;
+    next.vy = cmd.vy;
+    next.wz = cmd.wz;
+
+    // 控制任务优先级更高，更新样本时关临界区保证其读到完整的一组数据
+    taskENTER_CRITICAL();
+    prev_ = last_;
+    has_prev_ = session_alive;
+    last_ = next;
+    has_last_ = true;
+    last_rx_ms_ = now_ms;
+    taskEXIT_CRITICAL();
+
+    last_seq_ = cmd.seq;
+    last_pc_stamp_ms_ = cmd.stamp_ms;
+    received++;
+}
+
+bool NavCommand::setpoint(
+    uint32_t now_ms, float max_linear_speed, float max_rotation_speed, float & vx, float & vy,
+    float & wz) const
+{
+    if (!has_last_ || now_ms - last_rx_ms_ > timeout_ms_) return false;
+
+    vx = last_.vx;
+    vy = last_.vy;
+    wz = last_.wz;
+
+    // 最新指令的时刻起，用一个指令间隔从上一条指令过渡到最新指令；k限制在[0, 1]，
+    // 结果不会超出两条指令的范围
+    uint32_t interval = last_.local_ms - prev_.local_ms;
+    if (has_prev_ && interval >= MIN_SAMPLE_INTERVAL_MS && interval <= timeout_ms_) {
+        int32_t ahead = static_cast<int32_t>(now_ms - last_.local_ms);
+        ahead = std::max<int32_t>(std::min<int32_t>(ahead, static_cast<int32_t>(interval)), 0);
+        float k = static_cast<float>(ahead) / static_cast<float>(interval);
+
+        vx = prev_.vx + (last_.vx - prev_.vx) * k;
+        vy = prev_.vy + (last_.vy - prev_.vy) * k;
+        wz = prev_.wz + (last_.wz - prev_.wz) * k;
+    }
+
+    // 在线参数可能在指令接收后调低
+    vx = std::max(std::min(vx, max_linear_speed), -max_linear_speed);
+    vy = std::max(std::min(vy, max_linear_speed), -max_linear_speed);
+    wz = std::max(std::min(wz, max_rotation_speed), -max_rotation_speed);
+    return true;
+}
+
+void NavCommand::update_odometry(
+    float speed_lf, float speed_lr, float speed_rf, float speed_rr, float dt)
+{
+    forward_.calc(speed_lf, speed_lr, speed_rf, speed_rr);
+
+    // 中点法积分
+    float yaw_mid = yaw_ + 0.5f * forward_.wz * dt;
+    float cos_yaw = std::cos(yaw_mid);
+    float sin_yaw = std::sin(yaw_mid);
+    x_ += (forward_.vx * cos_yaw - forward_.vy * sin_yaw) * dt;
+    y_ += (forward_.vx * sin_yaw + forward_.vy * cos_yaw) * dt;
+    yaw_ += forward_.wz * dt;
+}
+
+void NavCommand::fill_odometry(NavOdomFrame & frame, uint32_t now_ms) const
+{
+    frame.stamp_ms = now_ms;
+    frame.cmd_stamp_ms = last_pc_stamp_ms_;
+    frame.cmd_seq = last_seq_;
+    frame.dropped = static_cast<uint16_t>(dropped);
+    frame.latency_ms = latency_ms_;
+    frame.x = x_;
+    frame.y = y_;
+    frame.yaw = yaw_;
+    frame.vx = forward_.vx;
+    frame.vy = forward_.vy;
+    frame.wz = forward_.wz;
+}
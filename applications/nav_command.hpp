@@ -0,0 +1,89 @@
+#ifndef NAV_COMMAND_HPP
+#define NAV_COMMAND_HPP
+
+#include <cstdint>
+
+#include "chassis_kinematics.hpp"
+
+// 上位机(NUC)速度指令，时间戳为上位机时钟 ms
+struct __attribute__((packed)) NavCmdFrame
+{
+    uint32_t stamp_ms;
+    uint16_t seq;
+    float vx;   // m/s
+    float vy;   // m/s
+    float wz;   // rad/s
+};
+
+// 回传里程计，附带最近一条指令的时间戳和序号，供上位机计算端到端延迟
+struct __attribute__((packed)) NavOdomFrame
+{
+    uint32_t stamp_ms;       // 下位机时钟
+    uint32_t cmd_stamp_ms;   // 最近一条有效指令的上位机时间戳
+    uint16_t cmd_seq;        // 最近一条有效指令的序号
+    uint16_t dropped;        // 累计丢失(序号跳变)的指令数
+    float latency_ms;        // 估计的传输延迟抖动 ms
+    float x, y, yaw;         // 里程计位姿 m, m, rad
+    float vx, vy, wz;        // 底盘速度 m/s, m/s, rad/s
+};
+
+// 上位机导航指令接口
+// 指令经过合法性检查后，按估计的时钟偏移映射到本地时间轴，
+// 控制周期中在最近两条指令之间按时间线性插值，把100~500Hz的指令阶跃摊到一个指令间隔内。
+// 插值结果总在两条指令之间，主机给出速度阶跃时不会冲过指令值
+class NavCommand
+{
+public:
+    NavCommand(uint32_t timeout_ms, float wheel_radius, float half_length, float half_width);
+
+    // 收到一条指令 (usb_task中调用)，速度上限取自在线参数
+    void on_command(const NavCmdFrame & cmd, uint32_t now_ms, float max_linear_speed, float max_rotation_speed);
+
+    // 求当前时刻的速度设定，指令超时返回false (控制任务中调用)
+    bool setpoint(
+        uint32_t now_ms, float max_linear_speed, float max_rotation_speed, float & vx, float & vy,
+        float & wz) const;
+
+    // 由轮速更新里程计 (dt: s)
+    void update_odometry(float speed_lf, float speed_lr, float speed_rf, float speed_rr, float dt);
+
+    // 填充里程计回传帧
+    void fill_odometry(NavOdomFrame & frame, uint32_t now_ms) const;
+
+    uint32_t received = 0;    // 收到的有效指令数
+    uint32_t rejected = 0;    // 非法或乱序的指令数
+    uint32_t dropped = 0;     // 序号跳变丢失的指令数
+
+private:
+    struct Sample
+    {
+        uint32_t local_ms;  // 映射到本地时钟的指令时间
+        float vx, vy, wz;
+    };
+
+    const uint32_t timeout_ms_;
+
+    // 最近两条指令，由控制任务读取
+    Sample last_;
+    Sample prev_;
+    uint32_t last_rx_ms_ = 0;
+    bool has_last_ = false;
+    bool has_prev_ = false;
+
+    uint16_t last_seq_ = 0;
+    uint32_t last_pc_stamp_ms_ = 0;
+
+    // 时钟偏移 = min(本地接收时间 - 上位机时间)，按经过的时间缓慢放松以跟随时钟漂移
+    int32_t offset_ms_ = 0;
+    uint32_t relax_stamp_ms_ = 0;
+    bool offset_valid_ = false;
+    float latency_ms_ = 0.0f;
+
+    // 里程计
+    MecanumForward forward_;
+    float x_ = 0.0f, y_ = 0.0f, yaw_ = 0.0f;
+};
+
+extern NavCommand nav_command;  // usb_task.cpp中实例化
+
+#endif // NAV_COMMAND_HPP
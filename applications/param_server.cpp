@@ -0,0 +1,116 @@
+#include "param_server.hpp"
+
+#include <cmath>
+#include <cstring>
+
+#include "cmsis_os.h"
+
+// 参数表，参数号即表中下标，新参数只追加在末尾
+static const ParamInfo PARAM_TABLE[] = {
+    {"pid_kp", ParamType::F32, offsetof(ChassisParams, pid_kp), 0.0f, 10.0f},
+    {"pid_ki", ParamType::F32, offsetof(ChassisParams, pid_ki), 0.0f, 10.0f},
+    {"pid_kd", ParamType::F32, offsetof(ChassisParams, pid_kd), 0.0f, 1.0f},
+    {"pid_mo", ParamType::F32, offsetof(ChassisParams, pid_mo), 0.0f, 8.0f},
+    {"pid_mio", ParamType::F32, offsetof(ChassisParams, pid_mio), 0.0f, 8.0f},
+    {"k1_torque_loss", ParamType::F32, offsetof(ChassisParams, k1_torque_loss), 0.0f, 20.0f},
+    {"k2_speed_loss", ParamType::F32, offsetof(ChassisParams, k2_speed_loss), 0.0f, 1.0f},
+    {"k3_static_power", ParamType::F32, offsetof(ChassisParams, k3_static_power), 0.0f, 50.0f},
+    {"k4_torque_rate", ParamType::F32, offsetof(ChassisParams, k4_torque_rate), 0.0f, 1.0f},
+    {"k5_speed_rate", ParamType::F32, offsetof(ChassisParams, k5_speed_rate), 0.0f, 1.0f},
+    {"max_linear_speed", ParamType::F32, offsetof(ChassisParams, max_linear_speed), 0.0f, 3.5f},
+    {"rotation_speed", ParamType::F32, offsetof(ChassisParams, rotation_speed), 0.0f, 20.0f},
+    {"ff_inertia", ParamType::F32, offsetof(ChassisParams, ff_inertia), 0.0f, 0.5f},
+    {"ff_viscous", ParamType::F32, offsetof(ChassisParams, ff_viscous), 0.0f, 0.5f},
+    {"ff_coulomb", ParamType::F32, offsetof(ChassisParams, ff_coulomb), 0.0f, 2.0f},
+    {"cap_energy_scale", ParamType::F32, offsetof(ChassisParams, cap_energy_scale), 1.0f, 65535.0f},
+    {"field_phase_lead", ParamType::F32, offsetof(ChassisParams, field_phase_lead), 0.0f, 0.1f},
+};
+
+constexpr size_t PARAM_COUNT = sizeof(PARAM_TABLE) / sizeof(PARAM_TABLE[0]);
+static_assert(PARAM_COUNT * sizeof(uint32_t) == sizeof(ChassisParams), "param table out of sync");
+
+ParamServer::ParamServer(const ChassisParams & defaults)
+{
+    blocks_[0] = defaults;
+    blocks_[1] = defaults;
+}
+
+bool ParamServer::update()
+{
+    if (!pending_.load(std::memory_order_acquire)) return false;
+
+    active_.store(active_.load(std::memory_order_relaxed) ^ 1, std::memory_order_relaxed);
+    pending_.store(false, std::memory_order_release);
+    return true;
+}
+
+size_t ParamServer::count() const { return PARAM_COUNT; }
+
+const ParamInfo & ParamServer::info(size_t id) const { return PARAM_TABLE[id]; }
+
+uint32_t ParamServer::get(size_t id) const
+{
+    uint32_t value;
+    std::memcpy(&value, reinterpret_cast<const uint8_t *>(&active()) + PARAM_TABLE[id].offset, sizeof(value));
+    return value;
+}
+
+bool ParamServer::valid(size_t id, uint32_t value) const
+{
+    if (id >= PARAM_COUNT) return false;
+
+    const ParamInfo & info = PARAM_TABLE[id];
+    if (info.type == ParamType::U32) {
+        return value >= info.min && value <= info.max;
+    }
+
+    float f;
+    std::memcpy(&f, &value, sizeof(f));
+    return std::isfinite(f) && f >= info.min && f <= info.max;
+}
+
+// 读-改-发布在临界区内完成：先确认上一次更新已被取走，再以当前块为基础修改备用块。
+// 否则在pending期间读到的"当前块"切换后就成了旧值，写回会覆盖掉尚未生效的那次修改；
+// USB任务和控制任务 (辨识结果写回) 都会调用，临界区同时排除两个写者交错
+ParamStatus ParamServer::set(const ParamEntry * entries, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        if (!valid(entries[i].id, entries[i].value)) return ParamStatus::INVALID;
+    }
+
+    taskENTER_CRITICAL();
+    if (pending_.load(std::memory_order_acquire)) {
+        taskEXIT_CRITICAL();
+        return ParamStatus::BUSY;
+    }
+    uint8_t active = active_.load(std::memory_order_relaxed);
+    ChassisParams & next = blocks_[active ^ 1];
+    next = blocks_[active];
+    for (size_t i = 0; i < n; i++) {
+        uint32_t value = entries[i].value;
+        std::memcpy(reinterpret_cast<uint8_t *>(&next) + PARAM_TABLE[entries[i].id].offset, &value, sizeof(value));
+    }
+    pending_.store(true, std::memory_order_release);
+    taskEXIT_CRITICAL();
+    return ParamStatus::OK;
+}
+
+ParamStatus ParamServer::publish(const ChassisParams & next)
+{
+    for (size_t id = 0; id < PARAM_COUNT; id++) {
+        uint32_t value;
+        std::memcpy(&value, reinterpret_cast<const uint8_t *>(&next) + PARAM_TABLE[id].offset, sizeof(value));
+        if (!valid(id, value)) return ParamStatus::INVALID;
+    }
+
+    // 控制任务切换前不能改写备用块
+    taskENTER_CRITICAL();
+    if (pending_.load(std::memory_order_acquire)) {
+        taskEXIT_CRITICAL();
+        return ParamStatus::BUSY;
+    }
+    blocks_[active_.load(std::memory_order_relaxed) ^ 1] = next;
+    pending_.store(true, std::memory_order_release);
+    taskEXIT_CRITICAL();
+    return ParamStatus::OK;
+}
@@ -0,0 +1,109 @@
+#ifndef PARAM_SERVER_HPP
+#define PARAM_SERVER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// 可在线调整的底盘参数块，默认值为chassis_control.hpp中的常量
+struct ChassisParams
+{
+    // 轮速环PID
+    float pid_kp;
+    float pid_ki;
+    float pid_kd;
+    float pid_mo;
+    float pid_mio;
+
+    // 功率模型
+    float k1_torque_loss;
+    float k2_speed_loss;
+    float k3_static_power;
+    float k4_torque_rate;
+    float k5_speed_rate;
+
+    // 速度上限
+    float max_linear_speed;
+    float rotation_speed;
+
+    // 轮速前馈
+    float ff_inertia;
+    float ff_viscous;
+    float ff_coulomb;
+
+    // 超级电容
+    float cap_energy_scale;  // 电容板剩余能量读数的满量程
+
+    // 小陀螺
+    float field_phase_lead;  // 场定向的执行延迟补偿 s
+};
+
+// 参数数据类型
+enum class ParamType : uint8_t
+{
+    F32,
+    U32,
+};
+
+// 参数描述：名称 + 类型 + 在参数块中的偏移 + 取值范围
+struct ParamInfo
+{
+    const char * name;
+    ParamType type;
+    uint16_t offset;
+    float min;
+    float max;
+};
+
+enum class ParamStatus : uint8_t
+{
+    OK,
+    INVALID,        // 参数号不存在或超出范围，整批不生效
+    BUSY,           // 上一次更新尚未被控制任务取走
+    LOCKED,         // 底盘未释放，拒绝写flash
+    STORAGE_ERROR,  // flash擦写失败
+};
+
+// 批量读写时的单个参数，value为参数的原始4字节
+struct __attribute__((packed)) ParamEntry
+{
+    uint8_t id;
+    uint32_t value;
+};
+
+// 参数服务器
+// 双缓冲参数块：控制任务只读当前块，USB任务把修改写入另一块后置位pending，
+// 控制任务在下一个周期开始时切换，因此一个控制周期内看到的参数始终是同一组，热路径上无锁；
+// 写入端在短临界区内完成读-改-发布，上一次修改未生效时返回BUSY
+class ParamServer
+{
+public:
+    explicit ParamServer(const ChassisParams & defaults);
+
+    // 控制任务每周期开始时调用，切换到新参数块时返回true
+    bool update();
+
+    // 控制任务当前使用的参数
+    const ChassisParams & active() const { return blocks_[active_.load(std::memory_order_relaxed)]; }
+
+    // 以下在USB任务中调用
+    size_t count() const;
+    const ParamInfo & info(size_t id) const;
+    uint32_t get(size_t id) const;
+    bool valid(size_t id, uint32_t value) const;
+
+    // 批量修改，全部校验通过后整批发布
+    ParamStatus set(const ParamEntry * entries, size_t n);
+
+    // 整块发布，逐项校验范围
+    ParamStatus publish(const ChassisParams & next);
+
+private:
+    ChassisParams blocks_[2];
+    std::atomic<uint8_t> active_{0};
+    std::atomic<bool> pending_{false};
+};
+
+extern ParamServer param_server;  // chassis_control_task.cpp中实例化
+
+#endif // PARAM_SERVER_HPP
@@ -0,0 +1,268 @@
+#include "param_store.hpp"
+
+#include "crc.h"
+
+constexpr uint32_t HEADER_MAGIC = 0x314D5250;  // "PRM1"
+constexpr uint32_t RECORD_TAG = 0xA55A0000;    // 记录首字高16位，低16位为key
+constexpr uint16_t KEY_MASK_KEY = 0xFFFF;      // 快照第一条：扇区中出现的key
+constexpr uint16_t APPENDED_KEY = 0xFFFE;      // 快照第二条：值字按位清零记下压缩后追加过的key，不带crc
+constexpr uint32_t SNAPSHOT_START = 2;         // 快照中第一个key的序号
+constexpr uint32_t WORD_BLANK = 0xFFFFFFFF;
+constexpr uint32_t HEADER_SIZE = 12;           // magic, generation, crc
+constexpr uint32_t RECORD_SIZE = 12;           // tag|key, value, crc
+constexpr uint32_t RECORD_CAPACITY = (PARAM_STORE_SECTOR_SIZE - HEADER_SIZE) / RECORD_SIZE;
+
+static inline uint32_t read_word(uint32_t addr)
+{
+    return *reinterpret_cast<const volatile uint32_t *>(addr);
+}
+
+static inline uint32_t record_addr(uint32_t sector_addr, uint32_t index)
+{
+    return sector_addr + HEADER_SIZE + index * RECORD_SIZE;
+}
+
+static inline uint32_t other_sector(uint32_t sector_addr)
+{
+    return (sector_addr == PARAM_STORE_SECTOR_A_ADDR) ? PARAM_STORE_SECTOR_B_ADDR : PARAM_STORE_SECTOR_A_ADDR;
+}
+
+// 硬件CRC32，只在USB任务和上电载入时使用
+static uint32_t crc32_words(uint32_t word0, uint32_t word1)
+{
+    uint32_t words[2] = {word0, word1};
+    return HAL_CRC_Calculate(&hcrc, words, 2);
+}
+
+ParamStore::ParamStore() {}
+
+bool ParamStore::header_valid(uint32_t sector_addr, uint32_t & generation) const
+{
+    uint32_t magic = read_word(sector_addr);
+    if (magic != HEADER_MAGIC) return false;
+    generation = read_word(sector_addr + 4);
+    return read_word(sector_addr + 8) == crc32_words(magic, generation);
+}
+
+bool ParamStore::record_valid(uint32_t sector_addr, uint32_t index, uint16_t & key, uint32_t & value) const
+{
+    uint32_t addr = record_addr(sector_addr, index);
+    uint32_t tag = read_word(addr);
+    if ((tag & 0xFFFF0000) != RECORD_TAG) return false;
+    value = read_word(addr + 4);
+    if (read_word(addr + 8) != crc32_words(tag, value)) return false;
+    key = static_cast<uint16_t>(tag);
+    return true;
+}
+
+bool ParamStore::record_blank(uint32_t sector_addr, uint32_t index) const
+{
+    uint32_t addr = record_addr(sector_addr, index);
+    return read_word(addr) == WORD_BLANK && read_word(addr + 4) == WORD_BLANK &&
+           read_word(addr + 8) == WORD_BLANK;
+}
+
+// 记录只追加，空白区一定是日志的后缀，二分查找第一条空白记录
+uint32_t ParamStore::find_end(uint32_t sector_addr) const
+{
+    uint32_t lo = 0;
+    uint32_t hi = RECORD_CAPACITY;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (record_blank(sector_addr, mid)) {
+            hi = mid;
+        }
+        else {
+            lo = mid + 1;
+        }
+    }
+    return lo;
+}
+
+void ParamStore::init()
+{
+    uint32_t gen_a = 0, gen_b = 0;
+    bool valid_a = header_valid(PARAM_STORE_SECTOR_A_ADDR, gen_a);
+    bool valid_b = header_valid(PARAM_STORE_SECTOR_B_ADDR, gen_b);
+
+    // 两个扇区都有效说明压缩后旧扇区尚未擦除，以代数大的为准
+    if (valid_a && (!valid_b || static_cast<int32_t>(gen_a - gen_b) > 0)) {
+        active_addr_ = PARAM_STORE_SECTOR_A_ADDR;
+        generation_ = gen_a;
+    }
+    else if (valid_b) {
+        active_addr_ = PARAM_STORE_SECTOR_B_ADDR;
+        generation_ = gen_b;
+    }
+    else {
+        active_addr_ = 0;
+        generation_ = 0;
+        end_ = 0;
+        key_mask_ = 0;
+        appended_ = 0;
+        base_ = 0;
+        return;
+    }
+    end_ = find_end(active_addr_);
+
+    // 旧版本写入的扇区没有快照，按所有key都可能出现处理，下次保存时压缩
+    uint16_t key;
+    uint32_t mask;
+    if (record_valid(active_addr_, 0, key, mask) && key == KEY_MASK_KEY) {
+        uint32_t addr = record_addr(active_addr_, 1);
+        key_mask_ = mask;
+        appended_ = (read_word(addr) == (RECORD_TAG | APPENDED_KEY)) ? ~read_word(addr + 4) : 0xFFFFFFFF;
+        base_ = SNAPSHOT_START + __builtin_popcount(mask);
+    }
+    else {
+        key_mask_ = 0xFFFFFFFF;
+        appended_ = 0xFFFFFFFF;
+        base_ = 0;
+    }
+}
+
+uint32_t ParamStore::load(uint32_t * values, size_t count) const
+{
+    if (active_addr_ == 0) return 0;
+    if (count > PARAM_STORE_MAX_KEYS) count = PARAM_STORE_MAX_KEYS;
+
+    // 日志中只找压缩后追加过的key，其余直接读快照
+    uint32_t wanted = key_mask_ & ((count == 32) ? 0xFFFFFFFF : ((1u << count) - 1));
+    uint32_t scan = wanted & appended_;
+    uint32_t found = 0;
+    for (uint32_t index = end_; index-- > base_ && (found & scan) != scan;) {
+        uint16_t key;
+        uint32_t value;
+        if (!record_valid(active_addr_, index, key, value)) continue;
+        if (key >= count || (found & (1u << key))) continue;
+        values[key] = value;
+        found |= 1u << key;
+    }
+
+    // 快照中第n个key是掩码中第n个key
+    for (uint32_t rest = wanted & ~found; rest != 0 && base_ != 0; rest &= rest - 1) {
+        uint32_t want = __builtin_ctz(rest);
+        uint32_t index = SNAPSHOT_START + __builtin_popcount(key_mask_ & ((1u << want) - 1));
+        uint16_t key;
+        uint32_t value;
+        if (!record_valid(active_addr_, index, key, value) || key != want) continue;
+        values[key] = value;
+        found |= 1u << key;
+    }
+    return found;
+}
+
+bool ParamStore::program_record(uint32_t sector_addr, uint32_t index, uint16_t key, uint32_t value)
+{
+    uint32_t addr = record_addr(sector_addr, index);
+    uint32_t tag = RECORD_TAG | key;
+    uint32_t crc = crc32_words(tag, value);
+    return HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, addr, tag) == HAL_OK &&
+           HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, addr + 4, value) == HAL_OK &&
+           HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, addr + 8, crc) == HAL_OK;
+}
+
+// 擦除扇区，写入快照 (key掩码、追加标记和mask中各key的值)，最后写扇区头使其生效
+bool ParamStore::format(uint32_t sector_addr, uint32_t generation, const uint32_t * values, uint32_t mask)
+{
+    FLASH_EraseInitTypeDef erase;
+    erase.TypeErase = FLASH_TYPEERASE_SECTORS;
+    erase.Banks = FLASH_BANK_1;
+    erase.Sector = (sector_addr == PARAM_STORE_SECTOR_A_ADDR) ? FLASH_SECTOR_10 : FLASH_SECTOR_11;
+    erase.NbSectors = 1;
+    erase.VoltageRange = FLASH_VOLTAGE_RANGE_3;
+    uint32_t sector_error;
+    if (HAL_FLASHEx_Erase(&erase, &sector_error) != HAL_OK) return false;
+
+    if (!program_record(sector_addr, 0, KEY_MASK_KEY, mask)) return false;
+    // 追加标记只写首字，值字保持全1即压缩后没有追加过
+    uint32_t marker = record_addr(sector_addr, 1);
+    if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, marker, RECORD_TAG | APPENDED_KEY) != HAL_OK) return false;
+    uint32_t index = SNAPSHOT_START;
+    for (uint16_t key = 0; key < PARAM_STORE_MAX_KEYS; key++) {
+        if (!(mask & (1u << key))) continue;
+        if (!program_record(sector_addr, index++, key, values[key])) return false;
+    }
+
+    uint32_t crc = crc32_words(HEADER_MAGIC, generation);
+    if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, sector_addr + 4, generation) != HAL_OK ||
+        HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, sector_addr + 8, crc) != HAL_OK ||
+        HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, sector_addr, HEADER_MAGIC) != HAL_OK) {
+        return false;
+    }
+
+    active_addr_ = sector_addr;
+    generation_ = generation;
+    end_ = index;
+    key_mask_ = mask;
+    appended_ = 0;
+    base_ = index;
+    return true;
+}
+
+// 压缩：各key最新值连同changed中的新值搬到另一扇区
+bool ParamStore::compact(const uint32_t * values, uint32_t changed)
+{
+    uint32_t latest[PARAM_STORE_MAX_KEYS];
+    uint32_t mask = load(latest, PARAM_STORE_MAX_KEYS);
+    for (uint32_t rest = changed; rest != 0; rest &= rest - 1) {
+        uint32_t key = __builtin_ctz(rest);
+        latest[key] = values[key];
+    }
+    uint32_t target = (active_addr_ == 0) ? PARAM_STORE_SECTOR_A_ADDR : other_sector(active_addr_);
+    return format(target, generation_ + 1, latest, mask | changed);
+}
+
+bool ParamStore::append(uint16_t key, uint32_t value)
+{
+    if (end_ >= RECORD_CAPACITY) {
+        uint32_t values[PARAM_STORE_MAX_KEYS];
+        values[key] = value;
+        return compact(values, 1u << key);
+    }
+
+    // 先在快照中记下这个key再追加，掉电时最多让载入多扫描一段
+    if (!(appended_ & (1u << key))) {
+        uint32_t marked = appended_ | (1u << key);
+        uint32_t addr = record_addr(active_addr_, 1) + 4;
+        if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, addr, ~marked) != HAL_OK) return false;
+        appended_ = marked;
+    }
+
+    if (!program_record(active_addr_, end_, key, value)) {
+        // 写坏的记录由crc识别，跳过该位置
+        end_++;
+        return false;
+    }
+    end_++;
+    return true;
+}
+
+bool ParamStore::save(const uint32_t * values, size_t count)
+{
+    if (count > PARAM_STORE_MAX_KEYS) return false;
+
+    uint32_t stored[PARAM_STORE_MAX_KEYS];
+    uint32_t found = load(stored, count);
+    uint32_t changed = 0;
+    for (uint16_t key = 0; key < count; key++) {
+        if (!(found & (1u << key)) || stored[key] != values[key]) changed |= 1u << key;
+    }
+    if (changed == 0) return true;
+
+    HAL_FLASH_Unlock();
+    bool ok = true;
+    if (base_ == 0 || (changed & ~key_mask_)) {
+        // 首次保存的key经一次压缩写入快照，保证扇区中出现的key都在掩码中；
+        // 空扇区和旧版本写入的扇区也在这里换成带快照的格式
+        ok = compact(values, changed);
+    }
+    else {
+        for (uint32_t rest = changed; rest != 0 && ok; rest &= rest - 1) {
+            uint16_t key = static_cast<uint16_t>(__builtin_ctz(rest));
+            ok = append(key, values[key]);
+        }
+    }
+    HAL_FLASH_Lock();
+    return ok;
+}
@@ -0,0 +1,60 @@
+#ifndef PARAM_STORE_HPP
+#define PARAM_STORE_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// 参数存储使用flash最后两个128KB扇区 (链接脚本中已从FLASH区域划出)
+constexpr uint32_t PARAM_STORE_SECTOR_A_ADDR = 0x080C0000;  // FLASH_SECTOR_10
+constexpr uint32_t PARAM_STORE_SECTOR_B_ADDR = 0x080E0000;  // FLASH_SECTOR_11
+constexpr uint32_t PARAM_STORE_SECTOR_SIZE = 128 * 1024;
+constexpr size_t PARAM_STORE_MAX_KEYS = 32;
+
+// flash键值存储
+// 日志结构：每次写入在当前扇区末尾追加一条 [key][value][crc32] 记录，同一key以最后一条为准，
+// 写满后把每个key的最新值搬到另一扇区 (压缩)，最后写入代数更大的扇区头完成切换，
+// 两个扇区交替擦写实现磨损均衡。任意时刻掉电，旧扇区或未写完的记录都能被crc识别
+// 压缩写入的扇区开头是快照：key掩码、压缩后追加过的key (按位清零记录)、按key顺序排列的各key的值。
+// 扇区中出现的key都在掩码中，首次保存的key也经一次压缩加入快照。
+// 载入时只为压缩后追加过的key从日志末尾向前扫描，最多到快照为止，其余key按下标直接读快照；
+// 从未保存过的key不在掩码中，不引起扫描
+class ParamStore
+{
+public:
+    ParamStore();
+
+    // 查找有效扇区和日志末尾，上电时调用一次
+    void init();
+
+    // 读取所有已保存的key，values按key下标存放，返回已找到的key掩码
+    uint32_t load(uint32_t * values, size_t count) const;
+
+    // 保存与已存值不同的key，返回是否成功
+    // 擦写期间CPU取指暂停，只能在电机释放时调用
+    bool save(const uint32_t * values, size_t count);
+
+    uint32_t generation() const { return generation_; }
+    uint32_t used_records() const { return end_; }
+
+private:
+    uint32_t active_addr_ = 0;  // 0为尚无有效扇区
+    uint32_t generation_ = 0;
+    uint32_t end_ = 0;          // 下一条记录的序号
+    uint32_t key_mask_ = 0;     // 扇区中出现过的key
+    uint32_t appended_ = 0;     // 压缩后追加过记录的key
+    uint32_t base_ = 0;         // 快照之后第一条记录的序号，0为没有快照 (空扇区或旧版本写入的扇区)
+
+    bool header_valid(uint32_t sector_addr, uint32_t & generation) const;
+    bool record_valid(uint32_t sector_addr, uint32_t index, uint16_t & key, uint32_t & value) const;
+    bool record_blank(uint32_t sector_addr, uint32_t index) const;
+    uint32_t find_end(uint32_t sector_addr) const;
+
+    bool format(uint32_t sector_addr, uint32_t generation, const uint32_t * values, uint32_t mask);
+    bool compact(const uint32_t * values, uint32_t changed);
+    bool append(uint16_t key, uint32_t value);
+    bool program_record(uint32_t sector_addr, uint32_t index, uint16_t key, uint32_t value);
+};
+
+extern ParamStore param_store;  // chassis_control_task.cpp中实例化
+
+#endif // PARAM_STORE_HPP
@@ -1,23 +1,135 @@
-#include <cstdio>
+#include <algorithm>
 #include <cstring>
 
 #include "chassis_control.hpp"
 #include "cmsis_os.h"
-#include "io/plotter/plotter.hpp"
+#include "cpu_profiler.hpp"
+#include "memory_monitor.hpp"
+#include "telemetry.hpp"
 #include "usart.h"
+#include "usb_link.hpp"
 
-sp::Plotter plotter(&huart1);
+constexpr uint32_t TELEMETRY_PERIOD_MS = 1;
+constexpr uint16_t POWER_PLOT_DECIMATION = 10;  // 功率曲线保持原来的100Hz
+constexpr uint16_t MONITOR_PLOT_DECIMATION = 1000;  // 系统监测数据每秒更新一次
+constexpr size_t CHANNEL_NAME_MAX = 24;
+
+// 各类通道的量化步长
+constexpr float POWER_QUANTUM = 0.01f;   // W
+constexpr float SPEED_QUANTUM = 0.01f;   // m/s, rad/s
+constexpr float TORQUE_QUANTUM = 0.001f; // N·m
+constexpr float SCALE_QUANTUM = 0.001f;
+
+Telemetry telemetry(&huart1);
 extern sp::PM02 pm02;  // uart_task.cpp中实例化
 
-// 数据可视化任务
+// 注册失败 (通道表已满) 时add返回-1，不能用于移位
+static void select_default(uint32_t & mask, int id)
+{
+    if (id >= 0) mask |= 1u << id;
+}
+
+// 注册底盘相关遥测通道
+// 通道表共TELEMETRY_MAX_CHANNELS个，留出余量给调试时临时加的通道；
+// 可由其它通道推出的量 (实际功率、各轮速度设定) 不单独注册，USB状态流中仍有各轮设定值
+static void register_chassis_channels()
+{
+    // 默认发送的功率曲线
+    uint32_t mask = 0;
+    select_default(mask, telemetry.add("power_limit", &chassis_data.chassis_power_limit, POWER_PLOT_DECIMATION));
+    select_default(mask, telemetry.add("power_in", &chassis_data.power_in, POWER_PLOT_DECIMATION, POWER_QUANTUM));
+    select_default(mask, telemetry.add("predicted_power", &chassis_data.predicted_power, POWER_PLOT_DECIMATION, POWER_QUANTUM));
+    select_default(mask, telemetry.add("buffer_energy", &pm02.power_heat.buffer_energy, POWER_PLOT_DECIMATION));
+
+    telemetry.add("power_out", &chassis_data.power_out, 1, POWER_QUANTUM);
+    telemetry.add("scale_factor", &chassis_data.power_scale_factor, 1, SCALE_QUANTUM);
+    telemetry.add("limit_active", &chassis_data.power_limit_active);
+    telemetry.add("accel_scale", &chassis_data.accel_scale, 1, SCALE_QUANTUM);
+    telemetry.add("traction", &chassis_data.traction_gain, 1, SCALE_QUANTUM);
+
+    telemetry.add("vx_set", &chassis_data.vx_set, 1, SPEED_QUANTUM);
+    telemetry.add("vy_set", &chassis_data.vy_set, 1, SPEED_QUANTUM);
+    telemetry.add("wz_set", &chassis_data.wz_set, 1, SPEED_QUANTUM);
+    telemetry.add("vx_est", &chassis_data.vx_est, 1, SPEED_QUANTUM);
+    telemetry.add("vy_est", &chassis_data.vy_est, 1, SPEED_QUANTUM);
+    telemetry.add("yaw_rate", &chassis_data.yaw_rate, 1, SPEED_QUANTUM);
+
+    telemetry.add("speed_lf", &chassis_lf.speed, 1, SPEED_QUANTUM);
+    telemetry.add("speed_lr", &chassis_lr.speed, 1, SPEED_QUANTUM);
+    telemetry.add("speed_rf", &chassis_rf.speed, 1, SPEED_QUANTUM);
+    telemetry.add("speed_rr", &chassis_rr.speed, 1, SPEED_QUANTUM);
+
+    telemetry.add("torque_lf", &chassis_data.torque_lf, 1, TORQUE_QUANTUM);
+    telemetry.add("torque_lr", &chassis_data.torque_lr, 1, TORQUE_QUANTUM);
+    telemetry.add("torque_rf", &chassis_data.torque_rf, 1, TORQUE_QUANTUM);
+    telemetry.add("torque_rr", &chassis_data.torque_rr, 1, TORQUE_QUANTUM);
+
+    telemetry.select(mask);
+}
+
+// 注册系统监测通道
+static void register_system_channels()
+{
+    telemetry.add("cpu_load", &cpu_profiler.cpu_load, MONITOR_PLOT_DECIMATION, 0.01f);
+    telemetry.add("stack_margin", &memory_monitor.stack_margin, MONITOR_PLOT_DECIMATION, 0.1f);
+    telemetry.add("heap_min", &memory_monitor.heap_free_min, MONITOR_PLOT_DECIMATION, 1.0f);
+    telemetry.add("mem_low", &memory_monitor.low_count, MONITOR_PLOT_DECIMATION, 1.0f);
+}
+
+// 运行时选择遥测通道
+static void on_telemetry_select(const uint8_t * payload, uint8_t len)
+{
+    if (len != sizeof(uint32_t)) return;
+    uint32_t mask;
+    std::memcpy(&mask, payload, sizeof(mask));
+    telemetry.select(mask);
+}
+
+// 运行时切换遥测格式
+static void on_telemetry_format(const uint8_t * payload, uint8_t len)
+{
+    if (len != 1 || payload[0] > static_cast<uint8_t>(TelemetryFormat::JUSTFLOAT)) return;
+    telemetry.set_format(static_cast<TelemetryFormat>(payload[0]));
+}
+
+// 回传通道列表，上位机据此解析遥测帧。通道数多于发送队列槽位，从请求的起始序号起分页回复
+static void on_telemetry_list(const uint8_t * request, uint8_t len)
+{
+    size_t count = telemetry.channel_count();
+    size_t id = (len >= 1) ? request[0] : 0;
+    uint32_t budget = usb_link.reply_budget();
+    for (; id < count && budget > 0; id++, budget--) {
+        const TelemetryChannel & channel = telemetry.channel(id);
+        uint8_t payload[8 + CHANNEL_NAME_MAX];
+        payload[0] = static_cast<uint8_t>(id);
+        payload[1] = static_cast<uint8_t>(channel.type);
+        std::memcpy(payload + 2, &channel.decimation, sizeof(channel.decimation));
+        std::memcpy(payload + 4, &channel.quantum, sizeof(channel.quantum));
+
+        size_t name_len = std::min(std::strlen(channel.name), CHANNEL_NAME_MAX);
+        std::memcpy(payload + 8, channel.name, name_len);
+        usb_link.send(UsbCmd::TELEMETRY_CHANNEL, payload, static_cast<uint8_t>(8 + name_len));
+    }
+    if (id >= count && budget > 0) {
+        uint8_t total = static_cast<uint8_t>(count);
+        usb_link.send(UsbCmd::TELEMETRY_CHANNEL, &total, sizeof(total));
+    }
+}
+
+// 遥测任务：低优先级周期采样，DMA非阻塞发送
 extern "C" void plot_task()
 {
-  while (true) {
-    plotter.plot(
-      chassis_data.chassis_power_limit, chassis_data.power_in, predict_power_consumption(),
-      // super_cap.cap_energy
-      pm02.power_heat.buffer_energy);
-
-    osDelay(10);
-  }
-}
\ No newline at end of file
+    register_chassis_channels();
+    register_system_channels();
+    usb_link.register_handler(UsbCmd::TELEMETRY_SELECT, on_telemetry_select);
+    usb_link.register_handler(UsbCmd::TELEMETRY_LIST, on_telemetry_list);
+    usb_link.register_handler(UsbCmd::TELEMETRY_FORMAT, on_telemetry_format);
+
+    TickType_t last_wake = xTaskGetTickCount();
+    while (true) {
+        telemetry.sample(osKernelSysTick());
+        telemetry.flush();
+
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(TELEMETRY_PERIOD_MS));
+    }
+}
@@ -0,0 +1,61 @@
+#include "scope_timer.hpp"
+
+#include <cstring>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+constexpr size_t SCOPE_COUNT = static_cast<size_t>(ScopeId::COUNT);
+
+ScopeHistogram scope_histograms[SCOPE_COUNT] __attribute__((section(".ccmbss")));
+
+static const char * const SCOPE_NAMES[] = {
+    "kinemat", "pid", "pwr_data", "pwr_lim", "cmd", "can_isr", "uart_isr", "imu_isr", "imu_filt",
+};
+static_assert(sizeof(SCOPE_NAMES) / sizeof(SCOPE_NAMES[0]) == SCOPE_COUNT, "scope name table");
+
+void scope_timers_init()
+{
+    std::memset(scope_histograms, 0, sizeof(scope_histograms));
+}
+
+// 分位数：在累计次数越过目标的桶内按线性分布插值
+static uint32_t percentile(const ScopeHistogram & hist, uint32_t permille)
+{
+    if (hist.count == 0) return 0;
+
+    uint64_t target = (static_cast<uint64_t>(hist.count) * permille + 999) / 1000;
+    uint64_t seen = 0;
+    for (size_t k = 0; k < SCOPE_HIST_BUCKETS; k++) {
+        uint32_t n = hist.buckets[k];
+        if (seen + n >= target) {
+            uint64_t low = 1ull << k;
+            uint64_t value = low + low * (target - seen) / n;
+            return static_cast<uint32_t>(value < hist.max ? value : hist.max);
+        }
+        seen += n;
+    }
+    return hist.max;
+}
+
+size_t scope_timers_sample(ScopeStatEntry * entries, size_t max_entries)
+{
+    size_t n = 0;
+    for (size_t id = 0; id < SCOPE_COUNT && n < max_entries; id++) {
+        // 中断中的计时点也会被关中断挡住，拷贝期间直方图不变
+        ScopeHistogram hist;
+        taskENTER_CRITICAL();
+        hist = scope_histograms[id];
+        std::memset(&scope_histograms[id], 0, sizeof(ScopeHistogram));
+        taskEXIT_CRITICAL();
+
+        ScopeStatEntry & entry = entries[n++];
+        entry.id = static_cast<uint8_t>(id);
+        entry.count = hist.count;
+        entry.p50 = percentile(hist, 500);
+        entry.p99 = percentile(hist, 990);
+        entry.max = hist.max;
+        std::strncpy(entry.name, SCOPE_NAMES[id], sizeof(entry.name));
+    }
+    return n;
+}
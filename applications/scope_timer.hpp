@@ -0,0 +1,88 @@
+#ifndef SCOPE_TIMER_HPP
+#define SCOPE_TIMER_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include "cpu_profiler.hpp"
+
+// 热路径分段计时，由CMake选项SCOPE_TIMERS控制，关闭时SCOPE_TIMER()不产生任何代码
+#ifndef SCOPE_TIMER_ENABLED
+#define SCOPE_TIMER_ENABLED 0
+#endif
+
+// 计时点
+enum class ScopeId : uint8_t
+{
+    KINEMATICS,   // 麦轮逆解
+    WHEEL_PID,    // 4个轮速环PID
+    POWER_DATA,   // update_power_data()
+    POWER_LIMIT,  // apply_power_limit()
+    MOTOR_CMD,    // 4个电机cmd()
+    CAN_RX_ISR,   // CAN接收回调
+    UART_RX_ISR,  // 串口接收回调
+    IMU_ISR,      // IMU SPI DMA完成回调
+    IMU_FILTER,   // 底盘速度估计
+    COUNT,
+};
+
+// log2直方图：第k桶统计耗时在 [2^k, 2^(k+1)) 个周期内的次数
+constexpr size_t SCOPE_HIST_BUCKETS = 24;
+
+struct ScopeHistogram
+{
+    uint32_t buckets[SCOPE_HIST_BUCKETS];
+    uint32_t count;
+    uint32_t max;
+};
+
+// 统计结果，单位为CPU周期
+struct __attribute__((packed)) ScopeStatEntry
+{
+    uint8_t id;
+    uint32_t count;
+    uint32_t p50;
+    uint32_t p99;
+    uint32_t max;
+    char name[8];
+};
+
+// 直方图位于CCM RAM，不会被启动代码清零，在profiler_init()中调用
+void scope_timers_init();
+
+// 每个计时点只在一个上下文 (某个任务或某个中断) 中记录，记录时无需加锁
+inline void scope_record(ScopeId id, uint32_t cycles)
+{
+    extern ScopeHistogram scope_histograms[];
+    ScopeHistogram & hist = scope_histograms[static_cast<size_t>(id)];
+    size_t bucket = 31 - __builtin_clz(cycles | 1);
+    if (bucket >= SCOPE_HIST_BUCKETS) bucket = SCOPE_HIST_BUCKETS - 1;
+    hist.buckets[bucket]++;
+    hist.count++;
+    if (cycles > hist.max) hist.max = cycles;
+}
+
+// 读取并清零所有直方图，计算本周期的分位数，返回条目数
+size_t scope_timers_sample(ScopeStatEntry * entries, size_t max_entries);
+
+class ScopeTimer
+{
+public:
+    explicit ScopeTimer(ScopeId id) : id_(id), start_(profiler_cycles()) {}
+    ~ScopeTimer() { scope_record(id_, profiler_cycles() - start_); }
+
+private:
+    ScopeId id_;
+    uint32_t start_;
+};
+
+#define SCOPE_TIMER_CONCAT_(a, b) a##b
+#define SCOPE_TIMER_CONCAT(a, b) SCOPE_TIMER_CONCAT_(a, b)
+
+#if SCOPE_TIMER_ENABLED
+#define SCOPE_TIMER(id) ScopeTimer SCOPE_TIMER_CONCAT(scope_timer_, __LINE__)(ScopeId::id)
+#else
+#define SCOPE_TIMER(id) static_cast<void>(0)
+#endif
+
+#endif // SCOPE_TIMER_HPP
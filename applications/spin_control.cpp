@@ -0,0 +1,44 @@
+#include "spin_control.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+constexpr float SPIN_BUFFER_RESERVE = 20.0f;   // 不参与规划的缓冲能量 J
+constexpr float SPIN_BUFFER_HORIZON = 5.0f;    // 高于保留值的缓冲能量在该时间内用完 s
+constexpr float SPIN_RATE_MIN = 2.0f;          // 功率不足时仍保持的最低角速度 rad/s
+
+// 四轮以相同轮速|ω|稳态运行时的功率为 P(ω)，求 P(ω) = power 的正根
+static float sustainable_wheel_speed(const PowerModel & model, float power)
+{
+    const float b_v = model.viscous;
+    const float f_c = model.coulomb;
+    const float k1 = model.k1_torque_loss;
+
+    // 4·[(B + k1·B² + k2)·ω² + (Fc + 2·k1·B·Fc)·ω + k1·Fc²] + k3 - P = 0
+    float a = 4.0f * (b_v + k1 * b_v * b_v + model.k2_speed_loss);
+    float b = 4.0f * (f_c + 2.0f * k1 * b_v * f_c);
+    float c = 4.0f * k1 * f_c * f_c + model.k3_static_power - power;
+    if (c >= 0.0f) return 0.0f;
+    if (a <= 0.0f) return (b > 0.0f) ? -c / b : 0.0f;
+    return (-b + std::sqrt(b * b - 4.0f * a * c)) / (2.0f * a);
+}
+
+SpinControl::SpinControl(float wheel_radius, float half_length, float half_width, float max_rate)
+: wheel_radius_(wheel_radius), spin_ratio_((half_length + half_width) / wheel_radius), max_rate_(max_rate)
+{
+}
+
+float SpinControl::update(const PowerModel & model, const SpinBudget & budget, float vx, float vy)
+{
+    float buffer_power = std::max(budget.buffer_energy - SPIN_BUFFER_RESERVE, 0.0f) * (1.0f / SPIN_BUFFER_HORIZON);
+    power_budget = budget.power_limit + buffer_power + budget.cap_power;
+
+    float wheel_rms = sustainable_wheel_speed(model, power_budget);
+    rate_max = std::min(wheel_rms / spin_ratio_, max_rate_);
+
+    // 平移分量的轮速均方根为 |v|/r
+    float trans_sq = (vx * vx + vy * vy) / (wheel_radius_ * wheel_radius_);
+    float spin_wheel = std::sqrt(std::max(wheel_rms * wheel_rms - trans_sq, 0.0f));
+    float rate = std::min(spin_wheel / spin_ratio_, max_rate_);
+    return std::max(rate, SPIN_RATE_MIN);
+}
@@ -0,0 +1,36 @@
+#ifndef SPIN_CONTROL_HPP
+#define SPIN_CONTROL_HPP
+
+#include "accel_limiter.hpp"
+
+// 小陀螺可用的能量来源
+struct SpinBudget
+{
+    float power_limit;    // 裁判系统底盘功率上限 (已扣除余量) W
+    float buffer_energy;  // 缓冲能量 J
+    float cap_power;      // 超级电容可持续补充的功率 W，不可用为0
+};
+
+// 小陀螺转速规划
+// 稳态自旋时轮速不变，力矩只用于克服摩擦：τ = B·ω + Fc，代入功率模型
+// P = Σ(τ·ω + k1·τ² + k2·ω²) + k3，解出可用功率下的轮速均方根上限；
+// 麦轮平移与自旋分量的轮速平方和可分离 (交叉项在四轮间抵消)，扣除平移占用的部分即为自旋轮速
+class SpinControl
+{
+public:
+    // max_rate: 小陀螺角速度上限 rad/s
+    SpinControl(float wheel_radius, float half_length, float half_width, float max_rate);
+
+    // 由功率预算和当前平移速度设定值求可持续的自旋角速度 rad/s
+    float update(const PowerModel & model, const SpinBudget & budget, float vx, float vy);
+
+    float rate_max = 0.0f;     // 不平移时的可持续角速度 rad/s
+    float power_budget = 0.0f; // 本周期可持续的功率 W
+
+private:
+    const float wheel_radius_;
+    const float spin_ratio_;   // 单位角速度对应的轮速 (l + w) / r
+    const float max_rate_;
+};
+
+#endif // SPIN_CONTROL_HPP
@@ -0,0 +1,295 @@
+#include "telemetry.hpp"
+
+#include <cmath>
+#include <cstring>
+
+#include "tools/crc/crc.hpp"
+
+constexpr uint8_t TELEMETRY_SOF0 = 0x5A;
+constexpr uint8_t TELEMETRY_SOF1 = 0xA5;
+constexpr size_t TELEMETRY_HEADER_SIZE = 6;  // SOF + len + kind + seq
+constexpr size_t TELEMETRY_MAX_BODY = 5 + 5 + TELEMETRY_MAX_CHANNELS * 5;
+
+constexpr uint8_t FRAME_KIND_RAW = 0;
+constexpr uint8_t FRAME_KIND_KEY = 1;
+constexpr uint8_t FRAME_KIND_DELTA = 2;
+constexpr uint8_t FRAME_KIND_SCHEMA = 3;
+
+constexpr uint8_t JUSTFLOAT_TAIL[4] = {0x00, 0x00, 0x80, 0x7F};
+
+size_t telemetry_type_size(TelemetryType type)
+{
+    switch (type) {
+        case TelemetryType::U8:
+            return 1;
+        case TelemetryType::U16:
+        case TelemetryType::I16:
+            return 2;
+        default:
+            return 4;
+    }
+}
+
+// 无符号LEB128编码
+static size_t put_varint(uint8_t * out, uint32_t value)
+{
+    size_t size = 0;
+    while (value >= 0x80) {
+        out[size++] = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    out[size++] = static_cast<uint8_t>(value);
+    return size;
+}
+
+// zig-zag映射，使小幅度的负数也编码为短varint
+static inline uint32_t zigzag(int32_t value)
+{
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+Telemetry::Telemetry(UART_HandleTypeDef * huart) : huart_(huart) {}
+
+int Telemetry::add_channel(
+    const char * name, const volatile void * ptr, TelemetryType type, uint16_t decimation,
+    float quantum)
+{
+    size_t id = channel_count_.load(std::memory_order_relaxed);
+    if (id >= TELEMETRY_MAX_CHANNELS) return -1;
+
+    if (type != TelemetryType::F32 || quantum <= 0.0f) quantum = 1.0f;
+
+    TelemetryChannel & channel = channels_[id];
+    channel.name = name;
+    channel.ptr = ptr;
+    channel.type = type;
+    channel.decimation = (decimation == 0) ? 1 : decimation;
+    channel.quantum = quantum;
+    channel.inv_quantum = 1.0f / quantum;
+
+    channel_count_.store(id + 1, std::memory_order_release);
+    return static_cast<int>(id);
+}
+
+int32_t Telemetry::quantize(const TelemetryChannel & channel) const
+{
+    const void * ptr = const_cast<const void *>(channel.ptr);
+    switch (channel.type) {
+        case TelemetryType::U8:
+            return *static_cast<const uint8_t *>(ptr);
+        case TelemetryType::U16:
+            return *static_cast<const uint16_t *>(ptr);
+        case TelemetryType::I16:
+            return *static_cast<const int16_t *>(ptr);
+        case TelemetryType::U32:
+        case TelemetryType::I32: {
+            int32_t value;
+            std::memcpy(&value, ptr, sizeof(value));
+            return value;
+        }
+        case TelemetryType::F32:
+        default:
+            return static_cast<int32_t>(std::lroundf(*static_cast<const float *>(ptr) * channel.inv_quantum));
+    }
+}
+
+float Telemetry::value_of(const TelemetryChannel & channel) const
+{
+    const void * ptr = const_cast<const void *>(channel.ptr);
+    switch (channel.type) {
+        case TelemetryType::U8:
+            return *static_cast<const uint8_t *>(ptr);
+        case TelemetryType::U16:
+            return *static_cast<const uint16_t *>(ptr);
+        case TelemetryType::I16:
+            return *static_cast<const int16_t *>(ptr);
+        case TelemetryType::U32:
+            return static_cast<float>(*static_cast<const uint32_t *>(ptr));
+        case TelemetryType::I32:
+            return static_cast<float>(*static_cast<const int32_t *>(ptr));
+        case TelemetryType::F32:
+        default:
+            return *static_cast<const float *>(ptr);
+    }
+}
+
+size_t Telemetry::encode_raw(uint8_t * body, uint32_t mask, uint32_t stamp_ms) const
+{
+    size_t size = 0;
+    std::memcpy(body + size, &stamp_ms, sizeof(stamp_ms));
+    size += sizeof(stamp_ms);
+    std::memcpy(body + size, &mask, sizeof(mask));
+    size += sizeof(mask);
+
+    for (size_t id = 0; mask >> id; id++) {
+        if (!(mask & (1u << id))) continue;
+        size_t type_size = telemetry_type_size(channels_[id].type);
+        std::memcpy(body + size, const_cast<const void *>(channels_[id].ptr), type_size);
+        size += type_size;
+    }
+    return size;
+}
+
+size_t Telemetry::encode_compact(uint8_t * body, uint32_t mask, uint32_t stamp_ms, bool keyframe)
+{
+    size_t size = 0;
+    if (keyframe) {
+        std::memcpy(body + size, &stamp_ms, sizeof(stamp_ms));
+        size += sizeof(stamp_ms);
+    }
+    else {
+        size += put_varint(body + size, stamp_ms - last_stamp_ms_);
+    }
+    size += put_varint(body + size, mask);
+
+    for (size_t id = 0; mask >> id; id++) {
+        if (!(mask & (1u << id))) continue;
+        int32_t value = quantize(channels_[id]);
+        int32_t coded = keyframe ? value
+                                 : static_cast<int32_t>(static_cast<uint32_t>(value) -
+                                                        static_cast<uint32_t>(last_value_[id]));
+        size += put_varint(body + size, zigzag(coded));
+        last_value_[id] = value;
+    }
+
+    last_stamp_ms_ = stamp_ms;
+    return size;
+}
+
+size_t Telemetry::encode_justfloat(uint8_t * out, uint32_t selected) const
+{
+    size_t size = 0;
+    for (size_t id = 0; selected >> id; id++) {
+        if (!(selected & (1u << id))) continue;
+        float value = value_of(channels_[id]);
+        std::memcpy(out + size, &value, sizeof(value));
+        size += sizeof(value);
+    }
+    std::memcpy(out + size, JUSTFLOAT_TAIL, sizeof(JUSTFLOAT_TAIL));
+    return size + sizeof(JUSTFLOAT_TAIL);
+}
+
+size_t Telemetry::encode_schema(uint8_t * body, uint32_t selected, uint8_t slot) const
+{
+    // 找到第slot个所选通道
+    uint32_t rest = selected;
+    for (uint8_t i = 0; i < slot; i++) rest &= rest - 1;
+    size_t id = __builtin_ctz(rest);
+    const TelemetryChannel & channel = channels_[id];
+
+    body[0] = slot;
+    body[1] = static_cast<uint8_t>(__builtin_popcount(selected));
+    body[2] = static_cast<uint8_t>(id);
+    body[3] = static_cast<uint8_t>(channel.type);
+    size_t name_len = strnlen(channel.name, TELEMETRY_SCHEMA_NAME_MAX);
+    std::memcpy(body + 4, channel.name, name_len);
+    return 4 + name_len;
+}
+
+void Telemetry::finish_frame(uint8_t * frame, uint8_t kind, size_t body_size)
+{
+    uint16_t len = static_cast<uint16_t>(body_size + 2);
+    frame[0] = TELEMETRY_SOF0;
+    frame[1] = TELEMETRY_SOF1;
+    std::memcpy(frame + 2, &len, sizeof(len));
+    frame[4] = kind;
+    frame[5] = seq_++;
+
+    size_t size = TELEMETRY_HEADER_SIZE + body_size;
+    uint16_t crc = sp::get_crc16(frame, size);
+    frame[size++] = static_cast<uint8_t>(crc);
+    frame[size] = static_cast<uint8_t>(crc >> 8);
+}
+
+bool Telemetry::append(const uint8_t * frame, size_t size)
+{
+    if (fill_size_ + size > TELEMETRY_BUFF_SIZE) {
+        dropped_frames++;
+        return false;
+    }
+    std::memcpy(buff_[fill_index_] + fill_size_, frame, size);
+    fill_size_ += size;
+    return true;
+}
+
+void Telemetry::sample(uint32_t stamp_ms)
+{
+    uint32_t tick = tick_++;
+    uint32_t selected = selected_mask_.load(std::memory_order_relaxed);
+    TelemetryFormat format = format_.load(std::memory_order_relaxed);
+    size_t count = channel_count_.load(std::memory_order_acquire);
+
+    // 本帧需要采样的通道
+    uint32_t mask = 0;
+    for (size_t id = 0; id < count; id++) {
+        if ((selected & (1u << id)) && tick % channels_[id].decimation == 0) mask |= 1u << id;
+    }
+
+    // 选择或格式变化后差分基准失效，需要关键帧；
+    // 关键帧包含全部所选通道，否则本帧未到抽取周期的通道在下一个关键帧前都没有绝对值
+    bool keyframe = false;
+    if (format == TelemetryFormat::COMPACT) {
+        keyframe = frames_since_key_ >= TELEMETRY_KEYFRAME_INTERVAL ||
+                   selected != last_selected_ || format != last_format_;
+        if (keyframe) mask = selected & ((count >= 32) ? ~0u : (1u << count) - 1);
+    }
+    if (mask == 0) return;
+
+    uint8_t frame[TELEMETRY_HEADER_SIZE + TELEMETRY_MAX_BODY + 2];
+    uint8_t * body = frame + TELEMETRY_HEADER_SIZE;
+    uint8_t kind;
+    size_t body_size;
+
+    if (format == TelemetryFormat::JUSTFLOAT) {
+        // 每帧包含全部所选通道，帧长固定
+        selected &= (count >= 32) ? ~0u : (1u << count) - 1;
+        if (selected != last_selected_ || format != last_format_) {
+            schema_slot_ = 0;
+            frames_since_schema_ = TELEMETRY_SCHEMA_INTERVAL;
+        }
+        last_selected_ = selected;
+        last_format_ = format;
+
+        if (frames_since_schema_ >= TELEMETRY_SCHEMA_INTERVAL) {
+            body_size = encode_schema(body, selected, schema_slot_);
+            finish_frame(frame, FRAME_KIND_SCHEMA, body_size);
+            if (append(frame, TELEMETRY_HEADER_SIZE + body_size + 2)) {
+                schema_slot_ = (schema_slot_ + 1 == __builtin_popcount(selected)) ? 0 : schema_slot_ + 1;
+                frames_since_schema_ = 0;
+            }
+        }
+        frames_since_schema_++;
+        append(frame, encode_justfloat(frame, selected));
+        return;
+    }
+
+    if (format == TelemetryFormat::COMPACT) {
+        kind = keyframe ? FRAME_KIND_KEY : FRAME_KIND_DELTA;
+        body_size = encode_compact(body, mask, stamp_ms, keyframe);
+        frames_since_key_ = keyframe ? 1 : frames_since_key_ + 1;
+    }
+    else {
+        kind = FRAME_KIND_RAW;
+        body_size = encode_raw(body, mask, stamp_ms);
+    }
+    last_selected_ = selected;
+    last_format_ = format;
+
+    finish_frame(frame, kind, body_size);
+
+    // 差分帧丢失后解码端无法继续，下一帧补发关键帧
+    if (!append(frame, TELEMETRY_HEADER_SIZE + body_size + 2)) frames_since_key_ = TELEMETRY_KEYFRAME_INTERVAL;
+}
+
+void Telemetry::flush()
+{
+    if (fill_size_ == 0) return;
+
+    // 串口忙时HAL直接返回HAL_BUSY，帧继续留在累积缓冲中
+    if (HAL_UART_Transmit_DMA(huart_, buff_[fill_index_], static_cast<uint16_t>(fill_size_)) != HAL_OK) {
+        return;
+    }
+
+    fill_index_ ^= 1;
+    fill_size_ = 0;
+}
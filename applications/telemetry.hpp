@@ -0,0 +1,157 @@
+#ifndef TELEMETRY_HPP
+#define TELEMETRY_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "usart.h"
+
+// 通道数据类型
+enum class TelemetryType : uint8_t
+{
+    U8,
+    U16,
+    U32,
+    I16,
+    I32,
+    F32,
+};
+
+template <typename T>
+struct TelemetryTypeOf;
+template <> struct TelemetryTypeOf<bool> { static constexpr TelemetryType value = TelemetryType::U8; };
+template <> struct TelemetryTypeOf<uint8_t> { static constexpr TelemetryType value = TelemetryType::U8; };
+template <> struct TelemetryTypeOf<uint16_t> { static constexpr TelemetryType value = TelemetryType::U16; };
+template <> struct TelemetryTypeOf<uint32_t> { static constexpr TelemetryType value = TelemetryType::U32; };
+template <> struct TelemetryTypeOf<int16_t> { static constexpr TelemetryType value = TelemetryType::I16; };
+template <> struct TelemetryTypeOf<int32_t> { static constexpr TelemetryType value = TelemetryType::I32; };
+template <> struct TelemetryTypeOf<float> { static constexpr TelemetryType value = TelemetryType::F32; };
+
+// 发送格式
+enum class TelemetryFormat : uint8_t
+{
+    RAW,      // 原始小端数据
+    COMPACT,  // 量化 + 帧间差分 + zig-zag varint
+    JUSTFLOAT,  // VOFA+ JustFloat兼容，穿插通道描述帧
+};
+
+constexpr size_t TELEMETRY_MAX_CHANNELS = 32;
+constexpr size_t TELEMETRY_BUFF_SIZE = 1024;
+constexpr float TELEMETRY_DEFAULT_QUANTUM = 0.001f;  // 浮点通道默认量化步长
+constexpr uint32_t TELEMETRY_KEYFRAME_INTERVAL = 100;  // 压缩格式关键帧间隔(帧)
+constexpr uint32_t TELEMETRY_SCHEMA_INTERVAL = 100;    // JustFloat格式每隔多少帧发一条通道描述
+constexpr size_t TELEMETRY_SCHEMA_NAME_MAX = 16;
+
+// 遥测通道：名称 + 数据地址 + 类型 + 抽取系数 + 量化步长
+struct TelemetryChannel
+{
+    const char * name;
+    const volatile void * ptr;
+    TelemetryType type;
+    uint16_t decimation;  // 每decimation个采样周期采一次
+    float quantum;        // 浮点通道量化步长，整数通道为1
+    float inv_quantum;
+};
+
+// 遥测引擎
+// 各模块注册命名通道，低优先级任务按周期采样到紧凑的二进制帧，
+// 帧累积在双缓冲中由DMA发出，采样任务从不等待串口
+//
+// 帧格式 (小端):
+//   [0x5A][0xA5][len u16][kind u8][seq u8][body: len-2字节][crc16]
+//   len 为 kind 到 body 末尾的字节数，crc16 覆盖从 0x5A 到 body 末尾
+//   seq 每帧加1，解码端据此发现丢帧，丢帧后等待下一个关键帧
+//
+// kind = 0 原始帧:    [stamp_ms u32][mask u32][按通道号顺序排列的原始数据]
+// kind = 1 压缩关键帧: [stamp_ms u32][mask varint][各通道量化值 zig-zag varint]
+// kind = 2 压缩差分帧: [Δstamp_ms varint][mask varint][各通道与该通道上一次采样量化值之差 zig-zag varint]
+//   浮点通道量化值为 round(value / quantum)，整数通道直接取值
+//   关键帧包含全部所选通道 (不论是否到达抽取周期)，差分帧只含本帧到期的通道
+//   关键帧每 TELEMETRY_KEYFRAME_INTERVAL 帧一次，通道选择变化或丢帧后立即补发
+// kind = 3 通道描述帧: [slot u8][slots u8][id u8][type u8][name]
+//   JustFloat数据帧中第slot个float对应通道id，共slots个
+//
+// JustFloat格式 (VOFA+): [所选通道值 f32 * slots][0x00 0x00 0x80 0x7F]
+//   不带时间戳，任一所选通道到达抽取周期时发一帧，其余通道取当前值
+//   每 TELEMETRY_SCHEMA_INTERVAL 帧轮流插入一条通道描述帧，选择变化后从slot 0重新开始，
+//   VOFA+会丢弃夹带描述帧的那一个数据帧
+class Telemetry
+{
+public:
+    explicit Telemetry(UART_HandleTypeDef * huart);
+
+    // 注册通道，返回通道号，通道已满返回-1
+    template <typename T>
+    int add(
+        const char * name, const volatile T * ptr, uint16_t decimation = 1,
+        float quantum = TELEMETRY_DEFAULT_QUANTUM)
+    {
+        return add_channel(name, ptr, TelemetryTypeOf<T>::value, decimation, quantum);
+    }
+
+    // 运行时选择要发送的通道
+    void select(uint32_t mask) { selected_mask_.store(mask, std::memory_order_relaxed); }
+    uint32_t selected() const { return selected_mask_.load(std::memory_order_relaxed); }
+
+    // 运行时切换发送格式
+    void set_format(TelemetryFormat format) { format_.store(format, std::memory_order_relaxed); }
+    TelemetryFormat format() const { return format_.load(std::memory_order_relaxed); }
+
+    // 采样一帧，每个采样周期调用一次
+    void sample(uint32_t stamp_ms);
+
+    // 若串口空闲则发出已累积的帧
+    void flush();
+
+    size_t channel_count() const { return channel_count_.load(std::memory_order_acquire); }
+    const TelemetryChannel & channel(size_t id) const { return channels_[id]; }
+
+    uint32_t dropped_frames = 0;  // 缓冲区满丢弃的帧数
+
+private:
+    UART_HandleTypeDef * huart_;
+
+    TelemetryChannel channels_[TELEMETRY_MAX_CHANNELS];
+    std::atomic<size_t> channel_count_{0};
+    std::atomic<uint32_t> selected_mask_{0};
+    std::atomic<TelemetryFormat> format_{TelemetryFormat::COMPACT};
+    uint32_t tick_ = 0;
+    uint8_t seq_ = 0;
+
+    // 压缩格式状态
+    int32_t last_value_[TELEMETRY_MAX_CHANNELS] = {};
+    uint32_t last_stamp_ms_ = 0;
+    uint32_t last_selected_ = 0;
+    uint32_t frames_since_key_ = TELEMETRY_KEYFRAME_INTERVAL;
+    TelemetryFormat last_format_ = TelemetryFormat::RAW;
+
+    // JustFloat格式状态
+    uint32_t frames_since_schema_ = TELEMETRY_SCHEMA_INTERVAL;
+    uint8_t schema_slot_ = 0;
+
+    // 双缓冲：一个由DMA发送，另一个用于累积新帧
+    uint8_t buff_[2][TELEMETRY_BUFF_SIZE];
+    size_t fill_index_ = 0;
+    size_t fill_size_ = 0;
+
+    int add_channel(
+        const char * name, const volatile void * ptr, TelemetryType type, uint16_t decimation,
+        float quantum);
+
+    size_t encode_raw(uint8_t * body, uint32_t mask, uint32_t stamp_ms) const;
+    size_t encode_compact(uint8_t * body, uint32_t mask, uint32_t stamp_ms, bool keyframe);
+    size_t encode_justfloat(uint8_t * out, uint32_t selected) const;
+    size_t encode_schema(uint8_t * body, uint32_t selected, uint8_t slot) const;
+    int32_t quantize(const TelemetryChannel & channel) const;
+    float value_of(const TelemetryChannel & channel) const;
+    void finish_frame(uint8_t * frame, uint8_t kind, size_t body_size);
+    bool append(const uint8_t * frame, size_t size);
+};
+
+// 各类型占用的字节数
+size_t telemetry_type_size(TelemetryType type);
+
+extern Telemetry telemetry;  // plot_task.cpp中实例化
+
+#endif // TELEMETRY_HPP
@@ -0,0 +1,194 @@
+#include "traction_control.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+constexpr float SLIP_SPEED_MIN = 3.0f;      // 打滑转速下限 rad/s，低于此值视为测量噪声
+constexpr float SLIP_RATIO = 0.2f;          // 打滑转速占期望转速的比例阈值
+constexpr float SLIP_SPEED_REF = 5.0f;      // 低速时比例的分母下限 rad/s
+constexpr float GAIN_MIN = 0.3f;            // 牵引系数下限
+constexpr float GAIN_DROP_RATE = 5.0f;      // 打滑时牵引系数下降速度 1/s
+constexpr float GAIN_RECOVER_RATE = 2.0f;   // 恢复抓地后牵引系数回升速度 1/s
+
+TractionControl::TractionControl(float wheel_radius, float half_length, float half_width, float max_torque, float dt)
+: inverse_(wheel_radius, half_length, half_width), max_torque_(max_torque), dt_(dt)
+{
+}
+
+// 首次使用时构建，与MecanumForward相同，避免在静态初始化阶段调用其他对象
+void TractionControl::build()
+{
+    const float unit[3][3] = {{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}};
+    for (int col = 0; col < 3; col++) {
+        inverse_.calc(unit[col][0], unit[col][1], unit[col][2]);
+        jac_[0][col] = inverse_.speed_lf;
+        jac_[1][col] = inverse_.speed_lr;
+        jac_[2][col] = inverse_.speed_rf;
+        jac_[3][col] = inverse_.speed_rr;
+    }
+
+    // 零空间：对每个基向量做Gram-Schmidt，去掉J列空间的分量，取剩余最大的一个
+    float basis[3][4];
+    for (int col = 0; col < 3; col++) {
+        for (int k = 0; k < 4; k++) basis[col][k] = jac_[k][col];
+        for (int prev = 0; prev < col; prev++) {
+            float dot = 0.0f;
+            for (int k = 0; k < 4; k++) dot += basis[col][k] * basis[prev][k];
+            for (int k = 0; k < 4; k++) basis[col][k] -= dot * basis[prev][k];
+        }
+        float norm = 0.0f;
+        for (int k = 0; k < 4; k++) norm += basis[col][k] * basis[col][k];
+        norm = std::sqrt(norm);
+        for (int k = 0; k < 4; k++) basis[col][k] /= norm;
+    }
+    float best_norm = 0.0f;
+    for (int e = 0; e < 4; e++) {
+        float v[4] = {};
+        v[e] = 1.0f;
+        for (int col = 0; col < 3; col++) {
+            float dot = basis[col][e];
+            for (int k = 0; k < 4; k++) v[k] -= dot * basis[col][k];
+        }
+        float norm = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2] + v[3] * v[3]);
+        if (norm > best_norm) {
+            best_norm = norm;
+            for (int k = 0; k < 4; k++) null_[k] = v[k] / norm;
+        }
+    }
+
+    ready_ = true;
+}
+
+void TractionControl::reset()
+{
+    for (int i = 0; i < 4; i++) {
+        slip[i] = 0.0f;
+        gain[i] = 1.0f;
+    }
+    slip_mask = 0;
+    compensating_mask = 0;
+    gain_min = 1.0f;
+}
+
+void TractionControl::detect(const float speed[4], const float torque[4], const BodyMotion & body)
+{
+    slip_mask = 0;
+    float expected[4];
+
+    if (body.valid) {
+        for (int i = 0; i < 4; i++) {
+            expected[i] = jac_[i][0] * body.vx + jac_[i][1] * body.vy + jac_[i][2] * body.wz;
+            slip[i] = (speed[i] - expected[i]) * (torque[i] >= 0.0f ? 1.0f : -1.0f);
+        }
+    }
+    else {
+        // 单轮偏差δ在零空间上的投影为 n_k·δ，除以n_i即为去掉第i轮后由其余三轮预测的偏差
+        float residual = 0.0f;
+        for (int i = 0; i < 4; i++) residual += null_[i] * speed[i];
+
+        int candidate = -1;
+        for (int i = 0; i < 4; i++) {
+            float delta = residual / null_[i];
+            expected[i] = speed[i] - delta;
+            slip[i] = 0.0f;
+            if (delta * torque[i] > 0.0f &&
+                (candidate < 0 || std::abs(torque[i]) > std::abs(torque[candidate]))) {
+                candidate = i;
+            }
+        }
+        if (candidate >= 0) slip[candidate] = std::abs(residual / null_[candidate]);
+    }
+
+    for (int i = 0; i < 4; i++) {
+        float threshold = std::max(SLIP_SPEED_MIN, SLIP_RATIO * std::max(std::abs(expected[i]), SLIP_SPEED_REF));
+        if (slip[i] > threshold) slip_mask |= 1u << i;
+    }
+}
+
+// 其余车轮补偿被削减的车体合力：J_N^T τ_N = W - J_S^T τ_S 的最小二乘解，无可补偿的轮子或方程奇异时返回false
+bool TractionControl::redistribute(const float wrench[3], float torque[4], uint8_t limited)
+{
+    int index[4];
+    int n = 0;
+    float target[3] = {wrench[0], wrench[1], wrench[2]};
+    for (int i = 0; i < 4; i++) {
+        if (limited & (1u << i)) {
+            for (int c = 0; c < 3; c++) target[c] -= jac_[i][c] * torque[i];
+        }
+        else {
+            index[n++] = i;
+        }
+    }
+    if (n == 0) return false;
+
+    // 法方程 (J_N J_N^T) τ_N = J_N·target，n≤3，高斯消元
+    float m[3][4];
+    for (int r = 0; r < n; r++) {
+        for (int c = 0; c < n; c++) {
+            const float * a = jac_[index[r]];
+            const float * b = jac_[index[c]];
+            m[r][c] = a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+        }
+        const float * a = jac_[index[r]];
+        m[r][n] = a[0] * target[0] + a[1] * target[1] + a[2] * target[2];
+    }
+    for (int col = 0; col < n; col++) {
+        int pivot = col;
+        for (int r = col + 1; r < n; r++) {
+            if (std::abs(m[r][col]) > std::abs(m[pivot][col])) pivot = r;
+        }
+        if (std::abs(m[pivot][col]) < 1e-6f) return false;
+        if (pivot != col) {
+            for (int c = 0; c <= n; c++) std::swap(m[col][c], m[pivot][c]);
+        }
+        for (int r = 0; r < n; r++) {
+            if (r == col) continue;
+            float f = m[r][col] / m[col][col];
+            for (int c = col; c <= n; c++) m[r][c] -= f * m[col][c];
+        }
+    }
+
+    for (int r = 0; r < n; r++) {
+        float value = m[r][n] / m[r][r];
+        torque[index[r]] = std::max(-max_torque_, std::min(value, max_torque_));
+    }
+    return true;
+}
+
+void TractionControl::apply(const float speed[4], float torque[4], const BodyMotion & body)
+{
+    if (!ready_) build();
+
+    detect(speed, torque, body);
+
+    compensating_mask = 0;
+    gain_min = 1.0f;
+    bool reduced = false;
+    for (int i = 0; i < 4; i++) {
+        if (slip_mask & (1u << i)) {
+            gain[i] = std::max(GAIN_MIN, gain[i] - GAIN_DROP_RATE * dt_);
+        }
+        else {
+            gain[i] = std::min(1.0f, gain[i] + GAIN_RECOVER_RATE * dt_);
+        }
+        gain_min = std::min(gain_min, gain[i]);
+        reduced = reduced || gain[i] < 1.0f;
+    }
+    if (!reduced) return;
+
+    // 削减前的车体合力 (按功率对偶 W = J^T τ)
+    float wrench[3] = {};
+    for (int i = 0; i < 4; i++) {
+        for (int c = 0; c < 3; c++) wrench[c] += jac_[i][c] * torque[i];
+    }
+
+    // 牵引系数仍在恢复的轮子同样视为受限，不参与补偿
+    uint8_t limited = 0;
+    for (int i = 0; i < 4; i++) {
+        if (gain[i] < 1.0f) {
+            torque[i] *= gain[i];
+            limited |= 1u << i;
+        }
+    }
+    if (redistribute(wrench, torque, limited)) compensating_mask = static_cast<uint8_t>(~limited & 0x0F);
+}
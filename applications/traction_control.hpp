@@ -0,0 +1,51 @@
+#ifndef TRACTION_CONTROL_HPP
+#define TRACTION_CONTROL_HPP
+
+#include <cstdint>
+
+#include "tools/mecanum/mecanum.hpp"
+
+// 车体运动估计，IMU可用时由底盘速度估计器给出
+struct BodyMotion
+{
+    float vx;
+    float vy;
+    float wz;
+    bool valid;   // false时只用轮速间的运动学一致性判断打滑
+};
+
+// 逐轮打滑检测与力矩再分配
+// 打滑量：IMU可用时为各轮转速与车体运动经逆运动学给出的期望转速之差；
+// 否则四轮比三自由度多出一个约束，不满足该约束的部分等量出现在每个轮子上，
+// 取转速偏差方向与力矩方向相同 (空转或抱死) 且力矩最大的轮子为打滑轮。
+// 打滑轮的力矩按牵引系数降低，被削减的车体合力/合力矩由其余车轮按最小二乘补偿
+class TractionControl
+{
+public:
+    TractionControl(float wheel_radius, float half_length, float half_width, float max_torque, float dt);
+
+    // speed/torque顺序为 lf, lr, rf, rr；torque原地修改
+    void apply(const float speed[4], float torque[4], const BodyMotion & body);
+
+    void reset();
+
+    float slip[4] = {};              // 各轮打滑转速 rad/s (正为沿力矩方向)
+    float gain[4] = {1.0f, 1.0f, 1.0f, 1.0f};  // 各轮牵引系数
+    uint8_t slip_mask = 0;           // 本周期判定打滑的轮子
+    uint8_t compensating_mask = 0;   // 本周期由再分配补偿了力矩的轮子 (其力矩已不是PID的输出)
+    float gain_min = 1.0f;           // 四轮中最小的牵引系数
+
+private:
+    sp::Mecanum inverse_;
+    const float max_torque_;
+    const float dt_;
+    bool ready_ = false;
+    float jac_[4][3];      // 逆运动学雅可比矩阵，列为单位vx、vy、wz
+    float null_[4];        // J^T 的零空间单位向量 (四轮运动学一致性约束)
+
+    void build();
+    void detect(const float speed[4], const float torque[4], const BodyMotion & body);
+    bool redistribute(const float wrench[3], float torque[4], uint8_t limited);
+};
+
+#endif // TRACTION_CONTROL_HPP
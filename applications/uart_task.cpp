@@ -1,4 +1,7 @@
 #include "cmsis_os.h"
+#include "cpu_profiler.hpp"
+#include "input_recorder.hpp"
+#include "scope_timer.hpp"
 #include "io/dbus/dbus.hpp"
 #include "referee/pm02/pm02.hpp"
 #include "usart.h"
@@ -9,6 +12,14 @@ extern UART_HandleTypeDef huart6;
 sp::DBus remote(&huart3);
 sp::PM02 pm02(&huart6);
 
+// 遥控器帧计数与接收时间戳，供底盘任务检测新帧和估计帧间隔
+volatile uint32_t remote_frame_count = 0;
+volatile uint32_t remote_frame_stamp_ms = 0;
+
+// 裁判系统帧计数与接收时间戳，供底盘任务判断裁判系统数据是否有效
+volatile uint32_t referee_frame_count = 0;
+volatile uint32_t referee_frame_stamp_ms = 0;
+
 // 串口通信任务
 extern "C" void uart_task(void const * argument)
 {
@@ -23,16 +34,25 @@ extern "C" void uart_task(void const * argument)
 // 串口接收中断处理
 extern "C" void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef * huart, uint16_t Size)
 {
+    IsrProfile profile(IsrId::UART_RX);
+    SCOPE_TIMER(UART_RX_ISR);
     auto stamp_ms = osKernelSysTick();
 
     if (huart == &huart3) {
+        // pRxBuffPtr仍指向本次接收的DMA缓冲区，需在request()重新启动接收前记录
+        input_recorder.record(InputSource::DBUS, 0, huart->pRxBuffPtr, Size);
         remote.update(Size, stamp_ms);
         remote.request();
+        remote_frame_stamp_ms = stamp_ms;
+        remote_frame_count = remote_frame_count + 1;
     }
     
     if (huart == &huart6) {
+        input_recorder.record(InputSource::REFEREE, 0, huart->pRxBuffPtr, Size);
         pm02.update(Size);
         pm02.request();
+        referee_frame_stamp_ms = stamp_ms;
+        referee_frame_count = referee_frame_count + 1;
     }
 }
 
@@ -0,0 +1,178 @@
+#include "usb_link.hpp"
+
+#include <cstring>
+
+#include "cmsis_os.h"
+#include "cpu_profiler.hpp"
+#include "input_recorder.hpp"
+#include "tools/crc/crc.hpp"
+#include "usbd_cdc_if.h"
+
+UsbLink usb_link;
+
+UsbLink::UsbLink()
+{
+    for (uint32_t i = 0; i < TX_SLOTS; i++) {
+        tx_slots_[i].seq.store(i, std::memory_order_relaxed);
+    }
+}
+
+// 有界多生产者队列：先用CAS抢占槽位，写完数据后再发布序号，消费者只读已发布的槽位
+bool UsbLink::send(UsbCmd cmd, const void * payload, uint8_t len)
+{
+    if (len > USB_FRAME_MAX_PAYLOAD) return false;
+
+    TxSlot * slot;
+    uint32_t pos = tx_enqueue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+        slot = &tx_slots_[pos & (TX_SLOTS - 1)];
+        uint32_t seq = slot->seq.load(std::memory_order_acquire);
+        int32_t diff = static_cast<int32_t>(seq - pos);
+
+        if (diff == 0) {
+            if (tx_enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        }
+        else if (diff < 0) {
+            // 队列已满
+            dropped_frames.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        else {
+            pos = tx_enqueue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+
+    uint8_t * frame = slot->data;
+    frame[0] = USB_FRAME_SOF;
+    frame[1] = static_cast<uint8_t>(cmd);
+    frame[2] = len;
+    frame[3] = static_cast<uint8_t>(pos);
+    std::memcpy(frame + USB_FRAME_HEADER_SIZE, payload, len);
+
+    size_t crc_pos = USB_FRAME_HEADER_SIZE + len;
+    uint16_t crc = sp::get_crc16(frame, crc_pos);
+    frame[crc_pos] = static_cast<uint8_t>(crc);
+    frame[crc_pos + 1] = static_cast<uint8_t>(crc >> 8);
+    slot->size = static_cast<uint8_t>(crc_pos + 2);
+
+    slot->seq.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+void UsbLink::register_handler(UsbCmd cmd, UsbCmdHandler handler)
+{
+    // 各任务启动时都可能注册，关临界区防止计数被并发修改
+    taskENTER_CRITICAL();
+    if (handler_count_ < MAX_HANDLERS) handlers_[handler_count_++] = {cmd, handler};
+    taskEXIT_CRITICAL();
+}
+
+uint32_t UsbLink::reply_budget() const
+{
+    uint32_t used = tx_enqueue_pos_.load(std::memory_order_acquire) - tx_dequeue_pos_;
+    uint32_t free = (used < TX_SLOTS) ? TX_SLOTS - used : 0;
+    if (free > USB_LIST_TX_RESERVE) return free - USB_LIST_TX_RESERVE;
+    return (free > 0) ? 1 : 0;
+}
+
+void UsbLink::on_receive(const uint8_t * data, uint32_t len)
+{
+    uint32_t head = rx_head_.load(std::memory_order_relaxed);
+    uint32_t tail = rx_tail_.load(std::memory_order_acquire);
+
+    for (uint32_t i = 0; i < len; i++) {
+        if (head - tail >= RX_BUFF_SIZE) {
+            rx_overflows += len - i;
+            break;
+        }
+        rx_buff_[head & (RX_BUFF_SIZE - 1)] = data[i];
+        head++;
+    }
+
+    rx_head_.store(head, std::memory_order_release);
+}
+
+void UsbLink::parse_byte(uint8_t byte)
+{
+    // 等待帧头
+    if (rx_frame_size_ == 0 && byte != USB_FRAME_SOF) return;
+
+    rx_frame_[rx_frame_size_++] = byte;
+
+    if (rx_frame_size_ == 3 && rx_frame_[2] > USB_FRAME_MAX_PAYLOAD) {
+        rx_frame_size_ = 0;
+        return;
+    }
+
+    if (rx_frame_size_ < USB_FRAME_HEADER_SIZE) return;
+    if (rx_frame_size_ < USB_FRAME_HEADER_SIZE + rx_frame_[2] + 2u) return;
+
+    if (sp::check_crc16(rx_frame_, rx_frame_size_)) {
+        dispatch();
+    }
+    else {
+        crc_errors++;
+    }
+    rx_frame_size_ = 0;
+}
+
+void UsbLink::dispatch()
+{
+    UsbCmd cmd = static_cast<UsbCmd>(rx_frame_[1]);
+    const uint8_t * payload = rx_frame_ + USB_FRAME_HEADER_SIZE;
+    uint8_t len = rx_frame_[2];
+
+    if (cmd == UsbCmd::PING) {
+        send(UsbCmd::PING, payload, len);
+        return;
+    }
+
+    for (size_t i = 0; i < handler_count_; i++) {
+        if (handlers_[i].cmd == cmd) {
+            handlers_[i].handler(payload, len);
+            return;
+        }
+    }
+}
+
+// 把已发布的帧整批拷入CDC发送缓冲区，一次传输由USB库拆成64字节包
+void UsbLink::flush_tx()
+{
+    if (!CDC_TxReady_FS()) return;
+
+    size_t size = 0;
+    while (true) {
+        TxSlot & slot = tx_slots_[tx_dequeue_pos_ & (TX_SLOTS - 1)];
+        if (slot.seq.load(std::memory_order_acquire) != tx_dequeue_pos_ + 1) break;
+        if (size + slot.size > APP_TX_DATA_SIZE) break;
+
+        std::memcpy(UserTxBufferFS + size, slot.data, slot.size);
+        size += slot.size;
+
+        slot.seq.store(tx_dequeue_pos_ + TX_SLOTS, std::memory_order_release);
+        tx_dequeue_pos_++;
+    }
+
+    if (size > 0) CDC_Transmit_FS(UserTxBufferFS, static_cast<uint16_t>(size));
+}
+
+void UsbLink::poll()
+{
+    uint32_t head = rx_head_.load(std::memory_order_acquire);
+    uint32_t tail = rx_tail_.load(std::memory_order_relaxed);
+    while (tail != head) {
+        parse_byte(rx_buff_[tail & (RX_BUFF_SIZE - 1)]);
+        tail++;
+    }
+    rx_tail_.store(tail, std::memory_order_release);
+
+    flush_tx();
+}
+
+// USB CDC接收回调 (usbd_cdc_if.c中调用)
+extern "C" void usb_link_on_receive(const uint8_t * data, uint32_t len)
+{
+    IsrProfile profile(IsrId::USB_RX);
+    input_recorder.record(InputSource::USB, 0, data, len);
+    usb_link.on_receive(data, len);
+}
@@ -0,0 +1,125 @@
+#ifndef USB_LINK_HPP
+#define USB_LINK_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// USB CDC 帧格式 (小端):
+//   [SOF 0xA5][cmd][len][seq][payload: len字节][crc16 低字节][crc16 高字节]
+// crc16 覆盖 SOF 到 payload 末尾，算法与裁判系统协议一致
+constexpr uint8_t USB_FRAME_SOF = 0xA5;
+constexpr size_t USB_FRAME_HEADER_SIZE = 4;
+constexpr size_t USB_FRAME_MAX_PAYLOAD = 120;
+constexpr size_t USB_FRAME_MAX_SIZE = USB_FRAME_HEADER_SIZE + USB_FRAME_MAX_PAYLOAD + 2;
+
+// 命令字，0x80以上为下位机主动上发
+enum class UsbCmd : uint8_t
+{
+    PING = 0x01,              // 回显payload
+    STREAM_CTRL = 0x02,       // 设置状态流周期: uint16 period_ms，0为关闭
+    NAV_CMD = 0x10,           // 上位机速度指令: NavCmdFrame
+    TELEMETRY_SELECT = 0x20,  // 选择遥测通道: uint32 mask
+    TELEMETRY_LIST = 0x21,    // 请求遥测通道列表: start u8 (可省略，为0)，分页回复
+    TELEMETRY_FORMAT = 0x22,  // 设置遥测格式: uint8 0原始 1压缩 2JustFloat
+    LOG_CTRL = 0x23,          // 记录仪控制: LogCtrlFrame
+    PARAM_LIST = 0x24,        // 请求参数列表: start u8 (可省略，为0)，分页回复
+    PARAM_GET = 0x25,         // 读取参数: id u8 * n，为空时读取全部
+    PARAM_SET = 0x26,         // 批量写入参数: ParamEntry * n
+    PARAM_SAVE = 0x27,        // 保存当前参数到flash，回复PARAM_VALUE(仅status)
+    INPUT_RECORD_CTRL = 0x28, // 输入记录控制: InputRecordOp u8
+    FF_IDENT = 0x29,          // 前馈参数辨识: IdentOp u8
+    CHASSIS_STATE = 0x81,     // 底盘全状态
+    NAV_ODOM = 0x82,          // 里程计回传: NavOdomFrame
+    TELEMETRY_CHANNEL = 0x83, // 遥测通道描述: id u8, type u8, decimation u16, quantum f32, name；列表结束: count u8
+    LOG_INFO = 0x84,          // 记录仪窗口描述: LogInfoFrame
+    LOG_RECORD = 0x85,        // 记录仪数据: index u16, LogRecord
+    PARAM_INFO = 0x86,        // 参数描述: id u8, type u8, min f32, max f32, value u32, name；列表结束: count u8
+    PARAM_VALUE = 0x87,       // 参数值: status u8, ParamEntry * n
+    CPU_STATS = 0x88,         // CPU占用统计: stamp u32, first u8, total u8, CpuStatEntry * n
+    SCOPE_STATS = 0x89,       // 分段耗时统计: stamp u32, cycles_per_us u16, first u8, total u8, ScopeStatEntry * n
+    MEM_STATS = 0x8A,         // 内存统计: stamp u32, HeapStat, first u8, total u8, StackStatEntry * n
+    INPUT_RECORD = 0x8B,      // 输入记录: seq u16, (InputEventHeader, data) * n
+    FF_IDENT_RESULT = 0x8C,   // 前馈辨识结果: IdentResultFrame
+    MOTOR_THERMAL = 0x8D,     // 电机热状态: MotorThermalFrame
+};
+
+// 命令处理函数，在usb_link_poll所在任务中调用
+using UsbCmdHandler = void (*)(const uint8_t * payload, uint8_t len);
+
+// 列表类请求 (TELEMETRY_LIST、PARAM_LIST) 的回复在命令处理函数中入队，poll()返回前才发出，
+// 一次最多只能回复发送队列的空闲槽位数。请求带起始序号，每次回复一页，
+// 回复到列表末尾时追加只含条目总数 (1字节) 的结束帧，上位机从缺失的序号起继续请求直到收到结束帧
+constexpr uint32_t USB_LIST_TX_RESERVE = 4;  // 分页回复时给周期上发的帧留出的槽位
+
+// USB CDC 高带宽通道
+// 发送端为多生产者无锁环形队列(任务和中断都可调用send)，由低优先级任务把帧拼接后
+// 整批写入CDC发送缓冲区，使64字节端点包尽量填满；接收端在USB中断中只做拷贝，
+// 解帧和命令分发放在任务中完成
+class UsbLink
+{
+public:
+    UsbLink();
+
+    // 发送一帧，队列满时丢弃并计数。可在任务和中断中调用
+    bool send(UsbCmd cmd, const void * payload, uint8_t len);
+
+    // 注册命令处理函数
+    void register_handler(UsbCmd cmd, UsbCmdHandler handler);
+
+    // 分页回复本次可用的帧数：留出USB_LIST_TX_RESERVE个槽位，队列将满时仍回复一帧。
+    // 只能在命令处理函数中调用 (与出队在同一任务)
+    uint32_t reply_budget() const;
+
+    // USB接收中断中调用
+    void on_receive(const uint8_t * data, uint32_t len);
+
+    // 周期调用：解析接收数据、分发命令、批量发送
+    void poll();
+
+    std::atomic<uint32_t> dropped_frames{0};  // 发送队列满丢弃的帧数
+    uint32_t rx_overflows = 0;    // 接收缓冲区溢出字节数
+    uint32_t crc_errors = 0;      // 接收crc错误帧数
+
+private:
+    static constexpr uint32_t TX_SLOTS = 16;  // 必须为2的幂
+    static constexpr uint32_t RX_BUFF_SIZE = 512;  // 必须为2的幂
+    static constexpr size_t MAX_HANDLERS = 16;
+
+    struct TxSlot
+    {
+        std::atomic<uint32_t> seq;
+        uint8_t size;
+        uint8_t data[USB_FRAME_MAX_SIZE];
+    };
+
+    struct HandlerEntry
+    {
+        UsbCmd cmd;
+        UsbCmdHandler handler;
+    };
+
+    TxSlot tx_slots_[TX_SLOTS];
+    std::atomic<uint32_t> tx_enqueue_pos_{0};
+    uint32_t tx_dequeue_pos_ = 0;
+
+    // 接收字节环 (单生产者：USB中断，单消费者：poll)
+    uint8_t rx_buff_[RX_BUFF_SIZE];
+    std::atomic<uint32_t> rx_head_{0};
+    std::atomic<uint32_t> rx_tail_{0};
+
+    // 接收解帧状态
+    uint8_t rx_frame_[USB_FRAME_MAX_SIZE];
+    size_t rx_frame_size_ = 0;
+
+    HandlerEntry handlers_[MAX_HANDLERS] = {};
+    size_t handler_count_ = 0;
+
+    void parse_byte(uint8_t byte);
+    void dispatch();
+    void flush_tx();
+};
+
+extern UsbLink usb_link;
+
+#endif // USB_LINK_HPP
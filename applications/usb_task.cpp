@@ -0,0 +1,336 @@
+#include <algorithm>
+#include <cstring>
+
+#include "chassis_control.hpp"
+#include "cmsis_os.h"
+#include "cpu_profiler.hpp"
+#include "data_logger.hpp"
+#include "feedforward.hpp"
+#include "input_recorder.hpp"
+#include "nav_command.hpp"
+#include "param_server.hpp"
+#include "param_store.hpp"
+#include "usb_link.hpp"
+
+constexpr uint16_t DEFAULT_STREAM_PERIOD_MS = 10;
+constexpr uint32_t NAV_TIMEOUT_MS = 50;       // 上位机指令超时
+constexpr uint32_t NAV_ODOM_PERIOD_MS = 5;    // 里程计回传周期
+constexpr uint32_t THERMAL_PERIOD_MS = 100;   // 电机热状态上发周期
+constexpr size_t LOG_FLUSH_BATCH = 4;         // 每周期最多上发的记录条数
+constexpr size_t INPUT_FLUSH_BATCH = 8;       // 每周期最多上发的输入记录帧数
+constexpr uint32_t INPUT_RECORD_BUFF_SIZE = 16384; // 必须为2的幂，含IMU时约100KB/s，可缓冲150ms
+constexpr uint32_t PARAM_PUBLISH_RETRY = 20;  // 参数发布忙时的重试次数 (每次1ms)
+constexpr size_t PARAM_NAME_MAX = 24;
+constexpr size_t PARAM_ENTRIES_PER_FRAME = (USB_FRAME_MAX_PAYLOAD - 1) / sizeof(ParamEntry);
+
+static DeadlineMonitor usb_deadline("usb", 1000, 1000);
+
+static uint8_t input_record_buffer[INPUT_RECORD_BUFF_SIZE] __attribute__((section(".ccmbss")));
+InputRecorder input_recorder(input_record_buffer, INPUT_RECORD_BUFF_SIZE);
+
+NavCommand nav_command(NAV_TIMEOUT_MS, WHEEL_RADIUS, HALF_LENGTH, HALF_WIDTH);
+
+// 底盘全状态帧
+struct __attribute__((packed)) ChassisStateFrame
+{
+    uint32_t stamp_ms;
+    float vx_set, vy_set, wz_set;
+    float speed_set[4];   // lf, lr, rf, rr  rad/s
+    float speed[4];       // lf, lr, rf, rr  rad/s
+    float torque[4];      // lf, lr, rf, rr  N·m
+    uint16_t chassis_power_limit;
+    uint16_t buffer_energy;
+    float power_scale_factor;
+    float power_in;
+    float power_out;
+    float predicted_power;
+    float cap_soc;        // 电容荷电状态 0-1
+    uint8_t cap_mode;     // sp::SuperCapMode
+    uint16_t cap_energy_raw;  // 电容板剩余能量原始读数，用于确认cap_energy_scale
+};
+static_assert(sizeof(ChassisStateFrame) <= USB_FRAME_MAX_PAYLOAD, "state frame too large");
+
+// 电机热状态帧 (遥测通道已满，温度变化慢，单独低频上发)
+struct __attribute__((packed)) MotorThermalFrame
+{
+    uint32_t stamp_ms;
+    float temp[4];          // lf, lr, rf, rr  模型绕组温度估计 °C
+    uint8_t reported[4];    // lf, lr, rf, rr  电调上报温度 °C
+    float derate;           // 最低力矩上限系数
+    uint8_t mismatch;       // 模型与反馈不一致的电机 (bit0-3)
+};
+
+// 状态流周期 ms，0为关闭
+static volatile uint16_t stream_period_ms = DEFAULT_STREAM_PERIOD_MS;
+
+static void on_stream_ctrl(const uint8_t * payload, uint8_t len)
+{
+    if (len < sizeof(uint16_t)) return;
+    uint16_t period_ms;
+    std::memcpy(&period_ms, payload, sizeof(period_ms));
+    stream_period_ms = period_ms;
+}
+
+static void on_nav_cmd(const uint8_t * payload, uint8_t len)
+{
+    if (len != sizeof(NavCmdFrame)) return;
+    NavCmdFrame cmd;
+    std::memcpy(&cmd, payload, sizeof(cmd));
+    const ChassisParams & params = param_server.active();
+    nav_command.on_command(cmd, osKernelSysTick(), params.max_linear_speed, params.rotation_speed);
+}
+
+static void on_input_record_ctrl(const uint8_t * payload, uint8_t len)
+{
+    if (len != 1) return;
+    switch (static_cast<InputRecordOp>(payload[0])) {
+        case InputRecordOp::START:
+            input_recorder.start();
+            break;
+        case InputRecordOp::STOP:
+            input_recorder.stop();
+            break;
+    }
+}
+
+// 前馈辨识控制，结果在usb_task循环中取回并上发，由上位机决定是否写入参数
+static void on_ff_ident(const uint8_t * payload, uint8_t len)
+{
+    if (len != 1 || payload[0] > static_cast<uint8_t>(IdentOp::SOLVE)) return;
+    ff_identifier.request(static_cast<IdentOp>(payload[0]));
+}
+
+static void on_log_ctrl(const uint8_t * payload, uint8_t len)
+{
+    if (len < 1) return;
+    switch (static_cast<LogCtrlOp>(payload[0])) {
+        case LogCtrlOp::ARM: {
+            if (len != sizeof(LogCtrlFrame)) return;
+            LogCtrlFrame ctrl;
+            std::memcpy(&ctrl, payload, sizeof(ctrl));
+            data_logger.arm(ctrl.pre, ctrl.post, ctrl.buffer_energy_min, ctrl.scale_min);
+            break;
+        }
+        case LogCtrlOp::TRIGGER:
+            data_logger.trigger();
+            break;
+        case LogCtrlOp::DISARM:
+            data_logger.disarm();
+            break;
+        default:
+            break;
+    }
+
+    LogInfoFrame info;
+    data_logger.fill_info(info);
+    usb_link.send(UsbCmd::LOG_INFO, &info, sizeof(info));
+}
+
+// 回传参数列表，上位机据此按名称读写参数。参数数多于发送队列槽位，从请求的起始序号起分页回复
+static void on_param_list(const uint8_t * request, uint8_t len)
+{
+    size_t count = param_server.count();
+    size_t id = (len >= 1) ? request[0] : 0;
+    uint32_t budget = usb_link.reply_budget();
+    for (; id < count && budget > 0; id++, budget--) {
+        const ParamInfo & info = param_server.info(id);
+        uint8_t payload[14 + PARAM_NAME_MAX];
+        uint32_t value = param_server.get(id);
+        payload[0] = static_cast<uint8_t>(id);
+        payload[1] = static_cast<uint8_t>(info.type);
+        std::memcpy(payload + 2, &info.min, sizeof(info.min));
+        std::memcpy(payload + 6, &info.max, sizeof(info.max));
+        std::memcpy(payload + 10, &value, sizeof(value));
+
+        size_t name_len = std::min(std::strlen(info.name), PARAM_NAME_MAX);
+        std::memcpy(payload + 14, info.name, name_len);
+        usb_link.send(UsbCmd::PARAM_INFO, payload, static_cast<uint8_t>(14 + name_len));
+    }
+    if (id >= count && budget > 0) {
+        uint8_t total = static_cast<uint8_t>(count);
+        usb_link.send(UsbCmd::PARAM_INFO, &total, sizeof(total));
+    }
+}
+
+static void send_param_values(ParamStatus status, const ParamEntry * entries, size_t n)
+{
+    uint8_t payload[1 + PARAM_ENTRIES_PER_FRAME * sizeof(ParamEntry)];
+    payload[0] = static_cast<uint8_t>(status);
+    if (n != 0) std::memcpy(payload + 1, entries, n * sizeof(ParamEntry));
+    usb_link.send(UsbCmd::PARAM_VALUE, payload, static_cast<uint8_t>(1 + n * sizeof(ParamEntry)));
+}
+
+static void on_param_get(const uint8_t * payload, uint8_t len)
+{
+    size_t count = (len == 0) ? param_server.count() : len;
+    ParamEntry entries[PARAM_ENTRIES_PER_FRAME];
+    size_t n = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        size_t id = (len == 0) ? i : payload[i];
+        if (id >= param_server.count()) {
+            send_param_values(ParamStatus::INVALID, nullptr, 0);
+            return;
+        }
+        entries[n].id = static_cast<uint8_t>(id);
+        entries[n].value = param_server.get(id);
+        if (++n == PARAM_ENTRIES_PER_FRAME) {
+            send_param_values(ParamStatus::OK, entries, n);
+            n = 0;
+        }
+    }
+    if (n != 0 || count == 0) send_param_values(ParamStatus::OK, entries, n);
+}
+
+// 批量写入，整批校验通过后在下一个控制周期开始时一起生效
+static void on_param_set(const uint8_t * payload, uint8_t len)
+{
+    size_t n = len / sizeof(ParamEntry);
+    if (len % sizeof(ParamEntry) != 0 || n > PARAM_ENTRIES_PER_FRAME) {
+        send_param_values(ParamStatus::INVALID, nullptr, 0);
+        return;
+    }
+
+    ParamEntry entries[PARAM_ENTRIES_PER_FRAME];
+    std::memcpy(entries, payload, len);
+
+    // 控制任务每个周期都会取走更新，忙时稍等即可
+    ParamStatus status = param_server.set(entries, n);
+    for (uint32_t retry = 0; status == ParamStatus::BUSY && retry < PARAM_PUBLISH_RETRY; retry++) {
+        osDelay(1);
+        status = param_server.set(entries, n);
+    }
+    send_param_values(status, entries, n);
+}
+
+// 保存到flash，擦写会暂停取指，只在底盘释放时执行
+static void on_param_save(const uint8_t *, uint8_t)
+{
+    if (!chassis_released) {
+        send_param_values(ParamStatus::LOCKED, nullptr, 0);
+        return;
+    }
+
+    uint32_t values[PARAM_STORE_MAX_KEYS];
+    size_t count = param_server.count();
+    for (size_t id = 0; id < count; id++) values[id] = param_server.get(id);
+
+    bool ok = param_store.save(values, count);
+    send_param_values(ok ? ParamStatus::OK : ParamStatus::STORAGE_ERROR, nullptr, 0);
+}
+
+static void send_nav_odometry(uint32_t now_ms)
+{
+    NavOdomFrame frame;
+    nav_command.fill_odometry(frame, now_ms);
+    usb_link.send(UsbCmd::NAV_ODOM, &frame, sizeof(frame));
+}
+
+static void send_chassis_state(uint32_t now_ms)
+{
+    ChassisStateFrame frame;
+    frame.stamp_ms = now_ms;
+    frame.vx_set = chassis_data.vx_set;
+    frame.vy_set = chassis_data.vy_set;
+    frame.wz_set = chassis_data.wz_set;
+    frame.speed_set[0] = chassis_data.speed_lf_set;
+    frame.speed_set[1] = chassis_data.speed_lr_set;
+    frame.speed_set[2] = chassis_data.speed_rf_set;
+    frame.speed_set[3] = chassis_data.speed_rr_set;
+    frame.speed[0] = chassis_lf.speed;
+    frame.speed[1] = chassis_lr.speed;
+    frame.speed[2] = chassis_rf.speed;
+    frame.speed[3] = chassis_rr.speed;
+    frame.torque[0] = chassis_data.torque_lf;
+    frame.torque[1] = chassis_data.torque_lr;
+    frame.torque[2] = chassis_data.torque_rf;
+    frame.torque[3] = chassis_data.torque_rr;
+    frame.chassis_power_limit = chassis_data.chassis_power_limit;
+    frame.buffer_energy = pm02.power_heat.buffer_energy;
+    frame.power_scale_factor = chassis_data.power_scale_factor;
+    frame.power_in = chassis_data.power_in;
+    frame.power_out = chassis_data.power_out;
+    frame.predicted_power = chassis_data.predicted_power;
+    frame.cap_soc = chassis_data.cap_soc;
+    frame.cap_mode = static_cast<uint8_t>(current_supercap_mode);
+    frame.cap_energy_raw = static_cast<uint16_t>(super_cap.cap_energy);
+
+    usb_link.send(UsbCmd::CHASSIS_STATE, &frame, sizeof(frame));
+}
+
+static void send_motor_thermal(uint32_t now_ms)
+{
+    MotorThermalFrame frame;
+    frame.stamp_ms = now_ms;
+    frame.temp[0] = chassis_data.temp_lf;
+    frame.temp[1] = chassis_data.temp_lr;
+    frame.temp[2] = chassis_data.temp_rf;
+    frame.temp[3] = chassis_data.temp_rr;
+    frame.reported[0] = chassis_lf.temperature;
+    frame.reported[1] = chassis_lr.temperature;
+    frame.reported[2] = chassis_rf.temperature;
+    frame.reported[3] = chassis_rr.temperature;
+    frame.derate = chassis_data.thermal_derate;
+    frame.mismatch = chassis_data.thermal_mismatch;
+
+    usb_link.send(UsbCmd::MOTOR_THERMAL, &frame, sizeof(frame));
+}
+
+// USB CDC通信任务：命令解析、上位机指令、在线参数、里程计与状态流上发、记录仪和输入记录上发、批量发送
+extern "C" void usb_task()
+{
+    usb_link.register_handler(UsbCmd::STREAM_CTRL, on_stream_ctrl);
+    usb_link.register_handler(UsbCmd::NAV_CMD, on_nav_cmd);
+    usb_link.register_handler(UsbCmd::LOG_CTRL, on_log_ctrl);
+    usb_link.register_handler(UsbCmd::PARAM_LIST, on_param_list);
+    usb_link.register_handler(UsbCmd::PARAM_GET, on_param_get);
+    usb_link.register_handler(UsbCmd::PARAM_SET, on_param_set);
+    usb_link.register_handler(UsbCmd::PARAM_SAVE, on_param_save);
+    usb_link.register_handler(UsbCmd::INPUT_RECORD_CTRL, on_input_record_ctrl);
+    usb_link.register_handler(UsbCmd::FF_IDENT, on_ff_ident);
+
+    cpu_profiler.add_deadline(&usb_deadline);
+
+    uint32_t last_stream_ms = osKernelSysTick();
+    uint32_t last_odom_ms = last_stream_ms;
+    uint32_t last_thermal_ms = last_stream_ms;
+    uint32_t last_loop_ms = last_stream_ms;
+
+    while (true) {
+        usb_deadline.tick();
+        uint32_t now_ms = osKernelSysTick();
+
+        // 里程计积分
+        float dt = static_cast<float>(now_ms - last_loop_ms) * 0.001f;
+        last_loop_ms = now_ms;
+        nav_command.update_odometry(
+            chassis_lf.speed, chassis_lr.speed, chassis_rf.speed, chassis_rr.speed, dt);
+        if (now_ms - last_odom_ms >= NAV_ODOM_PERIOD_MS) {
+            last_odom_ms = now_ms;
+            send_nav_odometry(now_ms);
+        }
+
+        uint16_t period_ms = stream_period_ms;
+        if (period_ms != 0 && now_ms - last_stream_ms >= period_ms) {
+            last_stream_ms = now_ms;
+            send_chassis_state(now_ms);
+        }
+
+        if (now_ms - last_thermal_ms >= THERMAL_PERIOD_MS) {
+            last_thermal_ms = now_ms;
+            send_motor_thermal(now_ms);
+        }
+
+        // 记录仪捕获完成后分批上发
+        data_logger.flush(LOG_FLUSH_BATCH);
+
+        // 输入记录持续上发
+        input_recorder.flush(INPUT_FLUSH_BATCH);
+
+        IdentResultFrame ident;
+        if (ff_identifier.take_result(ident)) usb_link.send(UsbCmd::FF_IDENT_RESULT, &ident, sizeof(ident));
+
+        usb_link.poll();
+        osDelay(1);
+    }
+}
@@ -0,0 +1,44 @@
+#include "wheel_pid.hpp"
+
+#include <algorithm>
+
+static float clamp_abs(float value, float limit)
+{
+    return std::max(-limit, std::min(value, limit));
+}
+
+WheelPid::WheelPid(float dt, float kp, float ki, float kd, float mo, float mio, float alpha, float kb)
+: dt_(dt), kp_(kp), ki_(ki), kd_(kd), mo_(mo), mio_(mio), alpha_(alpha), kb_(kb)
+{
+}
+
+void WheelPid::calc(float set, float fdb)
+{
+    float err = set - fdb;
+
+    pr = kp_ * err;
+    ir = clamp_abs(ir + ki_ * err * dt_, mio_);
+    // 首个周期没有上一次误差，不计微分
+    float derivative = started_ ? (err - last_err_) / dt_ : 0.0f;
+    dr = alpha_ * dr + (1.0f - alpha_) * kd_ * derivative;
+    last_err_ = err;
+    started_ = true;
+
+    unsat_ = pr + ir + dr;
+    out = clamp_abs(unsat_, mo_);
+}
+
+void WheelPid::set_gains(float kp, float ki, float kd)
+{
+    kp_ = kp;
+    ki_ = ki;
+    kd_ = kd;
+}
+
+// 只向零回退已累积的积分。大误差时单靠kp就饱和，不加限制会把积分推到另一侧直到未饱和输出等于限幅值，
+// 饱和结束后积分项要按ki·e·dt慢慢回来，期间留下稳态误差
+void WheelPid::back_calculate(float applied)
+{
+    float next = ir + kb_ * (applied - unsat_) * dt_;
+    ir = (ir > 0.0f) ? std::max(0.0f, std::min(next, ir)) : std::min(0.0f, std::max(next, ir));
+}
@@ -0,0 +1,42 @@
+#ifndef WHEEL_PID_HPP
+#define WHEEL_PID_HPP
+
+// 轮速环PID，带反算 (back-calculation) 抗积分饱和
+// 与sp::PID的参数含义一致：积分项按 ki·e·dt 累积并限幅在±mio，
+// 微分项为 kd·de/dt 经 alpha 一阶低通，总输出限幅在±mo。
+// 输出在下游被功率缩放或安全限幅后，调用back_calculate()把实际执行的力矩反馈回来，
+// 积分项按 kb·(实际输出-未饱和输出)·dt 向零回退，避免对无法达到的目标持续累积
+class WheelPid
+{
+public:
+    WheelPid(float dt, float kp, float ki, float kd, float mo, float mio, float alpha, float kb);
+
+    void calc(float set, float fdb);
+
+    // applied为本周期实际下发的PID部分力矩
+    void back_calculate(float applied);
+
+    // 增益调度：积分项按输出量累积，切换ki时输出不跳变
+    void set_gains(float kp, float ki, float kd);
+
+    float out = 0.0f;  // 限幅后的输出
+    float pr = 0.0f;
+    float ir = 0.0f;
+    float dr = 0.0f;
+
+private:
+    float dt_;
+    float kp_;
+    float ki_;
+    float kd_;
+    float mo_;
+    float mio_;
+    float alpha_;
+    float kb_;
+
+    float last_err_ = 0.0f;
+    bool started_ = false;
+    float unsat_ = 0.0f;  // 限幅前的输出
+};
+
+#endif // WHEEL_PID_HPP
@@ -0,0 +1,63 @@
+#include "wheel_tracker.hpp"
+
+#include <algorithm>
+
+#include "cpu_profiler.hpp"
+
+constexpr float TRACKER_GAP_RATIO = 5.0f;  // 帧间隔超过标称值的该倍数视为断流，重新初始化
+constexpr float TRACKER_DT_MIN_RATIO = 0.5f;
+constexpr float TRACKER_DT_MAX_RATIO = 2.0f;
+
+WheelTracker::WheelTracker(float alpha, float beta, float nominal_dt, float max_extrapolate)
+: alpha_(alpha), beta_(beta), nominal_dt_(nominal_dt), max_extrapolate_(max_extrapolate)
+{
+}
+
+void WheelTracker::update(float measurement, uint32_t frame_cycles, uint32_t now_cycles)
+{
+    // 系统时钟在任务启动前才配置好，不能在构造时换算
+    const float seconds_per_cycle = 1e-6f / static_cast<float>(profiler_cycles_per_us());
+
+    if (!initialized_) {
+        rate_ = measurement;
+        accel_ = 0.0f;
+        last_cycles_ = frame_cycles;
+        initialized_ = true;
+    }
+    else if (frame_cycles != last_cycles_) {
+        float dt = static_cast<float>(frame_cycles - last_cycles_) * seconds_per_cycle;
+        last_cycles_ = frame_cycles;
+
+        if (dt > TRACKER_GAP_RATIO * nominal_dt_) {
+            rate_ = measurement;
+            accel_ = 0.0f;
+        }
+        else {
+            // 帧间隔抖动时限制dt，避免两帧紧挨着到达时β/dt把一个量化台阶放大成加速度尖峰
+            dt = std::max(TRACKER_DT_MIN_RATIO * nominal_dt_, std::min(dt, TRACKER_DT_MAX_RATIO * nominal_dt_));
+            float predicted = rate_ + accel_ * dt;
+            float residual = measurement - predicted;
+            rate_ = predicted + alpha_ * residual;
+            accel_ += beta_ / dt * residual;
+        }
+    }
+
+    // 从帧到达时刻外推到当前时刻；反馈中断后停止外推，加速度按0处理
+    float age = static_cast<float>(now_cycles - last_cycles_) * seconds_per_cycle;
+    if (age > max_extrapolate_) {
+        speed = rate_;
+        accel = 0.0f;
+        return;
+    }
+    speed = rate_ + accel_ * age;
+    accel = accel_;
+}
+
+void WheelTracker::reset()
+{
+    initialized_ = false;
+    rate_ = 0.0f;
+    accel_ = 0.0f;
+    speed = 0.0f;
+    accel = 0.0f;
+}
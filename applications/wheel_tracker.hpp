@@ -0,0 +1,36 @@
+#ifndef WHEEL_TRACKER_HPP
+#define WHEEL_TRACKER_HPP
+
+#include <cstdint>
+
+// 轮速α-β跟踪器
+// 电调反馈帧与控制周期不同步，且轮速按转子rpm整数量化，直接差分得到的加速度基本是噪声；
+// 以 [轮速, 角加速度] 为状态，每收到一帧按实际帧间隔做预测-修正，
+// 控制周期取值时再从该帧的到达时刻外推到当前时刻
+class WheelTracker
+{
+public:
+    // alpha/beta: 速度/加速度修正增益; nominal_dt: 标称反馈周期 s; max_extrapolate: 最长外推时间 s
+    WheelTracker(float alpha, float beta, float nominal_dt, float max_extrapolate);
+
+    // measurement: 最近一帧的轮速 rad/s; frame_cycles: 该帧到达时的周期计数; now_cycles: 当前周期计数
+    void update(float measurement, uint32_t frame_cycles, uint32_t now_cycles);
+
+    void reset();
+
+    float speed = 0.0f;  // 对齐到当前时刻的轮速 rad/s
+    float accel = 0.0f;  // 角加速度 rad/s^2
+
+private:
+    const float alpha_;
+    const float beta_;
+    const float nominal_dt_;
+    const float max_extrapolate_;
+
+    float rate_ = 0.0f;   // 最近一帧时刻的速度状态
+    float accel_ = 0.0f;
+    uint32_t last_cycles_ = 0;
+    bool initialized_ = false;
+};
+
+#endif // WHEEL_TRACKER_HPP
@@ -0,0 +1,32 @@
+"""与固件一致的crc16 (同裁判系统协议，CRC-16/MCRF4XX)，校验值小端附在帧末尾"""
+
+
+def _make_table():
+    table = []
+    for byte in range(256):
+        crc = byte
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0x8408 if crc & 1 else crc >> 1
+        table.append(crc)
+    return table
+
+
+_TABLE = _make_table()
+
+
+def crc16(data, crc=0xFFFF):
+    for byte in data:
+        crc = (crc >> 8) ^ _TABLE[(crc ^ byte) & 0xFF]
+    return crc
+
+
+def append_crc16(data):
+    crc = crc16(data)
+    return bytes(data) + bytes((crc & 0xFF, crc >> 8))
+
+
+def check_crc16(frame):
+    if len(frame) <= 2:
+        return False
+    crc = crc16(frame[:-2])
+    return frame[-2] == (crc & 0xFF) and frame[-1] == (crc >> 8)
@@ -0,0 +1,269 @@
+#!/usr/bin/env python3
+"""在线参数 (applications/param_server.hpp) 的上位机客户端
+
+  param_client.py /dev/ttyACM0 list
+  param_client.py /dev/ttyACM0 get pid_kp pid_ki
+  param_client.py /dev/ttyACM0 set pid_kp=2.5 pid_ki=0.8
+  param_client.py /dev/ttyACM0 dump params.json
+  param_client.py /dev/ttyACM0 load params.json
+  param_client.py /dev/ttyACM0 save
+  param_client.py /dev/ttyACM0 sweep pid_kp 1.0 3.0 0.5 --dwell 2
+  param_client.py /dev/ttyACM0 script tune.txt
+
+一次set中的参数由下位机整批校验，在同一个控制周期开始时一起生效。
+sweep 和 script 结束后恢复开始前的参数 (--keep 保留最后的值)。
+脚本每行一条命令，#开头为注释:
+  set <名称>=<值> ...
+  wait <秒>
+  sweep <名称> <起始> <终止> <步长> <每步停留秒>
+  save
+"""
+
+import argparse
+import collections
+import json
+import shlex
+import struct
+import sys
+import time
+
+from usb_link import UsbCmd, UsbLink
+
+PARAM_TYPE_F32 = 0
+PARAM_TYPE_U32 = 1
+PARAM_ENTRY = struct.Struct("<BI")
+PARAM_ENTRIES_PER_FRAME = (120 - 1) // PARAM_ENTRY.size
+BUSY_RETRY = 5
+
+STATUS_NAMES = {0: "OK", 1: "INVALID", 2: "BUSY", 3: "LOCKED", 4: "STORAGE_ERROR"}
+
+Param = collections.namedtuple("Param", "id name type min max value")
+
+
+class ParamError(Exception):
+    pass
+
+
+def encode_value(param, value):
+    if param.type == PARAM_TYPE_U32:
+        return int(value) & 0xFFFFFFFF
+    return struct.unpack("<I", struct.pack("<f", float(value)))[0]
+
+
+def decode_value(param_type, raw):
+    if param_type == PARAM_TYPE_U32:
+        return raw
+    return struct.unpack("<f", struct.pack("<I", raw))[0]
+
+
+def frange(start, stop, step):
+    """含终点的等步长序列，按步数生成避免累加误差"""
+    if step == 0:
+        raise ValueError("step must be non-zero")
+    count = int(round((stop - start) / step))
+    if count < 0:
+        raise ValueError("step has wrong sign")
+    return [start + i * step for i in range(count + 1)]
+
+
+def _entries(reply):
+    """PARAM_VALUE回复: status u8, ParamEntry * n"""
+    count = (len(reply) - 1) // PARAM_ENTRY.size
+    return [PARAM_ENTRY.unpack_from(reply, 1 + i * PARAM_ENTRY.size) for i in range(count)]
+
+
+class ParamClient:
+    def __init__(self, link, timeout=1.0):
+        self.link = link
+        self.timeout = timeout
+        self.params = {}
+
+    def refresh(self):
+        """请求参数表，返回 {名称: Param}"""
+        replies = self.link.request_list(UsbCmd.PARAM_LIST, UsbCmd.PARAM_INFO, timeout=self.timeout)
+        if not replies:
+            raise ParamError("no reply to PARAM_LIST")
+        params = {}
+        for payload in replies:
+            pid, ptype, pmin, pmax, raw = struct.unpack_from("<BBffI", payload)
+            name = payload[14:].decode("utf-8", "replace")
+            params[name] = Param(pid, name, ptype, pmin, pmax, decode_value(ptype, raw))
+        self.params = params
+        return params
+
+    def param(self, name):
+        if not self.params:
+            self.refresh()
+        if name not in self.params:
+            raise ParamError("unknown parameter %s" % name)
+        return self.params[name]
+
+    def _request(self, cmd, payload):
+        """发送一条请求，等待PARAM_VALUE回复，返回 (状态, [(id, 原始值)])"""
+        self.link.send(cmd, payload)
+        deadline = time.monotonic() + self.timeout
+        while time.monotonic() < deadline:
+            frame = self.link.receive(deadline - time.monotonic())
+            if frame is None:
+                break
+            reply_cmd, reply = frame
+            if reply_cmd != UsbCmd.PARAM_VALUE:
+                continue
+            return reply[0], _entries(reply)
+        raise ParamError("no reply to %s" % UsbCmd(cmd).name)
+
+    def get(self, names=None):
+        """读取参数当前值，names为空时读取全部"""
+        if not self.params:
+            self.refresh()
+        if not names:
+            self.link.send(UsbCmd.PARAM_GET)
+            replies = self.link.collect(UsbCmd.PARAM_VALUE, timeout=self.timeout)
+            if not replies:
+                raise ParamError("no reply to PARAM_GET")
+            entries = []
+            for reply in replies:
+                if reply[0] != 0:
+                    raise ParamError("get failed: %s" % STATUS_NAMES.get(reply[0], reply[0]))
+                entries += _entries(reply)
+        else:
+            ids = bytes(self.param(name).id for name in names)
+            entries = []
+            for start in range(0, len(ids), PARAM_ENTRIES_PER_FRAME):
+                status, chunk = self._request(UsbCmd.PARAM_GET, ids[start : start + PARAM_ENTRIES_PER_FRAME])
+                if status != 0:
+                    raise ParamError("get failed: %s" % STATUS_NAMES.get(status, status))
+                entries += chunk
+        by_id = {p.id: p for p in self.params.values()}
+        return {by_id[pid].name: decode_value(by_id[pid].type, raw) for pid, raw in entries}
+
+    def set(self, values):
+        """整批写入 {名称: 值}，同一批在同一个控制周期生效；一帧放不下时报错而不是拆开"""
+        if len(values) > PARAM_ENTRIES_PER_FRAME:
+            raise ParamError("at most %d parameters per set" % PARAM_ENTRIES_PER_FRAME)
+        payload = b""
+        for name, value in values.items():
+            param = self.param(name)
+            if not param.min <= float(value) <= param.max:
+                raise ParamError("%s=%s out of range [%g, %g]" % (name, value, param.min, param.max))
+            payload += PARAM_ENTRY.pack(param.id, encode_value(param, value))
+        for _ in range(BUSY_RETRY):
+            status, _ = self._request(UsbCmd.PARAM_SET, payload)
+            if STATUS_NAMES.get(status) != "BUSY":
+                break
+            time.sleep(0.01)
+        if status != 0:
+            raise ParamError("set failed: %s" % STATUS_NAMES.get(status, status))
+
+    def set_all(self, values):
+        """写入任意多个参数，超过一帧时分批，各批之间不保证同时生效"""
+        items = list(values.items())
+        for start in range(0, len(items), PARAM_ENTRIES_PER_FRAME):
+            self.set(dict(items[start : start + PARAM_ENTRIES_PER_FRAME]))
+
+    def save(self):
+        status, _ = self._request(UsbCmd.PARAM_SAVE, b"")
+        if status != 0:
+            raise ParamError("save failed: %s" % STATUS_NAMES.get(status, status))
+
+
+def parse_assignments(items):
+    values = {}
+    for item in items:
+        name, sep, value = item.partition("=")
+        if not sep:
+            raise ParamError("expected name=value, got %s" % item)
+        values[name] = float(value)
+    return values
+
+
+def sweep(client, name, start, stop, step, dwell, log=print):
+    for value in frange(start, stop, step):
+        client.set({name: value})
+        log("%.3f %s=%g" % (time.monotonic(), name, value))
+        time.sleep(dwell)
+
+
+def run_script(client, lines, log=print):
+    for number, line in enumerate(lines, 1):
+        words = shlex.split(line, comments=True)
+        if not words:
+            continue
+        op, args = words[0], words[1:]
+        try:
+            if op == "set":
+                client.set(parse_assignments(args))
+                log("%.3f set %s" % (time.monotonic(), " ".join(args)))
+            elif op == "wait":
+                time.sleep(float(args[0]))
+            elif op == "sweep":
+                sweep(client, args[0], *map(float, args[1:5]), log=log)
+            elif op == "save":
+                client.save()
+            else:
+                raise ParamError("unknown command %s" % op)
+        except (IndexError, ValueError) as e:
+            raise ParamError("line %d: %s" % (number, e))
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("device", help="USB CDC设备")
+    parser.add_argument("--keep", action="store_true", help="sweep/script结束后不恢复原参数")
+    sub = parser.add_subparsers(dest="command", required=True)
+    sub.add_parser("list")
+    sub.add_parser("get").add_argument("names", nargs="*")
+    sub.add_parser("set").add_argument("assignments", nargs="+")
+    sub.add_parser("dump").add_argument("file")
+    sub.add_parser("load").add_argument("file")
+    sub.add_parser("save")
+    p = sub.add_parser("sweep")
+    p.add_argument("name")
+    p.add_argument("start", type=float)
+    p.add_argument("stop", type=float)
+    p.add_argument("step", type=float)
+    p.add_argument("--dwell", type=float, default=1.0, help="每步停留时间 s")
+    sub.add_parser("script").add_argument("file")
+    args = parser.parse_args(argv)
+
+    with UsbLink(args.device) as link:
+        client = ParamClient(link)
+        try:
+            if args.command == "list":
+                for param in sorted(client.refresh().values(), key=lambda p: p.id):
+                    kind = "f32" if param.type == PARAM_TYPE_F32 else "u32"
+                    print("%2d %-20s %s %-12g [%g, %g]" % (param.id, param.name, kind, param.value, param.min, param.max))
+            elif args.command == "get":
+                for name, value in client.get(args.names).items():
+                    print("%s=%g" % (name, value))
+            elif args.command == "set":
+                client.set(parse_assignments(args.assignments))
+            elif args.command == "dump":
+                with open(args.file, "w") as f:
+                    json.dump(client.get(), f, indent=2)
+                    f.write("\n")
+            elif args.command == "load":
+                with open(args.file) as f:
+                    client.set_all(json.load(f))
+            elif args.command == "save":
+                client.save()
+            else:
+                original = client.get()
+                try:
+                    if args.command == "sweep":
+                        sweep(client, args.name, args.start, args.stop, args.step, args.dwell)
+                    else:
+                        with open(args.file) as f:
+                            run_script(client, f.readlines())
+                finally:
+                    if not args.keep:
+                        current = client.get()
+                        client.set_all({n: v for n, v in original.items() if current[n] != v})
+        except ParamError as e:
+            print("error: %s" % e, file=sys.stderr)
+            return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
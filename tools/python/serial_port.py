@@ -0,0 +1,60 @@
+"""串口/伪终端/普通文件的统一读写，只依赖标准库 (termios)"""
+
+import os
+import select
+import stat
+import termios
+import tty
+
+_BAUD = {
+    115200: termios.B115200,
+    230400: termios.B230400,
+    460800: getattr(termios, "B460800", None),
+    921600: getattr(termios, "B921600", None),
+}
+
+
+class Port:
+    """字符设备按原始模式打开并设置波特率，普通文件按顺序读完即止"""
+
+    def __init__(self, path, baud=None, write=False):
+        flags = os.O_RDWR if write else os.O_RDONLY
+        self.fd = os.open(path, flags | os.O_NOCTTY)
+        self.is_tty = stat.S_ISCHR(os.fstat(self.fd).st_mode) and os.isatty(self.fd)
+        if self.is_tty:
+            tty.setraw(self.fd)
+            if baud is not None:
+                speed = _BAUD.get(baud)
+                if speed is None:
+                    raise ValueError("unsupported baud rate %d" % baud)
+                attrs = termios.tcgetattr(self.fd)
+                attrs[4] = attrs[5] = speed
+                termios.tcsetattr(self.fd, termios.TCSANOW, attrs)
+
+    def read(self, timeout=0.1, size=4096):
+        """返回读到的字节；超时返回b""；文件读完或设备关闭返回None"""
+        if self.is_tty:
+            ready, _, _ = select.select([self.fd], [], [], timeout)
+            if not ready:
+                return b""
+        try:
+            data = os.read(self.fd, size)
+        except OSError:
+            # 伪终端对端关闭时读返回EIO
+            return None
+        return data if data else None
+
+    def write(self, data):
+        view = memoryview(data)
+        while view:
+            written = os.write(self.fd, view)
+            view = view[written:]
+
+    def close(self):
+        os.close(self.fd)
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
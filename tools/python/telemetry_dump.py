@@ -0,0 +1,175 @@
+#!/usr/bin/env python3
+"""把遥测流解码为CSV或按列存储的二进制文件
+
+  telemetry_dump.py capture.bin --channels channels.json -o out.csv
+  telemetry_dump.py /dev/ttyUSB0 --baud 921600 --link /dev/ttyACM0 -o out.csv --duration 10
+  telemetry_dump.py capture.bin --channels channels.json --columnar out_dir
+
+通道表来自 --channels 指定的json文件，或经USB命令通道 (--link) 向下位机请求
+(TELEMETRY_LIST)，可用 --save-channels 保存下来供离线解码。
+
+列存格式: 目录下 stamp_ms.u32 为小端uint32时间戳，<通道名>.f64 为小端float64，
+本帧未采样的通道为NaN；manifest.json 记录行数、列名和文件名
+"""
+
+import argparse
+import csv
+import json
+import math
+import os
+import struct
+import sys
+import time
+
+from serial_port import Port
+from telemetry_stream import TelemetryDecoder, channel_from_payload, load_channels, save_channels
+from usb_link import UsbCmd, UsbLink
+
+
+def fetch_channels(link_path):
+    with UsbLink(link_path) as link:
+        replies = link.request_list(UsbCmd.TELEMETRY_LIST, UsbCmd.TELEMETRY_CHANNEL)
+    channels = {}
+    for payload in replies:
+        channel = channel_from_payload(payload)
+        channels[channel.id] = channel
+    return channels
+
+
+def read_samples(path, decoder, baud=None, duration=None):
+    """逐帧产出采样；设备读到duration秒或Ctrl-C为止，文件读完为止"""
+    deadline = None if duration is None else time.monotonic() + duration
+    with Port(path, baud) as port:
+        try:
+            while deadline is None or time.monotonic() < deadline:
+                data = port.read()
+                if data is None:
+                    break
+                yield from decoder.feed(data)
+        except KeyboardInterrupt:
+            pass
+
+
+class CsvWriter:
+    def __init__(self, path, ids, names, fill):
+        self._file = open(path, "w", newline="") if path != "-" else sys.stdout
+        self._writer = csv.writer(self._file)
+        self._writer.writerow(["stamp_ms"] + names)
+        self._ids = ids
+        self._fill = fill
+        self._held = {}
+
+    def write(self, sample):
+        if self._fill:
+            self._held.update(sample.values)
+            values = self._held
+        else:
+            values = sample.values
+        self._writer.writerow([sample.stamp_ms] + [_format(values.get(cid)) for cid in self._ids])
+
+    def close(self):
+        if self._file is not sys.stdout:
+            self._file.close()
+
+
+class ColumnarWriter:
+    def __init__(self, directory, ids, names, fill):
+        os.makedirs(directory, exist_ok=True)
+        self._directory = directory
+        self._ids = ids
+        self._names = names
+        self._fill = fill
+        self._held = {}
+        self._rows = 0
+        self._stamp = open(os.path.join(directory, "stamp_ms.u32"), "wb")
+        self._columns = [open(os.path.join(directory, name + ".f64"), "wb") for name in names]
+
+    def write(self, sample):
+        if self._fill:
+            self._held.update(sample.values)
+            values = self._held
+        else:
+            values = sample.values
+        self._stamp.write(struct.pack("<I", sample.stamp_ms))
+        for cid, column in zip(self._ids, self._columns):
+            value = values.get(cid)
+            column.write(struct.pack("<d", math.nan if value is None else float(value)))
+        self._rows += 1
+
+    def close(self):
+        self._stamp.close()
+        for column in self._columns:
+            column.close()
+        manifest = {
+            "rows": self._rows,
+            "stamp": "stamp_ms.u32",
+            "columns": [{"name": name, "file": name + ".f64"} for name in self._names],
+        }
+        with open(os.path.join(self._directory, "manifest.json"), "w") as f:
+            json.dump(manifest, f, indent=2)
+            f.write("\n")
+
+
+def _format(value):
+    if value is None:
+        return ""
+    if isinstance(value, float):
+        return "%.9g" % value
+    return str(value)
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", help="遥测串口设备或抓包文件")
+    parser.add_argument("--baud", type=int, default=921600, help="串口波特率 (默认921600)")
+    parser.add_argument("--channels", help="通道表json")
+    parser.add_argument("--link", help="USB命令通道设备，用于请求通道表")
+    parser.add_argument("--save-channels", help="把通道表保存到该json文件")
+    parser.add_argument("-o", "--output", help="输出CSV文件，'-'为标准输出")
+    parser.add_argument("--columnar", help="输出列存目录")
+    parser.add_argument("--fill", action="store_true", help="抽取通道在未采样的帧中沿用上一次的值")
+    parser.add_argument("--duration", type=float, help="从设备读取的时长 s")
+    args = parser.parse_args(argv)
+
+    if args.channels:
+        channels = load_channels(args.channels)
+    elif args.link:
+        channels = fetch_channels(args.link)
+        if not channels:
+            parser.error("no reply to TELEMETRY_LIST on %s" % args.link)
+    else:
+        parser.error("one of --channels or --link is required")
+    if args.save_channels:
+        save_channels(args.save_channels, channels)
+    if not args.output and not args.columnar:
+        parser.error("one of --output or --columnar is required")
+
+    ids = sorted(channels)
+    names = [channels[cid].name for cid in ids]
+    writers = []
+    if args.output:
+        writers.append(CsvWriter(args.output, ids, names, args.fill))
+    if args.columnar:
+        writers.append(ColumnarWriter(args.columnar, ids, names, args.fill))
+
+    decoder = TelemetryDecoder(channels)
+    count = 0
+    try:
+        for sample in read_samples(args.input, decoder, args.baud, args.duration):
+            for writer in writers:
+                writer.write(sample)
+            count += 1
+    finally:
+        for writer in writers:
+            writer.close()
+
+    print(
+        "%d samples, %d frames, %d lost, %d crc errors, %d skipped"
+        % (count, decoder.frames, decoder.lost_frames, decoder.crc_errors, decoder.skipped_frames),
+        file=sys.stderr,
+    )
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
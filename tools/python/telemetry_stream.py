@@ -0,0 +1,288 @@
+"""遥测流 (applications/telemetry.hpp) 解码
+
+帧格式 (小端):
+  [0x5A][0xA5][len u16][kind u8][seq u8][body: len-2字节][crc16]
+kind 0 原始帧、1 压缩关键帧、2 压缩差分帧、3 通道描述帧，详见telemetry.hpp
+
+JustFloat格式 (VOFA+) 的数据帧没有帧头: [所选通道值 f32 * slots][00 00 80 7F]，
+帧长由通道描述帧中的slots确定，通道号和名称也来自描述帧
+"""
+
+import collections
+import json
+import struct
+
+from crc16 import check_crc16
+
+SOF = b"\x5a\xa5"
+HEADER_SIZE = 6
+MAX_FRAME_LEN = 1024
+
+KIND_RAW = 0
+KIND_KEY = 1
+KIND_DELTA = 2
+KIND_SCHEMA = 3
+KIND_JUSTFLOAT = 4  # 解码端内部使用，表示JustFloat数据帧
+
+JUSTFLOAT_TAIL = b"\x00\x00\x80\x7f"
+
+# TelemetryType: 名称, struct格式
+TYPES = {
+    0: ("U8", "<B"),
+    1: ("U16", "<H"),
+    2: ("U32", "<I"),
+    3: ("I16", "<h"),
+    4: ("I32", "<i"),
+    5: ("F32", "<f"),
+}
+TYPE_F32 = 5
+TYPE_U32 = 2
+
+Channel = collections.namedtuple("Channel", "id name type decimation quantum")
+
+# 一个采样帧: stamp_ms (JustFloat帧为None), kind, values {通道号: 值}
+Sample = collections.namedtuple("Sample", "stamp_ms kind values")
+
+
+def _f32(value):
+    return struct.unpack("<f", struct.pack("<f", value))[0]
+
+
+def channel_from_payload(payload):
+    """解析USB TELEMETRY_CHANNEL回复: id u8, type u8, decimation u16, quantum f32, name"""
+    cid, ctype, decimation, quantum = struct.unpack_from("<BBHf", payload)
+    name = payload[8:].decode("utf-8", "replace")
+    return Channel(cid, name, ctype, decimation, quantum)
+
+
+def load_channels(path):
+    with open(path) as f:
+        entries = json.load(f)
+    return {
+        e["id"]: Channel(e["id"], e["name"], e["type"], e.get("decimation", 1), _f32(e.get("quantum", 1.0)))
+        for e in entries
+    }
+
+
+def save_channels(path, channels):
+    entries = [c._asdict() for c in sorted(channels.values())]
+    with open(path, "w") as f:
+        json.dump(entries, f, indent=2)
+        f.write("\n")
+
+
+def _varint(body, pos):
+    value = 0
+    shift = 0
+    while True:
+        if pos >= len(body) or shift > 28:
+            raise ValueError("truncated varint")
+        byte = body[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        if not byte & 0x80:
+            return value & 0xFFFFFFFF, pos
+        shift += 7
+
+
+def _unzigzag(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+def _wrap_i32(value):
+    value &= 0xFFFFFFFF
+    return value - (1 << 32) if value & 0x80000000 else value
+
+
+def _mask_ids(mask):
+    cid = 0
+    while mask:
+        if mask & 1:
+            yield cid
+        mask >>= 1
+        cid += 1
+
+
+class TelemetryDecoder:
+    """从字节流中解出采样帧；丢帧或crc错误后等待下一个关键帧再继续解差分帧。
+    收到通道描述帧后按JustFloat格式解析无帧头的数据帧，再收到数据帧头时切回"""
+
+    def __init__(self, channels=None):
+        self.channels = dict(channels or {})
+        self._buffer = bytearray()
+        self._seq = None
+        self._last = None  # 压缩格式各通道上一次的量化值，None表示等待关键帧
+        self._last_stamp = 0
+        self._justfloat_size = None  # JustFloat数据帧长，None表示不在JustFloat格式
+        self.frames = 0
+        self.crc_errors = 0
+        self.lost_frames = 0
+        self.skipped_frames = 0  # 等待关键帧或无法解析而跳过的数据帧
+        self.schema = {}  # 通道描述帧: slot -> 通道号
+
+    @property
+    def schema_complete(self):
+        """JustFloat格式下已收齐全部slot的通道描述"""
+        return self._justfloat_size is not None and len(self.schema) * 4 + 4 == self._justfloat_size
+
+    def feed(self, data):
+        self._buffer.extend(data)
+        samples = []
+        buf = self._buffer
+        pos = 0
+        while pos < len(buf):
+            # 先试带帧头的帧：选择变化后的描述帧加上新的短数据帧可能恰好符合旧帧长
+            if buf.startswith(SOF, pos):
+                end = self._header_frame(buf, pos, samples)
+                if end is None:
+                    break  # 等待帧的其余部分
+                if end > pos:
+                    pos = end
+                    continue
+
+            size = self._justfloat_size
+            if size is not None and len(buf) - pos >= size and buf[pos + size - 4 : pos + size] == JUSTFLOAT_TAIL:
+                samples.append(self._justfloat(buf[pos : pos + size - 4]))
+                pos += size
+                continue
+
+            if size is not None:
+                # JustFloat失步：丢到下一个帧尾或帧头之后重新对齐
+                if len(buf) - pos < size:
+                    break
+                tail = buf.find(JUSTFLOAT_TAIL, pos)
+                sof = buf.find(SOF, pos + 1)
+                candidates = [i for i in (tail + 4 if tail >= 0 else -1, sof) if i > pos]
+                if not candidates:
+                    pos = max(pos, len(buf) - 3)
+                    break
+                self.skipped_frames += 1
+                pos = min(candidates)
+            else:
+                start = buf.find(SOF, pos + 1)
+                if start < 0:
+                    # 保留末尾可能是帧头前半的字节
+                    pos = len(buf) - 1 if buf.endswith(SOF[:1]) else len(buf)
+                    break
+                pos = start
+        del buf[:pos]
+        return samples
+
+    def _header_frame(self, buf, start, samples):
+        """解析start处的带帧头帧，返回帧尾位置；数据不够返回None，不是有效帧返回start"""
+        if len(buf) - start < 4:
+            return None
+        length = buf[start + 2] | (buf[start + 3] << 8)
+        if length < 2 or length > MAX_FRAME_LEN:
+            return start
+        end = start + HEADER_SIZE + length - 2 + 2
+        if end > len(buf):
+            # JustFloat数据中可能出现帧头字节，帧长不可信时不等待
+            return None if self._justfloat_size is None else start
+        frame = bytes(buf[start:end])
+        if not check_crc16(frame):
+            # JustFloat格式下多半是数据中恰好出现帧头字节，不计为crc错误
+            if self._justfloat_size is None:
+                self.crc_errors += 1
+            return start
+        sample = self._frame(frame[4], frame[5], frame[HEADER_SIZE:-2])
+        if sample is not None:
+            samples.append(sample)
+        return end
+
+    def _frame(self, kind, seq, body):
+        self.frames += 1
+        if self._seq is not None and seq != (self._seq + 1) & 0xFF:
+            self.lost_frames += (seq - self._seq - 1) & 0xFF
+            self._last = None
+        self._seq = seq
+        if kind != KIND_SCHEMA:
+            self._justfloat_size = None
+        try:
+            if kind == KIND_RAW:
+                return self._raw(body)
+            if kind in (KIND_KEY, KIND_DELTA):
+                return self._compact(kind, body)
+            if kind == KIND_SCHEMA:
+                self._schema(body)
+                return None
+        except (ValueError, struct.error):
+            pass
+        self.skipped_frames += 1
+        if kind in (KIND_KEY, KIND_DELTA):
+            self._last = None
+        return None
+
+    def _raw(self, body):
+        stamp, mask = struct.unpack_from("<II", body)
+        pos = 8
+        values = {}
+        for cid in _mask_ids(mask):
+            channel = self.channels.get(cid)
+            if channel is None:
+                raise ValueError("unknown channel %d" % cid)
+            fmt = TYPES[channel.type][1]
+            (values[cid],) = struct.unpack_from(fmt, body, pos)
+            pos += struct.calcsize(fmt)
+        return Sample(stamp, KIND_RAW, values)
+
+    def _compact(self, kind, body):
+        if kind == KIND_KEY:
+            (stamp,) = struct.unpack_from("<I", body)
+            pos = 4
+            last = {}
+        else:
+            if self._last is None:
+                self.skipped_frames += 1
+                return None
+            delta, pos = _varint(body, 0)
+            stamp = (self._last_stamp + delta) & 0xFFFFFFFF
+            last = self._last
+        mask, pos = _varint(body, pos)
+
+        quantized = {}
+        for cid in _mask_ids(mask):
+            coded, pos = _varint(body, pos)
+            coded = _unzigzag(coded)
+            if kind == KIND_KEY:
+                quantized[cid] = coded
+            elif cid in last:
+                quantized[cid] = _wrap_i32(last[cid] + coded)
+            else:
+                raise ValueError("delta without base for channel %d" % cid)
+        if pos != len(body):
+            raise ValueError("trailing bytes")
+
+        last.update(quantized)
+        self._last = last
+        self._last_stamp = stamp
+        return Sample(stamp, kind, {cid: self._dequantize(cid, q) for cid, q in quantized.items()})
+
+    def _dequantize(self, cid, q):
+        channel = self.channels.get(cid)
+        if channel is None:
+            return q
+        if channel.type == TYPE_F32:
+            return q * channel.quantum
+        if channel.type == TYPE_U32:
+            return q & 0xFFFFFFFF
+        return q
+
+    def _schema(self, body):
+        slot, slots, cid, ctype = struct.unpack_from("<BBBB", body)
+        if slot >= slots:
+            raise ValueError("bad schema slot")
+        # slot数变化说明通道选择变了，旧描述作废
+        if self._justfloat_size != 4 * slots + 4:
+            self.schema = {}
+            self._justfloat_size = 4 * slots + 4
+        self.schema[slot] = cid
+        name = body[4:].decode("utf-8", "replace")
+        channel = self.channels.get(cid)
+        if channel is None or channel.name != name:
+            self.channels[cid] = Channel(cid, name, ctype, 1, 1.0)
+
+    def _justfloat(self, payload):
+        self.frames += 1
+        floats = struct.unpack("<%df" % (len(payload) // 4), payload)
+        return Sample(None, KIND_JUSTFLOAT, {self.schema[i]: v for i, v in enumerate(floats) if i in self.schema})
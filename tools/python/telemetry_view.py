@@ -0,0 +1,168 @@
+#!/usr/bin/env python3
+"""遥测流实时查看
+
+  telemetry_view.py /dev/ttyUSB0                       JustFloat格式，通道名来自描述帧
+  telemetry_view.py /dev/ttyUSB0 --link /dev/ttyACM0   压缩/原始格式，通道表经USB请求
+  telemetry_view.py capture.bin --channels ch.json --headless --export out.csv
+
+终端中按固定间隔刷新各通道的当前值、最小/最大/均值和最近一段波形，同时可导出CSV。
+JustFloat帧不带时间戳，导出时stamp_ms列为上位机收到数据的时间；
+没有通道表时导出从收齐一轮通道描述后开始。
+读取与解码在同一线程中进行，刷新只在两次读取之间做，1kHz × 20通道下解码耗时远小于帧间隔
+"""
+
+import argparse
+import collections
+import sys
+import time
+
+from serial_port import Port
+from telemetry_dump import CsvWriter, fetch_channels
+from telemetry_stream import KIND_JUSTFLOAT, TelemetryDecoder, load_channels
+
+SPARK = "▁▂▃▄▅▆▇█"
+HISTORY = 48
+
+
+class ChannelStats:
+    def __init__(self):
+        self.history = collections.deque(maxlen=HISTORY)
+        self.value = None
+        self.min = None
+        self.max = None
+        self.total = 0.0
+        self.count = 0
+
+    def add(self, value):
+        self.value = value
+        self.min = value if self.min is None else min(self.min, value)
+        self.max = value if self.max is None else max(self.max, value)
+        self.total += value
+        self.count += 1
+        self.history.append(value)
+
+    def sparkline(self):
+        if not self.history:
+            return ""
+        low, high = min(self.history), max(self.history)
+        span = (high - low) or 1.0
+        return "".join(SPARK[int((v - low) / span * (len(SPARK) - 1))] for v in self.history)
+
+
+class Viewer:
+    def __init__(self, channels=None, export=None):
+        self.decoder = TelemetryDecoder(channels)
+        self.stats = collections.defaultdict(ChannelStats)
+        self.samples = 0
+        self.export_path = export
+        self._writer = None
+        self._export_ids = set()
+        self._fixed_table = bool(channels)
+        self._start = time.monotonic()
+        self._rate_mark = (self._start, 0)
+        self.rate = 0.0
+
+    def feed(self, data):
+        now_ms = int((time.monotonic() - self._start) * 1000)
+        for sample in self.decoder.feed(data):
+            if sample.kind == KIND_JUSTFLOAT:
+                sample = sample._replace(stamp_ms=now_ms)
+            for cid, value in sample.values.items():
+                self.stats[cid].add(value)
+            self.samples += 1
+            self._export(sample)
+
+    def _export(self, sample):
+        if self.export_path is None:
+            return
+        if self._writer is None:
+            if self._fixed_table:
+                ids = sorted(self.decoder.channels)
+            elif self.decoder.schema_complete:
+                ids = sorted(self.decoder.schema.values())
+            else:
+                return
+            names = [self.decoder.channels[cid].name for cid in ids]
+            self._writer = CsvWriter(self.export_path, ids, names, fill=False)
+            self._export_ids = set(ids)
+        # 同一批数据中描述帧收齐之前解出的JustFloat帧缺少部分slot，不导出
+        if sample.kind == KIND_JUSTFLOAT and not self._fixed_table and set(sample.values) != self._export_ids:
+            return
+        self._writer.write(sample)
+
+    def close(self):
+        if self._writer is not None:
+            self._writer.close()
+
+    def render(self, out=sys.stdout):
+        now = time.monotonic()
+        mark_time, mark_samples = self._rate_mark
+        if now - mark_time >= 0.5:
+            self.rate = (self.samples - mark_samples) / (now - mark_time)
+            self._rate_mark = (now, self.samples)
+        d = self.decoder
+        lines = [
+            "\x1b[H\x1b[2J%d samples  %.0f/s  lost %d  crc %d  skipped %d"
+            % (self.samples, self.rate, d.lost_frames, d.crc_errors, d.skipped_frames),
+            "%-20s %12s %12s %12s %12s" % ("channel", "value", "min", "max", "mean"),
+        ]
+        for cid in sorted(self.stats):
+            s = self.stats[cid]
+            channel = d.channels.get(cid)
+            name = channel.name if channel else "#%d" % cid
+            lines.append(
+                "%-20s %12.6g %12.6g %12.6g %12.6g %s" % (name, s.value, s.min, s.max, s.total / s.count, s.sparkline())
+            )
+        out.write("\n".join(lines) + "\n")
+        out.flush()
+
+    def summary(self):
+        d = self.decoder
+        return "%d samples, %d frames, %d lost, %d crc errors, %d skipped" % (
+            self.samples, d.frames, d.lost_frames, d.crc_errors, d.skipped_frames)
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", help="遥测串口设备或抓包文件")
+    parser.add_argument("--baud", type=int, default=921600, help="串口波特率 (默认921600)")
+    parser.add_argument("--channels", help="通道表json (压缩/原始格式需要)")
+    parser.add_argument("--link", help="USB命令通道设备，用于请求通道表")
+    parser.add_argument("--export", help="同时导出CSV")
+    parser.add_argument("--refresh", type=float, default=0.2, help="刷新间隔 s")
+    parser.add_argument("--duration", type=float, help="读取时长 s")
+    parser.add_argument("--headless", action="store_true", help="不刷新画面，结束时输出统计")
+    args = parser.parse_args(argv)
+
+    channels = None
+    if args.channels:
+        channels = load_channels(args.channels)
+    elif args.link:
+        channels = fetch_channels(args.link)
+
+    viewer = Viewer(channels, args.export)
+    deadline = None if args.duration is None else time.monotonic() + args.duration
+    next_render = time.monotonic()
+    try:
+        with Port(args.input, args.baud) as port:
+            while deadline is None or time.monotonic() < deadline:
+                data = port.read(timeout=args.refresh)
+                if data is None:
+                    break
+                viewer.feed(data)
+                if not args.headless and time.monotonic() >= next_render:
+                    viewer.render()
+                    next_render = time.monotonic() + args.refresh
+    except KeyboardInterrupt:
+        pass
+    finally:
+        viewer.close()
+
+    if not args.headless:
+        viewer.render()
+    print(viewer.summary(), file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
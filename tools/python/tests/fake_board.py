@@ -0,0 +1,238 @@
+"""伪终端上的下位机替身，用于在没有C板时测试上位机工具
+
+FakeBoard在一个伪终端的主端按 applications/usb_task.cpp 的规则应答参数和遥测通道命令，
+工具打开从端 (path) 就像打开 /dev/ttyACMx 一样；也可以通过 write() 往从端推送任意字节流。
+导航指令按 applications/nav_command.cpp 的规则检查序号、统计丢失，收到第一条后每5ms回传里程计；
+nav_loss_every 和 nav_delay 模拟链路上丢掉每第N条指令和固定的传输延迟。
+应答与固件一样受发送队列深度限制：一次poll (一次读到的命令) 中入队超过16帧的应答被丢弃并计入
+dropped_frames，列表请求按剩余槽位分页回复
+"""
+
+import collections
+import os
+import select
+import struct
+import threading
+import time
+import tty
+
+from usb_link import FrameParser, UsbCmd, encode_frame
+
+PARAM_ENTRY = struct.Struct("<BI")
+PARAM_ENTRIES_PER_FRAME = (120 - 1) // PARAM_ENTRY.size
+STATUS_OK, STATUS_INVALID = 0, 1
+
+# 与applications/usb_link.hpp相同
+TX_SLOTS = 16
+LIST_TX_RESERVE = 4
+
+# 与applications/nav_command.hpp、usb_task.cpp相同
+NAV_CMD = struct.Struct("<IHfff")
+NAV_ODOM = struct.Struct("<IIHHfffffff")
+NAV_TIMEOUT_MS = 50
+NAV_ODOM_PERIOD_MS = 5
+LATENCY_FILTER_ALPHA = 0.05
+
+# (名称, 类型, 最小值, 最大值, 默认值)，取自applications/param_server.cpp的前几项
+DEFAULT_PARAMS = [
+    ("pid_kp", 0, 0.0, 10.0, 1.5),
+    ("pid_ki", 0, 0.0, 10.0, 0.4),
+    ("pid_kd", 0, 0.0, 1.0, 0.0),
+    ("max_linear_speed", 0, 0.0, 3.5, 2.0),
+    ("rotation_speed", 0, 0.0, 20.0, 10.0),
+]
+
+# applications/param_server.cpp的完整参数表 (17项，多于发送队列槽位)
+FIRMWARE_PARAMS = [
+    ("pid_kp", 0, 0.0, 10.0, 0.5),
+    ("pid_ki", 0, 0.0, 10.0, 0.05),
+    ("pid_kd", 0, 0.0, 1.0, 0.01),
+    ("pid_mo", 0, 0.0, 8.0, 2.5),
+    ("pid_mio", 0, 0.0, 8.0, 1.0),
+    ("k1_torque_loss", 0, 0.0, 20.0, 2.0),
+    ("k2_speed_loss", 0, 0.0, 1.0, 0.005),
+    ("k3_static_power", 0, 0.0, 50.0, 6.2),
+    ("k4_torque_rate", 0, 0.0, 1.0, 0.007),
+    ("k5_speed_rate", 0, 0.0, 1.0, 0.0),
+    ("max_linear_speed", 0, 0.0, 3.5, 2.0),
+    ("rotation_speed", 0, 0.0, 20.0, 10.0),
+    ("ff_inertia", 0, 0.0, 0.5, 0.0),
+    ("ff_viscous", 0, 0.0, 0.5, 0.0),
+    ("ff_coulomb", 0, 0.0, 2.0, 0.0),
+    ("cap_energy_scale", 0, 1.0, 65535.0, 255.0),
+    ("field_phase_lead", 0, 0.0, 0.1, 0.03),
+]
+
+
+def _f32_bits(value):
+    return struct.unpack("<I", struct.pack("<f", value))[0]
+
+
+class FakeBoard:
+    def __init__(self, params=DEFAULT_PARAMS, channels=(), nav_loss_every=0, nav_delay=0.0):
+        self.master, slave = os.openpty()
+        tty.setraw(slave)
+        self.path = os.ttyname(slave)
+        self._slave = slave  # 保持从端打开，工具关闭后主端读不会报错
+        self.params = [list(p) for p in params]
+        self.values = [_f32_bits(p[4]) for p in params]
+        self.channels = list(channels)  # TELEMETRY_CHANNEL payload
+        self.set_log = []  # 每次成功写入的 {id: 原始值}
+        self.saved = False
+        self.dropped_frames = 0  # 超出发送队列深度被丢弃的应答
+        self._queued = 0  # 本次poll中入队的应答帧数
+        self.nav_loss_every = nav_loss_every
+        self.nav_delay = nav_delay
+        self.nav_received = 0
+        self.nav_dropped = 0
+        self._nav_count = 0  # 链路上收到的导航指令数 (含模拟丢失的)
+        self._nav_pending = collections.deque()  # (到达时间, payload)
+        self._nav_last = None  # (本地接收时间ms, seq, 上位机时间戳)
+        self._nav_offset = None
+        self._nav_latency = 0.0
+        self._last_odom_ms = 0
+        self._start = time.monotonic()
+        self._parser = FrameParser()
+        self._seq = 0
+        self._lock = threading.Lock()
+        self._running = True
+        self._thread = threading.Thread(target=self._serve, daemon=True)
+        self._thread.start()
+
+    def close(self):
+        self._running = False
+        self._thread.join()
+        os.close(self.master)
+        os.close(self._slave)
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def write(self, data):
+        with self._lock:
+            view = memoryview(data)
+            while view:
+                view = view[os.write(self.master, view) :]
+
+    def send(self, cmd, payload=b""):
+        self.write(encode_frame(cmd, payload, self._seq))
+        self._seq = (self._seq + 1) & 0xFF
+
+    def _reply(self, cmd, payload=b""):
+        if self._queued >= TX_SLOTS:
+            self.dropped_frames += 1
+            return
+        self._queued += 1
+        self.send(cmd, payload)
+
+    def _reply_budget(self):
+        free = TX_SLOTS - self._queued
+        return free - LIST_TX_RESERVE if free > LIST_TX_RESERVE else min(free, 1)
+
+    def _reply_list(self, cmd, request, items):
+        """与固件相同的分页列表回复：从请求的起始序号起回复一页，到末尾时追加条目总数"""
+        start = request[0] if request else 0
+        budget = self._reply_budget()
+        end = min(start + budget, len(items))
+        for payload in items[start:end]:
+            self._reply(cmd, payload)
+        if end >= len(items) and budget > end - start:
+            self._reply(cmd, bytes((len(items),)))
+
+    def _now_ms(self):
+        return int((time.monotonic() - self._start) * 1000.0) & 0xFFFFFFFF
+
+    def _serve(self):
+        while self._running:
+            # 每轮相当于固件一次poll()，入队的应答在本轮发出
+            self._queued = 0
+            timeout = 0.001 if self._nav_last is not None or self._nav_pending else 0.02
+            ready, _, _ = select.select([self.master], [], [], timeout)
+            if ready:
+                try:
+                    data = os.read(self.master, 4096)
+                except OSError:
+                    data = b""
+                for cmd, payload in self._parser.feed(data):
+                    self._dispatch(cmd, payload)
+            self._serve_nav()
+
+    def _serve_nav(self):
+        while self._nav_pending and self._nav_pending[0][0] <= time.monotonic():
+            self._on_nav_cmd(self._nav_pending.popleft()[1])
+        now_ms = self._now_ms()
+        if self._nav_last is not None and now_ms - self._last_odom_ms >= NAV_ODOM_PERIOD_MS:
+            self._last_odom_ms = now_ms
+            _, seq, pc_stamp = self._nav_last
+            odom = NAV_ODOM.pack(now_ms, pc_stamp, seq, self.nav_dropped & 0xFFFF, self._nav_latency, *([0.0] * 6))
+            self._reply(UsbCmd.NAV_ODOM, odom)
+
+    def _on_nav_cmd(self, payload):
+        if len(payload) != NAV_CMD.size:
+            return
+        stamp, seq, _, _, _ = NAV_CMD.unpack(payload)
+        now_ms = self._now_ms()
+        alive = self._nav_last is not None and now_ms - self._nav_last[0] <= NAV_TIMEOUT_MS
+        if alive:
+            diff = (seq - self._nav_last[1] + 0x8000) % 0x10000 - 0x8000
+            if diff <= 0:
+                return
+            self.nav_dropped += diff - 1
+        else:
+            self._nav_offset = None
+        sample = now_ms - stamp
+        self._nav_offset = sample if self._nav_offset is None else min(self._nav_offset, sample)
+        self._nav_latency += LATENCY_FILTER_ALPHA * (sample - self._nav_offset - self._nav_latency)
+        self._nav_last = (now_ms, seq, stamp)
+        self.nav_received += 1
+
+    def _reply_values(self, status, entries=()):
+        payload = bytes((status,)) + b"".join(PARAM_ENTRY.pack(*e) for e in entries)
+        self._reply(UsbCmd.PARAM_VALUE, payload)
+
+    def _valid(self, pid, raw):
+        if pid >= len(self.params):
+            return False
+        _, ptype, pmin, pmax, _ = self.params[pid]
+        value = raw if ptype == 1 else struct.unpack("<f", struct.pack("<I", raw))[0]
+        return value == value and pmin <= value <= pmax
+
+    def _dispatch(self, cmd, payload):
+        if cmd == UsbCmd.PING:
+            self._reply(UsbCmd.PING, payload)
+        elif cmd == UsbCmd.PARAM_LIST:
+            infos = [
+                struct.pack("<BBffI", pid, ptype, pmin, pmax, self.values[pid]) + name.encode()
+                for pid, (name, ptype, pmin, pmax, _) in enumerate(self.params)
+            ]
+            self._reply_list(UsbCmd.PARAM_INFO, payload, infos)
+        elif cmd == UsbCmd.PARAM_GET:
+            ids = list(payload) if payload else list(range(len(self.params)))
+            if any(pid >= len(self.params) for pid in ids):
+                self._reply_values(STATUS_INVALID)
+                return
+            for start in range(0, len(ids), PARAM_ENTRIES_PER_FRAME):
+                chunk = ids[start : start + PARAM_ENTRIES_PER_FRAME]
+                self._reply_values(STATUS_OK, [(pid, self.values[pid]) for pid in chunk])
+        elif cmd == UsbCmd.PARAM_SET:
+            entries = [PARAM_ENTRY.unpack_from(payload, i) for i in range(0, len(payload), PARAM_ENTRY.size)]
+            if len(payload) % PARAM_ENTRY.size or not all(self._valid(*e) for e in entries):
+                self._reply_values(STATUS_INVALID)
+                return
+            for pid, raw in entries:
+                self.values[pid] = raw
+            self.set_log.append(dict(entries))
+            self._reply_values(STATUS_OK, entries)
+        elif cmd == UsbCmd.PARAM_SAVE:
+            self.saved = True
+            self._reply_values(STATUS_OK)
+        elif cmd == UsbCmd.NAV_CMD:
+            self._nav_count += 1
+            if self.nav_loss_every and self._nav_count % self.nav_loss_every == 0:
+                return
+            self._nav_pending.append((time.monotonic() + self.nav_delay, payload))
+        elif cmd == UsbCmd.TELEMETRY_LIST:
+            self._reply_list(UsbCmd.TELEMETRY_CHANNEL, payload, self.channels)
@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+"""导航上位机 (NUC) 的替身，测量导航指令链路的端到端延迟和丢失
+
+按固定频率发送带时间戳和序号的NAV_CMD (applications/nav_command.hpp)，速度按正弦变化，
+同时接收NAV_ODOM：里程计帧带回下位机最近处理的指令序号，从该指令发出到收到这一帧的时间即端到端延迟
+(含下位机处理和至多一个里程计回传周期)；丢失率取下位机按序号跳变统计的丢失数。
+既可以在单元测试中对FakeBoard运行，也可以直接连C板:
+
+  python3 -m tests.nav_host /dev/ttyACM0 --rate 200 --duration 10
+"""
+
+import argparse
+import collections
+import math
+import struct
+import sys
+import time
+
+from usb_link import UsbCmd, UsbLink
+
+NAV_CMD = struct.Struct("<IHfff")
+NAV_ODOM = struct.Struct("<IIHHfffffff")
+
+NavStats = collections.namedtuple(
+    "NavStats", "sent acked dropped drop_rate latency_mean latency_p95 latency_max board_jitter"
+)
+
+
+def percentile(values, p):
+    ordered = sorted(values)
+    return ordered[min(int(len(ordered) * p), len(ordered) - 1)]
+
+
+class NavHost:
+    def __init__(self, link, vx_amp=0.5, wz_amp=1.0, period=2.0):
+        self.link = link
+        self.vx_amp = vx_amp
+        self.wz_amp = wz_amp
+        self.period = period
+
+    def run(self, rate_hz, duration):
+        start = time.monotonic()
+        interval = 1.0 / rate_hz
+        sent = {}  # seq -> 发出时刻，序号回绕后覆盖
+        latencies = []
+        total = 0
+        seq = 0
+        dropped = 0
+        jitter = 0.0
+        next_send = start
+        end = start + duration
+        while True:
+            now = time.monotonic()
+            if now >= next_send and now < end:
+                t = now - start
+                phase = 2.0 * math.pi * t / self.period
+                stamp = int(t * 1000.0) & 0xFFFFFFFF
+                cmd = NAV_CMD.pack(stamp, seq, self.vx_amp * math.sin(phase), 0.0, self.wz_amp * math.cos(phase))
+                self.link.send(UsbCmd.NAV_CMD, cmd)
+                sent[seq] = now
+                total += 1
+                seq = (seq + 1) & 0xFFFF
+                next_send += interval
+            elif now >= end + 0.1:
+                break
+
+            frame = self.link.receive(max(min(next_send - time.monotonic(), 0.01), 0.0))
+            if frame is None or frame[0] != UsbCmd.NAV_ODOM or len(frame[1]) != NAV_ODOM.size:
+                continue
+            _, _, cmd_seq, dropped, jitter = NAV_ODOM.unpack(frame[1])[:5]
+            # 同一条指令可能被多帧里程计带回，只取第一帧
+            sent_at = sent.pop(cmd_seq, None)
+            if sent_at is not None:
+                latencies.append((time.monotonic() - sent_at) * 1000.0)
+
+        if not latencies:
+            return NavStats(total, 0, dropped, dropped / max(total, 1), 0.0, 0.0, 0.0, jitter)
+        return NavStats(
+            total,
+            len(latencies),
+            dropped,
+            dropped / total,
+            sum(latencies) / len(latencies),
+            percentile(latencies, 0.95),
+            max(latencies),
+            jitter,
+        )
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("port")
+    parser.add_argument("--rate", type=float, default=200.0, help="指令频率 Hz (100-500)")
+    parser.add_argument("--duration", type=float, default=10.0, help="s")
+    parser.add_argument("--vx", type=float, default=0.5, help="前进速度幅值 m/s")
+    parser.add_argument("--wz", type=float, default=1.0, help="旋转速度幅值 rad/s")
+    args = parser.parse_args(argv)
+
+    with UsbLink(args.port) as link:
+        stats = NavHost(link, args.vx, args.wz).run(args.rate, args.duration)
+    print("sent %d, acknowledged by odometry %d" % (stats.sent, stats.acked))
+    print("dropped %d (%.2f%%)" % (stats.dropped, 100.0 * stats.drop_rate))
+    print(
+        "end-to-end latency mean %.1f ms, p95 %.1f ms, max %.1f ms"
+        % (stats.latency_mean, stats.latency_p95, stats.latency_max)
+    )
+    print("board latency jitter estimate %.2f ms" % stats.board_jitter)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
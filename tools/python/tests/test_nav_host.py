@@ -0,0 +1,44 @@
+"""导航指令链路测试，上位机由NavHost代替，下位机由伪终端上的FakeBoard代替"""
+
+import unittest
+
+from tests.fake_board import FakeBoard
+from tests.nav_host import NavHost
+from usb_link import UsbLink
+
+RATE_HZ = 200.0
+DURATION = 1.0
+
+
+class NavHostTest(unittest.TestCase):
+    def run_host(self, **board_args):
+        with FakeBoard(**board_args) as board, UsbLink(board.path) as link:
+            stats = NavHost(link).run(RATE_HZ, DURATION)
+            return stats, board
+
+    def test_clean_link(self):
+        stats, board = self.run_host()
+        self.assertGreaterEqual(stats.sent, RATE_HZ * DURATION * 0.9)
+        self.assertEqual(board.nav_received, stats.sent)
+        self.assertEqual(stats.dropped, 0)
+        # 指令每5ms带回一次，200Hz下大部分指令都能被确认
+        self.assertGreater(stats.acked, stats.sent * 0.5)
+        self.assertLess(stats.latency_p95, 30.0)
+
+    def test_drop_rate(self):
+        stats, board = self.run_host(nav_loss_every=10)
+        # 最后一条之后丢失的指令下位机看不到序号跳变
+        lost = stats.sent // 10
+        self.assertIn(stats.dropped, (lost - 1, lost))
+        self.assertAlmostEqual(stats.drop_rate, 0.1, delta=0.01)
+        self.assertEqual(board.nav_received, stats.sent - lost)
+
+    def test_latency(self):
+        stats, _ = self.run_host(nav_delay=0.02)
+        self.assertGreaterEqual(stats.latency_mean, 20.0)
+        self.assertLess(stats.latency_mean, 20.0 + 15.0)
+        self.assertEqual(stats.dropped, 0)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,84 @@
+"""参数客户端测试，下位机由伪终端上的FakeBoard代替"""
+
+import os
+import struct
+import tempfile
+import unittest
+
+import param_client
+from tests.fake_board import FIRMWARE_PARAMS, TX_SLOTS, FakeBoard
+from param_client import ParamClient, ParamError
+from usb_link import UsbLink
+
+
+def _f32(value):
+    return struct.unpack("<f", struct.pack("<f", value))[0]
+
+
+def _bits(value):
+    return struct.unpack("<I", struct.pack("<f", value))[0]
+
+
+class ParamClientTest(unittest.TestCase):
+    def setUp(self):
+        self.board = FakeBoard()
+        self.link = UsbLink(self.board.path)
+        self.client = ParamClient(self.link)
+
+    def tearDown(self):
+        self.link.close()
+        self.board.close()
+
+    def test_list_and_get(self):
+        params = self.client.refresh()
+        self.assertEqual([params[n].id for n in ("pid_kp", "pid_ki", "rotation_speed")], [0, 1, 4])
+        self.assertEqual(params["max_linear_speed"].max, 3.5)
+        self.assertEqual(self.client.get()["pid_ki"], _f32(0.4))
+        self.assertEqual(self.client.get(["rotation_speed", "pid_kp"]), {"rotation_speed": 10.0, "pid_kp": 1.5})
+
+    def test_full_list_is_paged_within_queue_depth(self):
+        self.assertGreater(len(FIRMWARE_PARAMS), TX_SLOTS)
+        with FakeBoard(params=FIRMWARE_PARAMS) as board, UsbLink(board.path) as link:
+            params = ParamClient(link).refresh()
+            self.assertEqual(board.dropped_frames, 0)
+        self.assertEqual(len(params), len(FIRMWARE_PARAMS))
+        self.assertEqual(params["field_phase_lead"].id, 16)
+        self.assertEqual(params["cap_energy_scale"].value, 255.0)
+
+    def test_bulk_set_is_one_batch(self):
+        self.client.set({"pid_kp": 2.5, "pid_ki": 0.8})
+        self.assertEqual(self.board.set_log, [{0: _bits(2.5), 1: _bits(0.8)}])
+        self.assertEqual(self.client.get(["pid_kp", "pid_ki"]), {"pid_kp": 2.5, "pid_ki": _f32(0.8)})
+
+    def test_out_of_range_rejected(self):
+        with self.assertRaises(ParamError):
+            self.client.set({"pid_kp": 2.0, "max_linear_speed": 5.0})
+        with self.assertRaises(ParamError):
+            self.client.set({"no_such_param": 1.0})
+        self.assertEqual(self.board.set_log, [])
+
+    def test_sweep_restores_original(self):
+        path = self.board.path
+        self.link.close()
+        param_client.main([path, "sweep", "pid_kd", "0.0", "0.3", "0.1", "--dwell", "0"])
+        self.link = UsbLink(path)
+        steps = [entry[2] for entry in self.board.set_log if list(entry) == [2]]
+        self.assertEqual(steps, [_bits(v) for v in (0.0, 0.1, 0.2, 0.30000000000000004)] + [_bits(0.0)])
+
+    def test_script(self):
+        with tempfile.NamedTemporaryFile("w", suffix=".txt", delete=False) as f:
+            f.write("# 阶跃\nset pid_kp=3 pid_ki=1\nwait 0\nsweep rotation_speed 8 12 2 0\nsave\n")
+        try:
+            path = self.board.path
+            self.link.close()
+            param_client.main([path, "--keep", "script", f.name])
+            self.link = UsbLink(path)
+        finally:
+            os.unlink(f.name)
+        self.assertTrue(self.board.saved)
+        self.assertEqual(self.board.set_log[0], {0: _bits(3.0), 1: _bits(1.0)})
+        self.assertEqual([e[4] for e in self.board.set_log[1:]], [_bits(v) for v in (8.0, 10.0, 12.0)])
+
+
+if __name__ == "__main__":
+    unittest.main()
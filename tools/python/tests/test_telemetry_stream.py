@@ -0,0 +1,152 @@
+"""遥测解码往返测试
+
+样本由 tools/sim 的 telemetry_capture 用固件编码器生成，tests/data 下是一份存档；
+设置环境变量 TELEMETRY_CAPTURE 为编出的 telemetry_capture 路径时，先重新生成再测
+"""
+
+import csv
+import json
+import os
+import struct
+import subprocess
+import tempfile
+import unittest
+
+import telemetry_dump
+from telemetry_stream import KIND_DELTA, KIND_KEY, KIND_RAW, TYPE_F32, TelemetryDecoder, load_channels
+from tests.fake_board import TX_SLOTS, FakeBoard
+
+DATA_DIR = os.path.join(os.path.dirname(__file__), "data")
+
+
+def _capture_prefix():
+    binary = os.environ.get("TELEMETRY_CAPTURE")
+    if not binary:
+        return os.path.join(DATA_DIR, "telemetry_capture")
+    prefix = os.path.join(tempfile.mkdtemp(), "telemetry_capture")
+    subprocess.run([binary, prefix], check=True, stdout=subprocess.DEVNULL)
+    return prefix
+
+
+def _mask_ids(mask):
+    return {cid for cid in range(32) if mask & (1 << cid)}
+
+
+class TelemetryRoundTrip(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        prefix = _capture_prefix()
+        cls.channels = load_channels(prefix + ".json")
+        with open(prefix + ".bin", "rb") as f:
+            cls.stream = f.read()
+        cls.truth = {}
+        with open(prefix + ".csv") as f:
+            reader = csv.reader(f)
+            header = next(reader)
+            names = header[3:]
+            for row in reader:
+                values = {cid: float(v) for cid, v in enumerate(row[3:]) if v != ""}
+                cls.truth[int(row[0])] = (int(row[1]), int(row[2]), values)
+        assert [cls.channels[cid].name for cid in sorted(cls.channels)] == names
+
+    def check_sample(self, sample):
+        self.assertIn(sample.stamp_ms, self.truth)
+        selected, due, truth = self.truth[sample.stamp_ms]
+        ids = set(sample.values)
+        self.assertTrue(_mask_ids(due) <= ids, "stamp %d missing due channels" % sample.stamp_ms)
+        if sample.kind == KIND_KEY:
+            self.assertEqual(ids, _mask_ids(selected), "keyframe at %d incomplete" % sample.stamp_ms)
+        for cid, value in sample.values.items():
+            channel = self.channels[cid]
+            if channel.type == TYPE_F32 and sample.kind != KIND_RAW:
+                self.assertLessEqual(abs(value - truth[cid]), channel.quantum * 0.5 + 1e-6)
+            elif channel.type == TYPE_F32:
+                self.assertEqual(struct.pack("<f", value), struct.pack("<f", truth[cid]))
+            else:
+                self.assertEqual(value, truth[cid], "channel %s at %d" % (channel.name, sample.stamp_ms))
+
+    def test_every_sample_decodes(self):
+        decoder = TelemetryDecoder(self.channels)
+        samples = decoder.feed(self.stream)
+        self.assertEqual(len(samples), len(self.truth))
+        self.assertEqual((decoder.crc_errors, decoder.lost_frames, decoder.skipped_frames), (0, 0, 0))
+        kinds = {s.kind for s in samples}
+        self.assertEqual(kinds, {KIND_RAW, KIND_KEY, KIND_DELTA})
+        for sample in samples:
+            self.check_sample(sample)
+
+    def test_byte_by_byte_feed(self):
+        whole = TelemetryDecoder(self.channels).feed(self.stream)
+        decoder = TelemetryDecoder(self.channels)
+        pieces = []
+        for i in range(len(self.stream)):
+            pieces.extend(decoder.feed(self.stream[i : i + 1]))
+        self.assertEqual(pieces, whole)
+
+    def test_resync_after_corruption(self):
+        reference = TelemetryDecoder(self.channels).feed(self.stream)
+        stream = bytearray(self.stream)
+        corrupt_at = len(stream) // 3
+        stream[corrupt_at] ^= 0xFF
+
+        decoder = TelemetryDecoder(self.channels)
+        samples = decoder.feed(bytes(stream))
+        self.assertGreaterEqual(decoder.crc_errors + decoder.lost_frames, 1)
+        for sample in samples:
+            self.check_sample(sample)
+
+        # 损坏帧之后到下一个关键帧之间的差分帧都不应输出
+        stamps = {s.stamp_ms for s in samples}
+        missing = [s for s in reference if s.stamp_ms not in stamps]
+        self.assertTrue(missing)
+        self.assertTrue(all(s.kind == KIND_DELTA for s in missing[1:]))
+        resumed = [s for s in samples if s.stamp_ms > missing[-1].stamp_ms]
+        self.assertIn(resumed[0].kind, (KIND_KEY, KIND_RAW))
+
+    def test_cli_outputs(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            capture = os.path.join(tmp, "capture.bin")
+            channels = os.path.join(tmp, "channels.json")
+            with open(capture, "wb") as f:
+                f.write(self.stream)
+            with open(channels, "w") as f:
+                json.dump([c._asdict() for c in self.channels.values()], f)
+
+            out_csv = os.path.join(tmp, "out.csv")
+            out_dir = os.path.join(tmp, "columns")
+            telemetry_dump.main([capture, "--channels", channels, "-o", out_csv, "--columnar", out_dir, "--fill"])
+
+            with open(out_csv) as f:
+                rows = list(csv.reader(f))
+            self.assertEqual(rows[0][0], "stamp_ms")
+            self.assertEqual(len(rows) - 1, len(self.truth))
+            # --fill 时关键帧之后每行都有全部所选通道的值
+            self.assertTrue(all(cell != "" for cell in rows[-1][1:]))
+
+            with open(os.path.join(out_dir, "manifest.json")) as f:
+                manifest = json.load(f)
+            self.assertEqual(manifest["rows"], len(self.truth))
+            size = os.path.getsize(os.path.join(out_dir, manifest["columns"][0]["file"]))
+            self.assertEqual(size, 8 * len(self.truth))
+
+
+class ChannelListOverPty(unittest.TestCase):
+    # 与plot_task.cpp注册的通道数相同，多于发送队列槽位
+    CHANNELS = 27
+
+    def test_list_is_paged_within_queue_depth(self):
+        payloads = [
+            struct.pack("<BBHf", cid, TYPE_F32, 1 + cid % 3, 0.01) + ("ch%02d" % cid).encode()
+            for cid in range(self.CHANNELS)
+        ]
+        self.assertGreater(len(payloads), TX_SLOTS)
+        with FakeBoard(channels=payloads) as board:
+            channels = telemetry_dump.fetch_channels(board.path)
+            self.assertEqual(board.dropped_frames, 0)
+        self.assertEqual(sorted(channels), list(range(self.CHANNELS)))
+        self.assertEqual(channels[26].name, "ch26")
+        self.assertEqual(channels[4].decimation, 2)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,125 @@
+"""JustFloat解码和实时查看测试
+
+固件编码器样本需要设置 TELEMETRY_CAPTURE (tools/sim编出的telemetry_capture)，
+实时性测试用伪终端按1kHz推送20通道的JustFloat流
+"""
+
+import csv
+import os
+import struct
+import subprocess
+import tempfile
+import threading
+import time
+import unittest
+
+import telemetry_view
+from crc16 import append_crc16
+from serial_port import Port
+from telemetry_stream import KIND_JUSTFLOAT, TelemetryDecoder
+from tests.fake_board import FakeBoard
+
+TAIL = b"\x00\x00\x80\x7f"
+SCHEMA_INTERVAL = 100
+
+
+def schema_frame(seq, slot, slots, cid, name):
+    body = bytes((slot, slots, cid, 5)) + name.encode()
+    header = b"\x5a\xa5" + struct.pack("<H", len(body) + 2) + bytes((3, seq))
+    return append_crc16(header + body)
+
+
+def justfloat_frames(frames, channels):
+    out = []
+    seq = 0
+    slot = 0
+    for i in range(frames):
+        if i % SCHEMA_INTERVAL == 0:
+            out.append(schema_frame(seq, slot, channels, slot, "ch%02d" % slot))
+            seq = (seq + 1) & 0xFF
+            slot = (slot + 1) % channels
+        out.append(struct.pack("<%df" % channels, *[c + i * 0.001 for c in range(channels)]) + TAIL)
+    return out
+
+
+class JustFloatCapture(unittest.TestCase):
+    @unittest.skipUnless(os.environ.get("TELEMETRY_CAPTURE"), "needs TELEMETRY_CAPTURE")
+    def test_firmware_justfloat_roundtrip(self):
+        prefix = os.path.join(tempfile.mkdtemp(), "justfloat")
+        subprocess.run([os.environ["TELEMETRY_CAPTURE"], prefix, "justfloat"], check=True, stdout=subprocess.DEVNULL)
+        with open(prefix + ".bin", "rb") as f:
+            stream = f.read()
+        with open(prefix + ".csv") as f:
+            rows = list(csv.reader(f))[1:]
+
+        decoder = TelemetryDecoder()
+        samples = decoder.feed(stream)
+        self.assertEqual(len(samples), len(rows))
+        self.assertEqual((decoder.crc_errors, decoder.skipped_frames), (0, 0))
+        complete = 0
+        for sample, row in zip(samples, rows):
+            self.assertEqual(sample.kind, KIND_JUSTFLOAT)
+            selected = int(row[1])
+            for cid, value in sample.values.items():
+                self.assertTrue(selected & (1 << cid))
+                self.assertEqual(struct.pack("<f", value), struct.pack("<f", float(row[3 + cid])))
+            if len(sample.values) == bin(selected).count("1"):
+                complete += 1
+        # 描述帧每100帧一条：20个slot在第1900帧前收齐，选择变化后16个slot在第3500帧前收齐
+        self.assertEqual(complete, 100 + 500)
+        self.assertEqual(decoder.channels[19].name, "ch19")
+        self.assertEqual(set(samples[-1].values), set(range(20)) - {4, 5, 6, 7})
+
+
+class ViewerOverPty(unittest.TestCase):
+    def test_keeps_up_with_1khz_20_channels(self):
+        frames = justfloat_frames(2000, 20)
+        with FakeBoard() as board:
+            viewer = telemetry_view.Viewer()
+
+            def pump():
+                # 每10ms推送10帧，平均1kHz
+                start = time.monotonic()
+                for i in range(0, len(frames), 10):
+                    board.write(b"".join(frames[i : i + 10]))
+                    delay = start + (i + 10) * 0.001 - time.monotonic()
+                    if delay > 0:
+                        time.sleep(delay)
+
+            writer = threading.Thread(target=pump)
+            with Port(board.path) as port, open(os.devnull, "w") as null:
+                start = time.monotonic()
+                writer.start()
+                while viewer.samples < 2000 and time.monotonic() - start < 5.0:
+                    data = port.read(0.05)
+                    if data:
+                        viewer.feed(data)
+                    viewer.render(out=null)
+                finished = time.monotonic() - start
+                writer.join()
+
+        self.assertEqual(viewer.samples, 2000)
+        d = viewer.decoder
+        self.assertEqual((d.crc_errors, d.lost_frames, d.skipped_frames), (0, 0, 0))
+        # 流本身持续2s，查看端应在流结束后很快处理完，而不是积压
+        self.assertLess(finished, 2.5)
+        self.assertEqual(viewer.stats[19].value, struct.unpack("<f", struct.pack("<f", 19 + 1999 * 0.001))[0])
+
+    def test_export_after_schema_complete(self):
+        stream = b"".join(justfloat_frames(600, 4))
+        with tempfile.TemporaryDirectory() as tmp:
+            capture = os.path.join(tmp, "jf.bin")
+            out = os.path.join(tmp, "jf.csv")
+            with open(capture, "wb") as f:
+                f.write(stream)
+            telemetry_view.main([capture, "--headless", "--export", out])
+            with open(out) as f:
+                rows = list(csv.reader(f))
+        self.assertEqual(rows[0], ["stamp_ms", "ch00", "ch01", "ch02", "ch03"])
+        # 第4条描述帧在第300帧前，之后的帧都导出
+        self.assertEqual(len(rows) - 1, 300)
+        self.assertEqual(struct.pack("<f", float(rows[-1][4])), struct.pack("<f", 3 + 599 * 0.001))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,153 @@
+"""USB CDC命令通道 (applications/usb_link.hpp) 的上位机实现
+
+帧格式 (小端): [SOF 0xA5][cmd][len][seq][payload: len字节][crc16]
+"""
+
+import enum
+import time
+
+from crc16 import append_crc16, check_crc16
+from serial_port import Port
+
+USB_FRAME_SOF = 0xA5
+USB_FRAME_HEADER_SIZE = 4
+USB_FRAME_MAX_PAYLOAD = 120
+LIST_MAX_PAGES = 32
+
+
+class UsbCmd(enum.IntEnum):
+    PING = 0x01
+    STREAM_CTRL = 0x02
+    NAV_CMD = 0x10
+    TELEMETRY_SELECT = 0x20
+    TELEMETRY_LIST = 0x21
+    TELEMETRY_FORMAT = 0x22
+    LOG_CTRL = 0x23
+    PARAM_LIST = 0x24
+    PARAM_GET = 0x25
+    PARAM_SET = 0x26
+    PARAM_SAVE = 0x27
+    INPUT_RECORD_CTRL = 0x28
+    FF_IDENT = 0x29
+    CHASSIS_STATE = 0x81
+    NAV_ODOM = 0x82
+    TELEMETRY_CHANNEL = 0x83
+    LOG_INFO = 0x84
+    LOG_RECORD = 0x85
+    PARAM_INFO = 0x86
+    PARAM_VALUE = 0x87
+    CPU_STATS = 0x88
+    SCOPE_STATS = 0x89
+    MEM_STATS = 0x8A
+    INPUT_RECORD = 0x8B
+    FF_IDENT_RESULT = 0x8C
+    MOTOR_THERMAL = 0x8D
+
+
+def encode_frame(cmd, payload=b"", seq=0):
+    if len(payload) > USB_FRAME_MAX_PAYLOAD:
+        raise ValueError("payload too long: %d" % len(payload))
+    header = bytes((USB_FRAME_SOF, int(cmd), len(payload), seq & 0xFF))
+    return append_crc16(header + bytes(payload))
+
+
+class FrameParser:
+    """与固件UsbLink::parse_byte相同的解帧规则"""
+
+    def __init__(self):
+        self._frame = bytearray()
+        self.crc_errors = 0
+
+    def feed(self, data):
+        frames = []
+        for byte in data:
+            if not self._frame and byte != USB_FRAME_SOF:
+                continue
+            self._frame.append(byte)
+            if len(self._frame) == 3 and self._frame[2] > USB_FRAME_MAX_PAYLOAD:
+                self._frame.clear()
+                continue
+            if len(self._frame) < USB_FRAME_HEADER_SIZE:
+                continue
+            if len(self._frame) < USB_FRAME_HEADER_SIZE + self._frame[2] + 2:
+                continue
+            if check_crc16(self._frame):
+                frames.append((self._frame[1], bytes(self._frame[USB_FRAME_HEADER_SIZE:-2])))
+            else:
+                self.crc_errors += 1
+            self._frame.clear()
+        return frames
+
+
+class UsbLink:
+    def __init__(self, path):
+        self.port = Port(path, write=True)
+        self.parser = FrameParser()
+        self._seq = 0
+        self._pending = []
+
+    def close(self):
+        self.port.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def send(self, cmd, payload=b""):
+        self.port.write(encode_frame(cmd, payload, self._seq))
+        self._seq = (self._seq + 1) & 0xFF
+
+    def receive(self, timeout=0.1):
+        """返回一帧 (cmd, payload)，超时返回None"""
+        deadline = time.monotonic() + timeout
+        while not self._pending:
+            remaining = deadline - time.monotonic()
+            if remaining <= 0:
+                return None
+            data = self.port.read(remaining)
+            if data is None:
+                raise EOFError("usb link closed")
+            self._pending.extend(self.parser.feed(data))
+        return self._pending.pop(0)
+
+    def collect(self, reply_cmd, idle_timeout=0.2, timeout=2.0, until=None):
+        """收集某类回复，收到第一条后idle_timeout内没有新回复、或收到使until为真的回复即结束，其余帧丢弃"""
+        replies = []
+        start = last = time.monotonic()
+        while True:
+            now = time.monotonic()
+            if now - start > timeout or (replies and now - last > idle_timeout):
+                return replies
+            frame = self.receive(0.02)
+            if frame is not None and frame[0] == reply_cmd:
+                replies.append(frame[1])
+                last = time.monotonic()
+                if until is not None and until(frame[1]):
+                    return replies
+
+    def request_list(self, request_cmd, reply_cmd, idle_timeout=0.2, timeout=2.0):
+        """分页请求列表 (TELEMETRY_LIST、PARAM_LIST)，返回按序号排列的条目payload
+
+        下位机每次回复发送队列放得下的一页，到末尾时追加只含条目总数的结束帧。
+        从第一个缺失的序号起继续请求，直到收到结束帧且条目齐全；没有回复返回空列表
+        """
+        items = {}
+        total = None
+        for _ in range(LIST_MAX_PAGES):
+            start = 0
+            while start in items:
+                start += 1
+            if total is not None and start >= total:
+                break
+            self.send(request_cmd, bytes((start,)))
+            replies = self.collect(reply_cmd, idle_timeout, timeout, until=lambda p: len(p) == 1)
+            if not replies:
+                break
+            for payload in replies:
+                if len(payload) == 1:
+                    total = payload[0]
+                else:
+                    items[payload[0]] = payload
+        return [items[i] for i in sorted(items) if total is None or i < total]
@@ -0,0 +1,237 @@
+// 超级电容能量管理仿真
+// 20场7分钟的随机比赛工况：巡航、短时加速、3s放电加速 (操作手请求)、10-20s小陀螺。
+// 电容板模型：输入功率受下发的输入上限和裁判系统功率上限约束，电容可放电时补足底盘需求；
+// 电容板回传的功率有5%增益误差和噪声，电压换算的能量按0-255量化并带1%噪声。
+// CapManager为固件代码，电容参数与chassis_control_task.cpp相同；对照为改动前的做法：
+// 请求加速或小陀螺时直接切DISCHARGE，其余时间AUTOMODE，输入上限取裁判系统功率上限。
+// 检查:
+//   1. 能量管理满足的加速需求比例高于对照，加速被拒时间更短，荷电状态估计误差小
+//   2. 能量读数满量程设错 (电容板实际按0-1023上报) 时读数被丢弃，估计误差小于把读数截到1后照常使用
+//   3. 裁判系统离线时不因缓冲能量旧值下调输入上限
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "cap_manager.hpp"
+
+// 与chassis_control_task.cpp相同
+constexpr float CAP_CAPACITY = 2000.0f;
+constexpr float CAP_BOOST_RESERVE = 400.0f;
+constexpr float CAP_SPIN_RESERVE = 300.0f;
+constexpr float CAP_ENERGY_FULL_SCALE = 255.0f;
+constexpr float SPIN_CAP_POWER = 30.0f;  // 改动前小陀螺固定使用的电容功率 W
+
+// 电容板和比赛模型
+constexpr double DT = 0.001;
+constexpr double MATCH_TIME = 420.0;
+constexpr int MATCHES = 20;
+constexpr double POWER_LIMIT = 75.0;     // W
+constexpr double EFFICIENCY = 0.9;       // 与CapManager的假设相同
+constexpr double CHARGE_MAX = 150.0;     // 电容板最大充电功率 W
+constexpr double EMPTY_ENERGY = 20.0;    // 电容板欠压保护 J
+constexpr double BUFFER_MAX = 60.0;      // 缓冲能量 J
+constexpr double BOOST_DEMAND = 200.0;   // 放电加速时的底盘需求 W
+constexpr double POWER_IN_GAIN = 1.05;   // 电容板回传输入功率的增益误差
+constexpr double POWER_OUT_GAIN = 0.97;
+
+enum class Activity
+{
+    CRUISE,
+    BURST,  // 短时加速，不请求放电
+    BOOST,  // 操作手请求放电加速
+    SPIN,
+};
+
+struct Phase
+{
+    double end;
+    Activity activity;
+    double demand;  // 底盘需求 W (小陀螺按可用预算)
+};
+
+enum class Policy
+{
+    SWITCH,   // 改动前
+    MANAGER,
+};
+
+struct Result
+{
+    double boost_wanted = 0.0;  // 加速需求超出功率上限的能量 J
+    double boost_served = 0.0;  // 其中由电容提供的部分 J
+    double boost_denied = 0.0;  // 请求加速但电容没有放电的时间 s
+    double soc_error = 0.0;     // 荷电状态估计误差绝对值的均值 J
+    uint32_t rejects = 0;
+};
+
+static std::vector<Phase> script(std::mt19937 & rng)
+{
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    std::vector<Phase> phases;
+    double t = 0.0;
+    while (t < MATCH_TIME) {
+        double x = u(rng);
+        if (x < 0.08) {
+            t += 3.0;
+            phases.push_back({t, Activity::BOOST, BOOST_DEMAND});
+        }
+        else if (x < 0.12) {
+            t += 10.0 + 10.0 * u(rng);
+            phases.push_back({t, Activity::SPIN, 0.0});
+        }
+        else if (x < 0.40) {
+            t += 0.6;
+            phases.push_back({t, Activity::BURST, 110.0 + 60.0 * u(rng)});
+        }
+        else {
+            t += 1.0 + 4.0 * u(rng);
+            phases.push_back({t, Activity::CRUISE, 10.0 + 55.0 * u(rng)});
+        }
+    }
+    return phases;
+}
+
+// reading_range: 电容板能量读数的实际满量程；clamp_reading: 把读数截到1后再交给CapManager (对照)
+static Result run(Policy policy, int seed, float reading_range, bool clamp_reading)
+{
+    std::mt19937 rng(seed);
+    std::vector<Phase> phases = script(rng);
+    std::normal_distribution<double> noise(0.0, 1.0);
+
+    CapManager manager(CAP_CAPACITY, CAP_BOOST_RESERVE, CAP_SPIN_RESERVE, static_cast<float>(DT));
+    Result r;
+    double energy = 0.5 * CAP_CAPACITY;
+    double buffer = BUFFER_MAX;
+    double power_in = 0.0, power_out = 0.0, demand_last = 0.0;
+    size_t phase = 0;
+    const long steps = static_cast<long>(MATCH_TIME / DT);
+    for (long i = 0; i < steps; i++) {
+        double t = i * DT;
+        while (phase + 1 < phases.size() && phases[phase].end <= t) phase++;
+        const Phase & p = phases[phase];
+        bool boost = p.activity == Activity::BOOST;
+        bool spinning = p.activity == Activity::SPIN;
+
+        sp::SuperCapMode mode;
+        double input_limit = POWER_LIMIT;
+        double spin_power;
+        if (policy == Policy::SWITCH) {
+            mode = (boost || spinning) ? sp::SuperCapMode::DISCHARGE : sp::SuperCapMode::AUTOMODE;
+            spin_power = (mode == sp::SuperCapMode::DISCHARGE) ? SPIN_CAP_POWER : 0.0;
+        }
+        else {
+            float raw = std::round(static_cast<float>(energy / CAP_CAPACITY) * reading_range +
+                                   static_cast<float>(0.01 * reading_range * noise(rng)));
+            float reading = std::max(raw, 0.0f) / CAP_ENERGY_FULL_SCALE;
+            if (clamp_reading) reading = std::min(reading, 1.0f);
+            CapInputs in;
+            in.power_in = static_cast<float>(power_in * POWER_IN_GAIN + noise(rng));
+            in.power_out = static_cast<float>(power_out * POWER_OUT_GAIN + noise(rng));
+            in.energy_reading = reading;
+            in.power_limit = static_cast<float>(POWER_LIMIT);
+            in.buffer_energy = static_cast<float>(buffer);
+            in.referee_valid = true;
+            in.demand = static_cast<float>(demand_last);
+            in.boost = boost;
+            in.spinning = spinning;
+            manager.update(in);
+            mode = manager.mode;
+            input_limit = manager.input_limit;
+            spin_power = manager.spin_power;
+            r.soc_error += std::abs(manager.energy - energy) / static_cast<double>(steps);
+        }
+
+        double demand = spinning ? POWER_LIMIT + spin_power : p.demand;
+        demand_last = demand;
+
+        // 电容板：充电模式下只充不放；输入功率不超过下发的上限
+        bool can_discharge = mode != sp::SuperCapMode::CHARGE && energy > EMPTY_ENERGY;
+        bool full = energy >= CAP_CAPACITY;
+        double in_power = (mode == sp::SuperCapMode::DISCHARGE || full)
+                              ? std::min(input_limit, demand / EFFICIENCY)
+                              : std::min(input_limit, demand / EFFICIENCY + CHARGE_MAX);
+        double supplied = can_discharge ? demand : std::min(demand, EFFICIENCY * in_power);
+        double from_cap = std::max(supplied - EFFICIENCY * in_power, 0.0);
+        energy = std::max(0.0, std::min(energy + (EFFICIENCY * in_power - supplied) * DT, static_cast<double>(CAP_CAPACITY)));
+        power_in = in_power;
+        power_out = supplied;
+        buffer = std::min(BUFFER_MAX, buffer - (in_power - POWER_LIMIT) * DT);
+
+        if (boost) {
+            r.boost_wanted += (demand - POWER_LIMIT) * DT;
+            r.boost_served += from_cap * DT;
+            if (from_cap == 0.0) r.boost_denied += DT;
+        }
+    }
+    r.rejects = manager.reading_rejects;
+    return r;
+}
+
+static Result matches(Policy policy, float reading_range, bool clamp_reading)
+{
+    Result total;
+    for (int seed = 1; seed <= MATCHES; seed++) {
+        Result r = run(policy, seed, reading_range, clamp_reading);
+        total.boost_wanted += r.boost_wanted / MATCHES;
+        total.boost_served += r.boost_served / MATCHES;
+        total.boost_denied += r.boost_denied / MATCHES;
+        total.soc_error += r.soc_error / MATCHES;
+        total.rejects += r.rejects;
+    }
+    return total;
+}
+
+static bool check(bool ok, const char * what)
+{
+    if (!ok) fprintf(stderr, "FAIL: %s\n", what);
+    return ok;
+}
+
+int main()
+{
+    bool ok = true;
+
+    // 1. 对照与能量管理
+    Result baseline = matches(Policy::SWITCH, CAP_ENERGY_FULL_SCALE, false);
+    Result managed = matches(Policy::MANAGER, CAP_ENERGY_FULL_SCALE, false);
+    printf(
+        "switch   boost served %4.1f%%  denied %4.1f s/match\n", 100.0 * baseline.boost_served / baseline.boost_wanted,
+        baseline.boost_denied);
+    printf(
+        "manager  boost served %4.1f%%  denied %4.1f s/match  soc error %.1f J\n",
+        100.0 * managed.boost_served / managed.boost_wanted, managed.boost_denied, managed.soc_error);
+    ok &= check(managed.boost_served / managed.boost_wanted > baseline.boost_served / baseline.boost_wanted,
+                "manager serves more boost demand");
+    ok &= check(managed.boost_denied < baseline.boost_denied, "manager denies boost less often");
+    ok &= check(managed.soc_error < 0.02 * CAP_CAPACITY, "state of charge estimate within 2% of capacity");
+    ok &= check(managed.rejects == 0, "readings within full scale are used");
+
+    // 2. 满量程设错：电容板按0-1023上报
+    Result rejected = matches(Policy::MANAGER, 1023.0f, false);
+    Result clamped = matches(Policy::MANAGER, 1023.0f, true);
+    printf(
+        "wrong full scale  soc error %.1f J (%u readings rejected), clamped readings %.1f J\n", rejected.soc_error,
+        rejected.rejects, clamped.soc_error);
+    ok &= check(rejected.rejects > 0, "out-of-range readings are rejected");
+    ok &= check(rejected.soc_error < clamped.soc_error, "rejecting beats clamping a wrong-scale reading");
+
+    // 3. 裁判系统离线时缓冲能量为旧值
+    CapManager manager(CAP_CAPACITY, CAP_BOOST_RESERVE, CAP_SPIN_RESERVE, static_cast<float>(DT));
+    CapInputs in = {};
+    in.energy_reading = 0.5f;
+    in.power_limit = 80.0f;
+    in.buffer_energy = 5.0f;
+    in.referee_valid = true;
+    manager.update(in);
+    float online_limit = manager.input_limit;
+    in.referee_valid = false;
+    manager.update(in);
+    printf("buffer 5 J  input limit online %.1f W, referee offline %.1f W\n", online_limit, manager.input_limit);
+    ok &= check(online_limit < 80.0f, "low buffer lowers the input limit");
+    ok &= check(manager.input_limit == 80.0f, "stale buffer energy is ignored while the referee is offline");
+
+    return ok ? 0 : 1;
+}
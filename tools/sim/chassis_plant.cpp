@@ -0,0 +1,169 @@
+#include "chassis_plant.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "gain_schedule.hpp"
+
+// 3x3线性方程组 A x = b (克拉默法则)
+static void solve3(const float a[3][3], const float b[3], float x[3])
+{
+    float det = a[0][0] * (a[1][1] * a[2][2] - a[1][2] * a[2][1]) - a[0][1] * (a[1][0] * a[2][2] - a[1][2] * a[2][0]) +
+                a[0][2] * (a[1][0] * a[2][1] - a[1][1] * a[2][0]);
+    for (int c = 0; c < 3; c++) {
+        float m[3][3];
+        for (int r = 0; r < 3; r++) {
+            for (int k = 0; k < 3; k++) m[r][k] = (k == c) ? b[r] : a[r][k];
+        }
+        x[c] = (m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) +
+                m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0])) /
+               det;
+    }
+}
+
+ChassisPlant::ChassisPlant()
+{
+    sp::Mecanum inverse(WHEEL_RADIUS, HALF_LENGTH, HALF_WIDTH);
+    const float unit[3][3] = {{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}};
+    for (int c = 0; c < 3; c++) {
+        inverse.calc(unit[c][0], unit[c][1], unit[c][2]);
+        jac_[0][c] = inverse.speed_lf;
+        jac_[1][c] = inverse.speed_lr;
+        jac_[2][c] = inverse.speed_rf;
+        jac_[3][c] = inverse.speed_rr;
+    }
+    const float body[3] = {PLANT_MASS, PLANT_MASS, PLANT_YAW_INERTIA};
+    for (int r = 0; r < 3; r++) {
+        for (int c = 0; c < 3; c++) {
+            mass_[r][c] = (r == c) ? body[r] : 0.0f;
+            for (int i = 0; i < 4; i++) mass_[r][c] += PLANT_WHEEL_INERTIA * jac_[i][r] * jac_[i][c];
+        }
+    }
+}
+
+void ChassisPlant::update_wheels()
+{
+    for (int i = 0; i < 4; i++) wheel[i] = jac_[i][0] * v[0] + jac_[i][1] * v[1] + jac_[i][2] * v[2];
+}
+
+void ChassisPlant::set_velocity(float vx, float vy, float wz)
+{
+    v[0] = vx;
+    v[1] = vy;
+    v[2] = wz;
+    update_wheels();
+}
+
+void ChassisPlant::step(const float torque[4], float dt)
+{
+    power = K3_STATIC_POWER;
+    for (int i = 0; i < 4; i++) {
+        power += torque[i] * wheel[i] + K1_TORQUE_LOSS * torque[i] * torque[i] + K2_SPEED_LOSS * wheel[i] * wheel[i];
+    }
+
+    // 广义力 Jᵀ(τ - 摩擦)，车体坐标系下平移项含 m·ω×v
+    float force[3] = {};
+    for (int i = 0; i < 4; i++) {
+        float friction = PLANT_VISCOUS * wheel[i] + PLANT_COULOMB * std::tanh(wheel[i] / 0.1f);
+        for (int c = 0; c < 3; c++) force[c] += jac_[i][c] * (torque[i] - friction);
+    }
+    force[0] += PLANT_MASS * v[2] * v[1];
+    force[1] -= PLANT_MASS * v[2] * v[0];
+    solve3(mass_, force, accel);
+    for (int c = 0; c < 3; c++) v[c] += accel[c] * dt;
+    x += (v[0] * std::cos(yaw) - v[1] * std::sin(yaw)) * dt;
+    y += (v[0] * std::sin(yaw) + v[1] * std::cos(yaw)) * dt;
+    yaw += v[2] * dt;
+    update_wheels();
+}
+
+ChassisLoop::ChassisLoop(const LoopConfig & config)
+: pid{
+      WheelPid(PID_DT, PID_KP, PID_KI, PID_KD, PID_MO, PID_MIO, PID_ALPHA, config.kb),
+      WheelPid(PID_DT, PID_KP, PID_KI, PID_KD, PID_MO, PID_MIO, PID_ALPHA, config.kb),
+      WheelPid(PID_DT, PID_KP, PID_KI, PID_KD, PID_MO, PID_MIO, PID_ALPHA, config.kb),
+      WheelPid(PID_DT, PID_KP, PID_KI, PID_KD, PID_MO, PID_MIO, PID_ALPHA, config.kb),
+  },
+  config_(config),
+  inverse_(WHEEL_RADIUS, HALF_LENGTH, HALF_WIDTH),
+  limiter_(WHEEL_RADIUS, HALF_LENGTH, HALF_WIDTH, PID_DT),
+  feedforward_{WheelFeedforward(PID_DT), WheelFeedforward(PID_DT), WheelFeedforward(PID_DT), WheelFeedforward(PID_DT)}
+{
+}
+
+// 与predict_power_consumption()相同 (K5为0，不含角加速度项)
+float ChassisLoop::predict_power(const float wheel[4])
+{
+    constexpr float FILTER_ALPHA = 0.05f;
+    float raw = K3_STATIC_POWER;
+    for (int i = 0; i < 4; i++) {
+        raw += torque[i] * wheel[i] + K1_TORQUE_LOSS * torque[i] * torque[i] + K2_SPEED_LOSS * wheel[i] * wheel[i] +
+               K4_TORQUE_RATE * std::abs(torque[i] - last_torque_[i]) * 1000.0f;
+        last_torque_[i] = torque[i];
+    }
+    filtered_power_ = FILTER_ALPHA * raw + (1.0f - FILTER_ALPHA) * filtered_power_;
+    return filtered_power_;
+}
+
+void ChassisLoop::update(float vx, float vy, float wz, const float wheel[4])
+{
+    const FeedforwardModel & ff = config_.ff;
+    float power_limit = (config_.power_limit > 0.0f) ? config_.power_limit - 5.0f : 1e6f;
+    float max_torque = std::min(PID_MO, MAX_SAFE_TORQUE);
+
+    if (config_.accel_limit) {
+        float inertia = (ff.inertia > 0.0f) ? ff.inertia : ACCEL_LIMIT_INERTIA;
+        const PowerModel model = {K1_TORQUE_LOSS, K2_SPEED_LOSS, K3_STATIC_POWER, inertia, ff.viscous, ff.coulomb};
+        float accel_max = achievable_wheel_accel(model, power_limit, wheel, max_torque);
+        limiter_.limit(vx, vy, wz, accel_max, max_torque / inertia);
+    }
+
+    inverse_.calc(vx, vy, wz);
+    speed_set[0] = inverse_.speed_lf;
+    speed_set[1] = inverse_.speed_lr;
+    speed_set[2] = inverse_.speed_rf;
+    speed_set[3] = inverse_.speed_rr;
+
+    float mean_speed = 0.25f * (std::abs(wheel[0]) + std::abs(wheel[1]) + std::abs(wheel[2]) + std::abs(wheel[3]));
+    const GainScale gains = gain_schedule(mean_speed, scale < 1.0f);
+    float ff_torque[4];
+    for (int i = 0; i < 4; i++) {
+        pid[i].set_gains(PID_KP * gains.kp, PID_KI * gains.ki, PID_KD * gains.kd);
+        pid[i].calc(speed_set[i], wheel[i]);
+        ff_torque[i] = feedforward_[i].calc(speed_set[i], ff);
+        torque[i] = pid[i].out + ff_torque[i];
+    }
+
+    // update_power_data()和calculate_torque_scale_factor()各更新一次预测功率
+    scale = 1.0f;
+    if (config_.power_limit > 0.0f) {
+        predict_power(wheel);
+        float predicted = predict_power(wheel);
+        if (predicted > power_limit - 5.0f) {
+            float a = 0.0f, b = 0.0f, c = K3_STATIC_POWER - power_limit;
+            for (int i = 0; i < 4; i++) {
+                a += K1_TORQUE_LOSS * torque[i] * torque[i];
+                b += torque[i] * wheel[i];
+                c += K2_SPEED_LOSS * wheel[i] * wheel[i];
+            }
+            float discriminant = b * b - 4.0f * a * c;
+            scale = (discriminant < 0.0f) ? POWER_SCALE_MIN : (-b + std::sqrt(discriminant)) / (2.0f * a);
+            scale = std::max(std::min(scale, 1.0f), POWER_SCALE_MIN);
+        }
+    }
+
+    for (int i = 0; i < 4; i++) {
+        torque[i] = std::max(-max_torque, std::min(torque[i] * scale, max_torque));
+        pid[i].back_calculate(torque[i] - ff_torque[i]);
+    }
+}
+
+void ChassisLoop::reset()
+{
+    for (int i = 0; i < 4; i++) {
+        feedforward_[i].reset();
+        torque[i] = 0.0f;
+    }
+    limiter_.reset();
+    scale = 1.0f;
+}
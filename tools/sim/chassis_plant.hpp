@@ -0,0 +1,104 @@
+#ifndef SIM_CHASSIS_PLANT_HPP
+#define SIM_CHASSIS_PLANT_HPP
+
+#include "accel_limiter.hpp"
+#include "feedforward.hpp"
+#include "tools/mecanum/mecanum.hpp"
+#include "wheel_pid.hpp"
+
+// 主机仿真共用的麦轮底盘模型和轮速环链路
+
+// 与chassis_control.hpp、chassis_control_task.cpp相同
+constexpr float WHEEL_RADIUS = 0.077f;
+constexpr float HALF_LENGTH = 0.165f;
+constexpr float HALF_WIDTH = 0.185f;
+constexpr float PID_DT = 0.001f;
+constexpr float PID_KP = 0.5f;
+constexpr float PID_KI = 0.05f;
+constexpr float PID_KD = 0.01f;
+constexpr float PID_MO = 2.5f;
+constexpr float PID_MIO = 1.0f;
+constexpr float PID_ALPHA = 0.0f;
+constexpr float PID_KB = 20.0f;
+constexpr float K1_TORQUE_LOSS = 2.0f;
+constexpr float K2_SPEED_LOSS = 0.005f;
+constexpr float K3_STATIC_POWER = 6.2f;
+constexpr float K4_TORQUE_RATE = 0.007f;
+constexpr float MAX_SAFE_TORQUE = 8.0f;
+constexpr float POWER_SCALE_MIN = 0.1f;
+constexpr float ACCEL_LIMIT_INERTIA = 0.02f;
+
+// 车体模型
+constexpr float PLANT_MASS = 20.0f;           // kg
+constexpr float PLANT_YAW_INERTIA = 1.0f;     // kg·m^2
+constexpr float PLANT_WHEEL_INERTIA = 0.02f;  // 转子和车轮折算到轮轴 kg·m^2
+constexpr float PLANT_VISCOUS = 0.02f;        // N·m/(rad/s)
+constexpr float PLANT_COULOMB = 0.3f;         // N·m
+
+// 车轮不打滑的刚体模型 (与spin_sim相同)，轮轴带粘滞和库仑摩擦。
+// 电功率按固件功率模型的K1-K3项计算，作为裁判系统测得的底盘功率
+class ChassisPlant
+{
+public:
+    ChassisPlant();
+
+    // torque: 各轮输出轴力矩 N·m (lf, lr, rf, rr)
+    void step(const float torque[4], float dt);
+
+    // 设置车体速度 (车体坐标系)，轮速随之更新
+    void set_velocity(float vx, float vy, float wz);
+
+    float wheel[4] = {};  // 轮速 rad/s
+    float v[3] = {};      // 车体坐标系 vx, vy m/s, wz rad/s
+    float accel[3] = {};  // 上一步的广义加速度
+    float x = 0.0f;       // 世界坐标系位置 m
+    float y = 0.0f;
+    float yaw = 0.0f;     // rad
+    float power = 0.0f;   // 上一步的电功率 W
+
+private:
+    float jac_[4][3];   // 车体速度到轮速
+    float mass_[3][3];  // 车体广义质量 M = diag(m, m, Iz) + Jw·JᵀJ
+
+    void update_wheels();
+};
+
+// 与chassis_move_control()相同的轮速环链路 (不含小陀螺、航向保持、打滑控制和温度降额)：
+// 功率感知的设定值加速度限制、运动学解算、按轮速调度增益的PID加前馈、功率缩放、输出限幅、反算抗饱和。
+// 功率缩放与calculate_torque_scale_factor()相同：预测功率的低通在每周期更新两次 (update_power_data()一次)
+struct LoopConfig
+{
+    float power_limit = 80.0f;  // 裁判系统功率上限 W，0为不做功率缩放
+    bool accel_limit = true;    // 设定值加速度限制 (AccelLimiter)
+    FeedforwardModel ff = {0.0f, 0.0f, 0.0f};
+    float kb = PID_KB;          // 反算增益，0为不反算
+};
+
+class ChassisLoop
+{
+public:
+    explicit ChassisLoop(const LoopConfig & config);
+
+    // 每个控制周期调用，wheel为轮速反馈
+    void update(float vx, float vy, float wz, const float wheel[4]);
+
+    // 停止控制 (释放力矩) 后调用，与失控保护RELEASED分支相同
+    void reset();
+
+    float torque[4] = {};     // 本周期下发力矩
+    float speed_set[4] = {};  // 轮速设定值
+    float scale = 1.0f;       // 功率缩放系数
+    WheelPid pid[4];
+
+private:
+    const LoopConfig config_;
+    sp::Mecanum inverse_;
+    AccelLimiter limiter_;
+    WheelFeedforward feedforward_[4];
+    float filtered_power_ = 0.0f;
+    float last_torque_[4] = {};
+
+    float predict_power(const float wheel[4]);
+};
+
+#endif // SIM_CHASSIS_PLANT_HPP
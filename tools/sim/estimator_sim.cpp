@@ -0,0 +1,198 @@
+// 底盘速度估计仿真
+// 已知车体运动 (偏航角速度曲线加前后、横移速度) 合成IMU样本和四轮转速，ChassisEstimator为固件代码，
+// 每周期按chassis_control_task()的方式调用一次update()，外面套SCOPE_TIMER(IMU_FILTER)统计单次耗时。
+// IMU位于旋转中心、安装角为零；陀螺仪和加速度计带零偏和白噪声，轮速带量化级的噪声。
+// 过程：静止标定 → 偏航角速度曲线 (含正反转和平移) → 起步时左前轮打滑 → 停车静止
+// 检查:
+//   1. 静止阶段完成零偏标定
+//   2. 偏航角误差小于直接积分陀螺仪 (不减零偏) 和积分轮速里程计 (打滑时错误)
+//   3. 打滑在开始后SLIP_DETECT_MS内被检出，期间融合速度的误差远小于里程计
+//   4. 不打滑时融合速度跟随真值，停车后速度归零
+//   5. 每次update()都被计时，打印单次耗时的分位数
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+
+#include "chassis_estimator.hpp"
+#include "scope_timer.hpp"
+#include "task.h"
+
+// 与chassis_control.hpp相同
+constexpr float WHEEL_RADIUS = 0.077f;
+constexpr float HALF_LENGTH = 0.165f;
+constexpr float HALF_WIDTH = 0.185f;
+constexpr float PID_DT = 0.001f;
+
+constexpr float GYRO_BIAS = 0.02f;            // rad/s
+constexpr float ACCEL_BIAS[2] = {0.15f, -0.1f};  // m/s^2，含安装倾斜带来的重力分量
+constexpr float GYRO_NOISE = 0.005f;          // 一个控制周期内平均后的标准差 rad/s
+constexpr float ACCEL_NOISE = 0.05f;          // m/s^2
+constexpr float WHEEL_NOISE = 0.05f;          // rad/s
+
+constexpr float STILL_END = 1.0f;             // s
+constexpr float SLIP_START = 9.0f;
+constexpr float SLIP_END = 9.7f;
+constexpr float SLIP_WHEEL_SPEED = 20.0f;     // 左前轮相对车体多转的速度 rad/s
+constexpr float END = 12.0f;
+constexpr uint32_t SLIP_DETECT_MS = 100;
+constexpr float YAW_TOLERANCE = 0.02f;        // rad
+constexpr float VELOCITY_TOLERANCE = 0.05f;   // 不打滑时的速度误差均方根 m/s
+
+struct Keyframe
+{
+    float t;
+    float value;
+};
+
+// 关键帧之间线性插值，两端保持
+template <size_t N>
+static float profile(const Keyframe (&keys)[N], float t)
+{
+    if (t <= keys[0].t) return keys[0].value;
+    for (size_t i = 1; i < N; i++) {
+        if (t <= keys[i].t) {
+            float s = (t - keys[i - 1].t) / (keys[i].t - keys[i - 1].t);
+            return keys[i - 1].value + s * (keys[i].value - keys[i - 1].value);
+        }
+    }
+    return keys[N - 1].value;
+}
+
+// 正反转、平移中转向、起步 (打滑) 后停车
+constexpr Keyframe WZ_KEYS[] = {
+    {1.0f, 0.0f}, {1.5f, 3.0f}, {3.5f, 3.0f}, {4.5f, -2.0f}, {6.5f, -2.0f}, {7.0f, 0.0f},
+};
+constexpr Keyframe VX_KEYS[] = {
+    {1.0f, 0.0f}, {2.0f, 1.5f}, {7.0f, 1.5f}, {8.0f, 0.0f}, {9.0f, 0.0f}, {9.5f, 0.5f}, {10.0f, 0.5f}, {10.5f, 0.0f},
+};
+constexpr Keyframe VY_KEYS[] = {
+    {2.5f, 0.0f}, {3.0f, 0.5f}, {5.0f, 0.5f}, {5.5f, 0.0f},
+};
+// 左前轮多转的比例：0.2s升到SLIP_WHEEL_SPEED，保持0.3s后0.2s回落
+constexpr Keyframe SLIP_KEYS[] = {
+    {SLIP_START, 0.0f}, {SLIP_START + 0.2f, 1.0f}, {SLIP_END - 0.2f, 1.0f}, {SLIP_END, 0.0f},
+};
+
+// task.h、memory_monitor.hpp中由固件提供的函数，cpu_profiler.cpp用到，这里不统计任务
+extern "C" UBaseType_t uxTaskGetSystemState(TaskStatus_t *, UBaseType_t, uint32_t * total_runtime)
+{
+    *total_runtime = 0;
+    return 0;
+}
+extern "C" TaskHandle_t xTaskGetIdleTaskHandle(void) { return nullptr; }
+void msp_paint() {}
+
+static bool check(bool ok, const char * what)
+{
+    if (!ok) fprintf(stderr, "FAIL: %s\n", what);
+    return ok;
+}
+
+int main()
+{
+    bool ok = true;
+
+    std::mt19937 rng(43);
+    std::normal_distribution<float> gyro_noise(0.0f, GYRO_NOISE);
+    std::normal_distribution<float> accel_noise(0.0f, ACCEL_NOISE);
+    std::normal_distribution<float> wheel_noise(0.0f, WHEEL_NOISE);
+
+    ChassisEstimator estimator(WHEEL_RADIUS, HALF_LENGTH, HALF_WIDTH, 0.0f, PID_DT);
+    sp::Mecanum inverse(WHEEL_RADIUS, HALF_LENGTH, HALF_WIDTH);
+    scope_timers_init();
+
+    const uint32_t steps = static_cast<uint32_t>(END / PID_DT + 0.5f);
+    float vx = 0.0f, vy = 0.0f;
+    float yaw = 0.0f, gyro_yaw = 0.0f, odom_yaw = 0.0f;
+    float yaw_error_max = 0.0f;
+    bool calibrated_in_time = false;
+    uint32_t slip_detected_ms = UINT32_MAX;
+    float slip_error = 0.0f, slip_odom_error = 0.0f;  // 打滑期间的最大速度误差
+    double square_error = 0.0;
+    uint32_t tracked = 0;
+    for (uint32_t k = 1; k <= steps; k++) {
+        const float t = k * PID_DT;
+        const float wz = profile(WZ_KEYS, t);
+        const float next_vx = profile(VX_KEYS, t);
+        const float next_vy = profile(VY_KEYS, t);
+
+        // 机体坐标系下的加速度计读数：dv/dt = a + ω×v
+        ImuSample imu = {};
+        imu.gyro[2] = wz + GYRO_BIAS + gyro_noise(rng);
+        imu.accel[0] = (next_vx - vx) / PID_DT - wz * vy + ACCEL_BIAS[0] + accel_noise(rng);
+        imu.accel[1] = (next_vy - vy) / PID_DT + wz * vx + ACCEL_BIAS[1] + accel_noise(rng);
+        imu.gyro_count = 1;
+        imu.accel_count = 1;
+        vx = next_vx;
+        vy = next_vy;
+        yaw = wrap_angle(yaw + wz * PID_DT);
+
+        inverse.calc(vx, vy, wz);
+        const float slip = profile(SLIP_KEYS, t);
+        const float lf_sign = inverse.speed_lf >= 0.0f ? 1.0f : -1.0f;
+        float speed[4] = {
+            inverse.speed_lf + lf_sign * slip * SLIP_WHEEL_SPEED + wheel_noise(rng),
+            inverse.speed_lr + wheel_noise(rng),
+            inverse.speed_rf + wheel_noise(rng),
+            inverse.speed_rr + wheel_noise(rng),
+        };
+
+        {
+            SCOPE_TIMER(IMU_FILTER);
+            estimator.update(speed, imu);
+        }
+
+        gyro_yaw = wrap_angle(gyro_yaw + imu.gyro[2] * PID_DT);
+        odom_yaw = wrap_angle(odom_yaw + estimator.odom_wz * PID_DT);
+        if (k == static_cast<uint32_t>(STILL_END / PID_DT)) calibrated_in_time = estimator.imu_valid;
+        if (t > STILL_END) yaw_error_max = std::max(yaw_error_max, std::abs(wrap_angle(estimator.yaw - yaw)));
+
+        const bool slipping = t >= SLIP_START && t < SLIP_END;
+        if (slipping) {
+            if (estimator.slipping && slip_detected_ms == UINT32_MAX) {
+                slip_detected_ms = static_cast<uint32_t>((t - SLIP_START) * 1000.0f + 0.5f);
+            }
+            slip_error = std::max(slip_error, std::hypot(estimator.vx - vx, estimator.vy - vy));
+            slip_odom_error = std::max(slip_odom_error, std::hypot(estimator.odom_vx - vx, estimator.odom_vy - vy));
+        }
+        // 打滑结束后里程计校正还要一个时间常数才能把积分误差拉回，不计入跟随误差
+        else if (t > STILL_END && (t < SLIP_START || t > SLIP_END + 0.5f)) {
+            square_error += (estimator.vx - vx) * (estimator.vx - vx) + (estimator.vy - vy) * (estimator.vy - vy);
+            tracked++;
+        }
+    }
+
+    const float yaw_error = std::abs(wrap_angle(estimator.yaw - yaw));
+    const float gyro_error = std::abs(wrap_angle(gyro_yaw - yaw));
+    const float odom_error = std::abs(wrap_angle(odom_yaw - yaw));
+    const float velocity_rms = static_cast<float>(std::sqrt(square_error / tracked));
+    printf(
+        "yaw error after %.0f s: fused %.4f rad (max %.4f), raw gyro %.4f rad, odometry %.4f rad\n", END, yaw_error,
+        yaw_error_max, gyro_error, odom_error);
+    printf(
+        "left-front slip: detected after %u ms, max velocity error fused %.3f m/s, odometry %.3f m/s\n",
+        slip_detected_ms, slip_error, slip_odom_error);
+    printf("velocity error rms without slip %.4f m/s, final vx %.4f vy %.4f\n", velocity_rms, estimator.vx, estimator.vy);
+
+    ok &= check(calibrated_in_time, "bias calibration completes while still");
+    ok &= check(yaw_error_max < YAW_TOLERANCE, "fused yaw follows the profile");
+    ok &= check(yaw_error < 0.25f * gyro_error && yaw_error < 0.25f * odom_error, "fusion beats gyro-only and odometry yaw");
+    ok &= check(slip_detected_ms <= SLIP_DETECT_MS, "wheel slip is detected");
+    ok &= check(slip_error < 0.3f * slip_odom_error, "slip stays out of the fused velocity");
+    ok &= check(velocity_rms < VELOCITY_TOLERANCE, "fused velocity follows the chassis without slip");
+    ok &= check(estimator.vx == 0.0f && estimator.vy == 0.0f, "velocity returns to zero when still");
+
+    // 主机构建的profiler_cycles()为纳秒，C板上为168MHz的DWT周期
+    ScopeStatEntry entries[static_cast<size_t>(ScopeId::COUNT)];
+    size_t n = scope_timers_sample(entries, static_cast<size_t>(ScopeId::COUNT));
+    const ScopeStatEntry & filter = entries[static_cast<size_t>(ScopeId::IMU_FILTER)];
+    const float per_us = static_cast<float>(profiler_cycles_per_us());
+    printf(
+        "update(): %u calls, p50 %u p99 %u max %u cycles (%u cycles/us: p50 %.2f us, p99 %.2f us)\n", filter.count,
+        filter.p50, filter.p99, filter.max, profiler_cycles_per_us(), filter.p50 / per_us, filter.p99 / per_us);
+    ok &= check(n == static_cast<size_t>(ScopeId::COUNT) && filter.count == steps, "every update is timed");
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+// 失控保护仿真
+// 底盘以恒定设定值行驶到稳态后指令失效，比较两种处理在底盘模型 (chassis_plant) 上的停车距离和功率：
+//   切断：原先的做法，指令失效即释放力矩，底盘靠摩擦滑行
+//   制动：Failsafe为固件代码，进入制动时整形器从当前设定值出发减速到零，
+//         之后与chassis_control_task()相同，BRAKING/RECOVERING在功率限制下跟踪整形器，RELEASED释放力矩
+// 另外在轮速维持不变 (底盘被推着走、车轮悬空打滑) 时给出时断时续的指令，检查制动时限。
+// 检查:
+//   1. 主动制动的停车距离短于滑行，制动过程的峰值功率不超过功率上限，靠停稳判定释放而不是超时
+//   2. 指令时断时续、轮速降不下来时，从第一次失效起在制动时限之后的下一次失效释放力矩
+//      (恢复中指令有效时仍保持制动，最多再等一个恢复保持时间)
+//   3. 指令持续恢复重新接管后，下一次失效重新计时
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+#include "chassis_plant.hpp"
+#include "failsafe.hpp"
+#include "input_shaping.hpp"
+
+// 与chassis_control.hpp、chassis_control_task.cpp相同
+constexpr float LINEAR_ACC_MAX = 4.0f;
+constexpr float LINEAR_JERK_MAX = 40.0f;
+constexpr float ROTATION_ACC_MAX = 30.0f;
+constexpr float ROTATION_JERK_MAX = 300.0f;
+constexpr uint32_t CONTROL_PERIOD_MS = 1;
+constexpr uint32_t BRAKE_TIMEOUT_MS = 1500;
+constexpr float BRAKE_STOP_SPEED = 2.0f;
+constexpr uint32_t RECOVER_HOLD_MS = 100;
+
+constexpr float POWER_LIMIT = 80.0f;
+constexpr uint32_t CRUISE_MS = 2000;     // 指令失效前的行驶时间
+constexpr uint32_t END_MS = CRUISE_MS + 4000;
+constexpr float STOPPED_SPEED = 0.01f;   // 判定停车的车速 m/s
+constexpr float PUSHED_WHEEL_SPEED = 10.0f;  // 被推着走时的轮速 rad/s
+
+enum class Response
+{
+    CUT,
+    BRAKE,
+};
+
+struct Cruise
+{
+    const char * name;
+    float vx, vy, wz;
+};
+
+struct Result
+{
+    float distance = 0.0f;       // 失效到停车的路程 m
+    float stop_time = 0.0f;      // 失效到停车 s
+    float peak_power = 0.0f;     // 失效后的峰值功率 W
+    uint32_t release_ms = 0;     // 失效到释放力矩 ms
+};
+
+static float max_wheel_speed(const float wheel[4])
+{
+    return std::max(std::max(std::abs(wheel[0]), std::abs(wheel[1])), std::max(std::abs(wheel[2]), std::abs(wheel[3])));
+}
+
+static Result stop(const Cruise & cruise, Response response)
+{
+    Failsafe failsafe(BRAKE_TIMEOUT_MS, BRAKE_STOP_SPEED, RECOVER_HOLD_MS);
+    SetpointShaper vx_shaper(LINEAR_ACC_MAX, LINEAR_JERK_MAX, PID_DT);
+    SetpointShaper vy_shaper(LINEAR_ACC_MAX, LINEAR_JERK_MAX, PID_DT);
+    SetpointShaper wz_shaper(ROTATION_ACC_MAX, ROTATION_JERK_MAX, PID_DT);
+    LoopConfig config;
+    config.power_limit = POWER_LIMIT;
+    ChassisLoop loop(config);
+    ChassisPlant plant;
+    plant.set_velocity(cruise.vx, cruise.vy, cruise.wz);
+    vx_shaper.reset(cruise.vx);
+    vy_shaper.reset(cruise.vy);
+    wz_shaper.reset(cruise.wz);
+
+    Result r;
+    float last_x = 0.0f, last_y = 0.0f;
+    bool stopped = false;
+    FailsafeState last_state = FailsafeState::RELEASED;
+    for (uint32_t now_ms = 0; now_ms < END_MS; now_ms++) {
+        bool command_ok = now_ms < CRUISE_MS;
+        FailsafeState state = failsafe.update(command_ok, max_wheel_speed(plant.wheel), now_ms);
+        if (response == Response::CUT && !command_ok) state = FailsafeState::RELEASED;
+        // 与start_braking()相同，整形器已在行驶设定值上
+        if (state == FailsafeState::BRAKING && last_state == FailsafeState::ACTIVE) {
+            vx_shaper.set_target(0.0f, CONTROL_PERIOD_MS);
+            vy_shaper.set_target(0.0f, CONTROL_PERIOD_MS);
+            wz_shaper.set_target(0.0f, CONTROL_PERIOD_MS);
+        }
+        if (state == FailsafeState::RELEASED && last_state != FailsafeState::RELEASED && !command_ok) {
+            r.release_ms = now_ms - CRUISE_MS;
+        }
+        last_state = state;
+
+        float torque[4] = {};
+        if (state == FailsafeState::RELEASED) {
+            loop.reset();
+        }
+        else {
+            loop.update(vx_shaper.update(), vy_shaper.update(), wz_shaper.update(), plant.wheel);
+            std::copy(loop.torque, loop.torque + 4, torque);
+        }
+        plant.step(torque, PID_DT);
+
+        if (now_ms == CRUISE_MS - 1) {
+            last_x = plant.x;
+            last_y = plant.y;
+        }
+        if (now_ms >= CRUISE_MS && !stopped) {
+            r.distance += std::hypot(plant.x - last_x, plant.y - last_y);
+            last_x = plant.x;
+            last_y = plant.y;
+            r.peak_power = std::max(r.peak_power, plant.power);
+            if (std::hypot(plant.v[0], plant.v[1]) < STOPPED_SPEED && std::abs(plant.v[2]) < STOPPED_SPEED) {
+                stopped = true;
+                r.stop_time = (now_ms + 1 - CRUISE_MS) * 1e-3f;
+            }
+        }
+    }
+    return r;
+}
+
+// 轮速保持PUSHED_WHEEL_SPEED，指令时断时续：先失效lost_ms再有效ok_ms，重复repeat次。
+// 返回从第一次失效到释放力矩的时间，没有释放返回UINT32_MAX
+static uint32_t intermittent(Failsafe & failsafe, uint32_t start_ms, uint32_t ok_ms, uint32_t lost_ms, int repeat)
+{
+    const uint32_t period = ok_ms + lost_ms;
+    for (uint32_t t = 0; t < period * repeat; t++) {
+        bool command_ok = (t % period) >= lost_ms;
+        FailsafeState state = failsafe.update(command_ok, PUSHED_WHEEL_SPEED, start_ms + t);
+        if (state == FailsafeState::RELEASED) return t;
+    }
+    return UINT32_MAX;
+}
+
+static bool check(bool ok, const char * what)
+{
+    if (!ok) fprintf(stderr, "FAIL: %s\n", what);
+    return ok;
+}
+
+static void print(const char * name, const Result & r)
+{
+    printf(
+        "%-26s distance %5.3f m  stop %5.3f s  peak power %6.1f W  release %4u ms\n", name, r.distance,
+        r.stop_time, r.peak_power, r.release_ms);
+}
+
+int main()
+{
+    bool ok = true;
+
+    // 1. 行驶中指令失效
+    const Cruise cruises[] = {
+        {"straight 2 m/s", 2.0f, 0.0f, 0.0f},
+        {"diagonal, turning", 1.5f, 1.0f, 3.0f},
+        {"strafe 1.5 m/s", 0.0f, 1.5f, 0.0f},
+    };
+    char name[64];
+    for (const Cruise & cruise : cruises) {
+        Result cut = stop(cruise, Response::CUT);
+        Result brake = stop(cruise, Response::BRAKE);
+        snprintf(name, sizeof(name), "%s, cut", cruise.name);
+        print(name, cut);
+        snprintf(name, sizeof(name), "%s, brake", cruise.name);
+        print(name, brake);
+        ok &= check(brake.distance < cut.distance, "active braking stops shorter than coasting");
+        ok &= check(brake.peak_power <= POWER_LIMIT, "braking stays within the power limit");
+        ok &= check(brake.release_ms < BRAKE_TIMEOUT_MS, "braking releases on the stop speed, not the timeout");
+    }
+
+    // 2. 指令时断时续：有效时间短于恢复所需的保持时间，一直在BRAKING/RECOVERING之间切换
+    Failsafe failsafe(BRAKE_TIMEOUT_MS, BRAKE_STOP_SPEED, RECOVER_HOLD_MS);
+    for (uint32_t t = 0; t <= RECOVER_HOLD_MS; t++) failsafe.update(true, PUSHED_WHEEL_SPEED, t);
+    ok &= check(failsafe.state() == FailsafeState::ACTIVE, "steady command takes over");
+    uint32_t released = intermittent(failsafe, 1000, 60, 30, 100);
+    printf(
+        "intermittent command 60 ms on / 30 ms off: released after %u ms (timeout %u ms)\n", released,
+        BRAKE_TIMEOUT_MS);
+    ok &= check(released <= BRAKE_TIMEOUT_MS + RECOVER_HOLD_MS, "intermittent command cannot keep the chassis braking");
+
+    // 3. 重新接管后下一次失效重新计时
+    for (uint32_t t = 20000; t <= 20000 + RECOVER_HOLD_MS; t++) failsafe.update(true, PUSHED_WHEEL_SPEED, t);
+    ok &= check(failsafe.state() == FailsafeState::ACTIVE, "steady command takes over again");
+    uint32_t second = intermittent(failsafe, 30000, 0, 1, BRAKE_TIMEOUT_MS + 10);
+    printf("after takeover, lost command: released after %u ms\n", second);
+    ok &= check(second == BRAKE_TIMEOUT_MS, "takeover starts a fresh braking deadline");
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,180 @@
+// 轮速前馈仿真
+// 先按上车辨识的流程在底盘模型 (chassis_plant) 上求前馈参数：不带前馈沿前后、横移、旋转来回加减速，
+// FeedforwardIdentifier为固件代码，每周期送入轮速和下发力矩 (电调反馈的力矩)，最后求解J、B、Fc。
+// 再把阶跃设定值经与chassis_move_control()相同的链路 (功率感知加速度限制、PID、功率缩放、反算) 送到底盘上，
+// 比较不带前馈和带辨识结果的前馈：
+//   调节时间：设定值跳变到车速进入目标±5%并保持的时间
+//   能量：跳变到车速走完90%跳变量的电能，以及整个保持时间的电能。
+//         不带前馈时积分项很慢 (积分时间约10s)，保持时间内车速停在目标以下约6%，
+//         整段电能少是因为没到目标速度，所以按走完同样跳变量的电能比较
+// 阶跃都在80W下可持续的范围内，到不了的设定值由功率限制决定调节，与前馈无关
+// 检查:
+//   1. 辨识可解，J、B、Fc与模型折算到单轮的值同量级
+//      (J随平移/旋转变化，单一J的模型残差比库仑摩擦还大，不作为检查)
+//   2. 前馈缩短每个动作的调节时间，保持结束时的误差在调节带内
+//   3. 前馈不增加走完跳变量的电能。旋转时车体折算到单轮的惯量比平移小，单一J的前馈在旋转时偏大，
+//      按辨识J与该方向惯量之比放宽
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+#include "chassis_plant.hpp"
+
+constexpr float POWER_LIMIT = 80.0f;
+constexpr uint32_t IDENT_SEGMENT_MS = 1500;  // 辨识时每段动作的时长
+constexpr uint32_t STEP_HOLD_MS = 2500;      // 阶跃后保持的时长
+constexpr float SETTLE_BAND = 0.05f;         // 调节带，目标的比例
+constexpr float SETTLE_BAND_MIN = 0.02f;     // 目标为零时的调节带 m/s 或 rad/s
+constexpr float RISE_FRACTION = 0.9f;        // 统计电能的跳变量比例
+constexpr float ENERGY_MARGIN = 1.05f;
+
+struct Step
+{
+    const char * name;
+    int axis;  // 0: vx, 1: vy, 2: wz
+    float from, to;
+};
+
+struct Result
+{
+    float settle_time = 0.0f;   // s，没有调节完成为保持时长
+    float rise_energy = 0.0f;   // 跳变到走完RISE_FRACTION跳变量的电能 J
+    float energy = 0.0f;        // 整个保持时间内的电能 J
+    float end_error = 0.0f;     // 保持结束时的误差，目标的比例 (目标为零时为m/s或rad/s)
+    float overshoot = 0.0f;     // 超过目标的最大量，跳变量的比例
+};
+
+static bool check(bool ok, const char * what)
+{
+    if (!ok) fprintf(stderr, "FAIL: %s\n", what);
+    return ok;
+}
+
+// 1. 辨识：与上车辨识相同，不带前馈来回开，控制任务每周期送入轮速和力矩
+static IdentResultFrame identify()
+{
+    FeedforwardIdentifier ident(PID_DT);
+    LoopConfig config;
+    config.power_limit = 0.0f;
+    ChassisLoop loop(config);
+    ChassisPlant plant;
+
+    // 每段在设定值之间来回切换，加减速段提供α激励，匀速段提供ω激励
+    const float segments[][3] = {
+        {1.5f, 0.0f, 0.0f}, {-1.5f, 0.0f, 0.0f}, {0.5f, 0.0f, 0.0f}, {0.0f, 1.2f, 0.0f},  {0.0f, -1.2f, 0.0f},
+        {0.0f, 0.0f, 6.0f}, {0.0f, 0.0f, -6.0f}, {1.0f, 0.8f, 2.0f}, {-1.0f, -0.8f, -2.0f}, {2.0f, 0.0f, 0.0f},
+    };
+    ident.request(IdentOp::START);
+    for (const auto & segment : segments) {
+        for (uint32_t t = 0; t < IDENT_SEGMENT_MS; t++) {
+            loop.update(segment[0], segment[1], segment[2], plant.wheel);
+            ident.update(plant.wheel, loop.torque);
+            plant.step(loop.torque, PID_DT);
+        }
+    }
+    ident.request(IdentOp::SOLVE);
+    ident.update(plant.wheel, loop.torque);
+    IdentResultFrame result = {};
+    ident.take_result(result);
+    return result;
+}
+
+static Result run(const Step & step, const FeedforwardModel & ff)
+{
+    LoopConfig config;
+    config.power_limit = POWER_LIMIT;
+    config.ff = ff;
+    ChassisLoop loop(config);
+    ChassisPlant plant;
+    float from[3] = {}, to[3] = {};
+    from[step.axis] = step.from;
+    to[step.axis] = step.to;
+    plant.set_velocity(from[0], from[1], from[2]);
+
+    // 先在起始设定值上稳定下来
+    for (uint32_t t = 0; t < 1000; t++) {
+        loop.update(from[0], from[1], from[2], plant.wheel);
+        plant.step(loop.torque, PID_DT);
+    }
+
+    Result r;
+    const float span = std::abs(step.to - step.from);
+    const float band = std::max(SETTLE_BAND * std::abs(step.to), SETTLE_BAND_MIN);
+    const float direction = (step.to > step.from) ? 1.0f : -1.0f;
+    uint32_t settled_at = STEP_HOLD_MS;
+    bool risen = false;
+    for (uint32_t t = 0; t < STEP_HOLD_MS; t++) {
+        loop.update(to[0], to[1], to[2], plant.wheel);
+        plant.step(loop.torque, PID_DT);
+        r.energy += plant.power * PID_DT;
+
+        float error = plant.v[step.axis] - step.to;
+        if (!risen && direction * (plant.v[step.axis] - step.from) >= RISE_FRACTION * span) {
+            risen = true;
+            r.rise_energy = r.energy;
+        }
+        r.overshoot = std::max(r.overshoot, direction * error / span);
+        if (std::abs(error) > band) {
+            settled_at = STEP_HOLD_MS;
+        }
+        else if (settled_at == STEP_HOLD_MS) {
+            settled_at = t + 1;
+        }
+    }
+    if (!risen) r.rise_energy = r.energy;
+    r.settle_time = settled_at * PID_DT;
+    r.end_error = (plant.v[step.axis] - step.to) / std::max(std::abs(step.to), 1.0f);
+    return r;
+}
+
+int main()
+{
+    bool ok = true;
+
+    // 1. 辨识
+    IdentResultFrame ident = identify();
+    // 纯前后平移时单轮折算惯量 m·r²/4 + Jw，纯旋转时 Iz·r²/(4(a+b)²) + Jw
+    const float r2 = WHEEL_RADIUS * WHEEL_RADIUS;
+    const float inertia_translate = PLANT_MASS * r2 / 4.0f + PLANT_WHEEL_INERTIA;
+    const float inertia_rotate =
+        PLANT_YAW_INERTIA * r2 / (4.0f * (HALF_LENGTH + HALF_WIDTH) * (HALF_LENGTH + HALF_WIDTH)) + PLANT_WHEEL_INERTIA;
+    printf(
+        "identified J %.4f (translate %.4f, rotate %.4f) kg*m^2, B %.4f (%.4f) N*m*s, Fc %.3f (%.3f) N*m\n",
+        ident.inertia, inertia_translate, inertia_rotate, ident.viscous, PLANT_VISCOUS, ident.coulomb, PLANT_COULOMB);
+    printf("  %u samples, residual rms %.3f N*m\n", ident.samples, ident.rms_error);
+    ok &= check(ident.ok, "identification solves");
+    ok &= check(
+        ident.inertia > 0.5f * inertia_rotate && ident.inertia < 2.0f * inertia_translate,
+        "identified inertia lies between the rotation and translation values");
+    ok &= check(ident.coulomb > 0.5f * PLANT_COULOMB && ident.coulomb < 2.0f * PLANT_COULOMB, "identified friction");
+
+    // 2、3. 阶跃
+    const FeedforwardModel none = {0.0f, 0.0f, 0.0f};
+    const FeedforwardModel identified = {ident.inertia, ident.viscous, ident.coulomb};
+    const Step steps[] = {
+        {"forward 0 -> 1 m/s", 0, 0.0f, 1.0f},
+        {"forward 1 -> 0 m/s", 0, 1.0f, 0.0f},
+        {"reverse 0.8 -> -0.8 m/s", 0, 0.8f, -0.8f},
+        {"strafe 0 -> 0.8 m/s", 1, 0.0f, 0.8f},
+        {"rotate 0 -> 4 rad/s", 2, 0.0f, 4.0f},
+        {"forward 0 -> 0.3 m/s", 0, 0.0f, 0.3f},
+    };
+    for (const Step & step : steps) {
+        Result pid = run(step, none);
+        Result ff = run(step, identified);
+        printf(
+            "%-24s settle %5.3f -> %5.3f s  energy to 90%% %5.1f -> %5.1f J  total %5.1f -> %5.1f J  "
+            "end error %5.1f%% -> %5.1f%%  overshoot %4.1f%% -> %4.1f%%\n",
+            step.name, pid.settle_time, ff.settle_time, pid.rise_energy, ff.rise_energy, pid.energy, ff.energy,
+            100.0f * pid.end_error, 100.0f * ff.end_error, 100.0f * pid.overshoot, 100.0f * ff.overshoot);
+        ok &= check(ff.settle_time < pid.settle_time, "feedforward settles faster");
+        ok &= check(std::abs(ff.end_error) <= SETTLE_BAND, "feedforward holds the target");
+        const float margin = std::max(ENERGY_MARGIN, ident.inertia / (step.axis == 2 ? inertia_rotate : inertia_translate));
+        ok &= check(
+            ff.rise_energy - pid.rise_energy <= (margin - 1.0f) * std::abs(pid.rise_energy),
+            "feedforward does not cost energy to reach the target");
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,128 @@
+// 轮速环增益调度仿真
+// 单轮模型 (转动惯量 + 粘滞摩擦 + 负载力矩阶跃)，WheelPid和gain_schedule()为固件代码，
+// 调度方式与chassis_control_task.cpp相同：每周期按轮速查表，倍率乘在默认PID参数上。
+// 检查:
+//   1. 查表：断点处取表值，断点间连续，负轮速与正轮速相同，超出最后一个断点取末项
+//   2. 低速阶跃加负载：调度后误差积分 (IAE) 明显减小；高速阶跃基本不变
+//   3. 功率受限 (输出按固定比例缩放并反算) 时换表：受限期间力矩需求减小，解除限制后的跟踪与不换表相近
+//   4. 运行中切换ki输出不跳变
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+#include "gain_schedule.hpp"
+#include "wheel_pid.hpp"
+
+// 与chassis_control.hpp相同
+constexpr float PID_DT = 0.001f;
+constexpr float PID_KP = 0.5f;
+constexpr float PID_KI = 0.05f;
+constexpr float PID_KD = 0.01f;
+constexpr float PID_MO = 2.5f;
+constexpr float PID_MIO = 1.0f;
+constexpr float PID_ALPHA = 0.0f;
+constexpr float PID_KB = 20.0f;
+
+// 单轮模型，折算到轮轴
+constexpr float WHEEL_INERTIA = 0.02f;  // kg·m^2
+constexpr float WHEEL_VISCOUS = 0.02f;  // N·m/(rad/s)
+constexpr float LOAD_TORQUE = 0.5f;     // 负载阶跃 N·m
+constexpr uint32_t STEP_TICK = 100;     // 设定值阶跃时刻
+constexpr uint32_t LOAD_TICK = 400;     // 负载阶跃时刻
+constexpr uint32_t TICKS = 600;
+constexpr uint32_t LIMITED_TICKS = 2000; // 功率受限场景：受限阶段较长，轮速接近设定值后解除
+constexpr uint32_t RELEASE_TICK = 1200;
+constexpr float POWER_SCALE = 0.4f;     // 功率受限时的输出缩放
+
+struct StepResult
+{
+    float iae;        // 阶跃后的误差绝对值积分 rad
+    float request;    // 功率受限期间PID输出 (缩放前的力矩需求) 绝对值的均值 N·m
+    float settle_iae; // 功率限制解除后的误差绝对值积分 rad
+};
+
+static StepResult step(float from, float to, bool scheduled, bool power_limited, uint32_t ticks = TICKS)
+{
+    WheelPid pid(PID_DT, PID_KP, PID_KI, PID_KD, PID_MO, PID_MIO, PID_ALPHA, PID_KB);
+    float speed = from;
+    StepResult r = {};
+    for (uint32_t k = 0; k < ticks; k++) {
+        float set = (k < STEP_TICK) ? from : to;
+        bool limited = power_limited && k < RELEASE_TICK;
+        if (scheduled) {
+            const GainScale s = gain_schedule(speed, limited);
+            pid.set_gains(PID_KP * s.kp, PID_KI * s.ki, PID_KD * s.kd);
+        }
+        pid.calc(set, speed);
+        float torque = limited ? pid.out * POWER_SCALE : pid.out;
+        pid.back_calculate(torque);
+        if (limited && k >= STEP_TICK) r.request += std::abs(pid.out) / static_cast<float>(RELEASE_TICK - STEP_TICK);
+
+        float load = (k >= LOAD_TICK && !power_limited) ? LOAD_TORQUE : 0.0f;
+        speed += (torque - WHEEL_VISCOUS * speed - load) / WHEEL_INERTIA * PID_DT;
+        if (k >= STEP_TICK) r.iae += std::abs(set - speed) * PID_DT;
+        if (power_limited && k >= RELEASE_TICK) r.settle_iae += std::abs(set - speed) * PID_DT;
+    }
+    return r;
+}
+
+static bool check(bool ok, const char * what)
+{
+    if (!ok) fprintf(stderr, "FAIL: %s\n", what);
+    return ok;
+}
+
+static bool same(const GainScale & a, const GainScale & b, float tol)
+{
+    return std::abs(a.kp - b.kp) <= tol && std::abs(a.ki - b.ki) <= tol && std::abs(a.kd - b.kd) <= tol;
+}
+
+int main()
+{
+    bool ok = true;
+
+    // 1. 查表
+    for (int limited = 0; limited < 2; limited++) {
+        GainScale last = gain_schedule(0.0f, limited);
+        float max_jump = 0.0f;
+        for (float speed = 0.01f; speed <= 60.0f; speed += 0.01f) {
+            GainScale s = gain_schedule(speed, limited);
+            max_jump = std::max({max_jump, std::abs(s.kp - last.kp), std::abs(s.ki - last.ki), std::abs(s.kd - last.kd)});
+            ok &= check(same(s, gain_schedule(-speed, limited), 0.0f), "negative speed uses the same gains");
+            last = s;
+        }
+        ok &= check(max_jump < 0.01f, "gain schedule is continuous");
+        ok &= check(same(gain_schedule(40.0f, limited), gain_schedule(1000.0f, limited), 0.0f), "last entry beyond table");
+        ok &= check(same(gain_schedule(16.0f, limited), gain_schedule(15.999f, limited), 1e-3f), "breakpoint matches");
+    }
+
+    // 2. 阶跃响应
+    StepResult low_fixed = step(0.0f, 3.0f, false, false);
+    StepResult low_sched = step(0.0f, 3.0f, true, false);
+    StepResult high_fixed = step(20.0f, 30.0f, false, false);
+    StepResult high_sched = step(20.0f, 30.0f, true, false);
+    printf("0->3 rad/s    IAE fixed %.4f  scheduled %.4f\n", low_fixed.iae, low_sched.iae);
+    printf("20->30 rad/s  IAE fixed %.4f  scheduled %.4f\n", high_fixed.iae, high_sched.iae);
+    ok &= check(low_sched.iae < 0.8f * low_fixed.iae, "scheduling improves low-speed tracking");
+    ok &= check(std::abs(high_sched.iae - high_fixed.iae) < 0.1f * high_fixed.iae, "high-speed tracking unchanged");
+
+    // 3. 功率受限时的换表
+    StepResult limited_normal = step(0.0f, 30.0f, false, true, LIMITED_TICKS);
+    StepResult limited_sched = step(0.0f, 30.0f, true, true, LIMITED_TICKS);
+    printf(
+        "0->30 rad/s power-limited  request fixed %.3f scheduled %.3f N·m, after release IAE fixed %.4f scheduled %.4f\n",
+        limited_normal.request, limited_sched.request, limited_normal.settle_iae, limited_sched.settle_iae);
+    ok &= check(limited_sched.request < limited_normal.request, "limited table lowers the torque request");
+    ok &= check(limited_sched.settle_iae < 1.1f * limited_normal.settle_iae, "limited table recovers like the fixed gains");
+
+    // 4. 切换ki时输出连续：误差不变时只有kp项随倍率变化
+    WheelPid pid(PID_DT, PID_KP, PID_KI, PID_KD, PID_MO, PID_MIO, PID_ALPHA, PID_KB);
+    for (int k = 0; k < 200; k++) pid.calc(1.0f, 0.9f);
+    float before = pid.ir;
+    pid.set_gains(PID_KP, PID_KI * 0.3f, PID_KD);
+    pid.calc(1.0f, 0.9f);
+    ok &= check(std::abs(pid.ir - before) < 2.0f * PID_KI * 0.1f * PID_DT, "changing ki keeps the integral term");
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,415 @@
+// 输入记录与回放测试
+// 按虚拟时钟合成一段20s的输入流 (遥控器、裁判系统、CAN2电机反馈、USB命令、IMU)，分两遍运行同一个控制回路：
+//   第一遍用InputReplay注入合成流，各接收回调中的记录点写入InputRecorder，
+//         USB任务循环中flush()打包后经usb_link发出，收集发出的INPUT_RECORD帧
+//   第二遍用InputReplay注入收集到的记录流，记录仪关闭
+// 检查记录流与合成流逐字节相同、两遍每个控制周期的输出逐位相同，且第二遍至少比实时快100倍。
+// 串口和CAN回调与uart_task.cpp/can_task.cpp中的一样先记录再交给接收方 (那两个文件依赖sp_middleware，
+// 主机上无法编译)；USB和IMU的记录点及IMU的中断回调在固件的usb_link.cpp和bmi088.cpp中
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "bmi088.hpp"
+#include "can.h"
+#include "cmsis_os.h"
+#include "cpu_profiler.hpp"
+#include "input_recorder.hpp"
+#include "input_replay.hpp"
+#include "tools/crc/crc.hpp"
+#include "usart.h"
+#include "usb_link.hpp"
+#include "usbd_cdc_if.h"
+
+constexpr uint32_t CYCLES_PER_MS = 168000;
+constexpr uint32_t DURATION_MS = 20000;
+constexpr uint32_t START_CYCLES = 0xFFFFFFFFu - 3000 * CYCLES_PER_MS;  // 3s后DWT计数回绕
+constexpr size_t INPUT_FLUSH_BATCH = 8;  // 与usb_task.cpp相同
+constexpr uint32_t INPUT_RECORD_BUFF_SIZE = 16384;
+constexpr size_t DBUS_FRAME_SIZE = 18;
+constexpr size_t UART_RX_SIZE = 256;
+constexpr double REPLAY_SPEEDUP_MIN = 100.0;
+
+// ---------------------------------------------------------------- 主机版HAL与固件实例
+
+extern "C" {
+UART_HandleTypeDef huart3{3, nullptr, 0};
+UART_HandleTypeDef huart6{6, nullptr, 0};
+CAN_HandleTypeDef hcan2{2};
+SPI_HandleTypeDef hspi1{1, nullptr, nullptr, 0};
+GPIO_TypeDef sim_gpioa{0}, sim_gpiob{1}, sim_gpioc{2};
+uint8_t UserTxBufferFS[APP_TX_DATA_SIZE];
+}
+
+static uint32_t virtual_cycles = START_CYCLES;
+static std::vector<uint8_t> usb_tx;  // usb_link发出的字节
+static bool acc_selected = false;
+
+uint32_t profiler_cycles() { return virtual_cycles; }
+uint32_t profiler_cycles_per_us() { return CYCLES_PER_MS / 1000; }
+IsrProfile::~IsrProfile() {}
+
+extern "C" void osDelay(uint32_t) {}
+extern "C" uint32_t osKernelSysTick() { return virtual_cycles / CYCLES_PER_MS; }
+
+extern "C" void HAL_GPIO_WritePin(GPIO_TypeDef * port, uint16_t pin, GPIO_PinState state)
+{
+    if (port == CS1_ACC_GPIO_Port && pin == CS1_ACC_Pin) acc_selected = (state == GPIO_PIN_RESET);
+}
+
+// Bmi088::init()的阻塞寄存器读写，读芯片ID时按片选返回
+extern "C" HAL_StatusTypeDef HAL_SPI_TransmitReceive(
+    SPI_HandleTypeDef *, const uint8_t * tx, uint8_t * rx, uint16_t size, uint32_t)
+{
+    std::memset(rx, 0, size);
+    if (tx[0] == 0x80) rx[size - 1] = acc_selected ? 0x1E : 0x0F;
+    return HAL_OK;
+}
+
+extern "C" uint8_t CDC_TxReady_FS() { return 1; }
+
+extern "C" uint8_t CDC_Transmit_FS(uint8_t * buf, uint16_t len)
+{
+    usb_tx.insert(usb_tx.end(), buf, buf + len);
+    return 0;
+}
+
+static uint8_t input_record_buffer[INPUT_RECORD_BUFF_SIZE];
+InputRecorder input_recorder(input_record_buffer, INPUT_RECORD_BUFF_SIZE);
+Bmi088 bmi088(&hspi1);
+
+// ---------------------------------------------------------------- 被测控制回路
+
+// 控制回路看到的输入，全部由接收回调和USB命令处理函数写入
+struct LoopInputs
+{
+    uint8_t dbus[DBUS_FRAME_SIZE];
+    uint32_t referee_hash;
+    int16_t motor_speed[4];
+    int16_t motor_current[4];
+    float nav[3];
+    float gain;
+};
+
+static LoopInputs inputs;
+static uint8_t dbus_rx[UART_RX_SIZE];
+static uint8_t referee_rx[UART_RX_SIZE];
+
+extern "C" void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef * huart, uint16_t size)
+{
+    if (huart == &huart3) {
+        input_recorder.record(InputSource::DBUS, 0, huart->pRxBuffPtr, size);
+        if (size == DBUS_FRAME_SIZE) std::memcpy(inputs.dbus, huart->pRxBuffPtr, DBUS_FRAME_SIZE);
+        HAL_UARTEx_ReceiveToIdle_DMA(&huart3, dbus_rx, sizeof(dbus_rx));
+    }
+    if (huart == &huart6) {
+        input_recorder.record(InputSource::REFEREE, 0, huart->pRxBuffPtr, size);
+        for (uint16_t i = 0; i < size; i++) inputs.referee_hash = (inputs.referee_hash ^ huart->pRxBuffPtr[i]) * 16777619u;
+        HAL_UARTEx_ReceiveToIdle_DMA(&huart6, referee_rx, sizeof(referee_rx));
+    }
+}
+
+extern "C" void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef * hcan)
+{
+    CAN_RxHeaderTypeDef header;
+    uint8_t data[8];
+    while (HAL_CAN_GetRxFifoFillLevel(hcan, CAN_RX_FIFO0) > 0) {
+        if (HAL_CAN_GetRxMessage(hcan, CAN_RX_FIFO0, &header, data) != HAL_OK) return;
+        uint16_t id = static_cast<uint16_t>(header.StdId);
+        input_recorder.record(InputSource::CAN2, id, data, sizeof(data));
+        if (id >= 0x201 && id <= 0x204) {
+            inputs.motor_speed[id - 0x201] = static_cast<int16_t>(data[2] << 8 | data[3]);
+            inputs.motor_current[id - 0x201] = static_cast<int16_t>(data[4] << 8 | data[5]);
+        }
+    }
+}
+
+static void on_nav_cmd(const uint8_t * payload, uint8_t len)
+{
+    if (len == sizeof(inputs.nav)) std::memcpy(inputs.nav, payload, len);
+}
+
+static void on_param_set(const uint8_t * payload, uint8_t len)
+{
+    if (len == sizeof(inputs.gain)) std::memcpy(&inputs.gain, payload, len);
+}
+
+// 一个控制周期的输出，用到全部输入并带积分，任何一个输入不同都会一直留在输出里
+struct LoopOutput
+{
+    float torque[4];
+    float yaw;
+};
+
+static float yaw = 0.0f;
+
+static LoopOutput control_step(bool recording)
+{
+    usb_link.poll();
+    if (recording) input_recorder.flush(INPUT_FLUSH_BATCH);
+
+    ImuSample imu;
+    bmi088.take(imu);
+    yaw += imu.gyro[2] * 0.001f;
+
+    LoopOutput out;
+    for (int i = 0; i < 4; i++) {
+        float stick = static_cast<float>(inputs.dbus[2 * i] | (inputs.dbus[2 * i + 1] << 8)) / 65535.0f;
+        float speed_set = inputs.gain * (inputs.nav[0] + ((i & 1) ? -inputs.nav[1] : inputs.nav[1]) + inputs.nav[2] + stick);
+        float error = speed_set - static_cast<float>(inputs.motor_speed[i]) * 0.01f;
+        out.torque[i] = std::tanh(error + 0.001f * inputs.motor_current[i] + 0.1f * imu.accel[i % 3]) +
+                        1e-9f * static_cast<float>(inputs.referee_hash);
+    }
+    out.yaw = yaw;
+    return out;
+}
+
+static void reset_loop()
+{
+    std::memset(&inputs, 0, sizeof(inputs));
+    inputs.gain = 1.0f;
+    yaw = 0.0f;
+    HAL_UARTEx_ReceiveToIdle_DMA(&huart3, dbus_rx, sizeof(dbus_rx));
+    HAL_UARTEx_ReceiveToIdle_DMA(&huart6, referee_rx, sizeof(referee_rx));
+
+    // init()最后主动读一次两个传感器，补完这两次传输并丢弃数据
+    virtual_cycles = START_CYCLES;
+    bmi088.init();
+    std::memset(hspi1.pRxBuffPtr, 0, hspi1.RxXferSize);
+    HAL_SPI_TxRxCpltCallback(&hspi1);
+    std::memset(hspi1.pRxBuffPtr, 0, hspi1.RxXferSize);
+    HAL_SPI_TxRxCpltCallback(&hspi1);
+    ImuSample discard;
+    bmi088.take(discard);
+}
+
+// 按控制周期注入输入并运行控制回路，返回每个周期的输出
+static std::vector<LoopOutput> run(InputReplay & replay, bool recording, bool & ok)
+{
+    std::vector<LoopOutput> outputs;
+    outputs.reserve(DURATION_MS);
+    for (uint32_t ms = 1; ms <= DURATION_MS; ms++) {
+        uint64_t now = START_CYCLES + static_cast<uint64_t>(ms) * CYCLES_PER_MS;
+        while (!replay.done() && replay.next_cycles() <= now) {
+            virtual_cycles = static_cast<uint32_t>(replay.next_cycles());
+            if (!replay.step()) {
+                ok = false;
+                return outputs;
+            }
+        }
+        virtual_cycles = static_cast<uint32_t>(now);
+        outputs.push_back(control_step(recording));
+    }
+    if (recording) {
+        while (input_recorder.flush(INPUT_FLUSH_BATCH)) usb_link.poll();
+        usb_link.poll();
+    }
+    ok = replay.done();
+    return outputs;
+}
+
+// ---------------------------------------------------------------- 合成输入
+
+struct SyntheticEvent
+{
+    uint64_t cycles;
+    InputSource source;
+    uint16_t id;
+    std::vector<uint8_t> data;
+};
+
+static uint32_t lcg_state = 12345;
+
+static uint8_t next_byte()
+{
+    lcg_state = lcg_state * 1664525u + 1013904223u;
+    return static_cast<uint8_t>(lcg_state >> 24);
+}
+
+static std::vector<uint8_t> usb_frame(UsbCmd cmd, const void * payload, uint8_t len, uint8_t seq)
+{
+    std::vector<uint8_t> frame(USB_FRAME_HEADER_SIZE + len + 2);
+    frame[0] = USB_FRAME_SOF;
+    frame[1] = static_cast<uint8_t>(cmd);
+    frame[2] = len;
+    frame[3] = seq;
+    std::memcpy(&frame[USB_FRAME_HEADER_SIZE], payload, len);
+    uint16_t crc = sp::get_crc16(frame.data(), USB_FRAME_HEADER_SIZE + len);
+    frame[USB_FRAME_HEADER_SIZE + len] = static_cast<uint8_t>(crc);
+    frame[USB_FRAME_HEADER_SIZE + len + 1] = static_cast<uint8_t>(crc >> 8);
+    return frame;
+}
+
+static std::vector<SyntheticEvent> synthesize()
+{
+    std::vector<SyntheticEvent> events;
+    uint8_t usb_seq = 0;
+    for (uint32_t ms = 0; ms < DURATION_MS; ms++) {
+        uint64_t base = START_CYCLES + static_cast<uint64_t>(ms) * CYCLES_PER_MS;
+        float t = static_cast<float>(ms) * 0.001f;
+
+        // 4个电机反馈，间隔约20us
+        for (uint16_t i = 0; i < 4; i++) {
+            int16_t speed = static_cast<int16_t>(3000.0f * std::sin(t * (1.0f + i)));
+            int16_t current = static_cast<int16_t>(next_byte() * 20 - 2560);
+            std::vector<uint8_t> data = {0x12, 0x34, static_cast<uint8_t>(speed >> 8), static_cast<uint8_t>(speed),
+                                         static_cast<uint8_t>(current >> 8), static_cast<uint8_t>(current), 40, 0};
+            events.push_back({base + 1000 + i * 3400u, InputSource::CAN2, static_cast<uint16_t>(0x201 + i), data});
+        }
+
+        // 陀螺仪1kHz，加速度计1600Hz
+        std::vector<uint8_t> gyro(7);
+        for (auto & b : gyro) b = next_byte();
+        events.push_back({base + 50000, InputSource::IMU, INT_GYRO_Pin, gyro});
+        for (uint64_t at = (base + 104999) / 105000 * 105000; at < base + CYCLES_PER_MS; at += 105000) {
+            std::vector<uint8_t> accel(8);
+            for (auto & b : accel) b = next_byte();
+            events.push_back({at + 7, InputSource::IMU, INT_ACC_Pin, accel});
+        }
+
+        // 遥控器14ms一帧
+        if (ms % 14 == 3) {
+            std::vector<uint8_t> dbus(DBUS_FRAME_SIZE);
+            for (auto & b : dbus) b = next_byte();
+            events.push_back({base + 90000, InputSource::DBUS, 0, dbus});
+        }
+
+        // 裁判系统包长不一，超过单个事件的长包拆分记录
+        if (ms % 10 == 5) {
+            std::vector<uint8_t> referee(((ms / 10) % 5 == 0) ? 180 : 20 + ms % 60);
+            for (auto & b : referee) b = next_byte();
+            events.push_back({base + 120000, InputSource::REFEREE, 0, referee});
+        }
+
+        // 上位机速度指令10ms一帧，每秒写一次参数；USB包边界与帧边界无关
+        if (ms % 10 == 7) {
+            float nav[3] = {std::sin(t), std::cos(t), 0.3f * std::sin(3.0f * t)};
+            std::vector<uint8_t> stream = usb_frame(UsbCmd::NAV_CMD, nav, sizeof(nav), usb_seq++);
+            if (ms % 1000 == 7) {
+                float gain = 0.5f + 0.05f * static_cast<float>(ms / 1000);
+                std::vector<uint8_t> param = usb_frame(UsbCmd::PARAM_SET, &gain, sizeof(gain), usb_seq++);
+                stream.insert(stream.end(), param.begin(), param.end());
+            }
+            size_t split = (ms % 30 == 7) ? 5 : stream.size();
+            events.push_back({base + 60000, InputSource::USB, 0, {stream.begin(), stream.begin() + split}});
+            if (split < stream.size()) {
+                events.push_back({base + 60000 + 8400, InputSource::USB, 0, {stream.begin() + split, stream.end()}});
+            }
+        }
+    }
+
+    std::stable_sort(events.begin(), events.end(), [](const SyntheticEvent & a, const SyntheticEvent & b) {
+        return a.cycles < b.cycles;
+    });
+    return events;
+}
+
+// 按InputRecorder的规则编码：长数据拆成多个事件，除最后一个外标记INPUT_SOURCE_MORE
+static std::vector<uint8_t> encode(const std::vector<SyntheticEvent> & events)
+{
+    std::vector<uint8_t> stream;
+    for (const SyntheticEvent & event : events) {
+        size_t pos = 0;
+        do {
+            size_t n = std::min(event.data.size() - pos, INPUT_EVENT_MAX_DATA);
+            bool more = pos + n < event.data.size();
+            InputEventHeader header = {
+                static_cast<uint32_t>(event.cycles), static_cast<uint8_t>(static_cast<uint8_t>(event.source) | (more ? INPUT_SOURCE_MORE : 0)),
+                static_cast<uint8_t>(n), event.id};
+            const uint8_t * h = reinterpret_cast<const uint8_t *>(&header);
+            stream.insert(stream.end(), h, h + sizeof(header));
+            stream.insert(stream.end(), event.data.begin() + pos, event.data.begin() + pos + n);
+            pos += n;
+        } while (pos < event.data.size());
+    }
+    return stream;
+}
+
+// 从usb_link发出的字节中取出INPUT_RECORD帧，检查seq连续后按顺序拼接事件
+static bool collect_record(std::vector<uint8_t> & stream)
+{
+    uint16_t expected_seq = 0;
+    size_t pos = 0;
+    while (pos + USB_FRAME_HEADER_SIZE + 2 <= usb_tx.size()) {
+        if (usb_tx[pos] != USB_FRAME_SOF) return false;
+        size_t size = USB_FRAME_HEADER_SIZE + usb_tx[pos + 2] + 2;
+        if (!sp::check_crc16(&usb_tx[pos], size)) return false;
+        if (usb_tx[pos + 1] == static_cast<uint8_t>(UsbCmd::INPUT_RECORD)) {
+            uint16_t seq;
+            std::memcpy(&seq, &usb_tx[pos + USB_FRAME_HEADER_SIZE], sizeof(seq));
+            if (seq != expected_seq++) return false;
+            stream.insert(
+                stream.end(), usb_tx.begin() + pos + USB_FRAME_HEADER_SIZE + sizeof(seq),
+                usb_tx.begin() + pos + size - 2);
+        }
+        pos += size;
+    }
+    return pos == usb_tx.size();
+}
+
+int main()
+{
+    usb_link.register_handler(UsbCmd::NAV_CMD, on_nav_cmd);
+    usb_link.register_handler(UsbCmd::PARAM_SET, on_param_set);
+
+    std::vector<SyntheticEvent> events = synthesize();
+    std::vector<uint8_t> synthetic = encode(events);
+
+    // 第一遍：注入合成输入并记录
+    reset_loop();
+    input_recorder.start();
+    InputReplay source(synthetic.data(), synthetic.size());
+    bool ok = false;
+    std::vector<LoopOutput> recorded_outputs = run(source, true, ok);
+    input_recorder.stop();
+    if (!ok) {
+        fprintf(stderr, "synthetic input rejected after %u inputs\n", source.injected);
+        return 1;
+    }
+    if (input_recorder.dropped_events != 0 || usb_link.dropped_frames.load() != 0) {
+        fprintf(
+            stderr, "recorder dropped %u events, usb dropped %u frames\n", input_recorder.dropped_events,
+            usb_link.dropped_frames.load());
+        return 1;
+    }
+
+    std::vector<uint8_t> record;
+    if (!collect_record(record)) {
+        fprintf(stderr, "malformed INPUT_RECORD stream\n");
+        return 1;
+    }
+    if (record != synthetic) {
+        fprintf(stderr, "record differs from input: %zu vs %zu bytes\n", record.size(), synthetic.size());
+        return 1;
+    }
+
+    // 第二遍：回放记录
+    reset_loop();
+    InputReplay replay(record.data(), record.size());
+    auto start = std::chrono::steady_clock::now();
+    std::vector<LoopOutput> replayed_outputs = run(replay, false, ok);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!ok) {
+        fprintf(stderr, "replay stopped after %u inputs\n", replay.injected);
+        return 1;
+    }
+
+    if (replayed_outputs.size() != recorded_outputs.size() ||
+        std::memcmp(replayed_outputs.data(), recorded_outputs.data(), recorded_outputs.size() * sizeof(LoopOutput)) != 0) {
+        fprintf(stderr, "replayed outputs differ\n");
+        return 1;
+    }
+
+    double speedup = (DURATION_MS * 0.001) / elapsed;
+    printf(
+        "%zu inputs (%zu bytes) over %u ms, outputs identical, replay %.1f ms (%.0fx real time)\n", events.size(),
+        record.size(), DURATION_MS, elapsed * 1000.0, speedup);
+    if (speedup < REPLAY_SPEEDUP_MIN) {
+        fprintf(stderr, "replay slower than %.0fx real time\n", REPLAY_SPEEDUP_MIN);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,229 @@
+// 遥控输入整形回放仿真
+// 按操作手打杆习惯合成摇杆轨迹：每0.3-1.5s把左摇杆 (平移) 或右摇杆 (旋转) 推到新位置，
+// 推杆用时30-120ms，常有满杆和满杆反打；按DBus帧率 (14ms，±0.5ms抖动) 采样，量化为±660，
+// 中位附近带±3的噪声。两种设定值逐帧回放到同一条轮速环链路和底盘模型 (chassis_plant)：
+//   改动前：帧内保持摇杆线性映射的速度 (平移±2m/s，旋转±10rad/s)
+//   整形：shape_stick()和SetpointShaper为固件代码，帧间隔估计和参数与update_setpoint_targets()相同
+// 链路取两种：改动时的链路 (功率缩放，无设定值加速度限制和反算)，以及当前完整链路。
+// 检查:
+//   1. 改动时的链路上，整形后峰值功率、超出功率上限的能量 (消耗的缓冲能量) 和车体加加速度峰值都明显降低
+//   2. 当前完整链路上整形仍降低峰值功率和加加速度
+//   3. 摇杆中位噪声被死区滤掉：静止段没有设定值
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "chassis_plant.hpp"
+#include "input_shaping.hpp"
+
+// 与chassis_control.hpp、chassis_control_task.cpp相同
+constexpr float MAX_LINEAR_SPEED = 2.0f;
+constexpr float ROTATION_SPEED = 10.0f;
+constexpr float STICK_DEADBAND = 0.05f;
+constexpr float STICK_EXPO = 0.3f;
+constexpr float LINEAR_ACC_MAX = 4.0f;
+constexpr float LINEAR_JERK_MAX = 40.0f;
+constexpr float ROTATION_ACC_MAX = 30.0f;
+constexpr float ROTATION_JERK_MAX = 300.0f;
+constexpr uint32_t DBUS_FRAME_INTERVAL_MS = 14;
+constexpr uint32_t DBUS_FRAME_INTERVAL_MIN_MS = 7;
+constexpr uint32_t DBUS_FRAME_INTERVAL_MAX_MS = 30;
+
+// 轨迹和回放
+constexpr float POWER_LIMIT = 80.0f;
+constexpr double TRACE_TIME = 30.0;   // s
+constexpr int TRACES = 10;
+constexpr double FRAME_PERIOD = 0.014;
+constexpr double FRAME_JITTER = 0.0005;
+constexpr float STICK_RANGE = 660.0f;
+constexpr float STICK_NOISE = 3.0f;
+
+// 一帧遥控数据 (归一化到[-1, 1])
+struct Frame
+{
+    uint32_t stamp_ms;
+    float lv, lh, rv;
+};
+
+// 摇杆的一次动作：在start时刻起用move_time推到target
+struct Move
+{
+    double start;
+    double move_time;
+    int axis;  // 0: lv, 1: lh, 2: rv
+    float target;
+};
+
+static std::vector<Frame> record(int seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    std::normal_distribution<float> noise(0.0f, STICK_NOISE / 2.0f);
+    const float positions[] = {-1.0f, -1.0f, -0.5f, 0.0f, 0.0f, 0.3f, 0.5f, 1.0f, 1.0f};
+
+    std::vector<Move> moves;
+    for (double t = 0.5; t < TRACE_TIME - 2.0; t += 0.3 + 1.2 * u(rng)) {
+        int axis = (u(rng) < 0.6) ? 0 : ((u(rng) < 0.5) ? 1 : 2);
+        moves.push_back({t, 0.03 + 0.09 * u(rng), axis, positions[static_cast<int>(u(rng) * 9.0) % 9]});
+    }
+    // 最后两秒回中静止
+    for (int axis = 0; axis < 3; axis++) moves.push_back({TRACE_TIME - 2.0, 0.05, axis, 0.0f});
+
+    std::vector<Frame> frames;
+    float from[3] = {}, stick[3] = {};
+    std::vector<Move> active;
+    size_t next = 0;
+    for (double t = FRAME_PERIOD; t < TRACE_TIME; t += FRAME_PERIOD) {
+        double stamp = t + FRAME_JITTER * (2.0 * u(rng) - 1.0);
+        while (next < moves.size() && moves[next].start <= stamp) {
+            from[moves[next].axis] = stick[moves[next].axis];
+            active.push_back(moves[next++]);
+        }
+        for (auto it = active.begin(); it != active.end();) {
+            double x = std::min((stamp - it->start) / it->move_time, 1.0);
+            stick[it->axis] = from[it->axis] + (it->target - from[it->axis]) * static_cast<float>(x);
+            it = (x >= 1.0) ? active.erase(it) : it + 1;
+        }
+        float q[3];
+        for (int axis = 0; axis < 3; axis++) {
+            float counts = std::round(stick[axis] * STICK_RANGE + noise(rng));
+            q[axis] = std::max(-STICK_RANGE, std::min(counts, STICK_RANGE)) / STICK_RANGE;
+        }
+        frames.push_back({static_cast<uint32_t>(stamp * 1000.0), q[0], q[1], q[2]});
+    }
+    return frames;
+}
+
+enum class Input
+{
+    RAW,
+    SHAPED,
+};
+
+struct Result
+{
+    float peak_power = 0.0f;      // W
+    float over_energy = 0.0f;     // 超出功率上限的能量 J
+    float peak_jerk = 0.0f;       // 车体平移加加速度峰值 m/s^3
+    float idle_setpoint = 0.0f;   // 静止段设定值绝对值的最大值
+};
+
+static Result replay(const std::vector<Frame> & frames, Input input, const LoopConfig & config)
+{
+    SetpointShaper vx_shaper(LINEAR_ACC_MAX, LINEAR_JERK_MAX, PID_DT);
+    SetpointShaper vy_shaper(LINEAR_ACC_MAX, LINEAR_JERK_MAX, PID_DT);
+    SetpointShaper wz_shaper(ROTATION_ACC_MAX, ROTATION_JERK_MAX, PID_DT);
+    ChassisLoop loop(config);
+    ChassisPlant plant;
+    Result r;
+
+    uint32_t frame_interval_ms = DBUS_FRAME_INTERVAL_MS;
+    uint32_t last_stamp_ms = 0;
+    size_t next = 0;
+    float vx = 0.0f, vy = 0.0f, wz = 0.0f;
+    float last_ax = 0.0f, last_ay = 0.0f;
+    const uint32_t end_ms = static_cast<uint32_t>(TRACE_TIME * 1000.0);
+    for (uint32_t now_ms = 1; now_ms <= end_ms; now_ms++) {
+        // 帧在串口中断中到达，控制任务在下一个周期看到
+        while (next < frames.size() && frames[next].stamp_ms < now_ms) {
+            const Frame & f = frames[next++];
+            if (input == Input::RAW) {
+                vx = f.lv * MAX_LINEAR_SPEED;
+                vy = -f.lh * MAX_LINEAR_SPEED;
+                wz = f.rv * ROTATION_SPEED;
+                continue;
+            }
+            uint32_t interval = f.stamp_ms - last_stamp_ms;
+            if (interval >= DBUS_FRAME_INTERVAL_MIN_MS && interval <= DBUS_FRAME_INTERVAL_MAX_MS) {
+                frame_interval_ms = (frame_interval_ms * 7 + interval + 4) / 8;
+            }
+            last_stamp_ms = f.stamp_ms;
+            vx_shaper.set_target(shape_stick(f.lv, STICK_DEADBAND, STICK_EXPO) * MAX_LINEAR_SPEED, frame_interval_ms);
+            vy_shaper.set_target(-shape_stick(f.lh, STICK_DEADBAND, STICK_EXPO) * MAX_LINEAR_SPEED, frame_interval_ms);
+            wz_shaper.set_target(shape_stick(f.rv, STICK_DEADBAND, STICK_EXPO) * ROTATION_SPEED, frame_interval_ms);
+        }
+        if (input == Input::SHAPED) {
+            vx = vx_shaper.update();
+            vy = vy_shaper.update();
+            wz = wz_shaper.update();
+        }
+
+        loop.update(vx, vy, wz, plant.wheel);
+        plant.step(loop.torque, PID_DT);
+
+        r.peak_power = std::max(r.peak_power, plant.power);
+        r.over_energy += std::max(plant.power - POWER_LIMIT, 0.0f) * PID_DT;
+        float jerk = std::hypot(plant.accel[0] - last_ax, plant.accel[1] - last_ay) / PID_DT;
+        if (now_ms > 1) r.peak_jerk = std::max(r.peak_jerk, jerk);
+        last_ax = plant.accel[0];
+        last_ay = plant.accel[1];
+        if (now_ms > end_ms - 500) {
+            r.idle_setpoint = std::max({r.idle_setpoint, std::abs(vx), std::abs(vy), std::abs(wz)});
+        }
+    }
+    return r;
+}
+
+// 多条轨迹取峰值的最大值、超限能量的均值
+static Result replay_all(Input input, const LoopConfig & config)
+{
+    Result total;
+    for (int seed = 1; seed <= TRACES; seed++) {
+        Result r = replay(record(seed), input, config);
+        total.peak_power = std::max(total.peak_power, r.peak_power);
+        total.over_energy += r.over_energy / TRACES;
+        total.peak_jerk = std::max(total.peak_jerk, r.peak_jerk);
+        total.idle_setpoint = std::max(total.idle_setpoint, r.idle_setpoint);
+    }
+    return total;
+}
+
+static bool check(bool ok, const char * what)
+{
+    if (!ok) fprintf(stderr, "FAIL: %s\n", what);
+    return ok;
+}
+
+static void print(const char * name, const Result & r)
+{
+    printf(
+        "%-22s peak power %6.1f W  over limit %6.1f J/trace  peak jerk %7.0f m/s^3\n", name, r.peak_power,
+        r.over_energy, r.peak_jerk);
+}
+
+int main()
+{
+    bool ok = true;
+
+    // 1. 改动时的链路
+    LoopConfig then;
+    then.power_limit = POWER_LIMIT;
+    then.accel_limit = false;
+    then.kb = 0.0f;
+    Result then_raw = replay_all(Input::RAW, then);
+    Result then_shaped = replay_all(Input::SHAPED, then);
+    print("raw, power scaling", then_raw);
+    print("shaped, power scaling", then_shaped);
+    ok &= check(then_shaped.peak_power < 0.8f * then_raw.peak_power, "shaping cuts peak power");
+    ok &= check(then_shaped.over_energy < 0.5f * then_raw.over_energy, "shaping cuts energy drawn over the limit");
+    ok &= check(then_shaped.peak_jerk < 0.5f * then_raw.peak_jerk, "shaping cuts peak jerk");
+
+    // 2. 当前完整链路
+    LoopConfig now;
+    now.power_limit = POWER_LIMIT;
+    Result now_raw = replay_all(Input::RAW, now);
+    Result now_shaped = replay_all(Input::SHAPED, now);
+    print("raw, full chain", now_raw);
+    print("shaped, full chain", now_shaped);
+    ok &= check(now_shaped.peak_power < now_raw.peak_power, "shaping still cuts peak power with the accel limiter");
+    ok &= check(now_shaped.peak_jerk < now_raw.peak_jerk, "shaping still cuts peak jerk with the accel limiter");
+
+    // 3. 中位噪声
+    printf("idle setpoint raw %.4f shaped %.4f\n", then_raw.idle_setpoint, then_shaped.idle_setpoint);
+    ok &= check(then_shaped.idle_setpoint == 0.0f, "deadband removes stick noise at centre");
+
+    return ok ? 0 : 1;
+}
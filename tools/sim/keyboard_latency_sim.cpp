@@ -0,0 +1,214 @@
+// 键鼠控制延迟仿真
+// 按10us分辨率模拟键鼠指令从按下到CAN输出的整条链路：
+//   DBus接收机每14ms在帧开始时采样键鼠状态，18字节帧在100kbaud (8E2) 下传输约2.16ms，
+//   串口空闲中断中解析到remote；控制任务1ms周期，KeyboardControl为固件代码，
+//   之后的轮速环链路与chassis_move_control()相同 (chassis_plant)；CAN任务另以1ms周期发出0x200帧，
+//   帧在1Mbps总线上约130us，电调收到后力矩作用到底盘模型上。
+// 三个周期的相位和按键时刻每次随机，统计按键到第一帧有响应的CAN输出和到车体开始运动的延迟；
+// 松开的延迟与同样相位下一直按住的参照链路比较，取CAN输出第一次不同的时刻。
+// 不包括遥控器到接收机的无线链路和电调电流环。
+// 检查:
+//   1. W键按下/松开、鼠标横移/停止到CAN输出的延迟不超过一个DBus帧间隔 + 传输时间 + 两个1ms周期 + CAN帧，
+//      即链路中没有多出来的整帧或整周期的排队
+//   2. 车体开始运动的时刻随相位的变化不超过同一上限：起步本身 (加速度斜坡和轮速环跟踪) 是确定的
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+
+#include "chassis_plant.hpp"
+#include "keyboard_control.hpp"
+
+// 与chassis_control.hpp、chassis_control_task.cpp相同
+constexpr float MAX_LINEAR_SPEED = 2.0f;
+constexpr float ROTATION_SPEED = 10.0f;
+constexpr KeyMotionProfile KEY_PROFILE_NORMAL = {0.75f, 3.0f, 6.0f};
+constexpr KeyMotionProfile KEY_PROFILE_BOOST = {1.25f, 5.0f, 8.0f};
+constexpr KeyMotionProfile KEY_PROFILE_SLOW = {0.25f, 2.0f, 6.0f};
+constexpr float MOUSE_YAW_GAIN = 0.02f;
+
+// 链路时序 us
+constexpr uint32_t TICK_US = 10;
+constexpr uint32_t PLANT_STEP_US = 100;
+constexpr uint32_t DBUS_PERIOD_US = 14000;
+constexpr uint32_t DBUS_TRANSFER_US = 2160;
+constexpr uint32_t CONTROL_PERIOD_US = 1000;
+constexpr uint32_t CAN_FRAME_US = 130;
+constexpr uint32_t PRESS_US = 300000;    // 按下时刻的基准
+constexpr uint32_t HOLD_US = 1000000;    // 按住时长
+constexpr uint32_t END_US = PRESS_US + HOLD_US + 300000;
+constexpr uint32_t LATENCY_BOUND_US = DBUS_PERIOD_US + DBUS_TRANSFER_US + 2 * CONTROL_PERIOD_US + CAN_FRAME_US;
+constexpr int TRIALS = 200;
+
+constexpr float RESPONSE_TORQUE = 0.01f;  // 判定CAN输出有响应的力矩变化 N·m
+constexpr float MOTION_SPEED = 0.1f;      // 判定开始运动的车速 m/s
+constexpr float MOTION_RATE = 0.5f;       // 判定开始转动的角速度 rad/s
+constexpr int16_t MOUSE_SPEED = -200;     // 鼠标左移，对应逆时针4rad/s
+
+enum class Input
+{
+    KEY_W,
+    MOUSE,
+};
+
+struct Latency
+{
+    uint32_t press_to_can = 0;    // 按下到第一帧有响应的CAN输出 us
+    uint32_t press_to_motion = 0; // 按下到车体开始运动 us
+    uint32_t release_to_can = 0;  // 松开到第一帧受松开影响的CAN输出 us
+};
+
+// 接收机、控制任务、CAN任务和车体，三个周期各自的相位
+class Pipeline
+{
+public:
+    Pipeline(Input input, uint32_t frame_phase, uint32_t control_phase, uint32_t can_phase)
+    : input_(input),
+      frame_phase_(frame_phase),
+      control_phase_(control_phase),
+      can_phase_(can_phase),
+      keyboard_(KEY_PROFILE_NORMAL, KEY_PROFILE_BOOST, KEY_PROFILE_SLOW, MOUSE_YAW_GAIN, PID_DT),
+      loop_(LoopConfig{})
+    {
+        remote_.sw_r = sp::DBusSwitchMode::UP;
+        sampled_ = remote_;
+    }
+
+    // 推进一个TICK_US，held为操作手是否按住；返回本刻是否有CAN帧到达电调
+    bool tick(uint32_t t, bool held)
+    {
+        if (due(t, frame_phase_, DBUS_PERIOD_US)) {
+            sampled_.keys.w = (input_ == Input::KEY_W) && held;
+            sampled_.mouse.vx = (input_ == Input::MOUSE && held) ? MOUSE_SPEED : 0;
+        }
+        if (due(t, frame_phase_ + DBUS_TRANSFER_US, DBUS_PERIOD_US)) remote_ = sampled_;
+        if (due(t, control_phase_, CONTROL_PERIOD_US)) {
+            keyboard_.update(remote_, MAX_LINEAR_SPEED, ROTATION_SPEED);
+            loop_.update(keyboard_.vx, keyboard_.vy, keyboard_.wz, plant.wheel);
+            std::copy(loop_.torque, loop_.torque + 4, command_);
+        }
+        if (due(t, can_phase_, CONTROL_PERIOD_US)) std::copy(command_, command_ + 4, can_frame_);
+        bool received = due(t, can_phase_ + CAN_FRAME_US, CONTROL_PERIOD_US);
+        if (received) std::copy(can_frame_, can_frame_ + 4, applied);
+        if (t % PLANT_STEP_US == 0) plant.step(applied, PLANT_STEP_US * 1e-6f);
+        return received;
+    }
+
+    float applied[4] = {};  // 电调收到的力矩
+    ChassisPlant plant;
+
+private:
+    static bool due(uint32_t t, uint32_t phase, uint32_t period) { return t >= phase && (t - phase) % period == 0; }
+
+    const Input input_;
+    const uint32_t frame_phase_;
+    const uint32_t control_phase_;
+    const uint32_t can_phase_;
+    sp::DBus remote_;   // 串口中断解析完成的帧
+    sp::DBus sampled_;  // 接收机在帧开始时采样、正在传输的帧
+    KeyboardControl keyboard_;
+    ChassisLoop loop_;
+    float command_[4] = {};    // 控制任务写入电机对象的力矩
+    float can_frame_[4] = {};  // 正在总线上传输的0x200帧
+};
+
+// 同样相位下一直按住的参照链路与实际链路逐帧比较，CAN输出第一次不同即为松开的响应
+static Latency run(Input input, std::mt19937 & rng)
+{
+    std::uniform_int_distribution<uint32_t> phase(0, 99);
+    const uint32_t frame_phase = phase(rng) * (DBUS_PERIOD_US / 100) / TICK_US * TICK_US;
+    const uint32_t control_phase = phase(rng) * TICK_US;
+    const uint32_t can_phase = phase(rng) * TICK_US;
+    const uint32_t press = PRESS_US + phase(rng) * (DBUS_PERIOD_US / 100) / TICK_US * TICK_US;
+    const uint32_t release = press + HOLD_US;
+
+    Pipeline actual(input, frame_phase, control_phase, can_phase);
+    Pipeline held(input, frame_phase, control_phase, can_phase);
+    Latency r;
+    for (uint32_t t = 0; t < END_US; t += TICK_US) {
+        bool received = actual.tick(t, t >= press && t < release);
+        held.tick(t, t >= press);
+        if (received && t >= press) {
+            // 按下前各轮力矩为0
+            float response = 0.0f, diverged = 0.0f;
+            for (int i = 0; i < 4; i++) {
+                response = std::max(response, std::abs(actual.applied[i]));
+                diverged = std::max(diverged, std::abs(actual.applied[i] - held.applied[i]));
+            }
+            if (r.press_to_can == 0 && response > RESPONSE_TORQUE) r.press_to_can = t - press;
+            if (t >= release && r.release_to_can == 0 && diverged > RESPONSE_TORQUE) r.release_to_can = t - release;
+        }
+        bool moving = (input == Input::KEY_W) ? actual.plant.v[0] >= MOTION_SPEED : actual.plant.v[2] >= MOTION_RATE;
+        if (t >= press && r.press_to_motion == 0 && moving) r.press_to_motion = t - press;
+    }
+    return r;
+}
+
+struct Stats
+{
+    double sum = 0.0;
+    uint32_t max = 0;
+    uint32_t min = UINT32_MAX;
+    int count = 0;
+
+    void add(uint32_t us)
+    {
+        sum += us;
+        max = std::max(max, us);
+        min = std::min(min, us);
+        count++;
+    }
+    double mean_ms() const { return sum / count / 1000.0; }
+};
+
+static bool check(bool ok, const char * what)
+{
+    if (!ok) fprintf(stderr, "FAIL: %s\n", what);
+    return ok;
+}
+
+static void print(const char * name, const Stats & s)
+{
+    printf("%-22s min %5.2f  mean %5.2f  max %5.2f ms\n", name, s.min / 1000.0, s.mean_ms(), s.max / 1000.0);
+}
+
+int main()
+{
+    bool ok = true;
+    std::mt19937 rng(27);
+
+    Stats key_can, key_motion, release_can, mouse_can, mouse_motion, mouse_release;
+    for (int i = 0; i < TRIALS; i++) {
+        Latency w = run(Input::KEY_W, rng);
+        Latency m = run(Input::MOUSE, rng);
+        ok &= check(
+            w.press_to_can && w.press_to_motion && w.release_to_can && m.press_to_can && m.press_to_motion &&
+                m.release_to_can,
+            "every trial responds");
+        key_can.add(w.press_to_can);
+        key_motion.add(w.press_to_motion);
+        release_can.add(w.release_to_can);
+        mouse_can.add(m.press_to_can);
+        mouse_motion.add(m.press_to_motion);
+        mouse_release.add(m.release_to_can);
+    }
+    print("W down -> CAN", key_can);
+    print("W up -> CAN", release_can);
+    print("mouse -> CAN", mouse_can);
+    print("mouse stop -> CAN", mouse_release);
+    print("W down -> 0.1 m/s", key_motion);
+    print("mouse -> 0.5 rad/s", mouse_motion);
+    printf("bound (frame + transfer + 2 cycles + CAN frame) %.2f ms\n", LATENCY_BOUND_US / 1000.0);
+
+    ok &= check(key_can.max <= LATENCY_BOUND_US, "key press reaches CAN within one frame and two cycles");
+    ok &= check(release_can.max <= LATENCY_BOUND_US, "key release reaches CAN within one frame and two cycles");
+    ok &= check(mouse_can.max <= LATENCY_BOUND_US, "mouse reaches CAN within one frame and two cycles");
+    ok &= check(mouse_release.max <= LATENCY_BOUND_US, "mouse stop reaches CAN within one frame and two cycles");
+    // 起步时间 (键盘加速度斜坡和轮速环跟踪) 是确定的，随相位变化的只有链路延迟
+    ok &= check(
+        key_motion.max - key_motion.min <= LATENCY_BOUND_US && mouse_motion.max - mouse_motion.min <= LATENCY_BOUND_US,
+        "motion onset varies only by the link latency");
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,226 @@
+// 电机热模型与力矩降额仿真
+// 单个M3508在7分钟比赛中的工况：推挤 (轮速设定30rad/s、车轮被顶住不转，轮速环饱和) 与巡航
+// (轮速设定15-30rad/s，负载力矩0.5-2N·m) 交替。力矩由轮速环WheelPid给出，输出限幅和降额点与
+// chassis_control_task.cpp相同：PID与前馈 (默认为0) 之和限幅在 min(pid_mo, MAX_SAFE_TORQUE)·derate，
+// 实际执行的力矩反算回积分项。pid_mo取两种：默认PID_MO，以及推挤时常用的调高值PUSH_PID_MO。
+// 电机模型与固件模型有意不同：绕组电阻高10%、热阻高15%、热时间常数250s、环境温度35°C；
+// 电调温度传感器相对绕组滞后25s，按1°C量化上报，读数达到125°C过温保护停止输出，降到100°C恢复。
+// MotorThermal为固件代码；对照不降额，限幅恒为min(pid_mo, MAX_SAFE_TORQUE)。
+// 检查:
+//   1. 默认pid_mo：推挤时轮速环饱和在2.5N·m，到不了降额区间，降额与否结果相同
+//   2. 调高pid_mo冷启动：不降额时触发过温保护，降额后不触发，送达的力矩冲量比例更高；
+//      力矩上限逐周期的变化不超过温度反馈1°C量化造成的台阶
+//   3. 调高pid_mo热启动 (上一场结束时75°C)：降额以第一帧温度反馈为初值，同样不触发过温保护
+//   4. 传感器卡在40°C：判定不一致，按开环模型保守降额，真实绕组温度不超过过温保护阈值
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "motor_thermal.hpp"
+#include "wheel_pid.hpp"
+
+// 与chassis_control.hpp、chassis_control_task.cpp相同
+constexpr float PID_DT = 0.001f;
+constexpr float PID_KP = 0.5f;
+constexpr float PID_KI = 0.05f;
+constexpr float PID_KD = 0.01f;
+constexpr float PID_MO = 2.5f;
+constexpr float PID_MIO = 1.0f;
+constexpr float PID_ALPHA = 0.0f;
+constexpr float PID_KB = 20.0f;
+constexpr float MAX_SAFE_TORQUE = 8.0f;
+constexpr float PUSH_PID_MO = 5.0f;  // 推挤对抗时调高的轮速环限幅 N·m (在线参数pid_mo)
+// smoothstep最大斜率 (1.5·0.7/30 每°C) 下温度反馈跳1°C时PUSH_PID_MO的变化 N·m
+constexpr float DERATE_STEP_MAX = PUSH_PID_MO * 1.5f * 0.7f / 30.0f * 1.05f;
+
+// 电机模型，与固件中的THERMAL_*常数对应
+constexpr double KT = 0.3;                     // N·m/A
+constexpr double R20 = 0.29 * 1.1;             // Ω
+constexpr double ALPHA_CU = 0.00393;           // 1/K
+constexpr double RTH = 2.0 * 1.15;             // K/W
+constexpr double TAU = 250.0;                  // s
+constexpr double CAPACITY = TAU / RTH;         // J/K
+constexpr double AMBIENT = 35.0;               // °C
+constexpr double SENSOR_TAU = 25.0;            // s
+constexpr double TRIP_TEMP = 125.0;            // 电调过温保护 °C
+constexpr double RECOVER_TEMP = 100.0;         // 过温保护恢复 °C
+
+// 单轮模型，折算到轮轴 (转子惯量加四分之一车重)
+constexpr double WHEEL_INERTIA = 0.05;         // kg·m^2
+constexpr double WHEEL_VISCOUS = 0.02;         // N·m/(rad/s)
+constexpr float PUSH_SPEED_SET = 30.0f;        // 推挤时的轮速设定 rad/s
+constexpr double MATCH_TIME = 420.0;           // s
+constexpr int MATCHES = 20;
+
+struct Phase
+{
+    double end;
+    bool pushing;
+    float speed_set;  // 巡航轮速设定 rad/s
+    double load;      // 巡航负载力矩 N·m
+};
+
+enum class Sensor
+{
+    HEALTHY,
+    STUCK,  // 上报值卡在40°C
+};
+
+struct Result
+{
+    double peak_winding = 0.0;  // 真实绕组温度峰值 °C
+    double delivered = 0.0;     // 送达的力矩冲量占需求 (未降额、未过温时的输出) 的比例
+    float min_derate = 1.0f;
+    float max_limit_step = 0.0f;  // 力矩上限逐周期变化的最大值 N·m
+    int trips = 0;
+    int mismatches = 0;         // 判定过不一致的场数
+};
+
+static std::vector<Phase> script(std::mt19937 & rng)
+{
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    std::vector<Phase> phases;
+    double t = 0.0;
+    while (t < MATCH_TIME) {
+        t += 4.0 + 6.0 * u(rng);
+        phases.push_back({t, true, PUSH_SPEED_SET, 0.0});
+        t += 6.0 + 12.0 * u(rng);
+        phases.push_back({t, false, static_cast<float>(15.0 + 15.0 * u(rng)), 0.5 + 1.5 * u(rng)});
+    }
+    return phases;
+}
+
+static Result run(int seed, float pid_mo, bool derate, double start_temp, Sensor sensor_mode)
+{
+    std::mt19937 rng(seed);
+    std::vector<Phase> phases = script(rng);
+
+    WheelPid pid(PID_DT, PID_KP, PID_KI, PID_KD, pid_mo, PID_MIO, PID_ALPHA, PID_KB);
+    MotorThermal thermal(PID_DT);
+    Result r;
+    double speed = 0.0;
+    double winding = start_temp;
+    double sensor = start_temp;
+    bool tripped = false;
+    float last_limit = std::min(pid_mo, MAX_SAFE_TORQUE);
+    double requested = 0.0, delivered = 0.0;
+    size_t phase = 0;
+    const long steps = static_cast<long>(MATCH_TIME / PID_DT);
+    for (long i = 0; i < steps; i++) {
+        double t = i * PID_DT;
+        while (phase + 1 < phases.size() && phases[phase].end <= t) phase++;
+        const Phase & p = phases[phase];
+
+        uint8_t reported = (sensor_mode == Sensor::STUCK) ? 40 : static_cast<uint8_t>(std::lround(sensor));
+        if (reported >= TRIP_TEMP && !tripped) {
+            tripped = true;
+            r.trips++;
+        }
+        if (reported <= RECOVER_TEMP) tripped = false;
+
+        // 与apply_power_limit()相同的限幅和反算
+        float limit = std::min(pid_mo, MAX_SAFE_TORQUE) * (derate ? thermal.derate : 1.0f);
+        pid.calc(p.speed_set, static_cast<float>(speed));
+        float command = std::max(-limit, std::min(pid.out, limit));
+        pid.back_calculate(command);
+        double torque = tripped ? 0.0 : command;
+        thermal.update(static_cast<float>(torque), reported);
+        requested += std::abs(pid.out) * PID_DT;
+        delivered += std::abs(torque) * PID_DT;
+        r.max_limit_step = std::max(r.max_limit_step, std::abs(limit - last_limit));
+        r.min_derate = std::min(r.min_derate, thermal.derate);
+        last_limit = limit;
+
+        // 推挤时车轮被顶住；巡航时负载力矩与转向相反
+        if (p.pushing) {
+            speed = 0.0;
+        }
+        else {
+            double load = (speed > 0.0) ? p.load : 0.0;
+            speed += (torque - WHEEL_VISCOUS * speed - load) / WHEEL_INERTIA * PID_DT;
+        }
+
+        double current = torque / KT;
+        double heat = current * current * R20 * (1.0 + ALPHA_CU * (winding - 20.0));
+        winding += (heat - (winding - AMBIENT) / RTH) * (PID_DT / CAPACITY);
+        sensor += (winding - sensor) * (PID_DT / SENSOR_TAU);
+        r.peak_winding = std::max(r.peak_winding, winding);
+        if (thermal.mismatch) r.mismatches = 1;
+    }
+    r.delivered = delivered / requested;
+    return r;
+}
+
+// 多场取峰值温度最大值、最低降额系数、最大上限变化，送达比例取均值，触发次数和不一致场数求和
+static Result matches(float pid_mo, bool derate, double start_temp, Sensor sensor_mode)
+{
+    Result total;
+    for (int seed = 1; seed <= MATCHES; seed++) {
+        Result r = run(seed, pid_mo, derate, start_temp, sensor_mode);
+        total.peak_winding = std::max(total.peak_winding, r.peak_winding);
+        total.min_derate = std::min(total.min_derate, r.min_derate);
+        total.max_limit_step = std::max(total.max_limit_step, r.max_limit_step);
+        total.delivered += r.delivered / MATCHES;
+        total.trips += r.trips;
+        total.mismatches += r.mismatches;
+    }
+    return total;
+}
+
+static bool check(bool ok, const char * what)
+{
+    if (!ok) fprintf(stderr, "FAIL: %s\n", what);
+    return ok;
+}
+
+static void print(const char * name, const Result & r)
+{
+    printf(
+        "%-32s peak winding %5.1f C  trips %2d  delivered %4.1f%%  min derate %.2f  mismatch %d/%d\n", name,
+        r.peak_winding, r.trips, 100.0 * r.delivered, r.min_derate, r.mismatches, MATCHES);
+}
+
+int main()
+{
+    bool ok = true;
+
+    // 1. 默认pid_mo
+    Result default_off = matches(PID_MO, false, AMBIENT, Sensor::HEALTHY);
+    Result default_on = matches(PID_MO, true, AMBIENT, Sensor::HEALTHY);
+    print("pid_mo 2.5, no derate", default_off);
+    print("pid_mo 2.5, derate", default_on);
+    ok &= check(default_off.trips == 0 && default_on.trips == 0, "default output limit never reaches the trip");
+    ok &= check(default_on.delivered == default_off.delivered, "default output limit is not derated");
+
+    // 2. 调高pid_mo，冷启动
+    Result cold_off = matches(PUSH_PID_MO, false, AMBIENT, Sensor::HEALTHY);
+    Result cold_on = matches(PUSH_PID_MO, true, AMBIENT, Sensor::HEALTHY);
+    print("pid_mo 5.0, no derate", cold_off);
+    print("pid_mo 5.0, derate", cold_on);
+    printf("pid_mo 5.0 derate: largest per-cycle change of the torque limit %.4f N·m\n", cold_on.max_limit_step);
+    ok &= check(cold_off.trips > 0, "raised output limit trips the ESC without derating");
+    ok &= check(cold_on.trips == 0, "derating avoids the ESC over-temperature trip");
+    ok &= check(cold_on.delivered > cold_off.delivered, "derating delivers more torque than tripping");
+    ok &= check(cold_on.min_derate < 0.9f, "derating reduces the output limit that is actually in effect");
+    ok &= check(cold_on.max_limit_step < DERATE_STEP_MAX, "torque limit falls smoothly");
+    ok &= check(cold_on.mismatches == 0, "healthy sensor is not flagged");
+
+    // 3. 调高pid_mo，热启动
+    Result warm_off = matches(PUSH_PID_MO, false, 75.0, Sensor::HEALTHY);
+    Result warm_on = matches(PUSH_PID_MO, true, 75.0, Sensor::HEALTHY);
+    print("pid_mo 5.0 warm 75 C, no derate", warm_off);
+    print("pid_mo 5.0 warm 75 C, derate", warm_on);
+    ok &= check(warm_on.trips == 0, "warm start does not trip with derating");
+    ok &= check(warm_on.delivered > warm_off.delivered, "warm start delivers more torque with derating");
+
+    // 4. 传感器卡死
+    Result stuck = matches(PUSH_PID_MO, true, AMBIENT, Sensor::STUCK);
+    print("pid_mo 5.0 sensor stuck 40 C", stuck);
+    ok &= check(stuck.mismatches == MATCHES, "stuck sensor is flagged");
+    ok &= check(stuck.peak_winding < TRIP_TEMP, "open-loop model keeps the winding below the trip temperature");
+
+    return ok ? 0 : 1;
+}
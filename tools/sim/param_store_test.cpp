@@ -0,0 +1,382 @@
+// 参数存储掉电测试
+// 固件的param_store.cpp跑在内存中的flash替身上：两个扇区映射到与芯片相同的地址，
+// 编程只能把1写成0，擦除把整个扇区置1；HAL_CRC_Calculate为与STM32 CRC外设相同的CRC-32。
+// 掉电注入：第n次擦写操作进行到一半时断电——编程的字只清掉一部分位，擦除只擦掉一部分字，
+// 之后的操作全部失败；再用新的ParamStore上电载入，与上电时init()、load()的调用相同。
+// 检查:
+//   1. 旧版本格式 (没有快照) 的扇区照常载入，保存新增的key时换成带快照的格式，已存的值不变
+//   2. 载入不为从未保存过的key扫描日志：新增参数后上电读取的记录数与新增前相同；
+//      只调几个增益时，其余参数直接读快照，扫描只回溯到最近改过的增益
+//   3. 随机调参保存 (含压缩和新增key)，压缩中逐个位置断电，其余保存随机位置断电：
+//      上电后每个保存过的key都能读出，值为这次保存前或保存后的值；之后重新保存成功；
+//      flash编程只把1写成0 (追加标记字按位清零，其余都写在已擦除的字上)
+// 另外给出上电载入做的crc校验次数 (每条记录一次) 和主机上的耗时
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "crc.h"
+#include "param_store.hpp"
+
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE 0x100000
+#endif
+
+// 与param_store.cpp相同
+constexpr uint32_t HEADER_MAGIC = 0x314D5250;
+constexpr uint32_t RECORD_TAG = 0xA55A0000;
+constexpr uint32_t HEADER_SIZE = 12;
+constexpr uint32_t RECORD_SIZE = 12;
+constexpr uint32_t RECORD_CAPACITY = (PARAM_STORE_SECTOR_SIZE - HEADER_SIZE) / RECORD_SIZE;
+
+constexpr uint32_t FLASH_ADDR = PARAM_STORE_SECTOR_A_ADDR;
+constexpr uint32_t FLASH_SIZE = 2 * PARAM_STORE_SECTOR_SIZE;
+constexpr size_t KEYS_BEFORE = 15;        // 加入cap_energy_scale、field_phase_lead之前的参数个数
+constexpr size_t KEYS_AFTER = 17;
+constexpr uint32_t LEGACY_RECORDS = 8000; // 旧格式扇区中的日志长度
+constexpr uint32_t TUNING_SAVES = 2000;
+constexpr size_t TUNED_KEYS = 5;          // 调参时改动的增益个数
+constexpr int SCRIPT_SAVES = 16000;
+constexpr int SAVES_PER_NEW_KEY = 4000;
+constexpr int RANDOM_CUT_EVERY = 4;       // 不压缩的保存每几次注入一次断电
+
+// ---------------------------------------------------------------- flash和CRC外设替身
+
+CRC_HandleTypeDef hcrc;
+
+static uint8_t * flash = nullptr;
+static bool unlocked = false;
+static bool powered = true;
+static uint64_t flash_ops = 0;              // 擦写操作计数
+static uint64_t power_cut_at = UINT64_MAX;  // 在这一次操作中断电
+static uint32_t misuse = 0;                 // 锁定时擦写、越界、编程需要把0写成1
+static uint32_t crc_calls = 0;
+static uint32_t crc_table[256];
+static std::mt19937 rng(35);
+
+static bool flash_map()
+{
+    void * p = mmap(
+        reinterpret_cast<void *>(static_cast<uintptr_t>(FLASH_ADDR)), FLASH_SIZE, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if (p != reinterpret_cast<void *>(static_cast<uintptr_t>(FLASH_ADDR))) return false;
+    flash = static_cast<uint8_t *>(p);
+    std::memset(flash, 0xFF, FLASH_SIZE);
+
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i << 24;
+        for (int bit = 0; bit < 8; bit++) crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : crc << 1;
+        crc_table[i] = crc;
+    }
+    return true;
+}
+
+static uint32_t flash_word(uint32_t addr)
+{
+    uint32_t word;
+    std::memcpy(&word, flash + (addr - FLASH_ADDR), 4);
+    return word;
+}
+
+static void flash_set(uint32_t addr, uint32_t word) { std::memcpy(flash + (addr - FLASH_ADDR), &word, 4); }
+
+// 本次操作是否断电，断电后的操作都不执行
+static bool power_cut_now()
+{
+    if (flash_ops++ != power_cut_at) return false;
+    powered = false;
+    return true;
+}
+
+// 与STM32 CRC外设相同：多项式0x04C11DB7，初值全1，按字高位在前，不反转
+extern "C" uint32_t HAL_CRC_Calculate(CRC_HandleTypeDef *, uint32_t pBuffer[], uint32_t BufferLength)
+{
+    crc_calls++;
+    uint32_t crc = 0xFFFFFFFF;
+    for (uint32_t i = 0; i < BufferLength; i++) {
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            crc = (crc << 8) ^ crc_table[((crc >> 24) ^ (pBuffer[i] >> shift)) & 0xFF];
+        }
+    }
+    return crc;
+}
+
+extern "C" HAL_StatusTypeDef HAL_FLASH_Unlock(void)
+{
+    unlocked = true;
+    return HAL_OK;
+}
+
+extern "C" HAL_StatusTypeDef HAL_FLASH_Lock(void)
+{
+    unlocked = false;
+    return HAL_OK;
+}
+
+extern "C" HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data)
+{
+    if (!powered) return HAL_ERROR;
+    if (!unlocked || TypeProgram != FLASH_TYPEPROGRAM_WORD || Address < FLASH_ADDR ||
+        Address + 4 > FLASH_ADDR + FLASH_SIZE || Address % 4 != 0) {
+        misuse++;
+        return HAL_ERROR;
+    }
+    uint32_t word = flash_word(Address);
+    uint32_t data = static_cast<uint32_t>(Data);
+    if (data & ~word) misuse++;
+    if (power_cut_now()) {
+        // 只清掉了一部分位
+        flash_set(Address, word & (data | rng()));
+        return HAL_ERROR;
+    }
+    flash_set(Address, word & data);
+    return HAL_OK;
+}
+
+extern "C" HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef * pEraseInit, uint32_t * SectorError)
+{
+    if (!powered) return HAL_ERROR;
+    uint32_t sector_addr = (pEraseInit->Sector == FLASH_SECTOR_10) ? PARAM_STORE_SECTOR_A_ADDR : PARAM_STORE_SECTOR_B_ADDR;
+    if (!unlocked || pEraseInit->NbSectors != 1 ||
+        (pEraseInit->Sector != FLASH_SECTOR_10 && pEraseInit->Sector != FLASH_SECTOR_11)) {
+        misuse++;
+        return HAL_ERROR;
+    }
+    // 擦到一半断电：一部分字已擦除，其余保持原样
+    bool cut = power_cut_now();
+    for (uint32_t offset = 0; offset < PARAM_STORE_SECTOR_SIZE; offset += 4) {
+        if (!cut || (rng() & 1)) flash_set(sector_addr + offset, 0xFFFFFFFF);
+    }
+    *SectorError = cut ? pEraseInit->Sector : 0xFFFFFFFF;
+    return cut ? HAL_ERROR : HAL_OK;
+}
+
+// ---------------------------------------------------------------- 测试
+
+static bool check(bool ok, const char * what)
+{
+    if (!ok) fprintf(stderr, "FAIL: %s\n", what);
+    return ok;
+}
+
+struct Boot
+{
+    uint32_t found = 0;
+    uint32_t crc_checks = 0;  // 包括两个扇区头
+    uint32_t used = 0;        // 有效扇区中的记录数，旧的载入在有key从未保存时全部读一遍
+    double us = 0.0;
+};
+
+// 与load_stored_params()相同：上电后init()，再load()当前参数表
+static Boot boot(uint32_t * values, size_t count)
+{
+    Boot b;
+    crc_calls = 0;
+    auto start = std::chrono::steady_clock::now();
+    ParamStore store;
+    store.init();
+    b.found = store.load(values, count);
+    b.us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    b.crc_checks = crc_calls;
+    b.used = store.used_records();
+    return b;
+}
+
+static void print(const char * name, const Boot & b)
+{
+    printf("%-46s %5u records, %5u crc checks, %7.1f us on host\n", name, b.used, b.crc_checks, b.us);
+}
+
+static bool save(const std::vector<uint32_t> & values, size_t count)
+{
+    ParamStore store;
+    store.init();
+    return store.save(values.data(), count);
+}
+
+static uint32_t key_mask(size_t count) { return (count == 32) ? 0xFFFFFFFF : ((1u << count) - 1); }
+
+static bool matches(const uint32_t * values, uint32_t found, const std::vector<uint32_t> & expected, size_t count)
+{
+    if (found != key_mask(count)) return false;
+    return std::equal(values, values + count, expected.begin());
+}
+
+// 旧版本写入的扇区：扇区头之后直接是日志
+static void write_legacy_sector(uint32_t records, std::vector<uint32_t> & latest, size_t count)
+{
+    std::memset(flash, 0xFF, FLASH_SIZE);
+    auto crc32 = [](uint32_t a, uint32_t b) {
+        uint32_t words[2] = {a, b};
+        return HAL_CRC_Calculate(&hcrc, words, 2);
+    };
+    for (uint32_t index = 0; index < records; index++) {
+        uint16_t key = static_cast<uint16_t>((index < count) ? index : rng() % count);
+        uint32_t value = rng();
+        uint32_t addr = PARAM_STORE_SECTOR_A_ADDR + HEADER_SIZE + index * RECORD_SIZE;
+        flash_set(addr, RECORD_TAG | key);
+        flash_set(addr + 4, value);
+        flash_set(addr + 8, crc32(RECORD_TAG | key, value));
+        latest[key] = value;
+    }
+    flash_set(PARAM_STORE_SECTOR_A_ADDR, HEADER_MAGIC);
+    flash_set(PARAM_STORE_SECTOR_A_ADDR + 4, 1);
+    flash_set(PARAM_STORE_SECTOR_A_ADDR + 8, crc32(HEADER_MAGIC, 1));
+}
+
+// 1. 旧格式扇区的载入和转换
+static bool legacy_sector()
+{
+    bool ok = true;
+    std::vector<uint32_t> expected(KEYS_AFTER);
+    uint32_t values[PARAM_STORE_MAX_KEYS];
+    write_legacy_sector(LEGACY_RECORDS, expected, KEYS_BEFORE);
+
+    Boot before = boot(values, KEYS_AFTER);
+    print("old format, 2 keys never saved", before);
+    ok &= check(before.found == key_mask(KEYS_BEFORE), "old format sector loads every saved key");
+    ok &= check(std::equal(values, values + KEYS_BEFORE, expected.begin()), "old format sector loads the latest values");
+
+    // 固件保存整张参数表，新增的两个key第一次写入
+    expected[15] = 255;
+    expected[16] = 0x3CF5C28F;
+    ok &= check(save(expected, KEYS_AFTER), "saving new keys converts the sector");
+    Boot after = boot(values, KEYS_AFTER);
+    print("after conversion", after);
+    ok &= check(matches(values, after.found, expected, KEYS_AFTER), "conversion keeps every value");
+    ok &= check(after.crc_checks <= 3 + KEYS_AFTER, "converted sector loads from the snapshot");
+    return ok;
+}
+
+// 2. 从未保存过的key不引起扫描
+static bool unsaved_keys()
+{
+    bool ok = true;
+    std::memset(flash, 0xFF, FLASH_SIZE);
+    std::vector<uint32_t> current(KEYS_AFTER);
+    for (uint32_t & v : current) v = rng();
+    ok &= check(save(current, KEYS_BEFORE), "first save");
+    // 调参：每次保存改一两个增益
+    for (uint32_t i = 0; i < TUNING_SAVES; i++) {
+        current[rng() % TUNED_KEYS] = rng();
+        if (i % 3 == 0) current[rng() % TUNED_KEYS] = rng();
+        ok &= save(current, KEYS_BEFORE);
+    }
+    check(ok, "tuning saves");
+
+    uint32_t values[PARAM_STORE_MAX_KEYS];
+    Boot old_table = boot(values, KEYS_BEFORE);
+    ok &= check(matches(values, old_table.found, current, KEYS_BEFORE), "tuned values load");
+    Boot new_table = boot(values, KEYS_AFTER);
+    print("tuned, parameter table before new keys", old_table);
+    print("tuned, 2 keys never saved", new_table);
+    ok &= check(matches(values, new_table.found, current, KEYS_BEFORE), "never saved keys are reported missing");
+    ok &= check(new_table.crc_checks == old_table.crc_checks, "never saved keys do not extend the scan");
+    ok &= check(new_table.crc_checks < new_table.used / 10, "load stops well before the start of the log");
+
+    // 最坏情况：之后只改一个增益直到扇区写满，其余增益最后一次保存在日志开头附近
+    while (save(current, KEYS_BEFORE)) {
+        ParamStore store;
+        store.init();
+        if (store.used_records() >= RECORD_CAPACITY - 1) break;
+        current[0] = rng();
+    }
+    Boot full = boot(values, KEYS_AFTER);
+    print("worst case: full sector, 4 gains saved early", full);
+    ok &= check(matches(values, full.found, current, KEYS_BEFORE), "full sector loads");
+    ok &= check(full.crc_checks <= full.used + 3, "worst case reads each record at most once");
+    return ok;
+}
+
+// 3. 掉电注入
+static bool power_loss()
+{
+    bool ok = true;
+    std::memset(flash, 0xFF, FLASH_SIZE);
+    std::vector<uint8_t> before(FLASH_SIZE), after(FLASH_SIZE);
+    std::vector<uint32_t> current(KEYS_AFTER), saved(KEYS_AFTER);
+    for (uint32_t & v : current) v = rng();
+    uint32_t saved_mask = 0;
+    uint32_t cuts = 0, compaction_cuts = 0, compactions = 0;
+    uint32_t lost = 0, corrupted = 0, unrecovered = 0;
+
+    for (int s = 0; s < SCRIPT_SAVES; s++) {
+        size_t count = std::min(KEYS_BEFORE + s / SAVES_PER_NEW_KEY, KEYS_AFTER);
+        for (uint32_t n = 1 + rng() % 6; n > 0; n--) current[rng() % count] = rng();
+
+        std::memcpy(before.data(), flash, FLASH_SIZE);
+        ParamStore store;
+        store.init();
+        uint32_t generation = store.generation();
+        uint64_t first_op = flash_ops;
+        ok &= store.save(current.data(), count);
+        uint64_t ops = flash_ops - first_op;
+        bool compacted = store.generation() != generation;
+        compactions += compacted;
+        std::memcpy(after.data(), flash, FLASH_SIZE);
+
+        std::vector<uint64_t> cut_points;
+        if (compacted) {
+            for (uint64_t op = 0; op < ops; op++) cut_points.push_back(op);
+        }
+        else if (s % RANDOM_CUT_EVERY == 0 && ops > 0) {
+            cut_points.push_back(rng() % ops);
+        }
+        for (uint64_t op : cut_points) {
+            std::memcpy(flash, before.data(), FLASH_SIZE);
+            ParamStore victim;
+            victim.init();
+            power_cut_at = flash_ops + op;
+            victim.save(current.data(), count);
+            powered = true;
+            power_cut_at = UINT64_MAX;
+            cuts++;
+            compaction_cuts += compacted;
+
+            uint32_t values[PARAM_STORE_MAX_KEYS];
+            uint32_t found = boot(values, count).found;
+            for (size_t key = 0; key < count; key++) {
+                bool has = found & (1u << key);
+                if ((saved_mask & (1u << key)) && !has) lost++;
+                if (has && values[key] != current[key] && !((saved_mask & (1u << key)) && values[key] == saved[key])) {
+                    corrupted++;
+                }
+            }
+            if (!save(current, count) || !matches(values, boot(values, count).found, current, count)) unrecovered++;
+        }
+
+        std::memcpy(flash, after.data(), FLASH_SIZE);
+        saved = current;
+        saved_mask = key_mask(count);
+    }
+
+    printf(
+        "power loss: %d saves, %u compactions, cut at %u points (%u during compaction)\n", SCRIPT_SAVES, compactions,
+        cuts, compaction_cuts);
+    printf("  lost keys %u, corrupted values %u, failed re-saves %u, flash misuse %u\n", lost, corrupted, unrecovered, misuse);
+    ok &= check(compactions >= 4, "the script compacts several times");
+    ok &= check(lost == 0, "power loss never loses a saved key");
+    ok &= check(corrupted == 0, "power loss leaves either the old or the new value");
+    ok &= check(unrecovered == 0, "saving after power loss succeeds");
+    ok &= check(misuse == 0, "flash is only programmed while unlocked, in range and from 1 to 0");
+    return ok;
+}
+
+int main()
+{
+    if (!flash_map()) {
+        fprintf(stderr, "FAIL: cannot map the flash emulator at 0x%08X\n", FLASH_ADDR);
+        return 1;
+    }
+
+    bool ok = true;
+    ok &= legacy_sector();
+    ok &= unsaved_keys();
+    ok &= power_loss();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,212 @@
+// 小陀螺仿真
+// 车轮不打滑的刚体模型，轮轴带粘滞和库仑摩擦；SpinControl、HeadingControl、轮速PID和前馈为固件代码，
+// 链路与chassis_move_control()相同 (不含加速度限制和功率缩放)。
+// 前馈和功率模型的摩擦参数取两种情况：已辨识 (与车体一致) 和默认值0。
+// 检查:
+//   1. 已辨识时按SpinControl给出的角速度稳态自旋，按固件功率预测公式 (不含k4/k5动态项) 计算的平均功率
+//      接近且不超过预算；同时平移时自旋变慢，总功率仍不超过预算
+//   2. 默认参数时场定向超前FIELD_PHASE_LEAD减小场坐标系下的平移方向误差
+// 另外输出两种情况下不同超前时间的方向误差，供调整在线参数field_phase_lead参考。
+// 模型没有电调电流环和CAN的延迟，实车的最优超前时间会更长一些
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include "feedforward.hpp"
+#include "heading_control.hpp"
+#include "spin_control.hpp"
+#include "tools/mecanum/mecanum.hpp"
+#include "wheel_pid.hpp"
+
+// 与chassis_control.hpp、chassis_control_task.cpp相同
+constexpr float WHEEL_RADIUS = 0.077f;
+constexpr float HALF_LENGTH = 0.165f;
+constexpr float HALF_WIDTH = 0.185f;
+constexpr float PID_DT = 0.001f;
+constexpr float PID_KP = 0.5f;
+constexpr float PID_KI = 0.05f;
+constexpr float PID_KD = 0.01f;
+constexpr float PID_MO = 2.5f;
+constexpr float PID_MIO = 1.0f;
+constexpr float PID_ALPHA = 0.0f;
+constexpr float PID_KB = 20.0f;
+constexpr float MAX_SAFE_TORQUE = 8.0f;
+constexpr float K1_TORQUE_LOSS = 2.0f;
+constexpr float K2_SPEED_LOSS = 0.005f;
+constexpr float K3_STATIC_POWER = 6.2f;
+constexpr float SPIN_RATE_MAX = 15.0f;
+constexpr float FIELD_PHASE_LEAD = 0.03f;
+constexpr float HEADING_KP = 5.0f;
+constexpr float HEADING_KI = 2.0f;
+constexpr float HEADING_MAX_CORRECTION = 2.0f;
+constexpr float HEADING_CAPTURE_RATE = 0.3f;
+
+// 车体模型
+constexpr float MASS = 20.0f;            // kg
+constexpr float YAW_INERTIA = 1.0f;      // kg·m^2
+constexpr float WHEEL_INERTIA = 0.02f;   // 折算到轮轴 kg·m^2
+constexpr float WHEEL_VISCOUS = 0.02f;   // N·m/(rad/s)
+constexpr float WHEEL_COULOMB = 0.3f;    // N·m
+constexpr float POWER_LIMIT = 80.0f;     // 裁判系统功率上限 W
+constexpr float POWER_MARGIN = 5.0f;     // 与chassis_move_control()相同
+constexpr float BUFFER_ENERGY = 60.0f;   // J
+constexpr float SPIN_UP_TIME = 3.0f;     // 起转到进入稳态 s
+constexpr float MEASURE_TIME = 2.0f;     // 稳态统计时长 s
+
+constexpr float PI = 3.14159265f;
+
+struct Result
+{
+    float rate;            // 稳态自旋角速度 rad/s
+    float budget;          // 功率预算 W
+    float power;           // 稳态平均功率 W
+    float direction_error; // 场坐标系平移方向误差的均值 rad
+};
+
+// 3x3线性方程组 A x = b
+static void solve3(const float a[3][3], const float b[3], float x[3])
+{
+    float det = a[0][0] * (a[1][1] * a[2][2] - a[1][2] * a[2][1]) - a[0][1] * (a[1][0] * a[2][2] - a[1][2] * a[2][0]) +
+                a[0][2] * (a[1][0] * a[2][1] - a[1][1] * a[2][0]);
+    for (int c = 0; c < 3; c++) {
+        float m[3][3];
+        for (int r = 0; r < 3; r++) {
+            for (int k = 0; k < 3; k++) m[r][k] = (k == c) ? b[r] : a[r][k];
+        }
+        x[c] = (m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) +
+                m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0])) /
+               det;
+    }
+}
+
+// field_speed: 场坐标系平移速度 (沿场坐标系x) m/s；lead: 场定向超前时间 s
+static Result run(float field_speed, float lead, bool identified)
+{
+    const float dt = PID_DT;
+    sp::Mecanum inverse(WHEEL_RADIUS, HALF_LENGTH, HALF_WIDTH);
+    float jac[4][3];
+    const float unit[3][3] = {{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}};
+    for (int c = 0; c < 3; c++) {
+        inverse.calc(unit[c][0], unit[c][1], unit[c][2]);
+        jac[0][c] = inverse.speed_lf;
+        jac[1][c] = inverse.speed_lr;
+        jac[2][c] = inverse.speed_rf;
+        jac[3][c] = inverse.speed_rr;
+    }
+    // 车轮不打滑时车体广义质量 M = diag(m, m, Iz) + Jw·JᵀJ
+    float mass[3][3] = {{MASS, 0.0f, 0.0f}, {0.0f, MASS, 0.0f}, {0.0f, 0.0f, YAW_INERTIA}};
+    for (int r = 0; r < 3; r++) {
+        for (int c = 0; c < 3; c++) {
+            for (int i = 0; i < 4; i++) mass[r][c] += WHEEL_INERTIA * jac[i][r] * jac[i][c];
+        }
+    }
+
+    WheelPid pid[4] = {
+        WheelPid(dt, PID_KP, PID_KI, PID_KD, PID_MO, PID_MIO, PID_ALPHA, PID_KB),
+        WheelPid(dt, PID_KP, PID_KI, PID_KD, PID_MO, PID_MIO, PID_ALPHA, PID_KB),
+        WheelPid(dt, PID_KP, PID_KI, PID_KD, PID_MO, PID_MIO, PID_ALPHA, PID_KB),
+        WheelPid(dt, PID_KP, PID_KI, PID_KD, PID_MO, PID_MIO, PID_ALPHA, PID_KB),
+    };
+    WheelFeedforward feedforward[4] = {WheelFeedforward(dt), WheelFeedforward(dt), WheelFeedforward(dt), WheelFeedforward(dt)};
+    SpinControl spin(WHEEL_RADIUS, HALF_LENGTH, HALF_WIDTH, SPIN_RATE_MAX);
+    HeadingControl heading(HEADING_KP, HEADING_KI, HEADING_MAX_CORRECTION, HEADING_CAPTURE_RATE, dt);
+    const FeedforwardModel ff_model = identified ? FeedforwardModel{WHEEL_INERTIA, WHEEL_VISCOUS, WHEEL_COULOMB}
+                                                 : FeedforwardModel{0.0f, 0.0f, 0.0f};
+    const PowerModel power_model = {
+        K1_TORQUE_LOSS, K2_SPEED_LOSS, K3_STATIC_POWER, WHEEL_INERTIA, ff_model.viscous, ff_model.coulomb,
+    };
+    const SpinBudget budget = {POWER_LIMIT - POWER_MARGIN, BUFFER_ENERGY, 0.0f};
+
+    float v[3] = {};  // 车体坐标系 vx, vy, wz
+    float yaw = 0.0f;
+    Result r = {};
+    double power_sum = 0.0;
+    double error_sum = 0.0;
+    uint32_t samples = 0;
+    uint32_t steps = static_cast<uint32_t>((SPIN_UP_TIME + MEASURE_TIME) / dt);
+    for (uint32_t k = 0; k < steps; k++) {
+        float w[4];
+        for (int i = 0; i < 4; i++) w[i] = jac[i][0] * v[0] + jac[i][1] * v[1] + jac[i][2] * v[2];
+
+        float vx = field_speed, vy = 0.0f;
+        float wz = spin.update(power_model, budget, vx, vy);
+        wz = heading.hold(wz, yaw, v[2], true);
+        heading.field_to_body(vx, vy, yaw + v[2] * lead);
+        inverse.calc(vx, vy, wz);
+        const float set[4] = {inverse.speed_lf, inverse.speed_lr, inverse.speed_rf, inverse.speed_rr};
+
+        float torque[4];
+        float power = K3_STATIC_POWER;
+        for (int i = 0; i < 4; i++) {
+            pid[i].calc(set[i], w[i]);
+            float ff = feedforward[i].calc(set[i], ff_model);
+            torque[i] = std::max(-MAX_SAFE_TORQUE, std::min(pid[i].out + ff, MAX_SAFE_TORQUE));
+            pid[i].back_calculate(torque[i] - ff);
+            power += torque[i] * w[i] + K1_TORQUE_LOSS * torque[i] * torque[i] + K2_SPEED_LOSS * w[i] * w[i];
+        }
+
+        // 广义力 Jᵀ(τ - 摩擦)，车体坐标系下平移项含 m·ω×v
+        float force[3] = {};
+        for (int i = 0; i < 4; i++) {
+            float friction = WHEEL_VISCOUS * w[i] + WHEEL_COULOMB * std::tanh(w[i] / 0.1f);
+            for (int c = 0; c < 3; c++) force[c] += jac[i][c] * (torque[i] - friction);
+        }
+        force[0] += MASS * v[2] * v[1];
+        force[1] -= MASS * v[2] * v[0];
+        float acc[3];
+        solve3(mass, force, acc);
+        for (int c = 0; c < 3; c++) v[c] += acc[c] * dt;
+        yaw += v[2] * dt;
+
+        if (k * dt >= SPIN_UP_TIME) {
+            power_sum += power;
+            if (field_speed > 0.0f) {
+                float world_x = v[0] * std::cos(yaw) - v[1] * std::sin(yaw);
+                float world_y = v[0] * std::sin(yaw) + v[1] * std::cos(yaw);
+                error_sum += std::abs(std::atan2(world_y, world_x));
+            }
+            samples++;
+        }
+        r.rate = v[2];
+    }
+    r.budget = spin.power_budget;
+    r.power = static_cast<float>(power_sum / samples);
+    r.direction_error = static_cast<float>(error_sum / samples);
+    return r;
+}
+
+static bool check(bool ok, const char * what)
+{
+    if (!ok) fprintf(stderr, "FAIL: %s\n", what);
+    return ok;
+}
+
+int main()
+{
+    bool ok = true;
+
+    Result still = run(0.0f, FIELD_PHASE_LEAD, true);
+    Result moving = run(1.0f, FIELD_PHASE_LEAD, true);
+    printf("spin only       rate %5.2f rad/s  power %5.1f W / budget %5.1f W\n", still.rate, still.power, still.budget);
+    printf("spin + 1 m/s    rate %5.2f rad/s  power %5.1f W / budget %5.1f W\n", moving.rate, moving.power, moving.budget);
+    ok &= check(still.power <= 1.05f * still.budget, "steady spin stays within the power budget");
+    ok &= check(still.power >= 0.85f * still.budget, "steady spin uses most of the power budget");
+    ok &= check(still.rate < SPIN_RATE_MAX, "spin rate set by power, not by the cap");
+    ok &= check(moving.rate < still.rate, "translation slows the spin");
+    ok &= check(moving.power <= 1.05f * moving.budget, "spin with translation stays within the power budget");
+
+    // 平移方向误差随超前时间的变化
+    const float leads[] = {0.0f, 0.01f, 0.02f, FIELD_PHASE_LEAD, 0.04f};
+    float error[2][5];
+    for (int identified = 0; identified < 2; identified++) {
+        printf("%-14s  direction error", identified ? "identified ff" : "default ff");
+        for (int i = 0; i < 5; i++) {
+            error[identified][i] = run(1.0f, leads[i], identified).direction_error;
+            printf("  %2.0fms %4.1fdeg", leads[i] * 1000.0f, error[identified][i] * 180.0f / PI);
+        }
+        printf("\n");
+    }
+    ok &= check(error[0][3] < 0.7f * error[0][0], "phase lead corrects translation direction with default feedforward");
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,15 @@
+#ifndef SIM_FREERTOS_H
+#define SIM_FREERTOS_H
+
+// 仿真程序单线程运行，临界区为空
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef uint32_t UBaseType_t;
+typedef void * TaskHandle_t;
+
+#define taskENTER_CRITICAL() ((void)0)
+#define taskEXIT_CRITICAL() ((void)0)
+
+#endif // SIM_FREERTOS_H
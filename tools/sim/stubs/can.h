@@ -0,0 +1,16 @@
+#ifndef SIM_CAN_H
+#define SIM_CAN_H
+
+#include "main.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern CAN_HandleTypeDef hcan2;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_CAN_H
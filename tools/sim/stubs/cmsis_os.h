@@ -0,0 +1,19 @@
+#ifndef SIM_CMSIS_OS_H
+#define SIM_CMSIS_OS_H
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void osDelay(uint32_t millisec);
+uint32_t osKernelSysTick(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_CMSIS_OS_H
@@ -0,0 +1,21 @@
+#include "tools/crc/crc.hpp"
+
+namespace sp
+{
+uint16_t get_crc16(const uint8_t * data, size_t size)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < size; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) crc = (crc & 1) ? (crc >> 1) ^ 0x8408 : crc >> 1;
+    }
+    return crc;
+}
+
+bool check_crc16(const uint8_t * data, size_t size)
+{
+    if (size <= 2) return false;
+    uint16_t crc = get_crc16(data, size - 2);
+    return data[size - 2] == static_cast<uint8_t>(crc) && data[size - 1] == static_cast<uint8_t>(crc >> 8);
+}
+}  // namespace sp
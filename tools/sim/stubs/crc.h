@@ -0,0 +1,16 @@
+#ifndef SIM_CRC_H
+#define SIM_CRC_H
+
+#include "main.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern CRC_HandleTypeDef hcrc;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_CRC_H
@@ -0,0 +1,43 @@
+#ifndef SIM_DBUS_HPP
+#define SIM_DBUS_HPP
+
+#include <cstdint>
+
+// 与sp_middleware一致的DBus解析结果，只声明应用层用到的字段；
+// 主机仿真直接填写字段，代替串口中断中的帧解析
+namespace sp
+{
+enum class DBusSwitchMode : uint8_t
+{
+    UP = 1,
+    DOWN = 2,
+    MID = 3,
+};
+
+struct DBusKeys
+{
+    bool w, s, a, d, shift, ctrl, q, e, r, f, g, z, x, c, v, b;
+};
+
+struct DBusMouse
+{
+    int16_t vx, vy, vz;
+    bool left, right;
+};
+
+class DBus
+{
+public:
+    float ch_rh = 0.0f;  // 各通道归一化到[-1, 1]
+    float ch_rv = 0.0f;
+    float ch_lh = 0.0f;
+    float ch_lv = 0.0f;
+    float ch_lu = 0.0f;
+    DBusSwitchMode sw_r = DBusSwitchMode::MID;
+    DBusSwitchMode sw_l = DBusSwitchMode::MID;
+    DBusMouse mouse = {};
+    DBusKeys keys = {};
+};
+}  // namespace sp
+
+#endif // SIM_DBUS_HPP
@@ -0,0 +1,133 @@
+#ifndef SIM_MAIN_H
+#define SIM_MAIN_H
+
+// 主机仿真用的HAL替身，只声明应用层代码用到的类型和函数；
+// 函数实现由各仿真程序按需提供 (记录输出或注入输入)
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum
+{
+    HAL_OK = 0,
+    HAL_ERROR,
+    HAL_BUSY,
+    HAL_TIMEOUT
+} HAL_StatusTypeDef;
+
+typedef struct
+{
+    int instance;
+    uint8_t * pRxBuffPtr;
+    uint16_t RxXferSize;
+} UART_HandleTypeDef;
+
+typedef struct
+{
+    int instance;
+    const uint8_t * pTxBuffPtr;
+    uint8_t * pRxBuffPtr;
+    uint16_t RxXferSize;
+} SPI_HandleTypeDef;
+
+typedef struct
+{
+    int instance;
+} CAN_HandleTypeDef;
+
+typedef struct
+{
+    uint32_t StdId;
+    uint32_t ExtId;
+    uint32_t IDE;
+    uint32_t RTR;
+    uint32_t DLC;
+    uint32_t Timestamp;
+    uint32_t FilterMatchIndex;
+} CAN_RxHeaderTypeDef;
+
+#define CAN_RX_FIFO0 0x00000000U
+
+typedef struct
+{
+    int port;
+} GPIO_TypeDef;
+
+typedef enum
+{
+    GPIO_PIN_RESET = 0,
+    GPIO_PIN_SET
+} GPIO_PinState;
+
+extern GPIO_TypeDef sim_gpioa, sim_gpiob, sim_gpioc;
+#define GPIOA (&sim_gpioa)
+#define GPIOB (&sim_gpiob)
+#define GPIOC (&sim_gpioc)
+
+#define GPIO_PIN_0 ((uint16_t)0x0001)
+#define GPIO_PIN_4 ((uint16_t)0x0010)
+#define GPIO_PIN_5 ((uint16_t)0x0020)
+
+// 与Inc/main.h相同的BMI088引脚
+#define CS1_ACC_Pin GPIO_PIN_4
+#define CS1_ACC_GPIO_Port GPIOA
+#define INT_ACC_Pin GPIO_PIN_4
+#define INT_ACC_GPIO_Port GPIOC
+#define INT_GYRO_Pin GPIO_PIN_5
+#define INT_GYRO_GPIO_Port GPIOC
+#define CS1_GYRO_Pin GPIO_PIN_0
+#define CS1_GYRO_GPIO_Port GPIOB
+
+void HAL_GPIO_WritePin(GPIO_TypeDef * port, uint16_t pin, GPIO_PinState state);
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin);
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef * huart, const uint8_t * data, uint16_t size);
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef * huart, uint8_t * pData, uint16_t Size);
+
+HAL_StatusTypeDef HAL_SPI_TransmitReceive(
+    SPI_HandleTypeDef * hspi, const uint8_t * pTxData, uint8_t * pRxData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_SPI_TransmitReceive_DMA(
+    SPI_HandleTypeDef * hspi, const uint8_t * pTxData, uint8_t * pRxData, uint16_t Size);
+void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef * hspi);
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef * hspi);
+
+typedef struct
+{
+    int instance;
+} CRC_HandleTypeDef;
+
+uint32_t HAL_CRC_Calculate(CRC_HandleTypeDef * hcrc, uint32_t pBuffer[], uint32_t BufferLength);
+
+typedef struct
+{
+    uint32_t TypeErase;
+    uint32_t Banks;
+    uint32_t Sector;
+    uint32_t NbSectors;
+    uint32_t VoltageRange;
+} FLASH_EraseInitTypeDef;
+
+#define FLASH_TYPEERASE_SECTORS 0x00000000U
+#define FLASH_BANK_1 1U
+#define FLASH_SECTOR_10 10U
+#define FLASH_SECTOR_11 11U
+#define FLASH_VOLTAGE_RANGE_3 0x00000002U
+#define FLASH_TYPEPROGRAM_WORD 0x00000002U
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void);
+HAL_StatusTypeDef HAL_FLASH_Lock(void);
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data);
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef * pEraseInit, uint32_t * SectorError);
+
+uint32_t HAL_CAN_GetRxFifoFillLevel(CAN_HandleTypeDef * hcan, uint32_t RxFifo);
+HAL_StatusTypeDef HAL_CAN_GetRxMessage(
+    CAN_HandleTypeDef * hcan, uint32_t RxFifo, CAN_RxHeaderTypeDef * pHeader, uint8_t aData[]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_MAIN_H
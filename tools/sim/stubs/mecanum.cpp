@@ -0,0 +1,30 @@
+#include "tools/mecanum/mecanum.hpp"
+
+namespace sp
+{
+Mecanum::Mecanum(
+    float wheel_radius, float half_length, float half_width, bool lf_reverse, bool lr_reverse, bool rf_reverse,
+    bool rr_reverse)
+: speed_lf(0.0f),
+  speed_lr(0.0f),
+  speed_rf(0.0f),
+  speed_rr(0.0f),
+  r_(wheel_radius),
+  l_(half_length),
+  w_(half_width),
+  lf_sign_(lf_reverse ? -1.0f : 1.0f),
+  lr_sign_(lr_reverse ? -1.0f : 1.0f),
+  rf_sign_(rf_reverse ? -1.0f : 1.0f),
+  rr_sign_(rr_reverse ? -1.0f : 1.0f)
+{
+}
+
+void Mecanum::calc(float vx, float vy, float wz)
+{
+    float k = l_ + w_;
+    speed_lf = lf_sign_ * (vx - vy - k * wz) / r_;
+    speed_lr = lr_sign_ * (vx + vy - k * wz) / r_;
+    speed_rf = rf_sign_ * (-vx - vy - k * wz) / r_;
+    speed_rr = rr_sign_ * (-vx + vy - k * wz) / r_;
+}
+}  // namespace sp
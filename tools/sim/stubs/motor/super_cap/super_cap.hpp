@@ -0,0 +1,18 @@
+#ifndef SIM_SUPER_CAP_HPP
+#define SIM_SUPER_CAP_HPP
+
+#include <cstdint>
+
+// 与sp_middleware一致的电容板工作模式，主机仿真只用到该枚举
+namespace sp
+{
+enum class SuperCapMode : uint8_t
+{
+    DISABLE = 0,
+    AUTOMODE = 1,
+    DISCHARGE = 2,
+    CHARGE = 3,
+};
+}  // namespace sp
+
+#endif // SIM_SUPER_CAP_HPP
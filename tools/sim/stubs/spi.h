@@ -0,0 +1,16 @@
+#ifndef SIM_SPI_H
+#define SIM_SPI_H
+
+#include "main.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern SPI_HandleTypeDef hspi1;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_SPI_H
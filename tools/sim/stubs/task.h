@@ -0,0 +1,26 @@
+#ifndef SIM_TASK_H
+#define SIM_TASK_H
+
+// 只声明cpu_profiler.cpp用到的任务统计接口，实现由仿真程序提供
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    TaskHandle_t xHandle;
+    const char * pcTaskName;
+    UBaseType_t xTaskNumber;
+    uint32_t ulRunTimeCounter;
+} TaskStatus_t;
+
+UBaseType_t uxTaskGetSystemState(TaskStatus_t * status, UBaseType_t max_count, uint32_t * total_runtime);
+TaskHandle_t xTaskGetIdleTaskHandle(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_TASK_H
@@ -0,0 +1,15 @@
+#ifndef SIM_CRC_HPP
+#define SIM_CRC_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// 与sp_middleware一致的接口，算法同裁判系统协议：
+// crc16为CRC-16/MCRF4XX (反射多项式0x8408，初值0xFFFF)，校验值小端附在数据末尾
+namespace sp
+{
+uint16_t get_crc16(const uint8_t * data, size_t size);
+bool check_crc16(const uint8_t * data, size_t size);
+}  // namespace sp
+
+#endif // SIM_CRC_HPP
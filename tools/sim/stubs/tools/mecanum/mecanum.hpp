@@ -0,0 +1,30 @@
+#ifndef SIM_MECANUM_HPP
+#define SIM_MECANUM_HPP
+
+// 与sp_middleware一致的接口：输入车体速度 (m/s, rad/s)，输出各轮转速 rad/s。
+// 按X型麦轮的标准逆运动学计算，右侧电机反向安装，转速取反；reverse参数对单个轮子再取反
+namespace sp
+{
+class Mecanum
+{
+public:
+    Mecanum(
+        float wheel_radius, float half_length, float half_width, bool lf_reverse = false, bool lr_reverse = false,
+        bool rf_reverse = false, bool rr_reverse = false);
+
+    float speed_lf;
+    float speed_lr;
+    float speed_rf;
+    float speed_rr;
+
+    void calc(float vx, float vy, float wz);
+
+private:
+    const float r_;
+    const float l_;
+    const float w_;
+    const float lf_sign_, lr_sign_, rf_sign_, rr_sign_;
+};
+}  // namespace sp
+
+#endif // SIM_MECANUM_HPP
@@ -0,0 +1,21 @@
+#ifndef SIM_USBD_CDC_IF_H
+#define SIM_USBD_CDC_IF_H
+
+#include <stdint.h>
+
+#define APP_TX_DATA_SIZE 2048
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern uint8_t UserTxBufferFS[APP_TX_DATA_SIZE];
+
+uint8_t CDC_Transmit_FS(uint8_t * Buf, uint16_t Len);
+uint8_t CDC_TxReady_FS(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_USBD_CDC_IF_H
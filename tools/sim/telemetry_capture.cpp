@@ -0,0 +1,231 @@
+// 遥测编码器样本生成
+// 用固件的Telemetry编码一段合成数据，输出:
+//   <prefix>.bin   串口字节流
+//   <prefix>.json  通道表 (与USB TELEMETRY_CHANNEL回传的内容相同)
+//   <prefix>.csv   每个采样周期的真值: stamp_ms, 所选通道mask, 到期通道mask, 各通道值 (未选为空)
+// 默认样本在原始/压缩格式间切换并改变通道选择，覆盖关键帧补发、抽取通道和原始帧；
+// 第二个参数为justfloat时生成20个通道的JustFloat样本，中途改变一次通道选择
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+#include "telemetry.hpp"
+
+static FILE * capture_file = nullptr;
+static size_t capture_bytes[2] = {};
+static int capture_target = 0;
+
+extern "C" HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *, const uint8_t * data, uint16_t size)
+{
+    if (capture_target == 0) fwrite(data, 1, size, capture_file);
+    capture_bytes[capture_target] += size;
+    return HAL_OK;
+}
+
+static UART_HandleTypeDef huart_capture{0, nullptr, 0};
+static UART_HandleTypeDef huart_reference{1, nullptr, 0};
+
+struct Signals
+{
+    float speed;
+    float torque;
+    bool flag;
+    int16_t counter;
+    float power;
+    uint16_t energy;
+    uint32_t ticks;
+    int32_t offset;
+};
+
+static Signals signals;
+
+template <typename T>
+static void add_both(Telemetry & a, Telemetry & b, const char * name, const T * ptr, uint16_t decimation, float quantum)
+{
+    a.add(name, ptr, decimation, quantum);
+    b.add(name, ptr, decimation, quantum);
+}
+
+static void update_signals(uint32_t tick)
+{
+    float t = static_cast<float>(tick) * 0.001f;
+    signals.speed = 3.0f * std::sin(6.0f * t) + 0.002f * static_cast<float>(tick % 7);
+    signals.torque = -2.5f * std::cos(11.0f * t);
+    signals.flag = (tick / 40) % 2 == 0;
+    signals.counter = static_cast<int16_t>(-300 + static_cast<int>(tick % 600));
+    signals.power = 80.0f + 40.0f * std::sin(2.0f * t);
+    signals.energy = static_cast<uint16_t>(60 - (tick / 10) % 60);
+    signals.ticks = 4000000000u + tick * 1000u;  // 跨越int32上界，检验U32按无符号处理
+    signals.offset = -100000 + static_cast<int32_t>(tick) * 37;
+}
+
+static void write_value(FILE * csv, const TelemetryChannel & channel)
+{
+    const void * ptr = const_cast<const void *>(channel.ptr);
+    switch (channel.type) {
+        case TelemetryType::U8:
+            fprintf(csv, ",%u", *static_cast<const uint8_t *>(ptr));
+            break;
+        case TelemetryType::U16:
+            fprintf(csv, ",%u", *static_cast<const uint16_t *>(ptr));
+            break;
+        case TelemetryType::U32:
+            fprintf(csv, ",%u", *static_cast<const uint32_t *>(ptr));
+            break;
+        case TelemetryType::I16:
+            fprintf(csv, ",%d", *static_cast<const int16_t *>(ptr));
+            break;
+        case TelemetryType::I32:
+            fprintf(csv, ",%d", *static_cast<const int32_t *>(ptr));
+            break;
+        case TelemetryType::F32:
+            fprintf(csv, ",%.9g", *static_cast<const float *>(ptr));
+            break;
+    }
+}
+
+static void write_channel_table(FILE * json, const Telemetry & telemetry)
+{
+    size_t count = telemetry.channel_count();
+    fprintf(json, "[\n");
+    for (size_t id = 0; id < count; id++) {
+        const TelemetryChannel & channel = telemetry.channel(id);
+        fprintf(
+            json, "  {\"id\": %zu, \"name\": \"%s\", \"type\": %d, \"decimation\": %u, \"quantum\": %.9g}%s\n", id,
+            channel.name, static_cast<int>(channel.type), channel.decimation, channel.quantum,
+            (id + 1 < count) ? "," : "");
+    }
+    fprintf(json, "]\n");
+}
+
+static void write_truth_header(FILE * csv, const Telemetry & telemetry)
+{
+    fprintf(csv, "stamp_ms,selected,due");
+    for (size_t id = 0; id < telemetry.channel_count(); id++) fprintf(csv, ",%s", telemetry.channel(id).name);
+    fprintf(csv, "\n");
+}
+
+static void write_truth_row(FILE * csv, const Telemetry & telemetry, uint32_t stamp_ms, uint32_t selected, uint32_t due)
+{
+    fprintf(csv, "%u,%u,%u", stamp_ms, selected, due);
+    for (size_t id = 0; id < telemetry.channel_count(); id++) {
+        if (selected & (1u << id)) write_value(csv, telemetry.channel(id));
+        else fprintf(csv, ",");
+    }
+    fprintf(csv, "\n");
+}
+
+// 20个浮点通道的JustFloat流，1kHz采样
+constexpr size_t JUSTFLOAT_CHANNELS = 20;
+static float justfloat_values[JUSTFLOAT_CHANNELS];
+static char justfloat_names[JUSTFLOAT_CHANNELS][8];
+
+static int capture_justfloat(FILE * csv, FILE * json)
+{
+    Telemetry capture(&huart_capture);
+    for (size_t id = 0; id < JUSTFLOAT_CHANNELS; id++) {
+        snprintf(justfloat_names[id], sizeof(justfloat_names[id]), "ch%02zu", id);
+        capture.add(justfloat_names[id], &justfloat_values[id]);
+    }
+    write_channel_table(json, capture);
+    write_truth_header(csv, capture);
+
+    const uint32_t all = (1u << JUSTFLOAT_CHANNELS) - 1;
+    capture.set_format(TelemetryFormat::JUSTFLOAT);
+
+    constexpr uint32_t TICKS = 4000;
+    for (uint32_t tick = 0; tick < TICKS; tick++) {
+        uint32_t selected = (tick < 2000) ? all : all & ~0xF0u;
+        capture.select(selected);
+        for (size_t id = 0; id < JUSTFLOAT_CHANNELS; id++) {
+            justfloat_values[id] = static_cast<float>(id + 1) * std::sin(static_cast<float>(tick) * 0.001f * (id + 1));
+        }
+        write_truth_row(csv, capture, tick, selected, selected);
+        capture.sample(tick);
+        capture.flush();
+    }
+
+    printf("%u justfloat samples, %zu bytes\n", TICKS, capture_bytes[0]);
+    return capture.dropped_frames == 0 ? 0 : 1;
+}
+
+int main(int argc, char ** argv)
+{
+    std::string prefix = (argc > 1) ? argv[1] : "telemetry_capture";
+    bool justfloat = argc > 2 && std::string(argv[2]) == "justfloat";
+    capture_file = fopen((prefix + ".bin").c_str(), "wb");
+    FILE * csv = fopen((prefix + ".csv").c_str(), "w");
+    FILE * json = fopen((prefix + ".json").c_str(), "w");
+    if (!capture_file || !csv || !json) {
+        fprintf(stderr, "cannot open output files for %s\n", prefix.c_str());
+        return 1;
+    }
+
+    if (justfloat) {
+        int result = capture_justfloat(csv, json);
+        fclose(capture_file);
+        fclose(csv);
+        fclose(json);
+        return result;
+    }
+
+    // reference实例以原始格式编码同一组数据，用于计算压缩比
+    Telemetry capture(&huart_capture);
+    Telemetry reference(&huart_reference);
+    add_both(capture, reference, "speed", &signals.speed, 1, 0.001f);
+    add_both(capture, reference, "torque", &signals.torque, 1, 0.01f);
+    add_both(capture, reference, "flag", &signals.flag, 1, 1.0f);
+    add_both(capture, reference, "counter", &signals.counter, 3, 1.0f);
+    add_both(capture, reference, "power", &signals.power, 5, 0.1f);
+    add_both(capture, reference, "energy", &signals.energy, 10, 1.0f);
+    add_both(capture, reference, "ticks", &signals.ticks, 2, 1.0f);
+    add_both(capture, reference, "offset", &signals.offset, 4, 1.0f);
+    size_t count = capture.channel_count();
+    write_channel_table(json, capture);
+    write_truth_header(csv, capture);
+
+    const uint32_t all = (1u << count) - 1;
+    reference.set_format(TelemetryFormat::RAW);
+    reference.select(all);
+
+    constexpr uint32_t TICKS = 1200;
+    uint32_t stamp_ms = 1000;
+    for (uint32_t tick = 0; tick < TICKS; tick++) {
+        // 中途去掉再加回通道、切到原始格式再切回，各自触发关键帧
+        uint32_t selected = all;
+        if (tick >= 250 && tick < 330) selected = all & ~(1u << 1) & ~(1u << 4);
+        capture.select(selected);
+        capture.set_format((tick >= 500 && tick < 560) ? TelemetryFormat::RAW : TelemetryFormat::COMPACT);
+
+        update_signals(tick);
+        uint32_t due = 0;
+        for (size_t id = 0; id < count; id++) {
+            if ((selected & (1u << id)) && tick % capture.channel(id).decimation == 0) due |= 1u << id;
+        }
+
+        write_truth_row(csv, capture, stamp_ms, selected, due);
+
+        capture_target = 0;
+        capture.sample(stamp_ms);
+        capture.flush();
+        capture_target = 1;
+        reference.sample(stamp_ms);
+        reference.flush();
+
+        // 偶尔跳过1ms，覆盖时间戳差分大于1的情况
+        stamp_ms += (tick % 97 == 96) ? 2 : 1;
+    }
+
+    fclose(capture_file);
+    fclose(csv);
+    fclose(json);
+
+    printf(
+        "%u samples: mixed stream %zu bytes, raw stream %zu bytes, ratio %.2f\n", TICKS, capture_bytes[0],
+        capture_bytes[1], static_cast<double>(capture_bytes[1]) / static_cast<double>(capture_bytes[0]));
+    if (capture.dropped_frames != 0 || reference.dropped_frames != 0) {
+        fprintf(stderr, "encoder dropped frames\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,242 @@
+// 打滑检测与力矩再分配仿真
+// 麦轮底盘刚体模型 + tanh轮胎模型；轮速PID、TractionControl和ChassisEstimator为固件代码，
+// 控制链路与chassis_control_task.cpp相同 (不含前馈和功率限制，车体运动的有效条件和反算方式相同)。
+// 场景:
+//   1. 对开路面起步：左前轮附着系数0.1，比较不做牵引控制、只用轮速一致性、用IMU三种方式
+//   2. 小陀螺平移：C板偏离旋转中心，向心加速度使速度估计偏离；小陀螺时不用车体运动判断，不应误判打滑
+//   3. 补偿期间的积分项：补偿轮按PID自身限幅反算，与按实际力矩反算比较；
+//      后者把替打滑轮出的力计入积分项，低附着段结束后各轮积分项不一致，匀速时车轮之间持续对抗
+//      (反算只向零回退积分，不会推到另一侧，差别小于改动前)
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include "chassis_estimator.hpp"
+#include "traction_control.hpp"
+#include "wheel_pid.hpp"
+
+// 与chassis_control.hpp相同
+constexpr float WHEEL_RADIUS = 0.077f;
+constexpr float HALF_LENGTH = 0.165f;
+constexpr float HALF_WIDTH = 0.185f;
+constexpr float PID_DT = 0.001f;
+constexpr float PID_KP = 0.5f;
+constexpr float PID_KI = 0.05f;
+constexpr float PID_KD = 0.01f;
+constexpr float PID_MO = 2.5f;
+constexpr float PID_MIO = 1.0f;
+constexpr float PID_ALPHA = 0.0f;
+constexpr float PID_KB = 20.0f;
+constexpr float MAX_SAFE_TORQUE = 8.0f;
+
+// 车体和轮胎模型
+constexpr float MASS = 20.0f;           // kg
+constexpr float YAW_INERTIA = 1.0f;     // kg·m^2
+constexpr float WHEEL_INERTIA = 0.02f;  // 折算到轮轴 kg·m^2
+constexpr float GRAVITY = 9.8f;
+constexpr float MU_HIGH = 0.8f;
+constexpr float MU_LOW = 0.1f;
+constexpr float SLIP_VELOCITY = 0.05f;  // 轮胎力达到约76%饱和的滑移速度 m/s
+constexpr float IMU_OFFSET_X = 0.08f;   // C板相对旋转中心的安装位置 m
+constexpr float IMU_OFFSET_Y = 0.03f;
+constexpr uint32_t CALIB_STEPS = 600;   // 起步前静止，供估计器标定零偏
+
+enum class Traction
+{
+    OFF,
+    ODOMETRY,  // 车体运动无效，只用轮速一致性
+    IMU,
+    IMU_ALWAYS,  // 小陀螺时也用车体运动 (对照)
+};
+
+enum class BackCalc
+{
+    FIRMWARE,  // 补偿轮只按PID自身限幅反算
+    APPLIED,   // 所有轮子按实际力矩反算
+};
+
+struct Scenario
+{
+    Traction traction;
+    BackCalc back_calc;
+    bool spinning;
+    float vx_set;        // 车体坐标系平移速度设定 m/s (小陀螺时为场坐标系)
+    float wz_set;        // rad/s
+    float low_mu_time;   // 左前轮处于低附着路面的时长 s，<0表示一直在低附着路面
+    float duration;      // s
+};
+
+struct Result
+{
+    float yaw;               // 结束时航向 rad
+    float vx;                // 结束时场坐标系速度 m/s
+    float residual_torque;   // 结束时四轮力矩绝对值之和 N·m
+    uint32_t slip_cycles;    // 判定打滑的周期数
+    float gain_min;          // 过程中最小牵引系数
+    float estimate_error;    // 车体速度估计的最大误差 m/s
+};
+
+static Result run(const Scenario & s)
+{
+    const float dt = PID_DT;
+    sp::Mecanum inverse(WHEEL_RADIUS, HALF_LENGTH, HALF_WIDTH);
+    float jac[4][3];
+    const float unit[3][3] = {{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}};
+    for (int c = 0; c < 3; c++) {
+        inverse.calc(unit[c][0], unit[c][1], unit[c][2]);
+        jac[0][c] = inverse.speed_lf;
+        jac[1][c] = inverse.speed_lr;
+        jac[2][c] = inverse.speed_rf;
+        jac[3][c] = inverse.speed_rr;
+    }
+
+    WheelPid pid[4] = {
+        WheelPid(dt, PID_KP, PID_KI, PID_KD, PID_MO, PID_MIO, PID_ALPHA, PID_KB),
+        WheelPid(dt, PID_KP, PID_KI, PID_KD, PID_MO, PID_MIO, PID_ALPHA, PID_KB),
+        WheelPid(dt, PID_KP, PID_KI, PID_KD, PID_MO, PID_MIO, PID_ALPHA, PID_KB),
+        WheelPid(dt, PID_KP, PID_KI, PID_KD, PID_MO, PID_MIO, PID_ALPHA, PID_KB),
+    };
+    TractionControl traction(WHEEL_RADIUS, HALF_LENGTH, HALF_WIDTH, MAX_SAFE_TORQUE, dt);
+    ChassisEstimator estimator(WHEEL_RADIUS, HALF_LENGTH, HALF_WIDTH, 0.0f, dt);
+
+    float v[2] = {};   // 车体坐标系速度
+    float wz = 0.0f;
+    float yaw = 0.0f;
+    float w[4] = {};   // 轮速 rad/s
+    float accel[2] = {};
+    float alpha = 0.0f;
+    const float load = MASS * GRAVITY / 4.0f;
+
+    Result r = {};
+    r.gain_min = 1.0f;
+    uint32_t steps = CALIB_STEPS + static_cast<uint32_t>(s.duration / dt);
+    for (uint32_t k = 0; k < steps; k++) {
+        bool moving = k >= CALIB_STEPS;
+        float t = static_cast<float>(k - std::min(k, CALIB_STEPS)) * dt;
+        bool low_mu = s.low_mu_time < 0.0f || t < s.low_mu_time;
+        const float mu[4] = {low_mu ? MU_LOW : MU_HIGH, MU_HIGH, MU_HIGH, MU_HIGH};
+
+        // IMU样本：安装点加速度 = 质心加速度 + 切向 + 向心
+        ImuSample imu = {};
+        imu.gyro[2] = wz;
+        imu.accel[0] = accel[0] - alpha * IMU_OFFSET_Y - wz * wz * IMU_OFFSET_X;
+        imu.accel[1] = accel[1] + alpha * IMU_OFFSET_X - wz * wz * IMU_OFFSET_Y;
+        imu.accel[2] = GRAVITY;
+        imu.gyro_count = 1;
+        imu.accel_count = 1;
+        estimator.update(w, imu);
+        if (moving) {
+            float ex = estimator.vx - v[0];
+            float ey = estimator.vy - v[1];
+            r.estimate_error = std::max(r.estimate_error, std::sqrt(ex * ex + ey * ey));
+        }
+
+        // 设定值：小陀螺时平移速度按场坐标系给出，转到车体坐标系
+        float vx_set = 0.0f, vy_set = 0.0f, wz_set = 0.0f;
+        if (moving) {
+            float heading = s.spinning ? yaw : 0.0f;
+            vx_set = s.vx_set * std::cos(heading);
+            vy_set = -s.vx_set * std::sin(heading);
+            wz_set = s.wz_set;
+        }
+        inverse.calc(vx_set, vy_set, wz_set);
+        const float set[4] = {inverse.speed_lf, inverse.speed_lr, inverse.speed_rf, inverse.speed_rr};
+
+        float torque[4];
+        for (int i = 0; i < 4; i++) {
+            pid[i].calc(set[i], w[i]);
+            torque[i] = pid[i].out;
+        }
+
+        if (s.traction != Traction::OFF) {
+            bool body_valid = (s.traction == Traction::IMU && !s.spinning) || s.traction == Traction::IMU_ALWAYS;
+            body_valid = body_valid && estimator.imu_valid;
+            const BodyMotion body = {estimator.vx, estimator.vy, estimator.wz, body_valid};
+            traction.apply(w, torque, body);
+            if (traction.slip_mask != 0) r.slip_cycles++;
+            r.gain_min = std::min(r.gain_min, traction.gain_min);
+        }
+
+        for (int i = 0; i < 4; i++) {
+            torque[i] = std::max(-MAX_SAFE_TORQUE, std::min(torque[i], MAX_SAFE_TORQUE));
+            bool compensating = traction.compensating_mask & (1u << i);
+            if (s.traction != Traction::OFF && s.back_calc == BackCalc::FIRMWARE && compensating) {
+                pid[i].back_calculate(pid[i].out);
+            }
+            else {
+                pid[i].back_calculate(torque[i]);
+            }
+        }
+
+        // 轮胎力和刚体运动
+        float wrench[3] = {};
+        for (int i = 0; i < 4; i++) {
+            float ground = jac[i][0] * v[0] + jac[i][1] * v[1] + jac[i][2] * wz;
+            float slip = (w[i] - ground) * WHEEL_RADIUS;
+            float tire = mu[i] * load * WHEEL_RADIUS * std::tanh(slip / SLIP_VELOCITY);
+            w[i] += (torque[i] - tire) / WHEEL_INERTIA * dt;
+            for (int c = 0; c < 3; c++) wrench[c] += jac[i][c] * tire;
+        }
+        accel[0] = wrench[0] / MASS;
+        accel[1] = wrench[1] / MASS;
+        alpha = wrench[2] / YAW_INERTIA;
+        v[0] += (accel[0] + wz * v[1]) * dt;
+        v[1] += (accel[1] - wz * v[0]) * dt;
+        wz += alpha * dt;
+        yaw += wz * dt;
+
+        r.vx = v[0] * std::cos(yaw) - v[1] * std::sin(yaw);
+        r.residual_torque = std::abs(torque[0]) + std::abs(torque[1]) + std::abs(torque[2]) + std::abs(torque[3]);
+    }
+    r.yaw = yaw;
+    return r;
+}
+
+static bool check(bool ok, const char * what)
+{
+    if (!ok) fprintf(stderr, "FAIL: %s\n", what);
+    return ok;
+}
+
+int main()
+{
+    bool ok = true;
+
+    // 1. 对开路面起步 2 m/s
+    const char * names[] = {"off", "odometry", "imu"};
+    Result split[3];
+    for (int m = 0; m < 3; m++) {
+        split[m] = run({static_cast<Traction>(m), BackCalc::FIRMWARE, false, 2.0f, 0.0f, -1.0f, 1.0f});
+        printf(
+            "split-mu %-8s yaw %+6.3f rad  vx %.3f m/s  gain_min %.2f\n", names[m], split[m].yaw, split[m].vx,
+            split[m].gain_min);
+    }
+    for (int m = 1; m < 3; m++) {
+        ok &= check(std::abs(split[m].yaw) < 0.5f * std::abs(split[0].yaw), "traction control halves yaw drift");
+        ok &= check(split[m].vx > split[0].vx, "traction control accelerates faster on split mu");
+    }
+
+    // 2. 小陀螺 10 rad/s 同时平移 1 m/s，附着良好
+    Result gated = run({Traction::IMU, BackCalc::FIRMWARE, true, 1.0f, 10.0f, 0.0f, 2.0f});
+    Result ungated = run({Traction::IMU_ALWAYS, BackCalc::FIRMWARE, true, 1.0f, 10.0f, 0.0f, 2.0f});
+    printf(
+        "spin gated    estimate error %.2f m/s  slip cycles %u  gain_min %.2f\n", gated.estimate_error,
+        gated.slip_cycles, gated.gain_min);
+    printf(
+        "spin ungated  estimate error %.2f m/s  slip cycles %u  gain_min %.2f\n", ungated.estimate_error,
+        ungated.slip_cycles, ungated.gain_min);
+    ok &= check(ungated.estimate_error > 1.0f, "off-center IMU corrupts the estimate while spinning");
+    ok &= check(ungated.slip_cycles > 0, "corrupted estimate flags slip when not gated");
+    ok &= check(gated.slip_cycles == 0 && gated.gain_min == 1.0f, "no false slip while spinning");
+
+    // 3. 左前轮低附着0.4 s后恢复，比较反算方式
+    Result firmware = run({Traction::IMU, BackCalc::FIRMWARE, false, 2.0f, 0.0f, 0.4f, 1.5f});
+    Result applied = run({Traction::IMU, BackCalc::APPLIED, false, 2.0f, 0.0f, 0.4f, 1.5f});
+    printf(
+        "back-calc firmware residual torque %.2f N·m, applied-torque residual torque %.2f N·m\n",
+        firmware.residual_torque, applied.residual_torque);
+    ok &= check(
+        firmware.residual_torque < 0.5f * applied.residual_torque, "compensation stays out of the integrators");
+
+    return ok ? 0 : 1;
+}
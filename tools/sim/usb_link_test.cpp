@@ -0,0 +1,309 @@
+// USB链路测试
+// 固件的usb_link.cpp链接到主机版CDC接口上，CDC_Transmit_FS收集发出的字节，由测试中的解帧器检查。
+//   接收：主机编码的帧流加入帧间垃圾、错误crc和超长长度字段，按随机长度分块送入on_receive()，
+//         poll()分发后与原帧比较；一次送入超过接收缓冲区的数据计入rx_overflows
+//   发送：CDC忙时填满16个槽位，第17帧丢弃并计数；空闲后按序整批发出，序号连续，反复填满使位置计数回绕；
+//         分页回复可用的帧数随空闲槽位变化
+//   竞争：4个生产者线程同时send()，消费者线程不停poll()；每个生产者的帧按序、内容完整，
+//         发出的帧数加丢弃数等于调用次数，帧序号连续
+// 检查项失败时打印原因并返回1
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "cpu_profiler.hpp"
+#include "input_recorder.hpp"
+#include "tools/crc/crc.hpp"
+#include "usb_link.hpp"
+#include "usbd_cdc_if.h"
+
+constexpr uint32_t TX_SLOTS = 16;          // 与usb_link.hpp相同
+constexpr uint32_t RX_BUFF_SIZE = 512;     // 与usb_link.hpp相同
+constexpr int PRODUCERS = 4;
+constexpr uint32_t FRAMES_PER_PRODUCER = 50000;
+constexpr int FILL_ROUNDS = 40;            // 填满再发出的轮数，位置计数回绕两次以上
+
+// ---------------------------------------------------------------- 主机版CDC与固件实例
+
+extern "C" {
+uint8_t UserTxBufferFS[APP_TX_DATA_SIZE];
+}
+
+static std::atomic<bool> cdc_ready{true};
+static std::vector<uint8_t> usb_tx;  // usb_link发出的字节，只在调用poll()的线程中写入
+static uint32_t transfers = 0;
+
+extern "C" uint8_t CDC_TxReady_FS() { return cdc_ready.load() ? 1 : 0; }
+
+extern "C" uint8_t CDC_Transmit_FS(uint8_t * buf, uint16_t len)
+{
+    usb_tx.insert(usb_tx.end(), buf, buf + len);
+    transfers++;
+    return 0;
+}
+
+uint32_t profiler_cycles() { return 0; }
+uint32_t profiler_cycles_per_us() { return 168; }
+IsrProfile::~IsrProfile() {}
+extern "C" void osDelay(uint32_t) {}
+extern "C" uint32_t osKernelSysTick() { return 0; }
+
+static uint8_t input_record_buffer[1024];
+InputRecorder input_recorder(input_record_buffer, sizeof(input_record_buffer));
+
+// ---------------------------------------------------------------- 主机侧编解码
+
+struct Frame
+{
+    uint8_t cmd;
+    uint8_t seq;
+    std::vector<uint8_t> payload;
+};
+
+static std::vector<uint8_t> encode(uint8_t cmd, uint8_t seq, const std::vector<uint8_t> & payload)
+{
+    std::vector<uint8_t> frame = {USB_FRAME_SOF, cmd, static_cast<uint8_t>(payload.size()), seq};
+    frame.insert(frame.end(), payload.begin(), payload.end());
+    uint16_t crc = sp::get_crc16(frame.data(), frame.size());
+    frame.push_back(static_cast<uint8_t>(crc));
+    frame.push_back(static_cast<uint8_t>(crc >> 8));
+    return frame;
+}
+
+// 发出的字节必须是首尾相接的完整帧，不能有多余字节
+static bool decode(const std::vector<uint8_t> & bytes, std::vector<Frame> & frames)
+{
+    size_t pos = 0;
+    while (pos < bytes.size()) {
+        if (bytes.size() - pos < USB_FRAME_HEADER_SIZE + 2 || bytes[pos] != USB_FRAME_SOF) return false;
+        size_t len = bytes[pos + 2];
+        size_t size = USB_FRAME_HEADER_SIZE + len + 2;
+        if (len > USB_FRAME_MAX_PAYLOAD || bytes.size() - pos < size) return false;
+        if (!sp::check_crc16(bytes.data() + pos, size)) return false;
+        const uint8_t * payload = bytes.data() + pos + USB_FRAME_HEADER_SIZE;
+        frames.push_back({bytes[pos + 1], bytes[pos + 3], std::vector<uint8_t>(payload, payload + len)});
+        pos += size;
+    }
+    return true;
+}
+
+static bool check(bool ok, const char * what)
+{
+    if (!ok) fprintf(stderr, "FAIL: %s\n", what);
+    return ok;
+}
+
+// ---------------------------------------------------------------- 接收
+
+static std::vector<Frame> received;
+
+static void on_nav(const uint8_t * payload, uint8_t len)
+{
+    received.push_back({static_cast<uint8_t>(UsbCmd::NAV_CMD), 0, std::vector<uint8_t>(payload, payload + len)});
+}
+
+static bool test_receive()
+{
+    bool ok = true;
+    std::mt19937 rng(29);
+    std::uniform_int_distribution<int> byte(0, 255);
+    usb_link.register_handler(UsbCmd::NAV_CMD, on_nav);
+
+    // 帧流：有效帧之间夹着不含帧头的垃圾字节、crc错误帧和长度字段超限的假帧头
+    std::vector<uint8_t> stream;
+    std::vector<std::vector<uint8_t>> expected;
+    uint32_t corrupted = 0;
+    for (int i = 0; i < 300; i++) {
+        std::vector<uint8_t> payload(byte(rng) % (USB_FRAME_MAX_PAYLOAD + 1));
+        for (auto & b : payload) b = static_cast<uint8_t>(byte(rng));
+        std::vector<uint8_t> frame = encode(static_cast<uint8_t>(UsbCmd::NAV_CMD), static_cast<uint8_t>(i), payload);
+        switch (i % 5) {
+            case 1:
+                frame[USB_FRAME_HEADER_SIZE + payload.size()] ^= 0x5A;
+                corrupted++;
+                break;
+            case 2:
+                for (int k = byte(rng) % 8; k > 0; k--) stream.push_back(static_cast<uint8_t>(byte(rng) % USB_FRAME_SOF));
+                break;
+            case 3:
+                stream.insert(stream.end(), {USB_FRAME_SOF, 0x10, USB_FRAME_MAX_PAYLOAD + 1});
+                break;
+            default:
+                break;
+        }
+        if (i % 5 != 1) expected.push_back(payload);
+        stream.insert(stream.end(), frame.begin(), frame.end());
+    }
+
+    // 随机分块送入，每送入不超过接收缓冲区的数据poll一次
+    uint32_t crc_errors = usb_link.crc_errors;
+    size_t pos = 0;
+    while (pos < stream.size()) {
+        size_t chunk = std::min<size_t>(1 + byte(rng) % 64, stream.size() - pos);
+        usb_link.on_receive(stream.data() + pos, static_cast<uint32_t>(chunk));
+        pos += chunk;
+        if (byte(rng) < 96) usb_link.poll();
+    }
+    usb_link.poll();
+
+    bool same = received.size() == expected.size();
+    for (size_t i = 0; same && i < expected.size(); i++) same = received[i].payload == expected[i];
+    printf(
+        "receive: %zu bytes in random chunks, %zu frames dispatched, %u crc errors, %u rx overflows\n", stream.size(),
+        received.size(), usb_link.crc_errors - crc_errors, usb_link.rx_overflows);
+    ok &= check(same, "valid frames are dispatched intact and in order");
+    ok &= check(usb_link.crc_errors - crc_errors == corrupted, "corrupted frames are counted and skipped");
+    ok &= check(usb_link.rx_overflows == 0, "no overflow while polled");
+
+    // 不poll时超出接收缓冲区的字节丢弃并计数
+    std::vector<uint8_t> flood(RX_BUFF_SIZE + 100, 0);
+    usb_link.on_receive(flood.data(), static_cast<uint32_t>(flood.size()));
+    ok &= check(usb_link.rx_overflows == 100, "bytes beyond the receive buffer are counted as overflow");
+    usb_link.poll();
+
+    // PING原样回显
+    usb_tx.clear();
+    std::vector<uint8_t> ping = encode(static_cast<uint8_t>(UsbCmd::PING), 0, {1, 2, 3});
+    usb_link.on_receive(ping.data(), static_cast<uint32_t>(ping.size()));
+    usb_link.poll();
+    std::vector<Frame> echo;
+    ok &= check(
+        decode(usb_tx, echo) && echo.size() == 1 && echo[0].cmd == static_cast<uint8_t>(UsbCmd::PING) &&
+            echo[0].payload == std::vector<uint8_t>({1, 2, 3}),
+        "PING is echoed");
+    return ok;
+}
+
+// ---------------------------------------------------------------- 发送
+
+static bool test_queue_full()
+{
+    bool ok = true;
+    usb_tx.clear();
+    uint32_t dropped = usb_link.dropped_frames.load();
+    uint8_t last_seq = 0;
+    bool first = true, in_order = true, all_sent = true, budget = true;
+
+    for (int round = 0; round < FILL_ROUNDS; round++) {
+        cdc_ready = false;
+        for (uint32_t i = 0; i < TX_SLOTS; i++) {
+            // 分页回复的帧数：留出USB_LIST_TX_RESERVE个槽位，将满时为1，满时为0
+            uint32_t free = TX_SLOTS - i;
+            budget &= usb_link.reply_budget() == (free > USB_LIST_TX_RESERVE ? free - USB_LIST_TX_RESERVE : 1);
+            uint8_t payload[2] = {static_cast<uint8_t>(round), static_cast<uint8_t>(i)};
+            all_sent &= usb_link.send(UsbCmd::CHASSIS_STATE, payload, sizeof(payload));
+        }
+        budget &= usb_link.reply_budget() == 0;
+        uint8_t extra = 0xFF;
+        ok &= check(!usb_link.send(UsbCmd::CHASSIS_STATE, &extra, 1), "send fails when all slots are taken");
+        usb_link.poll();  // CDC忙，不发出
+
+        cdc_ready = true;
+        size_t before = usb_tx.size();
+        uint32_t transfers_before = transfers;
+        usb_link.poll();
+        ok &= check(transfers - transfers_before == 1, "queued frames go out in one transfer");
+
+        std::vector<uint8_t> bytes(usb_tx.begin() + before, usb_tx.end());
+        std::vector<Frame> frames;
+        ok &= check(decode(bytes, frames) && frames.size() == TX_SLOTS, "all queued frames are sent");
+        for (size_t i = 0; i < frames.size(); i++) {
+            in_order &= frames[i].payload[0] == round && frames[i].payload[1] == i;
+            in_order &= first || frames[i].seq == static_cast<uint8_t>(last_seq + 1);
+            last_seq = frames[i].seq;
+            first = false;
+        }
+    }
+    uint32_t dropped_now = usb_link.dropped_frames.load() - dropped;
+    printf("queue full: %d rounds of %u frames, %u dropped\n", FILL_ROUNDS, TX_SLOTS, dropped_now);
+    ok &= check(all_sent, "sends succeed while slots are free");
+    ok &= check(budget, "list reply budget follows the free slots");
+    ok &= check(dropped_now == FILL_ROUNDS, "each refused frame is counted once");
+    ok &= check(in_order, "frames leave in send order with consecutive sequence numbers");
+    return ok;
+}
+
+static bool test_contention()
+{
+    bool ok = true;
+    usb_tx.clear();
+    cdc_ready = true;
+    uint32_t dropped = usb_link.dropped_frames.load();
+
+    std::atomic<int> running{PRODUCERS};
+    std::atomic<bool> go{false};
+    std::atomic<uint32_t> refused{0};
+    std::vector<std::thread> producers;
+    for (int id = 0; id < PRODUCERS; id++) {
+        producers.emplace_back([id, &running, &go, &refused] {
+            uint8_t payload[USB_FRAME_MAX_PAYLOAD];
+            while (!go.load()) std::this_thread::yield();
+            for (uint32_t n = 0; n < FRAMES_PER_PRODUCER; n++) {
+                // id u8, n u32，其后为由id和n决定的填充
+                uint8_t len = static_cast<uint8_t>(5 + (n * 7 + id) % (USB_FRAME_MAX_PAYLOAD - 4));
+                payload[0] = static_cast<uint8_t>(id);
+                std::memcpy(payload + 1, &n, sizeof(n));
+                for (uint8_t k = 5; k < len; k++) payload[k] = static_cast<uint8_t>(n + k * id);
+                if (!usb_link.send(UsbCmd::CHASSIS_STATE, payload, len)) refused++;
+                // 每8帧让出一次时间片：4个生产者一轮合计32帧，超过槽位数，队列在满与不满之间反复切换
+                if (n % 8 == 7) std::this_thread::yield();
+            }
+            running--;
+        });
+    }
+    // 消费者：与usb_task相同，循环poll()
+    go = true;
+    while (running.load() > 0) {
+        usb_link.poll();
+        std::this_thread::yield();
+    }
+    for (auto & t : producers) t.join();
+    usb_link.poll();
+
+    std::vector<Frame> frames;
+    bool intact = decode(usb_tx, frames);
+    int64_t last[PRODUCERS];
+    for (auto & l : last) l = -1;
+    bool in_order = true, content = true, seq = true;
+    for (size_t i = 0; intact && i < frames.size(); i++) {
+        const Frame & f = frames[i];
+        uint32_t n;
+        int id = f.payload[0];
+        std::memcpy(&n, f.payload.data() + 1, sizeof(n));
+        if (id >= PRODUCERS) {
+            content = false;
+            break;
+        }
+        in_order &= static_cast<int64_t>(n) > last[id];
+        last[id] = n;
+        content &= f.payload.size() == 5 + (n * 7 + id) % (USB_FRAME_MAX_PAYLOAD - 4);
+        for (size_t k = 5; k < f.payload.size(); k++) content &= f.payload[k] == static_cast<uint8_t>(n + k * id);
+        if (i > 0) seq &= f.seq == static_cast<uint8_t>(frames[i - 1].seq + 1);
+    }
+    uint32_t attempts = PRODUCERS * FRAMES_PER_PRODUCER;
+    uint32_t dropped_now = usb_link.dropped_frames.load() - dropped;
+    printf(
+        "contention: %d producers x %u frames, %zu sent, %u dropped (%.1f%%), %u transfers\n", PRODUCERS,
+        FRAMES_PER_PRODUCER, frames.size(), dropped_now, 100.0 * dropped_now / attempts, transfers);
+    ok &= check(intact, "output is a clean sequence of valid frames");
+    ok &= check(content, "payloads are not torn between producers");
+    ok &= check(in_order, "each producer's frames stay in order");
+    ok &= check(seq, "sequence numbers are consecutive");
+    ok &= check(!frames.empty() && dropped_now != 0, "the queue both drains and fills up under contention");
+    ok &= check(frames.size() + dropped_now == attempts, "every send is either delivered or counted as dropped");
+    ok &= check(dropped_now == refused.load(), "dropped counter matches refused sends");
+    return ok;
+}
+
+int main()
+{
+    bool ok = true;
+    ok &= test_receive();
+    ok &= test_queue_full();
+    ok &= test_contention();
+    return ok ? 0 : 1;
+}
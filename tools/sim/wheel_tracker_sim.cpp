@@ -0,0 +1,175 @@
+// 轮速跟踪器仿真
+// 合成M3508反馈流：标称1kHz，帧到达时刻抖动±80us，电调时钟比主控慢0.03%，随机丢0.5%的帧，
+// 轮速按转子rpm整数量化并带5rpm噪声。控制周期按主控1kHz取值，帧时刻和当前时刻用168MHz周期计数，
+// 中途跨过32位回绕。WheelTracker为固件代码，参数与chassis_control_task.cpp相同；
+// 对照为改动前的做法：控制周期直接取最近一帧，加速度为相邻两个周期的差分。
+// 检查:
+//   1. 匀速：加速度噪声和轮速噪声明显小于直接差分
+//   2. 3Hz正弦：加速度误差明显小于直接差分
+//   3. 加速度阶跃：10ms内达到63%；匀加速时轮速没有滞后
+//   4. 反馈中断超过外推时间后加速度为0，恢复后重新初始化
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "cpu_profiler.hpp"
+#include "wheel_tracker.hpp"
+
+// 与chassis_control_task.cpp相同
+constexpr float TRACKER_ALPHA = 0.3f;
+constexpr float TRACKER_BETA = 0.0529f;
+constexpr float TRACKER_FRAME_DT = 0.001f;
+constexpr float TRACKER_MAX_EXTRAPOLATE = 0.005f;
+
+constexpr uint32_t CYCLES_PER_US = 168;
+constexpr double CYCLES_PER_S = CYCLES_PER_US * 1e6;
+constexpr uint32_t START_CYCLES = 0xFFFFFFFFu - 168000000u;  // 1s后回绕
+constexpr double FRAME_PERIOD = 0.001 * 1.0003;              // 电调时钟慢0.03%
+constexpr double FRAME_JITTER = 80e-6;
+constexpr double DROP_RATE = 0.005;
+constexpr float GEAR_RATIO = 3591.0f / 187.0f;
+constexpr float RPM_TO_WHEEL = 2.0f * 3.14159265f / 60.0f / GEAR_RATIO;  // 转子rpm到轮速 rad/s
+constexpr float RPM_NOISE = 5.0f;
+
+uint32_t profiler_cycles_per_us() { return CYCLES_PER_US; }
+
+struct Stats
+{
+    double speed_sq = 0.0;  // 轮速误差平方和
+    double accel_sq = 0.0;  // 加速度误差平方和
+    uint32_t count = 0;
+
+    float speed_rms() const { return static_cast<float>(std::sqrt(speed_sq / count)); }
+    float accel_rms() const { return static_cast<float>(std::sqrt(accel_sq / count)); }
+};
+
+struct Run
+{
+    Stats tracker;
+    Stats raw;
+    std::vector<float> accel;  // 每个控制周期的跟踪器加速度
+};
+
+// truth(t) 返回 {轮速, 角加速度}；skip_from/skip_to 之间不发反馈帧 (s)
+static Run run(
+    const std::function<void(double, float &, float &)> & truth, double duration, double skip_from = -1.0,
+    double skip_to = -1.0)
+{
+    std::mt19937 rng(48);
+    std::uniform_real_distribution<double> jitter(-FRAME_JITTER, FRAME_JITTER);
+    std::uniform_real_distribution<double> drop(0.0, 1.0);
+    std::normal_distribution<float> noise(0.0f, RPM_NOISE);
+
+    WheelTracker tracker(TRACKER_ALPHA, TRACKER_BETA, TRACKER_FRAME_DT, TRACKER_MAX_EXTRAPOLATE);
+    Run r;
+    double next_frame = FRAME_PERIOD + jitter(rng);
+    float latest = 0.0f;          // 最近一帧的轮速
+    uint32_t latest_cycles = START_CYCLES;
+    float last_raw = 0.0f;
+    uint32_t frame_index = 1;
+    for (uint32_t tick = 1; tick * 0.001 <= duration; tick++) {
+        double now = tick * 0.001;
+        while (next_frame <= now) {
+            if (drop(rng) >= DROP_RATE && !(next_frame >= skip_from && next_frame < skip_to)) {
+                float speed, accel;
+                truth(next_frame, speed, accel);
+                float rpm = std::round(speed / RPM_TO_WHEEL + noise(rng));
+                latest = rpm * RPM_TO_WHEEL;
+                latest_cycles = START_CYCLES + static_cast<uint32_t>(static_cast<uint64_t>(next_frame * CYCLES_PER_S));
+            }
+            frame_index++;
+            next_frame = frame_index * FRAME_PERIOD + jitter(rng);
+        }
+        uint32_t now_cycles = START_CYCLES + static_cast<uint32_t>(static_cast<uint64_t>(now * CYCLES_PER_S));
+        tracker.update(latest, latest_cycles, now_cycles);
+        float raw_accel = (latest - last_raw) * 1000.0f;
+        last_raw = latest;
+
+        float speed, accel;
+        truth(now, speed, accel);
+        r.accel.push_back(tracker.accel);
+        // 起始100ms内跟踪器和差分都在收敛，不计入
+        if (now >= 0.1) {
+            r.tracker.speed_sq += (tracker.speed - speed) * (tracker.speed - speed);
+            r.tracker.accel_sq += (tracker.accel - accel) * (tracker.accel - accel);
+            r.tracker.count++;
+            r.raw.speed_sq += (latest - speed) * (latest - speed);
+            r.raw.accel_sq += (raw_accel - accel) * (raw_accel - accel);
+            r.raw.count++;
+        }
+    }
+    return r;
+}
+
+static bool check(bool ok, const char * what)
+{
+    if (!ok) fprintf(stderr, "FAIL: %s\n", what);
+    return ok;
+}
+
+int main()
+{
+    bool ok = true;
+
+    // 1. 匀速 20 rad/s
+    Run still = run([](double, float & s, float & a) { s = 20.0f; a = 0.0f; }, 2.0);
+    printf(
+        "constant     accel noise raw %6.1f  tracker %5.1f rad/s^2   speed noise raw %.3f  tracker %.3f rad/s\n",
+        still.raw.accel_rms(), still.tracker.accel_rms(), still.raw.speed_rms(), still.tracker.speed_rms());
+    ok &= check(still.tracker.accel_rms() < 0.1f * still.raw.accel_rms(), "tracker removes acceleration noise");
+    ok &= check(still.tracker.speed_rms() < still.raw.speed_rms(), "tracker reduces speed noise");
+
+    // 2. 3Hz正弦，幅值10 rad/s
+    constexpr double W = 2.0 * 3.14159265 * 3.0;
+    Run sine = run(
+        [](double t, float & s, float & a) {
+            s = static_cast<float>(20.0 + 10.0 * std::sin(W * t));
+            a = static_cast<float>(10.0 * W * std::cos(W * t));
+        },
+        2.0);
+    printf("3 Hz sine    accel error raw %6.1f  tracker %5.1f rad/s^2\n", sine.raw.accel_rms(), sine.tracker.accel_rms());
+    ok &= check(sine.tracker.accel_rms() < 0.4f * sine.raw.accel_rms(), "tracker follows acceleration");
+
+    // 3. 0.5s时加速度从0阶跃到100 rad/s^2
+    Run ramp = run(
+        [](double t, float & s, float & a) {
+            double ramp_time = std::max(t - 0.5, 0.0);
+            s = static_cast<float>(10.0 + 100.0 * ramp_time);
+            a = (t >= 0.5) ? 100.0f : 0.0f;
+        },
+        1.0);
+    uint32_t rise_ms = 0;
+    while (500 + rise_ms < ramp.accel.size() && ramp.accel[500 + rise_ms - 1] < 63.0f) rise_ms++;
+    // 全程匀加速时的轮速误差 (从100ms起统计)
+    Run ramp_late = run(
+        [](double t, float & s, float & a) {
+            s = static_cast<float>(10.0 + 100.0 * t);
+            a = 100.0f;
+        },
+        0.5);
+    printf(
+        "accel step   63%% rise %u ms   ramp speed error tracker %.3f raw %.3f rad/s\n", rise_ms,
+        ramp_late.tracker.speed_rms(), ramp_late.raw.speed_rms());
+    ok &= check(rise_ms <= 10, "acceleration step rises within 10 ms");
+    ok &= check(ramp_late.tracker.speed_rms() < ramp_late.raw.speed_rms(), "no speed lag on a ramp");
+
+    // 4. 0.5s起反馈中断20ms，期间加速度为0，恢复后重新初始化
+    Run gap = run(
+        [](double t, float & s, float & a) {
+            s = static_cast<float>(10.0 + 50.0 * t);
+            a = 50.0f;
+        },
+        1.0, 0.5, 0.52);
+    bool stale_zero = true;
+    for (uint32_t ms = 507; ms < 520; ms++) stale_zero = stale_zero && gap.accel[ms - 1] == 0.0f;
+    float recovered = gap.accel[600 - 1];
+    printf("feedback gap accel during gap %s, 80 ms after %.1f rad/s^2\n", stale_zero ? "0" : "nonzero", recovered);
+    ok &= check(stale_zero, "stale feedback reports zero acceleration");
+    ok &= check(std::abs(recovered - 50.0f) < 10.0f, "tracker recovers after the gap");
+
+    return ok ? 0 : 1;
+}
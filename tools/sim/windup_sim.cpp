@@ -0,0 +1,141 @@
+// 饱和恢复回放
+// 同一底盘模型 (chassis_plant) 上比较两条轮速环链路：
+//   改动前：PID之后按功率缩放力矩，没有设定值加速度限制，积分项不反算 (与sp::PID相同，累积到±mio)
+//   当前：功率感知的设定值加速度限制 (AccelLimiter) 加WheelPid反算抗饱和，反算增益PID_KB
+// 两段饱和，结束后设定值都是1m/s：
+//   顶着功率上限：前进设定值2m/s超出80W下可持续的车速，3s后降到1m/s
+//   车轮卡住：设定值1m/s，车轮被障碍物卡住 (车速保持为零) 1s后松开
+// 统计饱和结束时的积分项、之后超过设定值的超调 (从0.5s起，避开降速的过渡)，
+// 与一直没有饱和、在1m/s上开了8s的参照比较。PID_KI很小 (积分时间约10s)，
+// 积分项一旦偏离要很久才能回来，车速的偏差会一直留着
+// 检查:
+//   1. 当前链路饱和结束后不超调，改动前积分饱和到mio，车速一直高于设定值
+//   2. 当前链路饱和结束时积分项在零和参照之间：既没有累积，也没有被反算推到另一侧
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+
+#include "chassis_plant.hpp"
+
+constexpr float POWER_LIMIT = 80.0f;
+constexpr float TARGET_SET = 1.0f;       // m/s
+constexpr float LIMIT_SET = 2.0f;        // m/s，80W下到不了
+constexpr uint32_t SATURATED_MS = 3000;  // 顶着功率上限的时长
+constexpr uint32_t BLOCKED_MS = 1000;
+constexpr uint32_t SETTLE_MS = 500;      // 饱和结束后不统计超调的过渡时间
+constexpr uint32_t RECOVER_MS = 2000;
+constexpr uint32_t REFERENCE_MS = 8000;
+constexpr float INTEGRAL_MARGIN = 0.02f; // N·m
+
+enum class Saturation
+{
+    POWER_LIMIT,
+    BLOCKED,
+};
+
+struct Recovery
+{
+    float integral = 0.0f;   // 饱和结束时各轮积分项的均值 (前进方向) N·m
+    float overshoot = 0.0f;  // 超过设定值的最大量，设定值的比例
+    float speed_1s = 0.0f;   // 饱和结束1s后的车速 m/s
+    float speed_2s = 0.0f;
+};
+
+// 左右轮转向相反，按前进方向取符号
+static float forward_integral(const ChassisLoop & loop)
+{
+    return 0.25f * (loop.pid[0].ir + loop.pid[1].ir - loop.pid[2].ir - loop.pid[3].ir);
+}
+
+// 参照：一直没有饱和，在TARGET_SET上开了REFERENCE_MS
+static Recovery reference(const LoopConfig & config)
+{
+    ChassisLoop loop(config);
+    ChassisPlant plant;
+    for (uint32_t t = 0; t < REFERENCE_MS; t++) {
+        loop.update(TARGET_SET, 0.0f, 0.0f, plant.wheel);
+        plant.step(loop.torque, PID_DT);
+    }
+    Recovery r;
+    r.integral = forward_integral(loop);
+    r.speed_1s = plant.v[0];
+    r.speed_2s = plant.v[0];
+    return r;
+}
+
+static Recovery recover(const LoopConfig & config, Saturation saturation)
+{
+    ChassisLoop loop(config);
+    ChassisPlant plant;
+    if (saturation == Saturation::POWER_LIMIT) {
+        for (uint32_t t = 0; t < SATURATED_MS; t++) {
+            loop.update(LIMIT_SET, 0.0f, 0.0f, plant.wheel);
+            plant.step(loop.torque, PID_DT);
+        }
+    }
+    else {
+        for (uint32_t t = 0; t < BLOCKED_MS; t++) {
+            loop.update(TARGET_SET, 0.0f, 0.0f, plant.wheel);
+            plant.step(loop.torque, PID_DT);
+            plant.set_velocity(0.0f, 0.0f, 0.0f);
+        }
+    }
+
+    Recovery r;
+    r.integral = forward_integral(loop);
+    for (uint32_t t = 1; t <= RECOVER_MS; t++) {
+        loop.update(TARGET_SET, 0.0f, 0.0f, plant.wheel);
+        plant.step(loop.torque, PID_DT);
+        if (t >= SETTLE_MS) r.overshoot = std::max(r.overshoot, (plant.v[0] - TARGET_SET) / TARGET_SET);
+        if (t == 1000) r.speed_1s = plant.v[0];
+    }
+    r.speed_2s = plant.v[0];
+    return r;
+}
+
+static bool check(bool ok, const char * what)
+{
+    if (!ok) fprintf(stderr, "FAIL: %s\n", what);
+    return ok;
+}
+
+static void print(const char * name, const Recovery & r)
+{
+    printf(
+        "%-32s integral %6.3f N*m  overshoot %5.1f%%  speed after 1 s %5.3f, 2 s %5.3f m/s\n", name, r.integral,
+        100.0f * r.overshoot, r.speed_1s, r.speed_2s);
+}
+
+int main()
+{
+    bool ok = true;
+
+    LoopConfig before;
+    before.power_limit = POWER_LIMIT;
+    before.accel_limit = false;
+    before.kb = 0.0f;
+    LoopConfig now;
+    now.power_limit = POWER_LIMIT;
+
+    print("never saturated, before", reference(before));
+    Recovery now_reference = reference(now);
+    print("never saturated, now", now_reference);
+
+    const Saturation cases[] = {Saturation::POWER_LIMIT, Saturation::BLOCKED};
+    const char * names[] = {"held at the power limit", "wheels blocked"};
+    for (int i = 0; i < 2; i++) {
+        Recovery b = recover(before, cases[i]);
+        Recovery n = recover(now, cases[i]);
+        char name[64];
+        snprintf(name, sizeof(name), "%s, before", names[i]);
+        print(name, b);
+        snprintf(name, sizeof(name), "%s, now", names[i]);
+        print(name, n);
+        ok &= check(n.overshoot == 0.0f && b.overshoot > 0.0f, "back-calculation removes the wind-up overshoot");
+        ok &= check(
+            n.integral >= -INTEGRAL_MARGIN && n.integral <= now_reference.integral + INTEGRAL_MARGIN,
+            "saturation neither winds the integral up nor pushes it to the other side");
+    }
+
+    return ok ? 0 : 1;
+}